@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Turbo
+{
+	static std::atomic<uint64> gNumAllocations = 0;
+	static std::atomic<uint64> gAllocatedBytes = 0;
+
+	static void* CountedAllocate(size_t size, size_t alignment)
+	{
+		gNumAllocations.fetch_add(1, std::memory_order_relaxed);
+		gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		size = glm::max<size_t>(size, 1);
+
+		void* result = nullptr;
+		if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		{
+			result = std::malloc(size);
+		}
+		else
+		{
+#if PLATFORM_WINDOWS
+			result = _aligned_malloc(size, alignment);
+#else
+			result = std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+		}
+
+		if (result == nullptr)
+		{
+			std::abort();
+		}
+
+		return result;
+	}
+
+	static void CountedFree(void* ptr, size_t alignment)
+	{
+#if PLATFORM_WINDOWS
+		if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		{
+			_aligned_free(ptr);
+			return;
+		}
+#endif
+		std::free(ptr);
+	}
+
+	FBenchmarkState::FBenchmarkState(uint32 numWarmupFrames, uint32 numFrames)
+		: mNumWarmupFrames(numWarmupFrames)
+		, mNumFrames(glm::max(numFrames, 1u))
+	{
+	}
+
+	bool FBenchmarkState::KeepRunning()
+	{
+		if (mFrame == mNumWarmupFrames)
+		{
+			mStartAllocations = Benchmark::GetNumAllocations();
+			mStartAllocatedBytes = Benchmark::GetAllocatedBytes();
+			mStartTime = FClock::now();
+		}
+		else if (mFrame == mNumWarmupFrames + mNumFrames)
+		{
+			mEndTime = FClock::now();
+			mEndAllocations = Benchmark::GetNumAllocations();
+			mEndAllocatedBytes = Benchmark::GetAllocatedBytes();
+			return false;
+		}
+
+		++mFrame;
+		return true;
+	}
+
+	double FBenchmarkState::GetNsPerFrame() const
+	{
+		const std::chrono::duration<double, std::nano> duration = mEndTime - mStartTime;
+		return duration.count() / mNumFrames;
+	}
+
+	double FBenchmarkState::GetAllocationsPerFrame() const
+	{
+		return static_cast<double>(mEndAllocations - mStartAllocations) / mNumFrames;
+	}
+
+	double FBenchmarkState::GetAllocatedBytesPerFrame() const
+	{
+		return static_cast<double>(mEndAllocatedBytes - mStartAllocatedBytes) / mNumFrames;
+	}
+
+	FAutoBenchmark::FAutoBenchmark(std::string_view name, FBenchmarkFunction function, std::initializer_list<uint32> sizes)
+	{
+		for (const uint32 size : sizes)
+		{
+			Benchmark::GetRegisteredBenchmarks().push_back({name, function, size});
+		}
+	}
+
+	std::vector<FRegisteredBenchmark>& Benchmark::GetRegisteredBenchmarks()
+	{
+		static std::vector<FRegisteredBenchmark> gBenchmarks;
+		return gBenchmarks;
+	}
+
+	uint64 Benchmark::GetNumAllocations()
+	{
+		return gNumAllocations.load(std::memory_order_relaxed);
+	}
+
+	uint64 Benchmark::GetAllocatedBytes()
+	{
+		return gAllocatedBytes.load(std::memory_order_relaxed);
+	}
+} // Turbo
+
+// Replaced global allocation functions, they count every heap allocation of the process
+void* operator new(size_t size) { return Turbo::CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return Turbo::CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) { return Turbo::CountedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return Turbo::CountedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Turbo::CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Turbo::CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+
+void operator delete(void* ptr) noexcept { Turbo::CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* ptr) noexcept { Turbo::CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* ptr, size_t) noexcept { Turbo::CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* ptr, size_t) noexcept { Turbo::CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { Turbo::CountedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { Turbo::CountedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { Turbo::CountedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { Turbo::CountedFree(ptr, static_cast<size_t>(alignment)); }
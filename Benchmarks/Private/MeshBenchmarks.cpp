@@ -0,0 +1,77 @@
+#include "Benchmark.h"
+
+#include "Assets/StaticMesh.h"
+
+namespace Turbo
+{
+	/** Wavy height field of quads, two triangles per quad. Curved, so the simplification has some error to weigh. */
+	static void CreateGridMesh(uint32 numQuadsPerSide, std::vector<uint32>& outIndices, std::vector<glm::float3>& outPositions)
+	{
+		const uint32 numVerticesPerSide = numQuadsPerSide + 1;
+		outPositions.reserve(numVerticesPerSide * numVerticesPerSide);
+		for (uint32 y = 0; y < numVerticesPerSide; ++y)
+		{
+			for (uint32 x = 0; x < numVerticesPerSide; ++x)
+			{
+				const float height = glm::sin(static_cast<float>(x) * 0.2f) * glm::cos(static_cast<float>(y) * 0.2f) * 4.f;
+				outPositions.emplace_back(static_cast<float>(x), static_cast<float>(y), height);
+			}
+		}
+
+		outIndices.reserve(numQuadsPerSide * numQuadsPerSide * 6);
+		for (uint32 y = 0; y < numQuadsPerSide; ++y)
+		{
+			for (uint32 x = 0; x < numQuadsPerSide; ++x)
+			{
+				const uint32 corner = y * numVerticesPerSide + x;
+				outIndices.insert(outIndices.end(), {corner, corner + 1, corner + numVerticesPerSide});
+				outIndices.insert(outIndices.end(), {corner + 1, corner + numVerticesPerSide + 1, corner + numVerticesPerSide});
+			}
+		}
+	}
+
+	/** Cluster building done by the mesh import, see MeshClusters::Build */
+	static void BenchmarkBuildClusters(FBenchmarkState& state, uint32 numQuadsPerSide)
+	{
+		std::vector<uint32> sourceIndices;
+		std::vector<glm::float3> positions;
+		CreateGridMesh(numQuadsPerSide, sourceIndices, positions);
+
+		std::vector<uint32> indices;
+		std::vector<FMeshCluster> clusters;
+		while (state.KeepRunning())
+		{
+			// Indices are reordered in place
+			indices = sourceIndices;
+			MeshClusters::Build(indices, positions, clusters);
+
+			Benchmark::DoNotOptimize(clusters.data());
+		}
+
+		state.SetCounter("clusters", clusters.size());
+	}
+
+	/** LOD chain simplification done by the mesh import, see MeshLods::Build */
+	static void BenchmarkBuildLods(FBenchmarkState& state, uint32 numQuadsPerSide)
+	{
+		std::vector<uint32> sourceIndices;
+		std::vector<glm::float3> positions;
+		CreateGridMesh(numQuadsPerSide, sourceIndices, positions);
+
+		std::vector<uint32> indices;
+		std::vector<FMeshLod> lods;
+		while (state.KeepRunning())
+		{
+			// LODs are appended to the indices
+			indices = sourceIndices;
+			MeshLods::Build(indices, positions, lods);
+
+			Benchmark::DoNotOptimize(lods.data());
+		}
+
+		state.SetCounter("lods", lods.size());
+	}
+
+	static FAutoBenchmark gBuildClustersBenchmark("mesh.buildClusters", &BenchmarkBuildClusters, {32, 128, 512});
+	static FAutoBenchmark gBuildLodsBenchmark("mesh.buildLods", &BenchmarkBuildLods, {32, 128, 512});
+} // Turbo
@@ -0,0 +1,80 @@
+#include "Benchmark.h"
+
+#include "Core/DataStructures/PagedGenPool.h"
+
+namespace Turbo
+{
+	struct FPooledResource
+	{
+		uint64 mPayload = 0;
+	};
+
+	using FResourcePool = TPagedGenPool<FPooledResource, FDummyColdType, true, 256>;
+
+	/**
+	 * Acquire and release churn of a pool with a limited capacity, the way the bindless texture and sampler pools are used.
+	 * The setup lowers and raises the limit first, the pool has to keep reporting the indices it can actually hand out.
+	 */
+	static void BenchmarkPoolAcquireRelease(FBenchmarkState& state, uint32 numHandles)
+	{
+		// Limit in the middle of a page, so the free indices of the last page are cut off
+		const FHandle::IndexType maxCapacity = numHandles + FResourcePool::GetPageSize() / 2;
+		FResourcePool pool(maxCapacity);
+
+		std::vector<THandle<FPooledResource>> handles;
+		handles.reserve(maxCapacity);
+		for (uint32 handleId = 0; handleId < maxCapacity; ++handleId)
+		{
+			handles.push_back(pool.Acquire());
+		}
+		TURBO_CHECK(pool.GetCapacity() == maxCapacity)
+
+		// Lowering the limit only needs the handles above it released, not the highest handle ever acquired
+		for (uint32 handleId = numHandles; handleId < maxCapacity; ++handleId)
+		{
+			pool.Release(handles[handleId]);
+		}
+		handles.resize(numHandles);
+		pool.SetMaxCapacity(numHandles);
+		TURBO_CHECK(pool.GetCapacity() == numHandles)
+
+		// Raising it gives back the cut off indices of the existing pages
+		const FHandle::IndexType numPages = pool.GetNumPages();
+		const FHandle::IndexType numPageIndices = numPages * FResourcePool::GetPageSize();
+		pool.SetMaxCapacity(numPageIndices);
+		TURBO_CHECK(pool.GetCapacity() == numPageIndices)
+		while (handles.size() < numPageIndices)
+		{
+			handles.push_back(pool.Acquire());
+		}
+		TURBO_CHECK(pool.GetNumPages() == numPages)
+
+		for (const THandle<FPooledResource> handle : handles)
+		{
+			pool.Release(handle);
+		}
+		handles.clear();
+
+		state.RequireNoAllocations();
+		while (state.KeepRunning())
+		{
+			for (uint32 handleId = 0; handleId < numHandles; ++handleId)
+			{
+				const THandle<FPooledResource> handle = pool.Acquire();
+				pool.Access(handle)->mPayload = handleId;
+				handles.push_back(handle);
+			}
+
+			for (const THandle<FPooledResource> handle : handles)
+			{
+				Benchmark::DoNotOptimize(pool.Access(handle)->mPayload);
+				pool.Release(handle);
+			}
+			handles.clear();
+		}
+
+		state.SetCounter("pages", pool.GetNumPages());
+	}
+
+	static FAutoBenchmark gPoolAcquireReleaseBenchmark("pool.acquireRelease", &BenchmarkPoolAcquireRelease, {256, 4096, 65536});
+} // Turbo
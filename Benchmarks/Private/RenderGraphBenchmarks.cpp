@@ -0,0 +1,250 @@
+#include "Benchmark.h"
+
+#include "Debug/IConsoleManager.h"
+#include "Graphics/CommandBuffer.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/FrameGraph/RenderGraph.h"
+
+namespace Turbo
+{
+	/**
+	 * Synthetic frame resembling the scene rendering: graphics passes rendering to new targets which the following
+	 * passes sample, compute passes writing buffers, some async compute, and a few passes which get culled.
+	 */
+	static void BuildSyntheticGraph(FRenderGraphBuilder& graphBuilder, uint32 numPasses)
+	{
+		const static FName passName("SyntheticPass");
+		const static FName textureName("SyntheticTexture");
+		const static FName bufferName("SyntheticBuffer");
+
+		auto emptyExecute = [](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources) { };
+
+		const FRGResourceHandle depth = graphBuilder.CreateTexture({
+			.mWidth = 1920,
+			.mHeight = 1080,
+			.mFormat = vk::Format::eD32Sfloat,
+			.mFlags = ETextureFlags::RenderTarget,
+			.mName = textureName
+		});
+
+		FRGResourceHandle lastTexture = {};
+		FRGResourceHandle lastBuffer = {};
+
+		for (uint32 passId = 0; passId < numPasses; ++passId)
+		{
+			switch (passId % 4)
+			{
+			case 0:
+			case 1:
+			{
+				const FRGResourceHandle target = graphBuilder.CreateTexture({
+					.mWidth = 1920,
+					.mHeight = 1080,
+					.mFormat = vk::Format::eR16G16B16A16Sfloat,
+					.mFlags = ETextureFlags::RenderTarget | ETextureFlags::Default,
+					.mName = textureName
+				});
+
+				FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Graphics);
+				pass->AddAttachment({.mTexture = target, .mLoadOp = ELoadOp::Clear, .mClearColor = EClearColor::OpaqueBlack}, 0);
+				pass->SetDepthStencilAttachment({.mTexture = depth, .mLoadOp = passId == 0 ? ELoadOp::Clear : ELoadOp::Load});
+				if (lastTexture.IsValid())
+				{
+					pass->ReadTexture(lastTexture);
+				}
+				if (lastBuffer.IsValid())
+				{
+					pass->ReadBuffer(lastBuffer);
+				}
+				pass->BindExecute(emptyExecute);
+
+				lastTexture = target;
+				break;
+			}
+			case 2:
+			{
+				const FRGResourceHandle output = graphBuilder.CreateTexture({
+					.mWidth = 960,
+					.mHeight = 540,
+					.mFormat = vk::Format::eR16G16B16A16Sfloat,
+					.mFlags = ETextureFlags::StorageImage | ETextureFlags::Default,
+					.mName = textureName
+				});
+
+				FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Compute);
+				pass->ReadTexture(lastTexture);
+				pass->WriteTexture(output);
+				pass->BindExecute(emptyExecute);
+
+				lastTexture = output;
+				break;
+			}
+			case 3:
+			{
+				const FRGResourceHandle buffer = graphBuilder.CreateBuffer({
+					.mSize = 64 * Constants::kKibi,
+					.mBufferFlags = EBufferFlags::StorageBuffer | EBufferFlags::IndirectBuffer,
+					.mName = bufferName
+				});
+
+				// Every other buffer pass is never read, so it's culled
+				const bool bAsyncCompute = (passId / 4) % 2 == 0;
+				FRGPassInitializer pass = graphBuilder.AddPass(passName, bAsyncCompute ? EPassType::AsyncCompute : EPassType::Compute);
+				pass->WriteBuffer(buffer);
+				pass->BindExecute(emptyExecute);
+
+				if (bAsyncCompute)
+				{
+					lastBuffer = buffer;
+				}
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		graphBuilder.ExportResource(lastTexture);
+	}
+
+	static void SetConsoleVariable(std::string_view name, bool bEnabled)
+	{
+		FConsoleVariable* variable = IConsoleManager::Get().FindConsoleVariable(name);
+		TURBO_CHECK(variable)
+		variable->Set(bEnabled);
+	}
+
+	/**
+	 * Steady state benchmarks run one frame before the measurement, so the arenas, the compile cache and the resource pool
+	 * are filled even without warmup frames.
+	 */
+	static void BenchmarkBuildGraph(FBenchmarkState& state, uint32 numPasses)
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FRenderGraphBuilder graphBuilder;
+
+		graphBuilder.Reset(gpu);
+		BuildSyntheticGraph(graphBuilder, numPasses);
+
+		state.RequireNoAllocations();
+		while (state.KeepRunning())
+		{
+			graphBuilder.Reset(gpu);
+			BuildSyntheticGraph(graphBuilder, numPasses);
+		}
+
+		state.SetCounter("textures", graphBuilder.mTextures.size());
+		graphBuilder.ReleaseResources(gpu);
+	}
+
+	static void BenchmarkCompileGraph(FBenchmarkState& state, uint32 numPasses)
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FRenderGraphBuilder graphBuilder;
+
+		SetConsoleVariable("rg.compileCache", false);
+
+		// Every frame compiles from scratch, the compilation scratch is reused
+		graphBuilder.Reset(gpu);
+		BuildSyntheticGraph(graphBuilder, numPasses);
+		graphBuilder.Compile();
+
+		state.RequireNoAllocations();
+		while (state.KeepRunning())
+		{
+			graphBuilder.Reset(gpu);
+			BuildSyntheticGraph(graphBuilder, numPasses);
+			graphBuilder.Compile();
+		}
+		SetConsoleVariable("rg.compileCache", true);
+
+		state.SetCounter("culled", graphBuilder.mNumCulledPasses);
+		graphBuilder.ReleaseResources(gpu);
+	}
+
+	static void BenchmarkCompileGraphCached(FBenchmarkState& state, uint32 numPasses)
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FRenderGraphBuilder graphBuilder;
+
+		graphBuilder.Reset(gpu);
+		BuildSyntheticGraph(graphBuilder, numPasses);
+		graphBuilder.Compile();
+
+		state.RequireNoAllocations();
+		while (state.KeepRunning())
+		{
+			graphBuilder.Reset(gpu);
+			BuildSyntheticGraph(graphBuilder, numPasses);
+			graphBuilder.Compile();
+		}
+
+		state.SetCounter("cache hits", graphBuilder.GetNumCompileCacheHits());
+		graphBuilder.ReleaseResources(gpu);
+	}
+
+	/** Whole frame of the graph, recorded into a null command buffer. The null device has no async compute queue. */
+	static void BenchmarkExecuteGraph(FBenchmarkState& state, uint32 numPasses)
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FRenderGraphBuilder graphBuilder;
+		const TUniquePtr<FCommandBuffer> cmd = gpu.CreateNullCommandBuffer();
+
+		// Null device has no memory to place the aliased resources in
+		SetConsoleVariable("rg.aliasing", false);
+
+		graphBuilder.Reset(gpu);
+		BuildSyntheticGraph(graphBuilder, numPasses);
+		graphBuilder.Compile();
+		graphBuilder.Execute(gpu, *cmd);
+
+		state.RequireNoAllocations();
+		while (state.KeepRunning())
+		{
+			graphBuilder.Reset(gpu);
+			BuildSyntheticGraph(graphBuilder, numPasses);
+			graphBuilder.Compile();
+			graphBuilder.Execute(gpu, *cmd);
+		}
+		SetConsoleVariable("rg.aliasing", true);
+
+		state.SetCounter("barriers", graphBuilder.GetNumBarriers());
+		graphBuilder.ReleaseResources(gpu);
+	}
+
+	/** Only the barrier compilation, the graph is compiled once in the setup */
+	static void BenchmarkCompileBarriers(FBenchmarkState& state, uint32 numPasses)
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FRenderGraphBuilder graphBuilder;
+
+		graphBuilder.Reset(gpu);
+		BuildSyntheticGraph(graphBuilder, numPasses);
+		graphBuilder.Compile();
+
+		while (state.KeepRunning())
+		{
+			graphBuilder.CompileTextureSynchronization();
+			graphBuilder.CompileBufferSynchronization();
+		}
+
+		uint32 numBarriers = 0;
+		for (const std::vector<FRGTextureMemoryBarrier>& passBarriers : graphBuilder.mPerPassTextureBarriers)
+		{
+			numBarriers += passBarriers.size();
+		}
+		for (const std::vector<FRGBufferMemoryBarrier>& passBarriers : graphBuilder.mPerPassBufferBarriers)
+		{
+			numBarriers += passBarriers.size();
+		}
+
+		state.SetCounter("barriers", numBarriers);
+		graphBuilder.ReleaseResources(gpu);
+	}
+
+	static FAutoBenchmark gBuildGraphBenchmark("rg.build", &BenchmarkBuildGraph, {64, 512, 4096});
+	static FAutoBenchmark gCompileGraphBenchmark("rg.compile", &BenchmarkCompileGraph, {64, 512, 4096});
+	static FAutoBenchmark gCompileGraphCachedBenchmark("rg.compile.cached", &BenchmarkCompileGraphCached, {64, 512, 4096});
+	static FAutoBenchmark gExecuteGraphBenchmark("rg.execute", &BenchmarkExecuteGraph, {64, 512, 4096});
+	static FAutoBenchmark gCompileBarriersBenchmark("rg.compile.barriers", &BenchmarkCompileBarriers, {64, 512, 4096});
+} // Turbo
@@ -0,0 +1,97 @@
+#include "Benchmark.h"
+
+#include <random>
+
+#include "Graphics/DrawCalls.h"
+#include "Graphics/GPUScene.h"
+#include "World/MeshComponent.h"
+#include "World/SceneGraph.h"
+
+namespace Turbo
+{
+	static constexpr uint32 kNumSyntheticMaterials = 16;
+	static constexpr uint32 kNumSyntheticMaterialInstances = 256;
+	static constexpr uint32 kNumSyntheticMeshes = 1024;
+
+	template <typename HandleType>
+	static HandleType MakeHandle(uint32 index)
+	{
+		HandleType handle;
+		handle.mIndexAndGen = FHandle::CreateIndex(index, 0);
+		return handle;
+	}
+
+	/** Mesh entities spread over a few materials, in the random order the level loading would leave them */
+	static void CreateSyntheticScene(entt::registry& registry, uint32 numEntities)
+	{
+		std::mt19937 random(numEntities);
+		std::uniform_int_distribution<uint32> materialDistribution(0, kNumSyntheticMaterials - 1);
+		std::uniform_int_distribution<uint32> instanceDistribution(0, kNumSyntheticMaterialInstances - 1);
+		std::uniform_int_distribution<uint32> meshDistribution(0, kNumSyntheticMeshes - 1);
+		std::uniform_real_distribution<float> positionDistribution(-1000.f, 1000.f);
+
+		for (uint32 entityId = 0; entityId < numEntities; ++entityId)
+		{
+			const entt::entity entity = registry.create();
+
+			registry.emplace<FMeshComponent>(entity, FMeshComponent{
+				.mMesh = MakeHandle<THandle<FMesh>>(meshDistribution(random)),
+				.mMaterial = MakeHandle<THandle<FMaterial>>(materialDistribution(random)),
+				.mMaterialInstance = MakeHandle<THandle<FMaterial::Instance>>(instanceDistribution(random))
+			});
+
+			const glm::float3 position(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			registry.emplace<FWorldTransform>(entity, FWorldTransform{glm::translate(glm::float4x4(1.f), position)});
+			registry.emplace<FGPUSceneInstanceId>(entity, FGPUSceneInstanceId{entityId});
+		}
+	}
+
+	/** Gathering, sorting and bucketing draw calls, see FGPUScene::RebuildDrawLists */
+	static void BenchmarkGatherDrawCalls(FBenchmarkState& state, uint32 numEntities)
+	{
+		entt::registry registry;
+		CreateSyntheticScene(registry, numEntities);
+
+		size_t numBuckets = 0;
+		while (state.KeepRunning())
+		{
+			FDrawCallStorage drawCalls;
+			DrawCalls::GatherDrawCalls(registry, drawCalls);
+
+			std::vector<FMaterialBucket> materialBuckets;
+			DrawCalls::CreateMaterialBuckets(drawCalls, materialBuckets);
+
+			numBuckets = materialBuckets.size();
+			Benchmark::DoNotOptimize(numBuckets);
+		}
+
+		state.SetCounter("buckets", numBuckets);
+	}
+
+	/** Instance transforms and world bounds of every mesh entity, written the same way as the GPU scene updates */
+	static void BenchmarkInstanceTransforms(FBenchmarkState& state, uint32 numEntities)
+	{
+		entt::registry registry;
+		CreateSyntheticScene(registry, numEntities);
+
+		const auto transformView = registry.view<FWorldTransform>();
+		const FBounds meshBounds = {.mMin = glm::float3(-1.f), .mRadius = glm::sqrt(3.f), .mMax = glm::float3(1.f), .mRadiusSquared = 3.f};
+		std::vector<FGPUSceneInstance> instances(transformView.size());
+
+		while (state.KeepRunning())
+		{
+			uint32 instanceIndex = 0;
+			for (entt::entity entity : transformView)
+			{
+				FGPUSceneInstance instance;
+				FGPUScene::FillInstanceTransforms(transformView.get<FWorldTransform>(entity).mTransform, meshBounds, instance);
+				instances[instanceIndex++] = instance;
+			}
+
+			Benchmark::DoNotOptimize(instances.data());
+		}
+	}
+
+	static FAutoBenchmark gGatherDrawCallsBenchmark("scene.gatherDrawCalls", &BenchmarkGatherDrawCalls, {1'000, 10'000, 50'000, 200'000});
+	static FAutoBenchmark gInstanceTransformsBenchmark("scene.instanceTransforms", &BenchmarkInstanceTransforms, {1'000, 10'000, 50'000, 200'000});
+} // Turbo
@@ -0,0 +1,80 @@
+#include "Benchmark.h"
+
+#include "Core/CommandLineArgs.h"
+#include "Debug/IConsoleManager.h"
+#include "Graphics/GPUDevice.h"
+
+/**
+ * Headless CPU benchmarks of the render graph and the scene draw preparation. GPU calls go to a null device.
+ *
+ *		--filter <substring>	Runs only the benchmarks which names contain the substring
+ *		--frames <n>			Number of measured frames
+ *		--warmup <n>			Number of frames before the measurement
+ *		--exec "<command>"		Console command executed before the benchmarks, e.g. "rg.compileCache 0"
+ *		--csv					Prints the results as csv
+ *
+ * Exits with 1 when a benchmark requiring no allocations in its steady state allocated.
+ */
+int32_t main(int argc, char* argv[])
+{
+	using namespace Turbo;
+
+	FCommandLineArgs::Parse(argc, argv);
+
+	const std::string_view filter = FCommandLineArgs::ParseString("filter").value_or("");
+	const uint32 numFrames = glm::max(FCommandLineArgs::ParseInt("frames").value_or(100), 1);
+	const uint32 numWarmupFrames = glm::max(FCommandLineArgs::ParseInt("warmup").value_or(10), 0);
+	const bool bCsv = FCommandLineArgs::HasFlag("csv");
+
+	entt::locator<FGPUDevice>::reset(FGPUDevice::CreateNullDevice());
+
+	if (const std::optional<std::string_view> command = FCommandLineArgs::ParseString("exec"))
+	{
+		IConsoleManager::Get().Parse(command.value());
+	}
+
+	if (bCsv)
+	{
+		fmt::println("name,size,ns/frame,allocs/frame,bytes/frame,counter,value");
+	}
+	else
+	{
+		fmt::println("{:<24} {:>8} {:>14} {:>14} {:>14}   {}", "Benchmark", "Size", "ns/frame", "allocs/frame", "bytes/frame", "Counter");
+	}
+
+	int32_t exitCode = 0;
+	for (const FRegisteredBenchmark& benchmark : Benchmark::GetRegisteredBenchmarks())
+	{
+		if (!filter.empty() && benchmark.mName.find(filter) == std::string_view::npos)
+		{
+			continue;
+		}
+
+		FBenchmarkState state(numWarmupFrames, numFrames);
+		benchmark.mFunction(state, benchmark.mSize);
+
+		if (bCsv)
+		{
+			fmt::println("{},{},{:.0f},{:.1f},{:.0f},{},{}",
+				benchmark.mName, benchmark.mSize, state.GetNsPerFrame(), state.GetAllocationsPerFrame(), state.GetAllocatedBytesPerFrame(),
+				state.GetCounterName(), state.GetCounter());
+		}
+		else
+		{
+			fmt::println("{:<24} {:>8} {:>14.0f} {:>14.1f} {:>14.0f}   {} {}",
+				benchmark.mName, benchmark.mSize, state.GetNsPerFrame(), state.GetAllocationsPerFrame(), state.GetAllocatedBytesPerFrame(),
+				state.GetCounterName(), state.GetCounter());
+		}
+
+		if (state.HasFailed())
+		{
+			fmt::println(stderr, "FAILED {} {}: {:.1f} heap allocations per frame, expected none",
+				benchmark.mName, benchmark.mSize, state.GetAllocationsPerFrame());
+			exitCode = 1;
+		}
+	}
+
+	entt::locator<FGPUDevice>::reset();
+
+	return exitCode;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+
+namespace Turbo
+{
+	/**
+	 * Drives the measured loop of a benchmark:
+	 *
+	 *		// setup, not measured
+	 *		while (state.KeepRunning())
+	 *		{
+	 *			// one frame
+	 *		}
+	 *
+	 * The first frames are warmup. Time and heap allocations are counted from the end of the warmup to the end of the last frame.
+	 * Benchmarks of steady state frames call RequireNoAllocations, any measured allocation then fails the run.
+	 */
+	class FBenchmarkState final
+	{
+	public:
+		FBenchmarkState(uint32 numWarmupFrames, uint32 numFrames);
+
+		[[nodiscard]] bool KeepRunning();
+
+		[[nodiscard]] uint32 GetNumFrames() const { return mNumFrames; }
+		[[nodiscard]] double GetNsPerFrame() const;
+		[[nodiscard]] double GetAllocationsPerFrame() const;
+		[[nodiscard]] double GetAllocatedBytesPerFrame() const;
+
+		void RequireNoAllocations() { mbRequireNoAllocations = true; }
+		[[nodiscard]] bool HasFailed() const { return mbRequireNoAllocations && mEndAllocations > mStartAllocations; }
+
+		/** Benchmark specific value printed with the results, e.g. the number of buckets */
+		void SetCounter(std::string_view name, double value) { mCounterName = name; mCounter = value; }
+		[[nodiscard]] std::string_view GetCounterName() const { return mCounterName; }
+		[[nodiscard]] double GetCounter() const { return mCounter; }
+
+	private:
+		using FClock = std::chrono::steady_clock;
+
+		uint32 mNumWarmupFrames = 0;
+		uint32 mNumFrames = 0;
+		uint32 mFrame = 0;
+
+		FClock::time_point mStartTime = {};
+		FClock::time_point mEndTime = {};
+		uint64 mStartAllocations = 0;
+		uint64 mEndAllocations = 0;
+		uint64 mStartAllocatedBytes = 0;
+		uint64 mEndAllocatedBytes = 0;
+		bool mbRequireNoAllocations = false;
+
+		std::string_view mCounterName = {};
+		double mCounter = 0.0;
+	};
+
+	using FBenchmarkFunction = void(*)(FBenchmarkState& state, uint32 size);
+
+	/** Registers the benchmark once per size at the static initialization, see FAutoConsoleCommand */
+	struct FAutoBenchmark final
+	{
+		FAutoBenchmark(std::string_view name, FBenchmarkFunction function, std::initializer_list<uint32> sizes);
+	};
+
+	struct FRegisteredBenchmark
+	{
+		std::string_view mName = {};
+		FBenchmarkFunction mFunction = nullptr;
+		uint32 mSize = 0;
+	};
+
+	namespace Benchmark
+	{
+		[[nodiscard]] std::vector<FRegisteredBenchmark>& GetRegisteredBenchmarks();
+
+		/** Heap allocations made through the global operator new since the start of the process */
+		[[nodiscard]] uint64 GetNumAllocations();
+		[[nodiscard]] uint64 GetAllocatedBytes();
+
+		/** Keeps the optimizer from removing computations which results are otherwise unused */
+		template <typename T>
+		void DoNotOptimize(const T& value)
+		{
+			asm volatile("" : : "r,m"(value) : "memory");
+		}
+	}
+} // Turbo
@@ -11,6 +11,7 @@
 #include "Graphics/FrameGraph/RenderGraphUtils.h"
 #include "Layers/ImGUILayer.h"
 #include "Windows/EditorViewportWindow.h"
+#include "Windows/GPUProfilerWindow.h"
 #include "Windows/PropertyEditor.h"
 #include "Windows/SceneOutlinerWindow.h"
 
@@ -34,6 +35,7 @@ namespace Turbo
 		mOutlinerWindow = MakeShared<FSceneOutlinerWindow>();
 		mPropertyEditor = MakeShared<FPropertyEditorWindow>();
 		mPropertyEditor->Init();
+		mGPUProfilerWindow = MakeShared<FGPUProfilerWindow>();
 	}
 
 	void FEditorLayer::Shutdown()
@@ -52,6 +54,7 @@ namespace Turbo
 		mViewportWindow->Draw();
 		mOutlinerWindow->Draw();
 		mPropertyEditor->Draw();
+		mGPUProfilerWindow->Draw();
 	}
 
 	bool FEditorLayer::ShouldTick()
@@ -0,0 +1,70 @@
+#include "Windows/GPUProfilerWindow.h"
+
+#include "imgui.h"
+#include "Extensions/ImGui/ImGuiExtensions.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/GPUProfiler.h"
+
+namespace Turbo
+{
+	void FGPUProfilerWindow::Draw()
+	{
+		const FGPUProfiler& profiler = entt::locator<FGPUDevice>::value().GetGPUProfiler();
+		const std::span<const FGPUProfilerScopeStats> scopeStats = profiler.GetScopeStats();
+		const bool bPipelineStatistics = profiler.IsPipelineStatisticsEnabled();
+
+		ImGui::Begin("GPU Profiler");
+
+		float totalTimeMs = 0.f;
+		for (const FGPUProfilerScopeStats& stats : scopeStats)
+		{
+			totalTimeMs += stats.mAverageTimeMs;
+		}
+		ImGui::TextFmt("GPU time: {:.3f} ms ({} frames average)", totalTimeMs, kGPUProfilerHistorySize);
+
+		const int32 numColumns = 4 + (bPipelineStatistics ? static_cast<int32>(kNumGPUPipelineStatistics) : 0);
+		constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+		if (ImGui::BeginTable("##GPUProfilerScopes", numColumns, tableFlags))
+		{
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Avg ms");
+			ImGui::TableSetupColumn("P95 ms");
+			ImGui::TableSetupColumn("P99 ms");
+			if (bPipelineStatistics)
+			{
+				ImGui::TableSetupColumn("Primitives");
+				ImGui::TableSetupColumn("VS");
+				ImGui::TableSetupColumn("FS");
+				ImGui::TableSetupColumn("CS");
+			}
+			ImGui::TableHeadersRow();
+
+			for (const FGPUProfilerScopeStats& stats : scopeStats)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(stats.mName.ToCString());
+				ImGui::TableNextColumn();
+				ImGui::TextFmt("{:.3f}", stats.mAverageTimeMs);
+				ImGui::TableNextColumn();
+				ImGui::TextFmt("{:.3f}", stats.mP95TimeMs);
+				ImGui::TableNextColumn();
+				ImGui::TextFmt("{:.3f}", stats.mP99TimeMs);
+
+				if (bPipelineStatistics)
+				{
+					for (const uint64 statistic : stats.mAveragePipelineStatistics)
+					{
+						ImGui::TableNextColumn();
+						ImGui::TextFmt("{}", statistic);
+					}
+				}
+			}
+
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
+	}
+} // Turbo
@@ -9,6 +9,7 @@ namespace Turbo
 	DECLARE_MULTICAST_DELEGATE(FOnSelectionChanged, entt::entity);
 
 	class FEditorViewportWindow;
+	class FGPUProfilerWindow;
 	class FPropertyEditorWindow;
 	class FSceneOutlinerWindow;
 
@@ -48,6 +49,7 @@ namespace Turbo
 		TSharedPtr<FEditorViewportWindow> mViewportWindow;
 		TSharedPtr<FSceneOutlinerWindow> mOutlinerWindow;
 		TSharedPtr<FPropertyEditorWindow> mPropertyEditor;
+		TSharedPtr<FGPUProfilerWindow> mGPUProfilerWindow;
 
 
 	private:
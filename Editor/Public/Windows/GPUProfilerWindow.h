@@ -0,0 +1,11 @@
+#pragma once
+
+namespace Turbo
+{
+	/** Shows per pass GPU times collected by FGPUProfiler */
+	class FGPUProfilerWindow
+	{
+	public:
+		void Draw();
+	};
+} // Turbo
@@ -71,6 +71,28 @@ namespace Turbo
 		return bounds;
 	}
 
+	/** Positions converted the same way as the position buffer */
+	std::vector<glm::float3> LoadPositions(const fastgltf::Asset& meshAsset, const FMeshLoadSettings& meshLoadSettings)
+	{
+		const fastgltf::Mesh& gltfMesh = meshAsset.meshes[meshLoadSettings.mMeshIndex];
+		const fastgltf::Primitive& gltfSubmesh = gltfMesh.primitives[meshLoadSettings.mSubMeshIndex];
+
+		std::vector<glm::float3> positions;
+		if (auto attribute = gltfSubmesh.findAttribute(kPositionName);
+			attribute != gltfSubmesh.attributes.cend())
+		{
+			const fastgltf::Accessor& accessor = meshAsset.accessors[attribute->accessorIndex];
+			positions.reserve(accessor.count);
+
+			fastgltf::iterateAccessor<glm::float3>(meshAsset, accessor, [&](const glm::float3& rawVertex)
+			{
+				positions.emplace_back(rawVertex.x, rawVertex.y, -rawVertex.z);
+			});
+		}
+
+		return positions;
+	}
+
 	template<typename ComponentType, typename ProcessFunction>
 	void LoadComponentBuffer(
 		const fastgltf::Asset& meshAsset,
@@ -106,6 +128,7 @@ namespace Turbo
 			);
 			bufferBuilder.SetData(componentData.data());
 			bufferBuilder.SetName(FName(fmt::format("{}_{}", gltfMesh.name, attributeName)));
+			bufferBuilder.SetMemoryCategory(EGPUMemoryCategory::Mesh);
 
 			FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 			outBuffer = gpu.CreateBuffer(bufferBuilder);
@@ -116,18 +139,49 @@ namespace Turbo
 
 	void FAssetManager::Init(FGPUDevice& gpu)
 	{
+		ReserveMeshBuffers(gpu);
+
+		EngineResources::LoadPlaceholders();
+	}
+
+	void FAssetManager::ReserveMeshBuffers(FGPUDevice& gpu)
+	{
+		const size_t numMeshes = glm::max(mMeshPool.GetCapacity(), kMeshPoolPageSize);
+		if (numMeshes <= mMeshData.size())
+		{
+			return;
+		}
+
+		TRACE_ZONE_SCOPED()
+
+		mMeshData.resize(numMeshes);
+		mMeshBounds.resize(numMeshes);
+
+		if (mMeshPointersPool.IsValid())
+		{
+			gpu.DestroyBuffer(mMeshPointersPool);
+			gpu.DestroyBuffer(mBoundsPool);
+		}
+
 		FBufferBuilder bufferBuilder = {};
 		bufferBuilder
-			.Init(EBufferFlags::StorageBuffer, sizeof(FMeshData) * kMaxMeshes)
-			.SetName(FName("MeshPointers"));
+			.Init(EBufferFlags::StorageBuffer, sizeof(FMeshData) * numMeshes)
+			.SetName(FName("MeshPointers"))
+			.SetMemoryCategory(EGPUMemoryCategory::Mesh);
 		mMeshPointersPool = gpu.CreateBuffer(bufferBuilder);
 
 		bufferBuilder
-			.Init(EBufferFlags::StorageBuffer, sizeof(FBounds) * kMaxMeshes)
-			.SetName(FName("MeshBounds"));
+			.Init(EBufferFlags::StorageBuffer, sizeof(FBounds) * numMeshes)
+			.SetName(FName("MeshBounds"))
+			.SetMemoryCategory(EGPUMemoryCategory::Mesh);
 		mBoundsPool = gpu.CreateBuffer(bufferBuilder);
 
-		EngineResources::LoadPlaceholders();
+		if (mMeshPool.GetNumAcquiredResources() > 0)
+		{
+			FGPUUploadManager& uploadManager = gpu.GetUploadManager();
+			uploadManager.UploadBuffer(gpu, mMeshPointersPool, 0, std::as_bytes(std::span(mMeshData)));
+			uploadManager.UploadBuffer(gpu, mBoundsPool, 0, std::as_bytes(std::span(mMeshBounds)));
+		}
 	}
 
 	void FAssetManager::Destroy(FGPUDevice& gpu) const
@@ -201,6 +255,7 @@ namespace Turbo
 		FMeshData meshData = {
 			.mIndex = meshHandle.GetIndex()
 		};
+		uint32 numPositions = 0;
 
 		{
 			const fastgltf::Accessor& indicesAccessor = loadedAsset.accessors[glftSubMesh.indicesAccessor.value()];
@@ -215,6 +270,51 @@ namespace Turbo
 				indices.push_back(index);
 			});
 
+			// LODs are appended to the source indices and share its vertices
+			const std::vector<glm::float3> positions = LoadPositions(loadedAsset, meshLoadSettings);
+			numPositions = positions.size();
+			std::vector<FMeshLod> lods;
+			MeshLods::Build(indices, positions, lods);
+			TURBO_CHECK(lods.size() <= MeshLods::kMaxLods)
+
+			// Clusters reorder the indices of each LOD, so they are built before the index buffer is created
+			std::vector<FMeshCluster> clusters;
+			std::vector<FMeshCluster> lodClusters;
+			for (FMeshLod& lod : lods)
+			{
+				MeshClusters::Build(std::span(indices).subspan(lod.mFirstIndex, lod.mNumIndices), positions, lodClusters);
+
+				for (FMeshCluster& cluster : lodClusters)
+				{
+					cluster.mFirstIndex += lod.mFirstIndex;
+					// Mirroring Z keeps the winding, so the counter-clockwise normals of the imported triangles point inwards
+					cluster.mConeAxis = -cluster.mConeAxis;
+				}
+
+				lod.mFirstCluster = clusters.size();
+				lod.mNumClusters = lodClusters.size();
+				clusters.insert(clusters.end(), lodClusters.begin(), lodClusters.end());
+			}
+
+			mesh->mNumLods = lods.size();
+			meshData.mNumLods = lods.size();
+			std::ranges::copy(lods, mesh->mLods.begin());
+			std::ranges::copy(lods, meshData.mLods.begin());
+
+			if (clusters.empty() == false)
+			{
+				FBufferBuilder clusterBufferBuilder = {};
+				clusterBufferBuilder.Init(EBufferFlags::StorageBuffer, clusters.size() * sizeof(FMeshCluster));
+				clusterBufferBuilder.SetData(clusters.data());
+				clusterBufferBuilder.SetName(FName(fmt::format("{}_CLUSTERS", loadedAsset.meshes.front().name)));
+				clusterBufferBuilder.SetMemoryCategory(EGPUMemoryCategory::Mesh);
+
+				mesh->mClusterBuffer = gpu.CreateBuffer(clusterBufferBuilder);
+				mesh->mNumClusters = lods.front().mNumClusters;
+				meshData.mClusterBuffer = gpu.AccessBuffer(mesh->mClusterBuffer)->mDeviceAddress;
+				meshData.mNumClusters = lods.front().mNumClusters;
+			}
+
 			FBufferBuilder bufferBuilder = {};
 			bufferBuilder.Init(
 				EBufferFlags::IndexBuffer | EBufferFlags::AccelerationStructureInput,
@@ -222,6 +322,7 @@ namespace Turbo
 			);
 			bufferBuilder.SetData(indices.data());
 			bufferBuilder.SetName(FName(fmt::format("{}_INDICES", loadedAsset.meshes.front().name)));
+			bufferBuilder.SetMemoryCategory(EGPUMemoryCategory::Mesh);
 
 			mesh->mIndexBuffer = gpu.CreateBuffer(bufferBuilder);
 			FBuffer* indicesBuffer = gpu.AccessBuffer(mesh->mIndexBuffer);
@@ -260,47 +361,32 @@ namespace Turbo
 
 		const FBounds boundingBox = FindBounds(loadedAsset, meshLoadSettings);
 
-		gpu.ImmediateSubmit(FOnImmediateSubmit::CreateLambda([&](FCommandBuffer& cmd)
-		{
-			const FBufferBuilder stagingBufferBuilder = FBufferBuilder::CreateStagingBuffer(
-				nullptr,
-				sizeof(FMeshData) + sizeof(FBounds)
-			);
-			const THandle<FBuffer> stagingBufferHandle = gpu.CreateBuffer(stagingBufferBuilder);
-			const FBuffer* stagingBuffer = gpu.AccessBuffer(stagingBufferHandle);
-
-			std::memcpy(stagingBuffer->mMappedAddress, &meshData, sizeof(FMeshData));
-			std::memcpy(stagingBuffer->mMappedAddress + sizeof(FMeshData), &boundingBox, sizeof(FBounds));
-
-			// Update mesh data
-			cmd.CopyBuffer({
-				.mSrc = stagingBufferHandle,
-				.mDst = mMeshPointersPool,
-				.mDstOffset = sizeof(FMeshData) * meshHandle.GetIndex(),
-				.mSize = sizeof(FMeshData)
-			});
-
-			// Update bounds
-			cmd.CopyBuffer({
-				.mSrc = stagingBufferHandle,
-				.mSrcOffset = sizeof(FMeshData),
-				.mDst = mBoundsPool,
-				.mDstOffset = sizeof(FBounds) * meshHandle.GetIndex(),
-				.mSize = sizeof(FBounds)
-			});
+		ReserveMeshBuffers(gpu);
+		mMeshData[meshHandle.GetIndex()] = meshData;
+		mMeshBounds[meshHandle.GetIndex()] = boundingBox;
+		// The GPU scene derives the instance bounding spheres from the host copy
+		mesh->mBounds = boundingBox;
 
-			gpu.DestroyBuffer(stagingBufferHandle);
-		}));
+		FGPUUploadManager& uploadManager = gpu.GetUploadManager();
+		uploadManager.UploadBuffer(gpu, mMeshPointersPool, sizeof(FMeshData) * meshHandle.GetIndex(), std::as_bytes(std::span(&meshData, 1)));
+		uploadManager.UploadBuffer(gpu, mBoundsPool, sizeof(FBounds) * meshHandle.GetIndex(), std::as_bytes(std::span(&boundingBox, 1)));
 
 #if RAY_TRACING_ENABLED
-		TURBO_LOG(LogMeshLoading, Info, "Building BLAS", gltfMesh.name);
-		const FBLASBuilder builder = {
-			.mVertexBuffer = mesh->mPositionBuffer,
-			.mIndexBuffer = mesh->mIndexBuffer,
-			.mNumVertices = mesh->mVertexCount,
-			.mName = FName(gltfMesh.name)
-		};
-		mesh->mBlas = gpu.CreateBLAS(builder);
+		TURBO_LOG(LogMeshLoading, Info, "Building {} BLAS of {}", mesh->mNumLods, gltfMesh.name);
+		std::array<FBLASBuilder, MeshLods::kMaxLods> blasBuilders = {};
+		for (uint32 lodId = 0; lodId < mesh->mNumLods; ++lodId)
+		{
+			const FMeshLod& lod = mesh->mLods[lodId];
+			blasBuilders[lodId] = {
+				.mVertexBuffer = mesh->mPositionBuffer,
+				.mIndexBuffer = mesh->mIndexBuffer,
+				.mNumVertices = lod.mNumIndices,
+				.mFirstIndex = lod.mFirstIndex,
+				.mMaxVertex = numPositions - 1,
+				.mName = lodId == 0 ? FName(gltfMesh.name) : FName(fmt::format("{}_LOD{}", gltfMesh.name, lodId))
+			};
+		}
+		gpu.CreateBLAS(std::span(blasBuilders.data(), mesh->mNumLods), std::span(mesh->mBlas.data(), mesh->mNumLods));
 #endif // else RAY_TRACING_ENABLED
 
 		if (meshLoadSettings.mbLevelAsset)
@@ -325,6 +411,11 @@ namespace Turbo
 		return pointersPoolBuffer->mDeviceAddress + memoryOffset;
 	}
 
+	FDeviceAddress FAssetManager::GetMeshTableAddress(const FGPUDevice& gpu) const
+	{
+		return gpu.AccessBuffer(mMeshPointersPool)->mDeviceAddress;
+	}
+
 	FDeviceAddress FAssetManager::GetBoundsAddress(const FGPUDevice& gpu) const
 	{
 		const FBuffer* boundsPool = gpu.AccessBuffer(mBoundsPool);
@@ -349,6 +440,7 @@ namespace Turbo
 			mesh->mTangentBuffer,
 			mesh->mUVBuffer,
 			mesh->mColorBuffer,
+			mesh->mClusterBuffer,
 		};
 
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
@@ -361,7 +453,10 @@ namespace Turbo
 		}
 
 #if RAY_TRACING_ENABLED
-		gpu.DestroyBLAS(mesh->mBlas);
+		for (uint32 lodId = 0; lodId < mesh->mNumLods; ++lodId)
+		{
+			gpu.DestroyBLAS(mesh->mBlas[lodId]);
+		}
 #endif // RAY_TRACING_ENABLED
 
 		mAssetCache.erase(mesh->mAssetHash);
@@ -500,49 +595,15 @@ namespace Turbo
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 		result = gpu.CreateTexture(textureBuilder);
 
-		// Calculate all mips size
-		uint32 numDataBytes = 0;
-		for (const dds::span<uint8>& mipMap : image.mipmaps)
-		{
-			numDataBytes += mipMap.size_bytes();
-		}
-
-		// Create staging buffer
-		const FBufferBuilder stagingBufferBuilder = FBufferBuilder::CreateStagingBuffer(numDataBytes);
-
-		const THandle<FBuffer> stagingBuffer = gpu.CreateBuffer(stagingBufferBuilder);
-		void* stagingMappedAddress = gpu.AccessBuffer(stagingBuffer)->mMappedAddress;
-
-		// Copy data to buffer;
-		uint32 dataOffset = 0;
-		for (const dds::span<uint8>& mipMap : image.mipmaps)
+		std::vector<std::span<const byte>> mips;
+		mips.reserve(image.numMips);
+		for (uint32 mipIndex = 0; mipIndex < image.numMips; ++mipIndex)
 		{
-			byte* mipDataStart = static_cast<byte*>(stagingMappedAddress) + dataOffset;
-			std::memcpy(mipDataStart, mipMap.data(), mipMap.size_bytes());
-
-			dataOffset += mipMap.size_bytes();
+			const dds::span<uint8>& mipMap = image.mipmaps[mipIndex];
+			mips.emplace_back(reinterpret_cast<const byte*>(mipMap.data()), mipMap.size_bytes());
 		}
 
-		// copy buffer to image
-		gpu.ImmediateSubmit(FOnImmediateSubmit::CreateLambda(
-				[&](FCommandBuffer& cmd)
-				{
-					cmd.TransitionImage(result, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-
-					uint32 bufferOffset = 0;
-					for (uint32 mipIndex = 0; mipIndex < image.numMips; ++mipIndex)
-					{
-						cmd.CopyBufferToTexture(stagingBuffer, result, mipIndex, bufferOffset);
-
-						const uint32 numMipBytes = image.mipmaps[mipIndex].size_bytes();
-						bufferOffset += numMipBytes;
-					}
-
-					cmd.TransitionImage(result, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-				})
-		);
-
-		gpu.DestroyBuffer(stagingBuffer);
+		gpu.GetUploadManager().UploadTexture(gpu, result, mips);
 
 		return result;
 	}
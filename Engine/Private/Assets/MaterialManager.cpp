@@ -10,12 +10,21 @@ namespace Turbo
 
 	void FMaterialManager::Init(FGPUDevice& gpuDevice)
 	{
+		// Material depth pipelines differ only in the name, so a shared one can be used while they are compiling
+		FPipelineBuilder fallbackDepthPipelineBuilder = CreateDepthPrepassPipeline("DepthPrepass.slang");
+		fallbackDepthPipelineBuilder.SetName(FName("Material_Fallback_Depth"));
+		mFallbackDepthOnlyPipeline = gpuDevice.CreatePipeline(fallbackDepthPipelineBuilder);
+
+		ReserveMaterialTable(gpuDevice);
 	}
 
 	void FMaterialManager::Destroy(FGPUDevice& gpuDevice)
 	{
+		gpuDevice.DestroyPipeline(mFallbackDepthOnlyPipeline);
+		mFallbackDepthOnlyPipeline = {};
+
 		std::vector<THandle<FMaterial>> materialsToDestroy;
-		materialsToDestroy.reserve(mMaterialPool.Size());
+		materialsToDestroy.reserve(mMaterialPool.GetNumAcquiredResources());
 
 		for (const auto& [key, value] : mMaterialToMaterialInstanceMap)
 		{
@@ -26,6 +35,9 @@ namespace Turbo
 		{
 			DestroyMaterial(materialHandle);
 		}
+
+		gpuDevice.DestroyBuffer(mMaterialTable);
+		mMaterialTable = {};
 	}
 
 	FPipelineBuilder FMaterialManager::CreateOpaquePipeline(std::string_view shaderName)
@@ -76,10 +88,10 @@ namespace Turbo
 		TURBO_CHECK(builder.mGraphicsPipeline)
 
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
-		const THandle<FPipeline> pipelineHandle = gpu.CreatePipeline(*builder.mGraphicsPipeline);
+		const THandle<FPipeline> pipelineHandle = gpu.CreatePipelineAsync(*builder.mGraphicsPipeline);
 		TURBO_CHECK(pipelineHandle);
 
-		const THandle<FPipeline> depthPipelineHandle = gpu.CreatePipeline(*builder.mDepthOnlyPipeline);
+		const THandle<FPipeline> depthPipelineHandle = gpu.CreatePipelineAsync(*builder.mDepthOnlyPipeline);
 		TURBO_CHECK(depthPipelineHandle);
 
 		const THandle<FMaterial> materialHandle = mMaterialPool.Acquire();
@@ -98,7 +110,8 @@ namespace Turbo
 			FBufferBuilder bufferBuilder = {};
 			bufferBuilder
 				.Init(EBufferFlags::CreateMapped | EBufferFlags::StorageBuffer, targetBufferSize)
-				.SetName(FName(fmt::format("{}_Uniforms", builder.mGraphicsPipeline->GetName())));
+				.SetName(FName(fmt::format("{}_Uniforms", builder.mGraphicsPipeline->GetName())))
+				.SetMemoryCategory(EGPUMemoryCategory::Material);
 			material->mDataBuffer = gpu.CreateBuffer(bufferBuilder);
 			TURBO_CHECK(material->mDataBuffer);
 		}
@@ -118,6 +131,9 @@ namespace Turbo
 		TURBO_CHECK_SLOW(mMaterialNameLookUp.find(builder.mName) == mMaterialNameLookUp.end())
 		mMaterialNameLookUp[builder.mName] = materialHandle;
 
+		ReserveMaterialTable(gpu);
+		UpdateMaterialTableEntry(gpu, materialHandle);
+
 		return materialHandle;
 	}
 
@@ -138,7 +154,11 @@ namespace Turbo
 		TURBO_CHECK(material)
 
 		FAvailableIndexes& availableIndexes = mMaterialToAvailableIndexesMap.at(materialHandle);
-		TURBO_CHECK(!availableIndexes.empty())
+		if (availableIndexes.empty())
+		{
+			GrowMaterialInstances(*material, availableIndexes);
+			UpdateMaterialTableEntry(entt::locator<FGPUDevice>::value(), materialHandle);
+		}
 
 		THandle<FMaterial::Instance> instanceHandle = mMaterialInstancePool.Acquire();
 		FMaterial::Instance* instance = mMaterialInstancePool.Access(instanceHandle);
@@ -150,6 +170,85 @@ namespace Turbo
 		return instanceHandle;
 	}
 
+	void FMaterialManager::GrowMaterialInstances(FMaterial& material, FAvailableIndexes& availableIndexes)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const uint32 oldMaxInstances = material.mMaxInstances;
+		const uint32 newMaxInstances = glm::max(oldMaxInstances * 2, 1u);
+		TURBO_LOG(LogMaterialManager, Info, "Growing {} material instances to {}.", material.mName, newMaxInstances)
+
+		if (material.mDataBuffer.IsValid() && material.mPerInstanceDataSize > 0)
+		{
+			FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+
+			FBufferBuilder bufferBuilder = {};
+			bufferBuilder
+				.Init(EBufferFlags::CreateMapped | EBufferFlags::StorageBuffer, CalculateInstanceByteOffset(material, newMaxInstances))
+				.SetName(FName(fmt::format("{}_Uniforms", material.mName)))
+				.SetMemoryCategory(EGPUMemoryCategory::Material);
+			const THandle<FBuffer> newDataBuffer = gpu.CreateBuffer(bufferBuilder);
+			TURBO_CHECK(newDataBuffer);
+
+			// Material data is written by the host only, so the mapped memory of the old buffer is up to date
+			const FBuffer* oldBuffer = gpu.AccessBuffer(material.mDataBuffer);
+			const FBuffer* newBuffer = gpu.AccessBuffer(newDataBuffer);
+			std::memcpy(newBuffer->mMappedAddress, oldBuffer->mMappedAddress, CalculateInstanceByteOffset(material, oldMaxInstances));
+
+			gpu.DestroyBuffer(material.mDataBuffer);
+			material.mDataBuffer = newDataBuffer;
+		}
+
+		for (uint32 instanceId = newMaxInstances; instanceId > oldMaxInstances; --instanceId)
+		{
+			availableIndexes.push_back(instanceId - 1);
+		}
+		material.mMaxInstances = newMaxInstances;
+	}
+
+	void FMaterialManager::ReserveMaterialTable(FGPUDevice& gpu)
+	{
+		const size_t numMaterials = glm::max(mMaterialPool.GetCapacity(), mMaterialPool.GetPageSize());
+		if (numMaterials <= mMaterialTableEntries.size())
+		{
+			return;
+		}
+
+		TRACE_ZONE_SCOPED()
+
+		mMaterialTableEntries.resize(numMaterials);
+
+		if (mMaterialTable.IsValid())
+		{
+			gpu.DestroyBuffer(mMaterialTable);
+		}
+
+		FBufferBuilder bufferBuilder = {};
+		bufferBuilder
+			.Init(EBufferFlags::StorageBuffer, sizeof(FMaterial::TableEntry) * numMaterials)
+			.SetName(FName("MaterialTable"))
+			.SetMemoryCategory(EGPUMemoryCategory::Material);
+		mMaterialTable = gpu.CreateBuffer(bufferBuilder);
+
+		if (mMaterialPool.GetNumAcquiredResources() > 0)
+		{
+			gpu.GetUploadManager().UploadBuffer(gpu, mMaterialTable, 0, std::as_bytes(std::span(mMaterialTableEntries)));
+		}
+	}
+
+	void FMaterialManager::UpdateMaterialTableEntry(FGPUDevice& gpu, THandle<FMaterial> handle)
+	{
+		const FMaterial* material = mMaterialPool.Access(handle);
+		TURBO_CHECK(material)
+
+		FMaterial::TableEntry& entry = mMaterialTableEntries[handle.GetIndex()];
+		entry.mData = GetMaterialDataAddress(gpu, handle);
+		entry.mInstancesOffset = material->mMaterialDataSize;
+		entry.mInstanceStride = material->mPerInstanceDataSize;
+
+		gpu.GetUploadManager().UploadBuffer(gpu, mMaterialTable, sizeof(FMaterial::TableEntry) * handle.GetIndex(), std::as_bytes(std::span(&entry, 1)));
+	}
+
 	void FMaterialManager::UpdateMaterialInstance(FCommandBuffer& cmd, THandle<FMaterial::Instance> instanceHandle, std::span<byte> data)
 	{
 		TRACE_ZONE_SCOPED();
@@ -224,6 +323,33 @@ namespace Turbo
 		return kNullDeviceAddress;
 	}
 
+	FDeviceAddress FMaterialManager::GetMaterialTableAddress(const FGPUDevice& gpu) const
+	{
+		return gpu.AccessBuffer(mMaterialTable)->mDeviceAddress;
+	}
+
+	THandle<FPipeline> FMaterialManager::GetGraphicsPipeline(const FGPUDevice& gpu, THandle<FMaterial> handle) const
+	{
+		const FMaterial* material = mMaterialPool.Access(handle);
+		TURBO_CHECK(material)
+
+		return gpu.IsPipelineReady(material->mGraphicsPipeline) ? material->mGraphicsPipeline : THandle<FPipeline>();
+	}
+
+	THandle<FPipeline> FMaterialManager::GetDepthOnlyPipeline(const FGPUDevice& gpu, THandle<FMaterial> handle) const
+	{
+		const FMaterial* material = mMaterialPool.Access(handle);
+		TURBO_CHECK(material)
+
+		// Depth of a material which isn't drawn in the base pass would leave a hole
+		if (!material->mDepthOnlyPipeline || gpu.IsPipelineReady(material->mGraphicsPipeline) == false)
+		{
+			return {};
+		}
+
+		return gpu.IsPipelineReady(material->mDepthOnlyPipeline) ? material->mDepthOnlyPipeline : mFallbackDepthOnlyPipeline;
+	}
+
 	size_t FMaterialManager::CalculateInstanceByteOffset(const FMaterial& material, uint32 instanceIndex)
 	{
 		return material.mMaterialDataSize + instanceIndex * material.mPerInstanceDataSize;
@@ -1,5 +1,138 @@
 #include "Assets/StaticMesh.h"
 
+#include "ProfilingMacros.h"
+
+#include "meshoptimizer.h"
+
 namespace Turbo
 {
-} // Turbo
\ No newline at end of file
+	/** Trades the spatial locality of the clusters for narrower normal cones */
+	static constexpr float kClusterConeWeight = 0.25f;
+
+	/** Fraction of the triangles of the previous LOD each LOD aims for */
+	static constexpr float kLodTriangleRatio = 0.5f;
+	/** LODs keeping more of the previous triangles, e.g. because of the mesh borders, aren't worth their memory */
+	static constexpr float kMaxLodTriangleRatio = 0.85f;
+	/** Limit of a single simplification step relative to the mesh extents, the selection keeps coarse LODs far away */
+	static constexpr float kMaxLodStepError = 0.1f;
+
+	void MeshClusters::Build(std::span<uint32> indices, std::span<const glm::float3> positions, std::vector<FMeshCluster>& outClusters)
+	{
+		TRACE_ZONE_SCOPED()
+
+		TURBO_CHECK(indices.size() % 3 == 0)
+		outClusters.clear();
+
+		if (indices.empty() || positions.empty())
+		{
+			return;
+		}
+
+		const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), kMaxVertices, kMaxTriangles);
+		std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+		std::vector<uint32> meshletVertices(maxMeshlets * kMaxVertices);
+		std::vector<uint8> meshletTriangles(maxMeshlets * kMaxTriangles * 3);
+
+		const float* vertexPositions = &positions[0].x;
+		const size_t numMeshlets = meshopt_buildMeshlets(
+			meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
+			indices.data(), indices.size(),
+			vertexPositions, positions.size(), sizeof(glm::float3),
+			kMaxVertices, kMaxTriangles, kClusterConeWeight
+		);
+
+		outClusters.reserve(numMeshlets);
+
+		// Meshlets keep their own copy of the triangles, so the indices are rewritten in place
+		uint32 numWrittenIndices = 0;
+		for (size_t meshletId = 0; meshletId < numMeshlets; ++meshletId)
+		{
+			const meshopt_Meshlet& meshlet = meshlets[meshletId];
+			const uint32* vertices = &meshletVertices[meshlet.vertex_offset];
+			const uint8* triangles = &meshletTriangles[meshlet.triangle_offset];
+
+			const meshopt_Bounds bounds = meshopt_computeMeshletBounds(
+				vertices, triangles, meshlet.triangle_count,
+				vertexPositions, positions.size(), sizeof(glm::float3)
+			);
+
+			FMeshCluster& cluster = outClusters.emplace_back();
+			cluster.mBoundingSphere = glm::float4(bounds.center[0], bounds.center[1], bounds.center[2], bounds.radius);
+			cluster.mConeAxis = glm::float3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+			cluster.mConeCutoff = bounds.cone_cutoff;
+			cluster.mFirstIndex = numWrittenIndices;
+			cluster.mNumIndices = meshlet.triangle_count * 3;
+
+			for (uint32 localIndex = 0; localIndex < cluster.mNumIndices; ++localIndex)
+			{
+				indices[numWrittenIndices++] = vertices[triangles[localIndex]];
+			}
+		}
+
+		TURBO_CHECK(numWrittenIndices == indices.size())
+	}
+
+	void MeshLods::Build(std::vector<uint32>& indices, std::span<const glm::float3> positions, std::vector<FMeshLod>& outLods)
+	{
+		TRACE_ZONE_SCOPED()
+
+		TURBO_CHECK(indices.size() % 3 == 0)
+		outLods.clear();
+		outLods.push_back(FMeshLod{.mNumIndices = static_cast<uint32>(indices.size())});
+
+		if (indices.empty() || positions.empty())
+		{
+			return;
+		}
+
+		const float* vertexPositions = &positions[0].x;
+		const float errorToMeshSpace = meshopt_simplifyScale(vertexPositions, positions.size(), sizeof(glm::float3));
+
+		std::vector<uint32> lodIndices;
+		while (outLods.size() < kMaxLods)
+		{
+			const FMeshLod sourceLod = outLods.back();
+
+			// A LOD smaller than a cluster doesn't save any draws
+			if (sourceLod.mNumIndices <= MeshClusters::kMaxTriangles * 3)
+			{
+				break;
+			}
+
+			const size_t targetNumIndices = static_cast<size_t>(static_cast<float>(sourceLod.mNumIndices / 3) * kLodTriangleRatio) * 3;
+
+			lodIndices.resize(sourceLod.mNumIndices);
+			float stepError = 0.f;
+			const size_t numLodIndices = meshopt_simplify(
+				lodIndices.data(), &indices[sourceLod.mFirstIndex], sourceLod.mNumIndices,
+				vertexPositions, positions.size(), sizeof(glm::float3),
+				targetNumIndices, kMaxLodStepError, 0, &stepError
+			);
+
+			if (numLodIndices == 0 || static_cast<float>(numLodIndices) > static_cast<float>(sourceLod.mNumIndices) * kMaxLodTriangleRatio)
+			{
+				break;
+			}
+
+			// LODs are simplified from the previous one, so their errors add up
+			outLods.push_back(FMeshLod{
+				.mFirstIndex = static_cast<uint32>(indices.size()),
+				.mNumIndices = static_cast<uint32>(numLodIndices),
+				.mError = sourceLod.mError + stepError * errorToMeshSpace
+			});
+
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + static_cast<std::ptrdiff_t>(numLodIndices));
+		}
+	}
+
+	uint32 MeshLods::SelectLod(std::span<const FMeshLod> lods, float errorScale)
+	{
+		uint32 lodId = 0;
+		while (lodId + 1 < lods.size() && lods[lodId + 1].mError * errorScale <= 1.f)
+		{
+			++lodId;
+		}
+
+		return lodId;
+	}
+} // Turbo
@@ -85,6 +85,8 @@ namespace Turbo
 
 		// Additional thread for io tasks
 		enki::TaskSchedulerConfig taskSchedulerConfig;
+		// Every task thread records commands into its own command pool
+		taskSchedulerConfig.numTaskThreadsToCreate = glm::min(taskSchedulerConfig.numTaskThreadsToCreate, kMaxRenderingThreads - 1);
 
 		entt::locator<enki::TaskScheduler>::emplace();
 		enki::TaskScheduler& taskScheduler = entt::locator<enki::TaskScheduler>::value();
@@ -98,7 +100,9 @@ namespace Turbo
 
 		entt::locator<IInputSystem>::reset<FSDLInputSystem>(new FSDLInputSystem());
 
-		window.InitBackend();
+		// Renders without a display and a presentation engine, e.g. on CI machines with a software Vulkan implementation
+		const bool bHeadless = FCommandLineArgs::HasFlag("headless");
+		window.InitBackend(bHeadless);
 
 		for (const TSharedPtr<ILayer>& layer : entt::locator<FLayersStack>::value())
 		{
@@ -107,6 +111,7 @@ namespace Turbo
 		}
 
 		FGPUDeviceBuilder gpuDeviceBuilder;
+		gpuDeviceBuilder.mbHeadless = bHeadless;
 		gpu.Init(gpuDeviceBuilder);
 
 		IFrameDebuggerAPI::Emplace();
@@ -169,10 +174,26 @@ namespace Turbo
 	void FEngine::GameThreadLoop()
 	{
 		FWindow& window = entt::locator<FWindow>::value();
+		const FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		FCoreTimer& coreTimer = entt::locator<FCoreTimer>::value();
+
+		// Fixed length runs for performance measurements
+		const std::optional<int32> exitAfterFrames = FCommandLineArgs::ParseInt("exitAfterFrames");
+		const double startTime = coreTimer.GetTimeFromEngineStart();
+
 		while (!mbExitRequested)
 		{
 			GameThreadTick();
 			window.PollWindowEventsAndErrors();
+
+			if (exitAfterFrames.has_value() && gpu.GetNumRenderedFrames() >= static_cast<uint32>(exitAfterFrames.value()))
+			{
+				const double elapsedTime = coreTimer.GetTimeFromEngineStart() - startTime;
+				TURBO_LOG(LogEngine, Info, "Rendered {} frames in {:.3f} s, {:.3f} ms per frame.",
+					gpu.GetNumRenderedFrames(), elapsedTime, elapsedTime * 1000. / glm::max(gpu.GetNumRenderedFrames(), 1u))
+
+				RequestExit();
+			}
 		}
 	}
 
@@ -216,7 +237,7 @@ namespace Turbo
 		if (gpu.BeginFrame())
 		{
 			FCommandBuffer& cmd = gpu.GetMainCommandBuffer();
-			graphBuilder.Reset();
+			graphBuilder.Reset(gpu);
 
 			FGeometryBuffer& geometryBuffer = entt::locator<FGeometryBuffer>::value();
 
@@ -224,11 +245,12 @@ namespace Turbo
 			const glm::int2 gbufferResolution = glm::floor(glm::float2(gpu.GetMainViewportSize()) * CVarResolutionScale.Get());
 			geometryBuffer.Init(graphBuilder, gbufferResolution);
 
+			// Headless present images are copied instead of presented
 			const THandle<FTexture> presentHandle = gpu.GetPresentImage();
 			FRGResourceHandle presentTexture = graphBuilder.RegisterExternalTexture(
 				presentHandle,
 				ETextureLayout::Undefined,
-				ETextureLayout::PresentSrc
+				gpu.IsHeadless() ? ETextureLayout::TransferSrc : ETextureLayout::PresentSrc
 			);
 
 			{
@@ -310,6 +332,7 @@ namespace Turbo
 
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 		gpu.WaitIdle();
+		entt::locator<FRenderGraphBuilder>::value().ReleaseResources(gpu);
 		gpu.FlushDestroyQueues();
 
 		FLayersStack& layerStack = entt::locator<FLayersStack>::value();
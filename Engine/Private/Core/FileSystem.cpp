@@ -27,6 +27,28 @@ namespace Turbo
 		return true;
 	}
 
+	bool FileSystem::SaveData(std::string_view filePath, std::span<const byte> data)
+	{
+		const std::string tempFilePath = std::string(filePath) + ".tmp";
+		{
+			std::ofstream file(tempFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (file.is_open() == false)
+			{
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			if (file.good() == false)
+			{
+				return false;
+			}
+		}
+
+		std::error_code errorCode;
+		std::filesystem::rename(tempFilePath, filePath, errorCode);
+		return !errorCode;
+	}
+
 	bool FileSystem::CreateDirectory(std::string_view path)
 	{
 		if (std::filesystem::exists(path) == false)
@@ -43,6 +65,7 @@ namespace Turbo
 		CreateDirectory(kSavedPath);
 		CreateDirectory(kLogPath);
 		CreateDirectory(kConfigPath);
+		CreateDirectory(kCachePath);
 	}
 
 	uint64 FileSystem::GetFileWriteTimeStamp(FName filePath)
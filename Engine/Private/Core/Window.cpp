@@ -13,9 +13,16 @@ namespace Turbo
 	FWindow::FWindow() = default;
 	FWindow::~FWindow() = default;
 
-	void FWindow::InitBackend()
+	void FWindow::InitBackend(bool bHeadless)
 	{
-		TURBO_LOG(LogWindow, Info, "Initializing SDL.");
+		mbHeadless = bHeadless;
+		if (mbHeadless)
+		{
+			// Works without a display server, events and window queries behave as with a hidden window
+			SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+		}
+
+		TURBO_LOG(LogWindow, Info, "Initializing SDL{}.", mbHeadless ? " (headless)" : "");
 		if (!SDL_Init(SDL_INIT_VIDEO))
 		{
 			LogError();
@@ -37,8 +44,9 @@ namespace Turbo
 	bool FWindow::Init()
 	{
 		TURBO_LOG(LogWindow, Info, "Initializing Window.");
+		const SDL_WindowFlags vulkanFlag = mbHeadless ? 0 : SDL_WINDOW_VULKAN;
 		mSDLWindow = SDL_CreateWindow(WindowDefaultValues::kName.data(), WindowDefaultValues::kSizeX, WindowDefaultValues::kSizeY,
-		                                     SDL_WINDOW_VULKAN | SDL_WINDOW_HIGH_PIXEL_DENSITY | SDL_WINDOW_HIDDEN | SDL_WINDOW_RESIZABLE);
+		                                     vulkanFlag | SDL_WINDOW_HIGH_PIXEL_DENSITY | SDL_WINDOW_HIDDEN | SDL_WINDOW_RESIZABLE);
 		if (!mSDLWindow)
 		{
 			TURBO_LOG(LogWindow, Error, "SDL window creation error. See bellow logs for details");
@@ -3,6 +3,7 @@
 #include "CommonMacros.h"
 #include "Core/DataStructures/Handle.h"
 #include "Core/Engine.h"
+#include "Debug/IConsoleManager.h"
 #include "Graphics/GPUDevice.h"
 #include "Graphics/Resources.h"
 #include "Graphics/VulkanInitializers.h"
@@ -10,11 +11,34 @@
 
 namespace Turbo
 {
+	static TAutoConsoleVariable<bool> CVarStateCache(
+		"gpu.cmd.stateCache",
+		true,
+		"Skip pipeline, descriptor set, push constant, viewport and scissor commands which don't change the bound state. Applied to command buffers which begin recording afterwards."
+	);
+
 	void FCommandBuffer::Begin()
 	{
+		Reset();
+		mbRecording = true;
+		vk::CommandBufferBeginInfo beginInfo = {};
+		beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+		CHECK_VULKAN_HPP(mVkCommandBuffer.begin(beginInfo));
+	}
+
+	void FCommandBuffer::BeginSecondary(const vk::CommandBufferInheritanceInfo& inheritanceInfo)
+	{
+		Reset();
 		mbRecording = true;
+
 		vk::CommandBufferBeginInfo beginInfo = {};
 		beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		if (inheritanceInfo.pNext != nullptr)
+		{
+			beginInfo.flags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+		}
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
 
 		CHECK_VULKAN_HPP(mVkCommandBuffer.begin(beginInfo));
 	}
@@ -198,6 +222,37 @@ namespace Turbo
 		mVkCommandBuffer.copyBufferToImage2(copyBufferToImageInfo);
 	}
 
+	void FCommandBuffer::CopyTextureToBuffer(THandle<FTexture> src, THandle<FBuffer> dst, uint32 mipIndex, FDeviceSize bufferOffset)
+	{
+		const FTexture* srcTexture = mGpu->AccessTexture(src);
+		const FTextureCold* srcTextureCold = mGpu->AccessTextureCold(src);
+		const FBuffer* dstBuffer = mGpu->AccessBuffer(dst);
+		const glm::int2 texSize = srcTextureCold->GetSize2D();
+		const glm::int2 mipSize = glm::int2(texSize.x >> mipIndex, texSize.y >> mipIndex);
+
+		vk::ImageSubresourceLayers imageSubresource = {};
+		imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+		imageSubresource.mipLevel = mipIndex;
+		imageSubresource.baseArrayLayer = 0;
+		imageSubresource.layerCount = 1;
+
+		vk::BufferImageCopy2 bufferImageCopy = {};
+		bufferImageCopy.bufferOffset = bufferOffset;
+		bufferImageCopy.bufferRowLength = mipSize.x;
+		bufferImageCopy.bufferImageHeight = mipSize.y;
+		bufferImageCopy.imageOffset = VulkanConverters::ToOffset3D(glm::int3(0.f));
+		bufferImageCopy.imageExtent = VulkanConverters::ToExtent3D(glm::int3(mipSize, 1.f));
+		bufferImageCopy.imageSubresource = imageSubresource;
+
+		vk::CopyImageToBufferInfo2 copyImageToBufferInfo = {};
+		copyImageToBufferInfo.srcImage = srcTexture->mVkImage;
+		copyImageToBufferInfo.srcImageLayout = vk::ImageLayout::eTransferSrcOptimal;
+		copyImageToBufferInfo.dstBuffer = dstBuffer->mVkBuffer;
+		copyImageToBufferInfo.setRegions(bufferImageCopy);
+
+		mVkCommandBuffer.copyImageToBuffer2(copyImageToBufferInfo);
+	}
+
 	void FCommandBuffer::FillBuffer(THandle<FBuffer> dst, FDeviceSize offset, FDeviceSize size, uint32 value)
 	{
 		TURBO_CHECK(offset % 4 == 0 && size % 4 == 0)
@@ -210,6 +265,32 @@ namespace Turbo
 	{
 		const FDescriptorSet* descriptorSet = mGpu->AccessDescriptorSet(descriptorSetHandle);
 		const FPipeline* currentPipeline = mGpu->AccessPipeline(mCurrentPipeline);
+		TURBO_CHECK(descriptorSet && currentPipeline)
+		TURBO_CHECK(setIndex < kMaxDescriptorSets)
+
+		constexpr uint32 commandId = static_cast<uint32>(EStateCommand::BindDescriptorSet);
+		if (mbStateCache
+			&& mBoundState.mDescriptorSets[setIndex] == descriptorSet->mVkDescriptorSet
+			&& mBoundState.mDescriptorSetBindPoints[setIndex] == currentPipeline->mVkBindPoint
+			&& mBoundState.mDescriptorSetLayoutKeys[setIndex] == currentPipeline->mLayoutKey)
+		{
+			++mStats.mNumSkipped[commandId];
+			return;
+		}
+
+		// Binding a set disturbs the higher sets bound with an incompatible layout
+		for (uint32 higherSetId = setIndex + 1; higherSetId < kMaxDescriptorSets; ++higherSetId)
+		{
+			if (mBoundState.mDescriptorSetLayoutKeys[higherSetId] != currentPipeline->mLayoutKey)
+			{
+				mBoundState.mDescriptorSets[higherSetId] = nullptr;
+			}
+		}
+
+		mBoundState.mDescriptorSets[setIndex] = descriptorSet->mVkDescriptorSet;
+		mBoundState.mDescriptorSetBindPoints[setIndex] = currentPipeline->mVkBindPoint;
+		mBoundState.mDescriptorSetLayoutKeys[setIndex] = currentPipeline->mLayoutKey;
+		++mStats.mNumIssued[commandId];
 
 		mVkCommandBuffer.bindDescriptorSets(
 			currentPipeline->mVkBindPoint,
@@ -227,8 +308,19 @@ namespace Turbo
 		const FPipeline* pipeline = mGpu->AccessPipeline(pipelineHandle);
 		TURBO_CHECK(pipeline)
 
-		mVkCommandBuffer.bindPipeline(pipeline->mVkBindPoint, pipeline->mVkPipeline);
 		mCurrentPipeline = pipelineHandle;
+
+		constexpr uint32 commandId = static_cast<uint32>(EStateCommand::BindPipeline);
+		if (mbStateCache && mBoundState.mVkPipeline == pipeline->mVkPipeline)
+		{
+			++mStats.mNumSkipped[commandId];
+			return;
+		}
+
+		mBoundState.mVkPipeline = pipeline->mVkPipeline;
+		++mStats.mNumIssued[commandId];
+
+		mVkCommandBuffer.bindPipeline(pipeline->mVkBindPoint, pipeline->mVkPipeline);
 	}
 
 	void FCommandBuffer::BindIndexBuffer(THandle<FBuffer> indexBuffer)
@@ -244,10 +336,14 @@ namespace Turbo
 		mVkCommandBuffer.dispatch(groupCount.x, groupCount.y, groupCount.z);
 	}
 
-	void FCommandBuffer::BeginRendering(const FRenderingAttachments& renderingAttachments)
+	void FCommandBuffer::BeginRendering(const FRenderingAttachments& renderingAttachments, bool bSecondaryCommandBuffersContent)
 	{
 		vk::RenderingInfo renderingInfo = {};
 		renderingInfo.layerCount = 1;
+		if (bSecondaryCommandBuffersContent)
+		{
+			renderingInfo.flags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+		}
 
 		std::array<vk::RenderingAttachmentInfo, 8> colorAttachments;
 		vk::RenderingAttachmentInfo vkDepthAttachmentInfo;
@@ -324,6 +420,28 @@ namespace Turbo
 		mVkCommandBuffer.beginRendering(renderingInfo);
 	}
 
+	void FCommandBuffer::ExecuteCommands(std::span<FCommandBuffer* const> secondaryCommandBuffers)
+	{
+		if (secondaryCommandBuffers.empty())
+		{
+			return;
+		}
+
+		std::array<vk::CommandBuffer, kMaxRenderingThreads> vkCommandBuffers;
+		TURBO_CHECK(secondaryCommandBuffers.size() <= vkCommandBuffers.size())
+
+		for (uint32 bufferId = 0; bufferId < secondaryCommandBuffers.size(); ++bufferId)
+		{
+			vkCommandBuffers[bufferId] = secondaryCommandBuffers[bufferId]->mVkCommandBuffer;
+		}
+
+		mVkCommandBuffer.executeCommands(secondaryCommandBuffers.size(), vkCommandBuffers.data());
+
+		// State bound by the primary command buffer is undefined after executing secondary ones
+		mCurrentPipeline.Reset();
+		InvalidateBoundState();
+	}
+
 	void FCommandBuffer::EndRendering()
 	{
 		mVkCommandBuffer.endRendering();
@@ -341,6 +459,17 @@ namespace Turbo
 		vkViewport.minDepth = viewport.MinDepth;
 		vkViewport.maxDepth = viewport.MaxDepth;
 
+		constexpr uint32 commandId = static_cast<uint32>(EStateCommand::SetViewport);
+		if (mbStateCache && mBoundState.mbViewportValid && mBoundState.mViewport == vkViewport)
+		{
+			++mStats.mNumSkipped[commandId];
+			return;
+		}
+
+		mBoundState.mbViewportValid = true;
+		mBoundState.mViewport = vkViewport;
+		++mStats.mNumIssued[commandId];
+
 		mVkCommandBuffer.setViewport(0, 1, &vkViewport);
 	}
 
@@ -350,6 +479,17 @@ namespace Turbo
 		vkScissor.offset = VulkanConverters::ToOffset2D(rect.Position);
 		vkScissor.extent = VulkanConverters::ToExtent2D(rect.Size);
 
+		constexpr uint32 commandId = static_cast<uint32>(EStateCommand::SetScissor);
+		if (mbStateCache && mBoundState.mbScissorValid && mBoundState.mScissor == vkScissor)
+		{
+			++mStats.mNumSkipped[commandId];
+			return;
+		}
+
+		mBoundState.mbScissorValid = true;
+		mBoundState.mScissor = vkScissor;
+		++mStats.mNumIssued[commandId];
+
 		mVkCommandBuffer.setScissor(0, 1, &vkScissor);
 	}
 
@@ -385,14 +525,14 @@ namespace Turbo
 
 	void FCommandBuffer::BuildTLAS(const FBuildTLASParams& buildTLASParams)
 	{
-		const FBuffer* instanceDataBuffer = mGpu->AccessBuffer(buildTLASParams.mInstanceDataBuffer);
 		const FBuffer* scratchBuffer = mGpu->AccessBuffer(buildTLASParams.mScratchBuffer);
 		const FTLAS* tlas = mGpu->AccessTLAS(buildTLASParams.mTLAS);
-		TURBO_CHECK(instanceDataBuffer && scratchBuffer && tlas)
+		TURBO_CHECK(scratchBuffer && tlas)
+		TURBO_CHECK(buildTLASParams.mInstanceData != kNullDeviceAddress || buildTLASParams.mNumInstances == 0)
 
 		vk::AccelerationStructureGeometryInstancesDataKHR instancesData = {};
 		instancesData.arrayOfPointers = false;
-		instancesData.data = instanceDataBuffer->mDeviceAddress;
+		instancesData.data = buildTLASParams.mInstanceData;
 
 		vk::AccelerationStructureGeometryKHR geometry = {};
 		geometry.geometryType = vk::GeometryTypeKHR::eInstances;
@@ -408,7 +548,7 @@ namespace Turbo
 		geometryInfo.dstAccelerationStructure = tlas->mVkAccelerationStructure;
 
 		vk::AccelerationStructureBuildRangeInfoKHR rangeInfo = {};
-		rangeInfo.primitiveCount = instanceDataBuffer->mDeviceSize / sizeof(vk::AccelerationStructureInstanceKHR);
+		rangeInfo.primitiveCount = buildTLASParams.mNumInstances;
 		rangeInfo.primitiveOffset = 0;
 		rangeInfo.firstVertex = 0;
 		rangeInfo.transformOffset = 0;
@@ -435,14 +575,22 @@ namespace Turbo
 
 	void FCommandBuffer::Reset()
 	{
-		for (int setId = 0; setId < kMaxDescriptorSets; ++setId)
-		{
-			mBoundDescriptorSets[setId].Reset();
-		}
 		mCurrentPipeline.Reset();
+		InvalidateBoundState();
+		mStats = {};
+		mbStateCache = CVarStateCache.Get();
 		mbRecording = false;
 	}
 
+	void FCommandBuffer::InvalidateBoundState()
+	{
+		mBoundState.mVkPipeline = nullptr;
+		mBoundState.mDescriptorSets = {};
+		mBoundState.mPushConstantsSize = 0;
+		mBoundState.mbViewportValid = false;
+		mBoundState.mbScissorValid = false;
+	}
+
 	vk::CommandBufferSubmitInfo FCommandBuffer::CreateSubmitInfo() const
 	{
 		vk::CommandBufferSubmitInfo result{};
@@ -458,6 +606,23 @@ namespace Turbo
 		const FPipeline* currentPipeline = mGpu->AccessPipeline(mCurrentPipeline);
 		TURBO_CHECK(currentPipeline)
 
+		TURBO_CHECK(size <= kMaxPushConstantSize)
+
+		constexpr uint32 commandId = static_cast<uint32>(EStateCommand::PushConstants);
+		if (mbStateCache
+			&& mBoundState.mPushConstantsSize == size
+			&& mBoundState.mPushConstantsLayoutKey == currentPipeline->mLayoutKey
+			&& std::memcmp(mBoundState.mPushConstants.data(), pushConstants, size) == 0)
+		{
+			++mStats.mNumSkipped[commandId];
+			return;
+		}
+
+		mBoundState.mPushConstantsSize = size;
+		mBoundState.mPushConstantsLayoutKey = currentPipeline->mLayoutKey;
+		std::memcpy(mBoundState.mPushConstants.data(), pushConstants, size);
+		++mStats.mNumIssued[commandId];
+
 		vk::ShaderStageFlags stageFlagBits = vk::ShaderStageFlagBits::eCompute;
 		if (currentPipeline->mbGraphicsPipeline)
 		{
@@ -16,17 +16,19 @@ namespace Turbo
 		commandBuffer.BeginDebugUtilsLabel(label.ToCString(), color);
 
 #if WITH_PROFILER
-		mGPUZone = new tracy::VkCtxScope(
-			commandBuffer.GetGPUDevice()->GetTraceGpuCtx(),
+		// Null devices have no GPU trace context
+		const FTraceGPUCtx traceGpuCtx = commandBuffer.GetGPUDevice()->GetTraceGpuCtx();
+		mGPUZone.emplace(
+			traceGpuCtx,
 			0,
 			StringUtils::kEmptyCString, 0,
 			StringUtils::kEmptyCString, 0,
 			label.ToCString(), std::strlen(label.ToCString()),
 			commandBuffer.GetVkCommandBuffer(),
-			true
+			traceGpuCtx != nullptr
 		);
 
-		mCPUZone = new tracy::ScopedZone(
+		mCPUZone.emplace(
 			0,
 			StringUtils::kEmptyCString, 0,
 			StringUtils::kEmptyCString, 0,
@@ -41,9 +43,6 @@ namespace Turbo
 	{
 		TURBO_CHECK(mCommandBuffer)
 		mCommandBuffer->EndDebugUtilsLabel();
-
-		delete mGPUZone;
-		delete mCPUZone;
 	}
 
 #endif // WITH_DEBUG_RENDERING_FEATURES
@@ -62,10 +61,13 @@ namespace Turbo
 		if (bCapture)
 		{
 			mGraphBuilder = &graphBuilder;
+			// Capture has to begin before any pass is recorded
+			graphBuilder.ForceSerialRecording();
 
 			static FName passName = FName("BeginRenderCapture");
 			auto pass = graphBuilder.AddPass(passName, EPassType::Compute);
-			pass->mExecutePass.BindLambda(
+			pass->SetNeverCull();
+			pass->BindExecute(
 				[](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 				{
 					entt::locator<IFrameDebuggerAPI>::value().BeginCapture(&gpu, nullptr);
@@ -80,7 +82,8 @@ namespace Turbo
 		{
 			static FName passName = FName("EndRenderCapture");
 			FRGPassInitializer pass = mGraphBuilder->AddPass(passName, EPassType::Compute);
-			pass->mExecutePass.BindLambda(
+			pass->SetNeverCull();
+			pass->BindExecute(
 				[](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 				{
 					entt::locator<IFrameDebuggerAPI>::value().EndCapture(&gpu, nullptr);
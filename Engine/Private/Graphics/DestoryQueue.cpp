@@ -14,4 +14,51 @@ namespace Turbo
 		mOnDestroy.Broadcast();
 		mOnDestroy.RemoveAll();
 	}
+
+	void FTimelineDestroyQueue::Seal(uint64 timelineValue)
+	{
+		if (mbOpenQueueEmpty)
+		{
+			return;
+		}
+
+		TURBO_CHECK(mSealedQueues.empty() || mSealedQueues.back().mTimelineValue <= timelineValue)
+
+		TUniquePtr<FDestroyQueue> newOpenQueue;
+		if (mFreeQueues.empty() == false)
+		{
+			newOpenQueue = std::move(mFreeQueues.back());
+			mFreeQueues.pop_back();
+		}
+		else
+		{
+			newOpenQueue = MakeUnique<FDestroyQueue>();
+		}
+
+		mSealedQueues.push_back({timelineValue, std::exchange(mOpenQueue, std::move(newOpenQueue))});
+		mbOpenQueueEmpty = true;
+	}
+
+	void FTimelineDestroyQueue::Flush(FGPUDevice& GPUDevice, uint64 completedTimelineValue)
+	{
+		while (mSealedQueues.empty() == false && mSealedQueues.front().mTimelineValue <= completedTimelineValue)
+		{
+			// Destroyers may request other destroys, those go to the open queue
+			TUniquePtr<FDestroyQueue> queue = std::move(mSealedQueues.front().mQueue);
+			mSealedQueues.pop_front();
+
+			queue->Flush(GPUDevice);
+			mFreeQueues.push_back(std::move(queue));
+		}
+	}
+
+	void FTimelineDestroyQueue::FlushAll(FGPUDevice& GPUDevice)
+	{
+		do
+		{
+			Seal(std::numeric_limits<uint64>::max());
+			Flush(GPUDevice, std::numeric_limits<uint64>::max());
+		}
+		while (mbOpenQueueEmpty == false);
+	}
 } // Turbo
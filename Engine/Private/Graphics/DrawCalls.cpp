@@ -0,0 +1,89 @@
+#include "Graphics/DrawCalls.h"
+
+#include "Graphics/GPUScene.h"
+#include "ProfilingMacros.h"
+#include "World/MeshComponent.h"
+
+namespace Turbo
+{
+	void DrawCalls::GatherDrawCalls(entt::registry& registry, FDrawCallStorage& outDrawCalls)
+	{
+		TRACE_ZONE_SCOPED_N("Prepare drawcalls")
+
+		const auto meshView = registry.view<FMeshComponent, FGPUSceneInstanceId>();
+
+		{
+			TRACE_ZONE_SCOPED_N("Reserve storage")
+			outDrawCalls.reserve(meshView.size_hint());
+
+			for (entt::entity entity : meshView)
+			{
+				outDrawCalls.emplace(entity);
+			}
+		}
+
+		{
+			TRACE_ZONE_SCOPED_N("Fill draw calls")
+			for (entt::entity entity : meshView)
+			{
+				const FMeshComponent& meshComponent = meshView.get<FMeshComponent>(entity);
+
+				FDrawCall& currentDrawCall = outDrawCalls.get(entity);
+				currentDrawCall.mInstanceId = meshView.get<FGPUSceneInstanceId>(entity).mId;
+				currentDrawCall.mMesh = meshComponent.mMesh;
+				currentDrawCall.mMaterial = meshComponent.mMaterial;
+				currentDrawCall.mMaterialInstance = meshComponent.mMaterialInstance;
+
+				constexpr uint64 kMaterialMask = 0xFFFF000000000000;
+				constexpr uint64 kMaterialInstanceMask = 0x0000FFFF00000000;
+				constexpr uint64 kMeshMask = 0x00000000FFFF0000;
+
+				TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMaterialMask))
+				TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMaterialInstanceMask))
+				TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMeshMask))
+
+				currentDrawCall.mDrawCallHash =
+					static_cast<uint64>(currentDrawCall.mMaterial.GetIndex()) << std::countr_zero(kMaterialMask)
+					| static_cast<uint64>(currentDrawCall.mMaterialInstance.GetIndex()) << std::countr_zero(kMaterialInstanceMask)
+					| static_cast<uint64>(currentDrawCall.mMesh.GetIndex()) << std::countr_zero(kMeshMask);
+			}
+		}
+
+		{
+			TRACE_ZONE_SCOPED_N("Sort draw calls")
+			outDrawCalls.sort([&](entt::entity left, const entt::entity& right)
+			{
+				return outDrawCalls.get(left).mDrawCallHash < outDrawCalls.get(right).mDrawCallHash;
+			});
+		}
+	}
+
+	void DrawCalls::CreateMaterialBuckets(FDrawCallStorage& drawCalls, std::vector<FMaterialBucket>& outBuckets)
+	{
+		TRACE_ZONE_SCOPED_N("Create material buckets")
+
+		if (drawCalls.empty())
+		{
+			return;
+		}
+
+		outBuckets.push_back({
+			.mTargetMaterial = drawCalls.begin()->mMaterial,
+			.mStartIt = drawCalls.begin()
+		});
+
+		for (FDrawCallIt drawCallIt = drawCalls.begin(); drawCallIt != drawCalls.end(); ++drawCallIt)
+		{
+			if (drawCallIt->mMaterial != outBuckets.back().mTargetMaterial)
+			{
+				outBuckets.back().mEndIt = drawCallIt;
+				outBuckets.push_back({
+					.mTargetMaterial = drawCallIt->mMaterial,
+					.mStartIt = drawCallIt
+				});
+			}
+		}
+
+		outBuckets.back().mEndIt = drawCalls.end();
+	}
+} // Turbo
@@ -1,51 +1,173 @@
 #include "Graphics/FrameGraph/RenderGraph.h"
 
 #include "CommonMacros.h"
+#include "Core/CoreUtils.h"
 #include "Core/DataStructures/Handle.h"
 #include "Graphics/CommandBuffer.h"
 #include "Graphics/Debug.h"
 #include "Graphics/GPUDevice.h"
 #include "Graphics/FrameGraph/RenderGraphHelpers.h"
 #include "Graphics/Resources.h"
+#include "Debug/IConsoleManager.h"
 #include "entt/locator/locator.hpp"
+#include "TaskScheduler.h"
 #include "vulkan/vulkan_to_string.hpp"
 #include <iterator>
 
 namespace Turbo
 {
-	FRGResourceHandle FRGPassInfo::ReadTexture(FRGResourceHandle texture)
+	static TAutoConsoleVariable<bool> CVarAliasing(
+		"rg.aliasing",
+		true,
+		"Places render graph transient resources with disjoint lifetimes in shared memory."
+	);
+
+	static TAutoConsoleVariable<bool> CVarCulling(
+		"rg.culling",
+		true,
+		"Skips render graph passes which don't contribute to any external or exported resource."
+	);
+
+	static TAutoConsoleVariable<bool> CVarParallelRecording(
+		"rg.parallelRecording",
+		true,
+		"Records render graph passes on task threads into secondary command buffers."
+	);
+
+	static TAutoConsoleVariable<bool> CVarAsyncCompute(
+		"rg.asyncCompute",
+		true,
+		"Submits AsyncCompute render graph passes to the async compute queue, if the device has one."
+	);
+
+	static TAutoConsoleVariable<bool> CVarCompileCache(
+		"rg.compileCache",
+		true,
+		"Reuses the previous render graph compilation when the graph structure didn't change."
+	);
+
+	static TAutoConsoleVariable<int32> CVarParallelMinWorkItems(
+		"rg.parallelMinWorkItems",
+		4,
+		"Minimal number of work items (e.g. draw buckets) recorded by a single task when a pass is split across threads."
+	);
+
+	static FAutoConsoleCommand gRGMemoryCommand(
+		"rg.memory",
+		"Prints memory used by the render graph transient resources.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRenderGraphBuilder& graphBuilder = entt::locator<FRenderGraphBuilder>::value();
+			consoleManager.Printf(
+				"Transient memory: {:.2f} MiB (without aliasing: {:.2f} MiB)",
+				static_cast<double>(graphBuilder.GetTransientMemorySize()) / Constants::kMebi,
+				static_cast<double>(graphBuilder.GetTransientMemorySizeWithoutAliasing()) / Constants::kMebi
+			);
+		}));
+
+	static FAutoConsoleCommand gRGBarriersCommand(
+		"rg.barriers",
+		"Prints number of barriers recorded by the last executed render graph.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRenderGraphBuilder& graphBuilder = entt::locator<FRenderGraphBuilder>::value();
+			consoleManager.Printf(
+				"Barriers: {} in {} batches",
+				graphBuilder.GetNumBarriers(),
+				graphBuilder.GetNumBarrierBatches()
+			);
+		}));
+
+	static FAutoConsoleCommand gRGCompileCacheCommand(
+		"rg.compileCache.stats",
+		"Prints how many render graph compilations were reused from the previous frame.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRenderGraphBuilder& graphBuilder = entt::locator<FRenderGraphBuilder>::value();
+			consoleManager.Printf(
+				"Compile cache: {} hits, {} misses",
+				graphBuilder.GetNumCompileCacheHits(),
+				graphBuilder.GetNumCompileCacheMisses()
+			);
+		}));
+
+	static FAutoConsoleCommand gRGCommandStatsCommand(
+		"rg.commandStats",
+		"Prints state commands issued and skipped as redundant by each pass of the last executed render graph.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRenderGraphBuilder& graphBuilder = entt::locator<FRenderGraphBuilder>::value();
+
+			std::string message = fmt::format("{:<32}", "Pass");
+			for (uint32 commandId = 0; commandId < kNumStateCommands; ++commandId)
+			{
+				message += fmt::format("{:>24}", magic_enum::enum_name(static_cast<EStateCommand>(commandId)));
+			}
+
+			FCommandBufferStats totalStats = {};
+			auto formatStats = [&message](const FCommandBufferStats& stats)
+			{
+				for (uint32 commandId = 0; commandId < kNumStateCommands; ++commandId)
+				{
+					message += fmt::format("{:>24}", fmt::format("{} / {} skipped", stats.mNumIssued[commandId], stats.mNumSkipped[commandId]));
+				}
+			};
+
+			for (const FRGPassCommandStats& passStats : graphBuilder.GetPassCommandStats())
+			{
+				if (passStats.mStats.GetNumIssued() + passStats.mStats.GetNumSkipped() == 0)
+				{
+					continue;
+				}
+
+				message += fmt::format("\n{:<32}", passStats.mPassName);
+				formatStats(passStats.mStats);
+				totalStats += passStats.mStats;
+			}
+
+			message += fmt::format("\n{:<32}", "Total");
+			formatStats(totalStats);
+
+			consoleManager.Print(message);
+		}));
+
+	FRGResourceHandle FRGPassInfo::ReadTexture(FRGResourceHandle texture, ERGResourceUsage usage)
 	{
 		TURBO_CHECK(texture.IsValid())
 		TURBO_CHECK(texture.GetType() == ERGResourceType::Texture)
 		TURBO_CHECK_SLOW(std::ranges::find(mTextureReads, texture) == mTextureReads.end())
 		mTextureReads.emplace_back(texture);
+		mTextureReadUsages.emplace_back(usage);
 		return texture;
 	}
 
-	FRGResourceHandle FRGPassInfo::WriteTexture(FRGResourceHandle texture)
+	FRGResourceHandle FRGPassInfo::WriteTexture(FRGResourceHandle texture, ERGResourceUsage usage)
 	{
 		TURBO_CHECK(texture.IsValid())
 		TURBO_CHECK(texture.GetType() == ERGResourceType::Texture)
 		TURBO_CHECK_SLOW(std::ranges::find(mTextureWrites, texture) == mTextureWrites.end())
 		mTextureWrites.emplace_back(texture);
+		mTextureWriteUsages.emplace_back(usage);
 		return texture;
 	}
 
-	FRGResourceHandle FRGPassInfo::ReadBuffer(FRGResourceHandle buffer)
+	FRGResourceHandle FRGPassInfo::ReadBuffer(FRGResourceHandle buffer, ERGResourceUsage usage)
 	{
 		TURBO_CHECK(buffer.IsValid())
 		TURBO_CHECK(buffer.GetType() == ERGResourceType::Buffer)
 		TURBO_CHECK_SLOW(std::ranges::find(mBufferReads, buffer) == mBufferReads.end())
 		mBufferReads.emplace_back(buffer);
+		mBufferReadUsages.emplace_back(usage);
 		return buffer;
 	}
 
-	FRGResourceHandle FRGPassInfo::WriteBuffer(FRGResourceHandle buffer)
+	FRGResourceHandle FRGPassInfo::WriteBuffer(FRGResourceHandle buffer, ERGResourceUsage usage)
 	{
 		TURBO_CHECK(buffer.IsValid())
 		TURBO_CHECK(buffer.GetType() == ERGResourceType::Buffer)
 		TURBO_CHECK_SLOW(std::ranges::find(mBufferWrites, buffer) == mBufferWrites.end())
 		mBufferWrites.emplace_back(buffer);
+		mBufferWriteUsages.emplace_back(usage);
 		return buffer;
 	}
 
@@ -59,10 +181,10 @@ namespace Turbo
 		TURBO_CHECK(attachmentIndex < kMaxColorAttachments);
 		TURBO_CHECK(mColorAttachments[attachmentIndex].IsValid() == false)
 
-		WriteTexture(attachment.mTexture);
+		WriteTexture(attachment.mTexture, ERGResourceUsage::ColorAttachment);
 		if (attachment.mResolveTexture.IsValid())
 		{
-			WriteTexture(attachment.mResolveTexture);
+			WriteTexture(attachment.mResolveTexture, ERGResourceUsage::ColorAttachment);
 		}
 
 		mColorAttachments[attachmentIndex] = attachment;
@@ -80,10 +202,10 @@ namespace Turbo
 	{
 		TURBO_CHECK(mDepthStencilAttachment.IsValid() == false)
 
-		WriteTexture(attachment.mTexture);
+		WriteTexture(attachment.mTexture, ERGResourceUsage::DepthStencilAttachment);
 		if (attachment.mResolveTexture.IsValid())
 		{
-			WriteTexture(attachment.mResolveTexture);
+			WriteTexture(attachment.mResolveTexture, ERGResourceUsage::DepthStencilAttachment);
 		}
 
 		mDepthStencilAttachment = attachment;
@@ -100,7 +222,11 @@ namespace Turbo
 		const FRGPassInfo& pass = Get();
 
 		TURBO_CHECK(pass.mPassType != EPassType::Undefined)
-		TURBO_CHECK_MSG(pass.mExecutePass.IsBound(), "{}: Execute delegate is not bound", pass.mName)
+		TURBO_CHECK_MSG(pass.mExecutePass.IsBound() || pass.mExecutePassRange.IsBound(), "{}: Execute delegate is not bound", pass.mName)
+		TURBO_CHECK_MSG(
+			pass.mPassType != EPassType::AsyncCompute || (pass.mColorAttachments[0].IsValid() == false && pass.mDepthStencilAttachment.IsValid() == false),
+			"{}: Async compute pass can't have attachments", pass.mName
+		)
 	}
 
 	FRGPassInfo& FRGPassInitializer::Get() const
@@ -186,44 +312,6 @@ namespace Turbo
 		return {ERGResourceType::Buffer, static_cast<uint32>(mBuffers.size() - 1)};
 	}
 
-	void FRenderGraphBuilder::QueueBufferUpload(const FRGBufferUpload& bufferUpload)
-	{
-#if WITH_SLOW_ASSERTIONS
-		const FRGBufferInfo& bufferInfo = mBuffers[bufferUpload.mTargetBuffer.GetIndex()];
-		TURBO_CHECK(bufferUpload.mDataSize + bufferUpload.mOffset <= bufferInfo.mSize)
-		TURBO_CHECK(mAllocator.Contains(bufferUpload.mData, bufferUpload.mDataSize + bufferUpload.mOffset))
-#endif // WITH_SLOW_ASSERTIONS
-
-		mQueuedBufferUploads.push_back(bufferUpload);
-	}
-
-	std::tuple<FRGResourceHandle, void* /*intermediatePtr */> FRenderGraphBuilder::CreateAndQueueBufferUpload(const FCreateAndUploadBuffer& createAndUploadBuffer)
-	{
-		TURBO_CHECK(createAndUploadBuffer.mData)
-
-		FRGResourceHandle result = CreateBuffer(FRGBufferInfo{
-			.mSize = createAndUploadBuffer.mSize,
-			.mBufferFlags = createAndUploadBuffer.mBufferFlags | EBufferFlags::CreateMapped,
-			.mName = createAndUploadBuffer.mName,
-		});
-
-		void* data = createAndUploadBuffer.mData;
-		if (mAllocator.Contains(createAndUploadBuffer.mData) == false)
-		{
-			data = mAllocator.Allocate(createAndUploadBuffer.mSize);
-			memcpy(data, createAndUploadBuffer.mData, createAndUploadBuffer.mSize);
-		}
-
-		QueueBufferUpload(FRGBufferUpload{
-			.mTargetBuffer = result,
-			.mData = data,
-			.mDataSize = createAndUploadBuffer.mSize,
-			.mOffset = 0
-		});
-
-		return std::make_tuple(result, data);
-	}
-
 	FRGBufferInfo FRenderGraphBuilder::GetBufferInfo(FRGResourceHandle resourceHandle) const
 	{
 		TURBO_CHECK(resourceHandle.GetType() == ERGResourceType::Buffer && resourceHandle.IsValid())
@@ -234,6 +322,15 @@ namespace Turbo
 		   : mBuffers[resourceHandle.GetIndex()];
 	}
 
+	void FRenderGraphBuilder::ExportResource(FRGResourceHandle resourceHandle)
+	{
+		TURBO_CHECK(resourceHandle.IsValid())
+		if (std::ranges::find(mExportedResources, resourceHandle) == mExportedResources.end())
+		{
+			mExportedResources.push_back(resourceHandle);
+		}
+	}
+
 	FRGResourceHandle FRenderGraphBuilder::RegisterExternalBuffer(THandle<FBuffer> bufferHandle)
 	{
 		TURBO_CHECK(bufferHandle)
@@ -280,57 +377,129 @@ namespace Turbo
 		passInfo.mHandle = { .mIndex = static_cast<uint16>(mRenderPasses.size() - 1) };
 		passInfo.mName = passName;
 
+		passInfo.mTextureReads = AllocateArray<FRGResourceHandle>();
+		passInfo.mTextureWrites = AllocateArray<FRGResourceHandle>();
+		passInfo.mBufferReads = AllocateArray<FRGResourceHandle>();
+		passInfo.mBufferWrites = AllocateArray<FRGResourceHandle>();
+		passInfo.mTextureReadUsages = AllocateArray<ERGResourceUsage>();
+		passInfo.mTextureWriteUsages = AllocateArray<ERGResourceUsage>();
+		passInfo.mBufferReadUsages = AllocateArray<ERGResourceUsage>();
+		passInfo.mBufferWriteUsages = AllocateArray<ERGResourceUsage>();
+
 		return FRGPassInitializer(*this, passInfo);
 	}
 
-	constexpr vk::AccessFlags2 FindAccessMask(EResourceAccess passType)
+	/** Pipeline stages of the shaders a pass of given type can run */
+	constexpr vk::PipelineStageFlags2 FindShaderStageMask(EPassType passType)
 	{
 		switch (passType)
 		{
-		case EResourceAccess::Read:
-			return vk::AccessFlagBits2::eMemoryRead;
-		case EResourceAccess::ReadWrite:
-			return vk::AccessFlagBits2::eMemoryWrite | vk::AccessFlagBits2::eMemoryRead;
+		case EPassType::Graphics:
+			return vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader;
+		case EPassType::Compute:
+		case EPassType::AsyncCompute:
+			return vk::PipelineStageFlagBits2::eComputeShader;
 		default:
-			TURBO_UNINPLEMENTED()
+			return vk::PipelineStageFlagBits2::eAllCommands;
 		}
+	}
 
-		std::unreachable();
-	};
-
-	inline vk::PipelineStageFlags2 FindTextureStageMask(EPassType passType, vk::Format format)
+	constexpr ERGResourceUsage FindDefaultUsage(EPassType passType, ERGResourceType resourceType, bool bWrite)
 	{
-		switch (passType)
+		if (passType == EPassType::Transfer)
 		{
-		case EPassType::Undefined:
-			return vk::PipelineStageFlagBits2::eAllCommands;
-		case EPassType::Graphics:
-			return TextureFormat::HasDepth(format)
-				       ? vk::PipelineStageFlagBits2::eEarlyFragmentTests
-				       : vk::PipelineStageFlagBits2::eColorAttachmentOutput;
-		case EPassType::Compute:
-			return vk::PipelineStageFlagBits2::eComputeShader;
-		case EPassType::Transfer:
-			return vk::PipelineStageFlagBits2::eTransfer;
-		default:
-			TURBO_UNINPLEMENTED()
+			return bWrite ? ERGResourceUsage::TransferDst : ERGResourceUsage::TransferSrc;
 		}
 
-		std::unreachable();
-	};
+		if (resourceType == ERGResourceType::Texture)
+		{
+			// Graphics pass writes textures only through attachments, which set the usage explicitly
+			return bWrite ? ERGResourceUsage::Storage : ERGResourceUsage::Sampled;
+		}
+
+		// Graphics passes read buffers both as draw arguments and from shaders
+		return passType == EPassType::Graphics && bWrite == false
+			? ERGResourceUsage::Default
+			: ERGResourceUsage::Storage;
+	}
 
-	inline vk::PipelineStageFlagBits2 FindBufferStageMask(EPassType passType)
+	static FRGResourceAccess FindResourceAccess(EPassType passType, ERGResourceType resourceType, ERGResourceUsage usage, bool bWrite)
 	{
-		switch (passType)
+		using EStage = vk::PipelineStageFlagBits2;
+		using EAccess = vk::AccessFlagBits2;
+
+		if (usage == ERGResourceUsage::Default)
 		{
-		case EPassType::Undefined:
-			return vk::PipelineStageFlagBits2::eAllCommands;
-		case EPassType::Graphics:
-			return vk::PipelineStageFlagBits2::eDrawIndirect;
-		case EPassType::Compute:
-			return vk::PipelineStageFlagBits2::eComputeShader;
-		case EPassType::Transfer:
-			return vk::PipelineStageFlagBits2::eTransfer;
+			usage = FindDefaultUsage(passType, resourceType, bWrite);
+		}
+
+		switch (usage)
+		{
+		case ERGResourceUsage::Default:
+			return {
+				.mStageMask = EStage::eDrawIndirect | FindShaderStageMask(passType),
+				.mAccessMask = EAccess::eIndirectCommandRead | EAccess::eShaderStorageRead | EAccess::eUniformRead,
+			};
+		case ERGResourceUsage::IndirectArgument:
+			TURBO_CHECK(bWrite == false)
+			return {
+				.mStageMask = EStage::eDrawIndirect,
+				.mAccessMask = EAccess::eIndirectCommandRead,
+			};
+		case ERGResourceUsage::Uniform:
+			TURBO_CHECK(bWrite == false)
+			return {
+				.mStageMask = FindShaderStageMask(passType),
+				.mAccessMask = EAccess::eUniformRead,
+			};
+		case ERGResourceUsage::Storage:
+			return {
+				.mStageMask = FindShaderStageMask(passType),
+				.mAccessMask = bWrite ? EAccess::eShaderStorageRead | EAccess::eShaderStorageWrite : EAccess::eShaderStorageRead,
+				.mLayout = ETextureLayout::General,
+			};
+		case ERGResourceUsage::Sampled:
+			TURBO_CHECK(bWrite == false)
+			return {
+				.mStageMask = FindShaderStageMask(passType),
+				.mAccessMask = EAccess::eShaderSampledRead,
+				.mLayout = ETextureLayout::ReadOnly,
+			};
+		case ERGResourceUsage::ColorAttachment:
+			return {
+				.mStageMask = EStage::eColorAttachmentOutput,
+				.mAccessMask = EAccess::eColorAttachmentRead | EAccess::eColorAttachmentWrite,
+				.mLayout = ETextureLayout::ColorAttachment,
+			};
+		case ERGResourceUsage::DepthStencilAttachment:
+			return {
+				.mStageMask = EStage::eEarlyFragmentTests | EStage::eLateFragmentTests,
+				.mAccessMask = EAccess::eDepthStencilAttachmentRead | EAccess::eDepthStencilAttachmentWrite,
+				.mLayout = ETextureLayout::DepthStencilAttachment,
+			};
+		case ERGResourceUsage::TransferSrc:
+			return {
+				.mStageMask = EStage::eTransfer,
+				.mAccessMask = EAccess::eTransferRead,
+				.mLayout = ETextureLayout::TransferSrc,
+			};
+		case ERGResourceUsage::TransferDst:
+			return {
+				.mStageMask = EStage::eTransfer,
+				.mAccessMask = EAccess::eTransferWrite,
+				.mLayout = ETextureLayout::TransferDst,
+			};
+		case ERGResourceUsage::AccelerationStructureBuild:
+			return {
+				.mStageMask = EStage::eAccelerationStructureBuildKHR,
+				.mAccessMask = bWrite ? EAccess::eAccelerationStructureReadKHR | EAccess::eAccelerationStructureWriteKHR : EAccess::eShaderRead,
+			};
+		case ERGResourceUsage::AccelerationStructureRead:
+			TURBO_CHECK(bWrite == false)
+			return {
+				.mStageMask = EStage::eFragmentShader | EStage::eComputeShader,
+				.mAccessMask = EAccess::eAccelerationStructureReadKHR,
+			};
 		default:
 			TURBO_UNINPLEMENTED()
 		}
@@ -338,592 +507,1770 @@ namespace Turbo
 		std::unreachable();
 	}
 
-	inline void GroupResourcesByUsage(
-		const std::vector<FRGResourceHandle>& inReads,
-		const std::vector<FRGResourceHandle>& inWrites,
-		std::vector<FRGResourceHandle>& outReadOnly,
-		std::vector<FRGResourceHandle>& outReadWrite
+	constexpr vk::AccessFlags2 kWriteAccessMask =
+		vk::AccessFlagBits2::eShaderWrite
+		| vk::AccessFlagBits2::eShaderStorageWrite
+		| vk::AccessFlagBits2::eColorAttachmentWrite
+		| vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+		| vk::AccessFlagBits2::eTransferWrite
+		| vk::AccessFlagBits2::eAccelerationStructureWriteKHR
+		| vk::AccessFlagBits2::eHostWrite
+		| vk::AccessFlagBits2::eMemoryWrite;
+
+	struct FRGResourceUse
+	{
+		FRGResourceHandle mResource = {};
+		FRGResourceAccess mAccess = {};
+		bool mbWrite = false;
+	};
+
+	/** Merges reads and writes of a pass into a single use per resource. Resource read and written by the pass gets both accesses. */
+	static void GatherResourceUses(
+		const FRGPassInfo& pass,
+		ERGResourceType resourceType,
+		std::span<const FRGResourceHandle> reads,
+		std::span<const ERGResourceUsage> readUsages,
+		std::span<const FRGResourceHandle> writes,
+		std::span<const ERGResourceUsage> writeUsages,
+		std::vector<FRGResourceUse>& outUses
 	)
 	{
-		TURBO_CHECK(&inReads != &inWrites && &outReadOnly != &outReadWrite);
+		outUses.clear();
+		for (uint32 writeId = 0; writeId < writes.size(); ++writeId)
+		{
+			outUses.push_back({
+				.mResource = writes[writeId],
+				.mAccess = FindResourceAccess(pass.mPassType, resourceType, writeUsages[writeId], true),
+				.mbWrite = true,
+			});
+		}
 
-		outReadWrite = inWrites;
-		for (FRGResourceHandle read : inReads)
+		for (uint32 readId = 0; readId < reads.size(); ++readId)
 		{
-			if (std::ranges::find(outReadWrite, read) == outReadWrite.end())
+			const FRGResourceAccess readAccess = FindResourceAccess(pass.mPassType, resourceType, readUsages[readId], false);
+
+			auto foundWrite = std::ranges::find(outUses, reads[readId], &FRGResourceUse::mResource);
+			if (foundWrite != outUses.end())
 			{
-				outReadOnly.push_back(read);
+				// Layout is defined by the write
+				foundWrite->mAccess.mStageMask |= readAccess.mStageMask;
+				foundWrite->mAccess.mAccessMask |= readAccess.mAccessMask;
+				continue;
 			}
+
+			outUses.push_back({
+				.mResource = reads[readId],
+				.mAccess = readAccess,
+			});
 		}
 	}
 
-	void FRenderGraphBuilder::CompileTextureSynchronization()
+	/**
+	 * Synchronization state of a resource between passes.
+	 * Reads after a write are made visible only to the stages and accesses that need them, so a read already covered by
+	 * an earlier barrier doesn't need a new one. Writes wait for the previous write and for all reads since then.
+	 */
+	struct FRGResourceSyncState
 	{
-		struct FResourceState
-		{
-			EPassType mLastUseType = EPassType::Graphics;
-			EResourceAccess mAccess = EResourceAccess::ReadWrite;
-			ETextureLayout mLayout = ETextureLayout::Undefined;
-			vk::Format mFormat = vk::Format::eUndefined;
-		};
+		/** Stages of the last write (or layout transition). eNone when the content is already visible, e.g. written by the host. */
+		vk::PipelineStageFlags2 mWriteStages = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 mWriteAccess = vk::AccessFlagBits2::eNone;
 
-		entt::dense_map<FRGResourceHandle, FResourceState> resourceData;
+		vk::PipelineStageFlags2 mReadStages = vk::PipelineStageFlagBits2::eNone;
 
-		// register external resources
-		for (uint32 externalTextureId = 0; externalTextureId < mExternalTextures.size(); ++externalTextureId)
+		vk::PipelineStageFlags2 mVisibleStages = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 mVisibleAccess = vk::AccessFlagBits2::eNone;
+
+		ETextureLayout mLayout = ETextureLayout::Undefined;
+
+		/** Queue owning the resource and the last pass using it there. Resources outside the graph belong to the graphics queue. */
+		ERGQueue mQueue = ERGQueue::Graphics;
+		uint32 mLastPass = FRGQueueDependency::kGraphBegin;
+
+		/** State of resource used outside the graph (external or from the previous frame) */
+		static FRGResourceSyncState Unknown(ETextureLayout layout)
 		{
-			FRGResourceHandle resourceHandle(ERGResourceType::Texture, externalTextureId, true);
-			resourceData[resourceHandle] = {
-				.mLastUseType = EPassType::Undefined,
-				.mAccess = EResourceAccess::ReadWrite,
-				.mLayout = mExternalTextures[externalTextureId].mInitialLayout,
-				.mFormat = mExternalTextures[externalTextureId].mTextureInfo.mFormat
+			return {
+				.mWriteStages = vk::PipelineStageFlagBits2::eAllCommands,
+				.mWriteAccess = vk::AccessFlagBits2::eMemoryWrite,
+				.mLayout = layout,
 			};
 		}
+	};
 
-		mPerPassTextureBarriers.clear();
-		mPerPassTextureBarriers.resize(mRenderPasses.size());
+	struct FRGBarrierScope
+	{
+		vk::PipelineStageFlags2 mSrcStageMask = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 mSrcAccessMask = vk::AccessFlagBits2::eNone;
+		vk::PipelineStageFlags2 mDstStageMask = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 mDstAccessMask = vk::AccessFlagBits2::eNone;
+		ETextureLayout mOldLayout = ETextureLayout::Undefined;
+	};
 
-		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+	/** Updates the resource state and returns the barrier scope if the use needs one */
+	static std::optional<FRGBarrierScope> TransitionResource(FRGResourceSyncState& state, const FRGResourceUse& use, bool bTexture)
+	{
+		const FRGResourceAccess& access = use.mAccess;
+		const bool bLayoutChange = bTexture && state.mLayout != access.mLayout;
+
+		FRGBarrierScope scope = {
+			.mDstStageMask = access.mStageMask,
+			.mDstAccessMask = access.mAccessMask,
+			.mOldLayout = state.mLayout,
+		};
+
+		if (use.mbWrite || bLayoutChange)
 		{
-			const FRGPassInfo& pass = mRenderPasses[passId];
-			TURBO_LOG(LogRenderGraph, Display, "[Compile Texture Syncronization] {}", pass.mName)
+			// Write after read needs only an execution dependency. Layout transition is a write too.
+			scope.mSrcStageMask = state.mWriteStages | state.mReadStages;
+			scope.mSrcAccessMask = state.mWriteAccess;
+
+			state.mWriteStages = access.mStageMask;
+			state.mWriteAccess = use.mbWrite ? access.mAccessMask & kWriteAccessMask : vk::AccessFlagBits2::eNone;
+			state.mReadStages = use.mbWrite ? vk::PipelineStageFlagBits2::eNone : access.mStageMask;
+			state.mVisibleStages = access.mStageMask;
+			state.mVisibleAccess = access.mAccessMask;
+			state.mLayout = bTexture ? access.mLayout : ETextureLayout::Undefined;
+
+			if (scope.mSrcStageMask == vk::PipelineStageFlagBits2::eNone && bLayoutChange == false)
+			{
+				return std::nullopt;
+			}
+			return scope;
+		}
 
-			std::vector<FRGTextureMemoryBarrier>& passImageBarriers = mPerPassTextureBarriers[passId];
+		// Read after read, or read of data already made visible to this stage and access
+		state.mReadStages |= access.mStageMask;
+		if (state.mWriteStages == vk::PipelineStageFlagBits2::eNone
+			|| ((access.mStageMask & ~state.mVisibleStages) == vk::PipelineStageFlagBits2::eNone
+				&& (access.mAccessMask & ~state.mVisibleAccess) == vk::AccessFlagBits2::eNone))
+		{
+			return std::nullopt;
+		}
 
-			std::vector<FRGResourceHandle> readWriteResources = pass.mTextureWrites;
-			std::vector<FRGResourceHandle> readOnlyResources;
+		scope.mSrcStageMask = state.mWriteStages;
+		scope.mSrcAccessMask = state.mWriteAccess;
 
-			GroupResourcesByUsage(
-				pass.mTextureReads,
-				pass.mTextureWrites,
-				readOnlyResources,
-				readWriteResources
-			);
+		state.mVisibleStages |= access.mStageMask;
+		state.mVisibleAccess |= access.mAccessMask;
+		return scope;
+	}
 
-			for (FRGResourceHandle read : readOnlyResources)
-			{
-				auto foundSrcData = resourceData.find(read);
-				TURBO_CHECK_MSG(foundSrcData != resourceData.end(), "Pass tries to read non existent resource")
+	/**
+	 * Moves the resource to the queue of the pass using it. The pass waits for the last pass using it on the other queue.
+	 * The semaphore wait makes all writes of the other queue visible, so a barrier is needed only to transfer the ownership
+	 * of the texture content. Returns state of the resource before the transfer.
+	 */
+	static FRGResourceSyncState TransferResourceQueue(FRGResourceSyncState& state, ERGQueue queue, uint32 passId, std::vector<FRGQueueDependency>& outDependencies)
+	{
+		const FRGResourceSyncState previousState = state;
+		outDependencies.push_back({.mSrcPass = state.mLastPass, .mDstPass = passId});
 
-				if (FResourceState& srcData = foundSrcData->second;
-					srcData.mAccess != EResourceAccess::Read || srcData.mLayout != ETextureLayout::ReadOnly)
-				{
-					FRGTextureMemoryBarrier& newBarrier = passImageBarriers.emplace_back();
-					newBarrier.mTexture = read;
-					newBarrier.mOldLayout = srcData.mLayout;
-					newBarrier.mNewLayout =
-						pass.mPassType == EPassType::Transfer
-							? ETextureLayout::TransferSrc
-							: ETextureLayout::ReadOnly;
-
-					newBarrier.mSrcStageMask = FindTextureStageMask(srcData.mLastUseType, srcData.mFormat);
-					newBarrier.mDstStageMask =
-						pass.mPassType == EPassType::Compute
-							? vk::PipelineStageFlagBits2::eAllCommands
-							: vk::PipelineStageFlagBits2::eAllGraphics;
-
-					newBarrier.mSrcAccessMask = FindAccessMask(srcData.mAccess);
-					newBarrier.mDstAccessMask =
-						pass.mPassType == EPassType::Transfer
-							? vk::AccessFlagBits2::eTransferRead
-							: vk::AccessFlagBits2::eShaderRead;
-
-					srcData.mLastUseType = pass.mPassType;
-					srcData.mAccess = EResourceAccess::Read;
-					srcData.mLayout = ETextureLayout::ReadOnly;
-
-					TURBO_LOG(LogRenderGraph, Display, "[Read Only] {}, {}", GetTextureInfo(read).mName, newBarrier.ToString())
-				}
-			}
+		state = {
+			.mLayout = state.mLayout,
+			.mQueue = queue,
+			.mLastPass = passId,
+		};
 
-			for (FRGResourceHandle write : readWriteResources)
-			{
-				FRGTextureMemoryBarrier& newBarrier = passImageBarriers.emplace_back();
-				newBarrier.mTexture = write;
-				newBarrier.mDstAccessMask = FindAccessMask(EResourceAccess::ReadWrite);
+		return previousState;
+	}
 
-				if (auto srcDataIt = resourceData.find(write);
-					srcDataIt != resourceData.end())
-				{
-					newBarrier.mOldLayout = srcDataIt->second.mLayout;
-					newBarrier.mSrcAccessMask = FindAccessMask(srcDataIt->second.mAccess);
-					newBarrier.mSrcStageMask = FindTextureStageMask(srcDataIt->second.mLastUseType, srcDataIt->second.mFormat);
-				}
-				else
-				{
-					// This pass creates new texture
-					newBarrier.mOldLayout = ETextureLayout::Undefined;
-					newBarrier.mSrcAccessMask = vk::AccessFlagBits2::eNone;
-					newBarrier.mSrcStageMask = vk::PipelineStageFlagBits2::eNone;
-
-					resourceData[write] = {
-						.mFormat = GetTextureFormat(write)
-					};
-				}
+	/** Pair of barriers transferring texture ownership from the queue of previousState to dstQueue */
+	static std::pair<FRGTextureMemoryBarrier, FRGTextureMemoryBarrier> MakeQueueTransferBarriers(
+		FRGResourceHandle texture,
+		const FRGResourceSyncState& previousState,
+		ERGQueue dstQueue,
+		ETextureLayout newLayout,
+		vk::PipelineStageFlags2 dstStageMask,
+		vk::AccessFlags2 dstAccessMask
+	)
+	{
+		// Layouts of release and acquire barriers have to match. Stages of the other queue are covered by the semaphore.
+		const FRGTextureMemoryBarrier releaseBarrier = {
+			.mOldLayout = previousState.mLayout,
+			.mNewLayout = newLayout,
+			.mSrcStageMask = previousState.mWriteStages | previousState.mReadStages,
+			.mDstStageMask = vk::PipelineStageFlagBits2::eNone,
+			.mSrcAccessMask = previousState.mWriteAccess,
+			.mDstAccessMask = vk::AccessFlagBits2::eNone,
+			.mSrcQueue = previousState.mQueue,
+			.mDstQueue = dstQueue,
+			.mTexture = texture,
+		};
 
-				switch (pass.mPassType)
-				{
-				case EPassType::Graphics:
-					newBarrier.mNewLayout =
-						pass.mDepthStencilAttachment.mTexture == write
-							? ETextureLayout::DepthStencilAttachment
-							: ETextureLayout::ColorAttachment;
-					break;
-				case EPassType::Compute:
-					newBarrier.mNewLayout = ETextureLayout::General;
-					break;
-				case EPassType::Transfer:
-					newBarrier.mNewLayout = ETextureLayout::TransferDst;
-					break;
-				default:
-					TURBO_UNINPLEMENTED()
-				}
+		const FRGTextureMemoryBarrier acquireBarrier = {
+			.mOldLayout = previousState.mLayout,
+			.mNewLayout = newLayout,
+			.mSrcStageMask = vk::PipelineStageFlagBits2::eNone,
+			.mDstStageMask = dstStageMask,
+			.mSrcAccessMask = vk::AccessFlagBits2::eNone,
+			.mDstAccessMask = dstAccessMask,
+			.mSrcQueue = previousState.mQueue,
+			.mDstQueue = dstQueue,
+			.mTexture = texture,
+		};
+
+		return {releaseBarrier, acquireBarrier};
+	}
 
-				FResourceState& currentData = resourceData.at(write);
-				newBarrier.mDstStageMask = FindTextureStageMask(pass.mPassType, currentData.mFormat);
+	/** Vulkan barriers of a single pipeline barrier. Passes are recorded on many threads, so each thread reuses its own. */
+	static std::vector<vk::ImageMemoryBarrier2>& GetImageBarriersScratch()
+	{
+		thread_local std::vector<vk::ImageMemoryBarrier2> imageBarriers;
+		imageBarriers.clear();
+		return imageBarriers;
+	}
+
+	static EQueueType GetPassQueueType(const FRGPassInfo& pass)
+	{
+		return pass.mQueue == ERGQueue::AsyncCompute ? EQueueType::Compute : EQueueType::Graphics;
+	}
+
+	static void MergeMemoryBarrier(
+		vk::MemoryBarrier2& memoryBarrier,
+		vk::PipelineStageFlags2 srcStageMask,
+		vk::AccessFlags2 srcAccessMask,
+		vk::PipelineStageFlags2 dstStageMask,
+		vk::AccessFlags2 dstAccessMask
+	)
+	{
+		memoryBarrier.srcStageMask |= srcStageMask;
+		memoryBarrier.srcAccessMask |= srcAccessMask;
+		memoryBarrier.dstStageMask |= dstStageMask;
+		memoryBarrier.dstAccessMask |= dstAccessMask;
+	}
+
+	struct FAliasingCandidate
+	{
+		uint32 mResourceId = 0;
+		vk::MemoryRequirements mRequirements = {};
+		FRGResourceLifetime mLifetime = {};
+	};
+
+	/** Scratch of the compilation steps. It's kept between frames, so recompiling a graph of the same size doesn't allocate. */
+	struct FRGCompileScratch
+	{
+		std::vector<bool> mNeededTextures;
+		std::vector<bool> mNeededBuffers;
+
+		std::vector<FAliasingCandidate> mAliasingCandidates;
+		std::vector<uint32> mPlacedCandidates;
+		std::vector<std::pair<FDeviceSize, FDeviceSize>> mOccupiedRanges;
+
+		std::vector<FRGResourceUse> mUses;
+		entt::dense_map<FRGResourceHandle, FRGResourceSyncState> mResourceStates;
 
-				TURBO_LOG(LogRenderGraph, Display, "[Read Write] {} {}", GetTextureInfo(write).mName, newBarrier.ToString())
+		std::vector<bool> mSplitBefore;
+		std::vector<bool> mSplitAfter;
+		std::vector<uint32> mPassSubmissions;
+		std::vector<uint32> mWaitingSubmissions;
+	};
+
+	static FRGCompileScratch& GetCompileScratch()
+	{
+		thread_local FRGCompileScratch scratch;
+		return scratch;
+	}
 
+	void FRenderGraphBuilder::CullPasses()
+	{
+		TRACE_ZONE_SCOPED()
 
-				currentData.mLastUseType = pass.mPassType;
-				currentData.mAccess = EResourceAccess::ReadWrite;
-				currentData.mLayout = newBarrier.mNewLayout;
+		mNumCulledPasses = 0;
+		if (CVarCulling.Get() == false)
+		{
+			for (FRGPassInfo& pass : mRenderPasses)
+			{
+				pass.mbCulled = false;
 			}
+			return;
 		}
 
-		// Add final exterior resources barriers
-		for (uint32 externalTextureId = 0; externalTextureId < mExternalTextures.size(); ++externalTextureId)
+		// Resources read by a pass which is alive. External and exported resources are the graph outputs.
+		FRGCompileScratch& scratch = GetCompileScratch();
+		std::vector<bool>& neededTextures = scratch.mNeededTextures;
+		std::vector<bool>& neededBuffers = scratch.mNeededBuffers;
+		neededTextures.assign(mTextures.size(), false);
+		neededBuffers.assign(mBuffers.size(), false);
+
+		for (FRGResourceHandle exported : mExportedResources)
 		{
-			FRGResourceHandle resourceHandle(ERGResourceType::Texture, externalTextureId, true);
-			if (auto foundSrcData = resourceData.find(resourceHandle);
-				foundSrcData != resourceData.end())
+			if (exported.IsExternal() == false)
+			{
+				(exported.GetType() == ERGResourceType::Texture ? neededTextures : neededBuffers)[exported.GetIndex()] = true;
+			}
+		}
+
+		auto isAnyNeeded = [](const std::vector<bool>& needed, std::span<const FRGResourceHandle> resources)
+		{
+			return std::ranges::any_of(resources, [&needed](FRGResourceHandle resource)
 			{
-				FResourceState& srcData = foundSrcData->second;
+				return resource.IsExternal() || needed[resource.GetIndex()];
+			});
+		};
 
-				// Skip transitions to undefined
-				if (mExternalTextures[externalTextureId].mFinalLayout == ETextureLayout::Undefined)
+		auto markNeeded = [](std::vector<bool>& needed, std::span<const FRGResourceHandle> resources)
+		{
+			for (FRGResourceHandle resource : resources)
+			{
+				if (resource.IsExternal() == false)
 				{
-					continue;
+					needed[resource.GetIndex()] = true;
 				}
+			}
+		};
 
-				FRGTextureMemoryBarrier& newBarrier = mExternalTexturesBarriers.emplace_back();
-				newBarrier.mSrcStageMask = FindTextureStageMask(srcData.mLastUseType, srcData.mFormat);
-				newBarrier.mDstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
-
-				newBarrier.mSrcAccessMask = FindAccessMask(srcData.mAccess);
-				newBarrier.mDstAccessMask = FindAccessMask(EResourceAccess::ReadWrite);
+		// Passes are recorded in the execution order, so walking backwards visits consumers before producers
+		for (int32 passId = static_cast<int32>(mRenderPasses.size()) - 1; passId >= 0; --passId)
+		{
+			FRGPassInfo& pass = mRenderPasses[passId];
 
-				newBarrier.mOldLayout = srcData.mLayout;
-				newBarrier.mNewLayout = mExternalTextures[externalTextureId].mFinalLayout;
+			pass.mbCulled =
+				pass.mbNeverCull == false
+				&& isAnyNeeded(neededTextures, pass.mTextureWrites) == false
+				&& isAnyNeeded(neededBuffers, pass.mBufferWrites) == false;
 
-				newBarrier.mTexture = resourceHandle;
+			if (pass.mbCulled)
+			{
+				++mNumCulledPasses;
+				TURBO_LOG(LogRenderGraph, Display, "Culling pass: {}", pass.mName)
+				continue;
 			}
+
+			// Writes are also needed. Pass can write only a part of the resource (e.g. load op), so earlier writers have to stay.
+			markNeeded(neededTextures, pass.mTextureReads);
+			markNeeded(neededTextures, pass.mTextureWrites);
+			markNeeded(neededBuffers, pass.mBufferReads);
+			markNeeded(neededBuffers, pass.mBufferWrites);
 		}
+
+		static const cstring kCulledPasses = "RG Culled Passes";
+		TRACE_PLOT_CONFIGURE(kCulledPasses, EPlotFormat::Number, true, true, 0xFFFF00)
+		TRACE_PLOT(kCulledPasses, static_cast<int64>(mNumCulledPasses))
 	}
 
-	void FRenderGraphBuilder::CompileBufferSynchronization()
+	void FRenderGraphBuilder::CompileQueues()
 	{
-		struct FResourceState
-		{
-			EPassType mLastUseType = EPassType::Graphics;
-			EResourceAccess mAccess = EResourceAccess::ReadWrite;
-		};
-
-		entt::dense_map<FRGResourceHandle, FResourceState> resourceData;
+		const FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+		const bool bAsyncComputeQueue = CVarAsyncCompute.Get() && gpu.HasAsyncComputeQueue();
 
-		// Register external buffers
-		for (uint32 externalBufferId = 0; externalBufferId < mExternalBuffers.size(); ++externalBufferId)
+		mQueueDependencies.clear();
+		mbUsesAsyncCompute = false;
+		for (FRGPassInfo& pass : mRenderPasses)
 		{
-			FRGResourceHandle resourceHandle(ERGResourceType::Buffer, externalBufferId, true);
-			resourceData[resourceHandle] = {
-				.mLastUseType = EPassType::Undefined,
-				.mAccess = EResourceAccess::ReadWrite,
-			};
+			const bool bAsyncCompute = bAsyncComputeQueue && pass.mPassType == EPassType::AsyncCompute && pass.mbCulled == false;
+			pass.mQueue = bAsyncCompute ? ERGQueue::AsyncCompute : ERGQueue::Graphics;
+			mbUsesAsyncCompute |= bAsyncCompute;
 		}
+	}
 
-		for (const FRGBufferUpload& upload : mQueuedBufferUploads)
-		{
-			resourceData[upload.mTargetBuffer] = {
-				.mLastUseType = EPassType::Undefined,
-				.mAccess = EResourceAccess::HostWrite
-			};
-		}
+	void FRenderGraphBuilder::CompileResourceLifetimes()
+	{
+		mTextureLifetimes.assign(mTextures.size(), {});
+		mBufferLifetimes.assign(mBuffers.size(), {});
 
-		mPerPassBufferBarriers.clear();
-		mPerPassBufferBarriers.resize(mRenderPasses.size());
+		auto addPassToLifetimes = [this](std::vector<FRGResourceLifetime>& lifetimes, std::span<const FRGResourceHandle> resources, uint16 passId)
+		{
+			for (FRGResourceHandle resource : resources)
+			{
+				if (resource.IsExternal() == false)
+				{
+					FRGResourceLifetime& lifetime = lifetimes[resource.GetIndex()];
+					lifetime.AddPass(passId);
+					lifetime.mbAsyncCompute |= mRenderPasses[passId].mQueue == ERGQueue::AsyncCompute;
+				}
+			}
+		};
 
-		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		for (uint16 passId = 0; passId < mRenderPasses.size(); ++passId)
 		{
 			const FRGPassInfo& pass = mRenderPasses[passId];
+			if (pass.mbCulled)
+			{
+				continue;
+			}
 
-			std::vector<FRGResourceHandle> readWriteResources;
-			std::vector<FRGResourceHandle> readOnlyResources;
+			// Attachments are already part of the texture writes
+			addPassToLifetimes(mTextureLifetimes, pass.mTextureReads, passId);
+			addPassToLifetimes(mTextureLifetimes, pass.mTextureWrites, passId);
+			addPassToLifetimes(mBufferLifetimes, pass.mBufferReads, passId);
+			addPassToLifetimes(mBufferLifetimes, pass.mBufferWrites, passId);
+		}
+	}
 
-			GroupResourcesByUsage(
-				pass.mBufferReads, pass.mBufferWrites,
-				readOnlyResources, readWriteResources
-			);
+	/** Greedy first fit. Biggest resources are placed first, each one at the lowest offset not used by any resource with an overlapping lifetime. */
+	static FRGTransientHeapInfo PlaceTransientResources(std::vector<FAliasingCandidate>& candidates, std::vector<FRGResourcePlacement>& outPlacements)
+	{
+		std::ranges::sort(candidates, std::ranges::greater{}, [](const FAliasingCandidate& candidate) { return candidate.mRequirements.size; });
 
-			for (FRGResourceHandle read : readOnlyResources)
-			{
-				auto foundSrcData = resourceData.find(read);
-				TURBO_CHECK_MSG(foundSrcData != resourceData.end(), "Pass tries to read non existent resource");
+		FRGTransientHeapInfo heapInfo = {};
 
-				if (FResourceState& srcData = foundSrcData->second;
-					srcData.mAccess != EResourceAccess::Read && srcData.mAccess != EResourceAccess::HostWrite)
-				{
-					FRGBufferMemoryBarrier& newBarrier = mPerPassBufferBarriers[passId].emplace_back();
-					newBarrier.mBuffer = read;
+		FRGCompileScratch& scratch = GetCompileScratch();
+		std::vector<uint32>& placedCandidates = scratch.mPlacedCandidates;
+		placedCandidates.clear();
 
-					newBarrier.mSrcAccessMask = FindAccessMask(EResourceAccess::ReadWrite);
-					newBarrier.mDstAccessMask = FindAccessMask(EResourceAccess::Read);
+		std::vector<std::pair<FDeviceSize, FDeviceSize>>& occupiedRanges = scratch.mOccupiedRanges;
 
-					newBarrier.mSrcStageMask = FindBufferStageMask(srcData.mLastUseType);
-					newBarrier.mDstStageMask = FindBufferStageMask(pass.mPassType);
+		for (uint32 candidateId = 0; candidateId < candidates.size(); ++candidateId)
+		{
+			const FAliasingCandidate& candidate = candidates[candidateId];
+			const vk::MemoryRequirements& requirements = candidate.mRequirements;
 
-					srcData.mLastUseType = pass.mPassType;
-					srcData.mAccess = EResourceAccess::Read;
-				}
+			// Resource which can't share memory type with the rest is not aliased
+			if ((heapInfo.mMemoryTypeBits & requirements.memoryTypeBits) == 0)
+			{
+				continue;
 			}
 
-			for (FRGResourceHandle write : readWriteResources)
+			occupiedRanges.clear();
+			for (const uint32 placedId : placedCandidates)
 			{
-				auto srcDataIt = resourceData.find(write);
-				if (srcDataIt != resourceData.end() && srcDataIt->second.mAccess == EResourceAccess::HostWrite)
+				if (candidates[placedId].mLifetime.Overlaps(candidate.mLifetime))
 				{
-					continue;
+					const FRGResourcePlacement& placement = outPlacements[candidates[placedId].mResourceId];
+					occupiedRanges.emplace_back(placement.mOffset, placement.mOffset + placement.mSize);
 				}
+			}
+			std::ranges::sort(occupiedRanges);
 
-				FRGBufferMemoryBarrier& newBarrier = mPerPassBufferBarriers[passId].emplace_back();
-				newBarrier.mBuffer = write;
-				newBarrier.mDstAccessMask = FindAccessMask(EResourceAccess::ReadWrite);
-
-				if (srcDataIt != resourceData.end())
-				{
-					newBarrier.mSrcAccessMask = FindAccessMask(srcDataIt->second.mAccess);
-					newBarrier.mSrcStageMask = FindBufferStageMask(srcDataIt->second.mLastUseType);
-				}
-				else
+			FDeviceSize offset = 0;
+			for (const auto& [rangeBegin, rangeEnd] : occupiedRanges)
+			{
+				if (Memory::Align(offset, requirements.alignment) + requirements.size <= rangeBegin)
 				{
-					// This pass creates a new buffer
-					newBarrier.mSrcAccessMask = vk::AccessFlagBits2::eNone;
-					newBarrier.mSrcStageMask = vk::PipelineStageFlagBits2::eNone;
-
-					resourceData[write] = {};
+					break;
 				}
 
-				FResourceState& currentData = resourceData.at(write);
-				currentData.mLastUseType = pass.mPassType;
-				currentData.mAccess = EResourceAccess::ReadWrite;
+				offset = glm::max(offset, rangeEnd);
 			}
+			offset = Memory::Align(offset, requirements.alignment);
+
+			outPlacements[candidate.mResourceId] = {
+				.mOffset = offset,
+				.mSize = requirements.size,
+				.mbAliased = true
+			};
+
+			heapInfo.mSize = glm::max(heapInfo.mSize, offset + requirements.size);
+			heapInfo.mAlignment = glm::max(heapInfo.mAlignment, requirements.alignment);
+			heapInfo.mMemoryTypeBits &= requirements.memoryTypeBits;
+
+			placedCandidates.push_back(candidateId);
 		}
+
+		return heapInfo;
 	}
 
-	void FRenderGraphBuilder::Compile()
+	void FRenderGraphBuilder::CompileResourceAliasing()
 	{
 		TRACE_ZONE_SCOPED()
 
-		CompileTextureSynchronization();
-		CompileBufferSynchronization();
-	}
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 
-   void FRenderGraphBuilder::Execute(FGPUDevice& gpu, FCommandBuffer& cmd)
-	{
-		TRACE_ZONE_SCOPED()
-		TURBO_LOG(LogRenderGraph, Display, "Executing render graph");
+		mTexturePlacements.assign(mTextures.size(), {});
+		mBufferPlacements.assign(mBuffers.size(), {});
+		mTransientHeaps = {};
+
+		FDeviceSize notAliasedSize = 0;
+		mTransientMemorySizeWithoutAliasing = 0;
 
-		FRenderResources renderResources = {};
-		renderResources.mTextures.reserve(mTextures.size() + mExternalTextures.size());
-		renderResources.mBuffers.reserve(mBuffers.size() + mExternalBuffers.size());
+		std::vector<FAliasingCandidate>& candidates = GetCompileScratch().mAliasingCandidates;
+		candidates.clear();
+
+		// Candidates which couldn't share the memory type with others get dedicated memory
+		auto sumNotPlaced = [&candidates](const std::vector<FRGResourcePlacement>& placements)
+		{
+			FDeviceSize result = 0;
+			for (const FAliasingCandidate& candidate : candidates)
+			{
+				result += placements[candidate.mResourceId].mbAliased ? 0 : candidate.mRequirements.size;
+			}
+			return result;
+		};
 
-		// Allocate textures
+		// Textures
 		for (uint32 textureId = 0; textureId < mTextures.size(); ++textureId)
 		{
-			const FRGTextureInfo& textureInfo = mTextures[textureId];
-			TURBO_LOG(LogRenderGraph, Display, "Allocating texture: {}", textureInfo.mName);
+			// Used only by culled passes. Not created at all.
+			if (mTextureLifetimes[textureId].IsValid() == false)
+			{
+				continue;
+			}
 
-			FTextureBuilder builder = {
+			const FRGTextureInfo& textureInfo = mTextures[textureId];
+			const FTextureBuilder builder = {
 				.mWidth = textureInfo.mWidth,
 				.mHeight = textureInfo.mHeight,
 				.mFlags = textureInfo.mFlags,
 				.mFormat = textureInfo.mFormat,
 				.mType = ETextureType::Texture2D,
 				.mNumSamples = textureInfo.mNumSamples,
-				.mName = textureInfo.mName
 			};
 
-			const FRGResourceHandle handle(ERGResourceType::Texture, textureId, false);
-			const THandle<FTexture> texture = gpu.CreateTexture(builder);
-			TURBO_CHECK(texture)
+			const vk::MemoryRequirements requirements = gpu.GetTextureMemoryRequirements(builder);
+			mTransientMemorySizeWithoutAliasing += requirements.size;
 
-			renderResources.mTextures.emplace(handle, texture);
+			if (CVarAliasing.Get() && mTextureLifetimes[textureId].mbAsyncCompute == false)
+			{
+				candidates.push_back({textureId, requirements, mTextureLifetimes[textureId]});
+			}
+			else
+			{
+				notAliasedSize += requirements.size;
+			}
 		}
 
-		// Allocate buffers
+		mTransientHeaps[static_cast<uint32>(ERGTransientHeap::Textures)] = PlaceTransientResources(candidates, mTexturePlacements);
+		notAliasedSize += sumNotPlaced(mTexturePlacements);
+
+		// Buffers
+		candidates.clear();
 		for (uint32 bufferId = 0; bufferId < mBuffers.size(); ++bufferId)
 		{
-			const FRGBufferInfo bufferInfo = mBuffers[bufferId];
+			if (mBufferLifetimes[bufferId].IsValid() == false)
+			{
+				continue;
+			}
 
-			FBufferBuilder builder = {
+			const FRGBufferInfo& bufferInfo = mBuffers[bufferId];
+			const FBufferBuilder builder = {
 				.mBufferFlags = bufferInfo.mBufferFlags,
 				.mSize = bufferInfo.mSize,
-				.mName = bufferInfo.mName
 			};
 
-			const FRGResourceHandle handle(ERGResourceType::Buffer, bufferId, false);
-			const THandle<FBuffer> buffer = gpu.CreateBuffer(builder);
-			TURBO_CHECK(buffer)
+			const vk::MemoryRequirements requirements = gpu.GetBufferMemoryRequirements(builder);
+			mTransientMemorySizeWithoutAliasing += requirements.size;
 
-			renderResources.mBuffers.emplace(handle, buffer);
+			// Mapped buffers are written by the host and have to stay in host visible memory.
+			const bool bHostVisible = (bufferInfo.mBufferFlags & EBufferFlags::CreateMapped) != EBufferFlags::None;
+			if (CVarAliasing.Get() && bHostVisible == false && mBufferLifetimes[bufferId].mbAsyncCompute == false)
+			{
+				candidates.push_back({bufferId, requirements, mBufferLifetimes[bufferId]});
+			}
+			else
+			{
+				notAliasedSize += requirements.size;
+			}
 		}
 
-		// Register external textures
+		mTransientHeaps[static_cast<uint32>(ERGTransientHeap::Buffers)] = PlaceTransientResources(candidates, mBufferPlacements);
+		notAliasedSize += sumNotPlaced(mBufferPlacements);
+
+		mTransientMemorySize = notAliasedSize;
+		for (const FRGTransientHeapInfo& heapInfo : mTransientHeaps)
+		{
+			mTransientMemorySize += heapInfo.mSize;
+		}
+
+		static const cstring kTransientMemory = "RG Transient Memory";
+		TRACE_PLOT_CONFIGURE(kTransientMemory, EPlotFormat::Memory, true, true, 0x00FF00)
+		TRACE_PLOT(kTransientMemory, static_cast<int64>(mTransientMemorySize))
+
+		static const cstring kTransientMemoryWithoutAliasing = "RG Transient Memory (No Aliasing)";
+		TRACE_PLOT_CONFIGURE(kTransientMemoryWithoutAliasing, EPlotFormat::Memory, true, true, 0xFF0000)
+		TRACE_PLOT(kTransientMemoryWithoutAliasing, static_cast<int64>(mTransientMemorySizeWithoutAliasing))
+	}
+
+	void FRenderGraphBuilder::CompileTextureSynchronization()
+	{
+		FRGCompileScratch& scratch = GetCompileScratch();
+		entt::dense_map<FRGResourceHandle, FRGResourceSyncState>& resourceStates = scratch.mResourceStates;
+		resourceStates.clear();
+
+		// register external resources
 		for (uint32 externalTextureId = 0; externalTextureId < mExternalTextures.size(); ++externalTextureId)
 		{
-			const THandle<FTexture> texture = mExternalTextures[externalTextureId].mTextureHandle;
-			TURBO_CHECK(texture)
+			FRGResourceHandle resourceHandle(ERGResourceType::Texture, externalTextureId, true);
+			resourceStates[resourceHandle] = FRGResourceSyncState::Unknown(mExternalTextures[externalTextureId].mInitialLayout);
+		}
 
-			const FRGResourceHandle handle(ERGResourceType::Texture, externalTextureId, true);
-			renderResources.mTextures.emplace(handle, texture);
+		// Barrier lists are cleared in place to keep their capacity
+		mPerPassTextureBarriers.resize(mRenderPasses.size());
+		mPerPassTextureReleaseBarriers.resize(mRenderPasses.size());
+		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		{
+			mPerPassTextureBarriers[passId].clear();
+			mPerPassTextureReleaseBarriers[passId].clear();
+		}
+		mExternalTexturesBarriers.clear();
+		mExternalTexturesReleaseBarriers.clear();
 
-			TURBO_LOG(LogRenderGraph, Display, "Registering external texture: {}", mExternalTextures[externalTextureId].mTextureInfo.mName);
+		std::vector<FRGResourceUse>& uses = scratch.mUses;
+		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		{
+			const FRGPassInfo& pass = mRenderPasses[passId];
+			if (pass.mbCulled)
+			{
+				continue;
+			}
+
+			TURBO_LOG(LogRenderGraph, Display, "[Compile Texture Syncronization] {}", pass.mName)
+
+			GatherResourceUses(
+				pass, ERGResourceType::Texture,
+				pass.mTextureReads, pass.mTextureReadUsages,
+				pass.mTextureWrites, pass.mTextureWriteUsages,
+				uses
+			);
+
+			for (const FRGResourceUse& use : uses)
+			{
+				auto foundState = resourceStates.find(use.mResource);
+				if (foundState == resourceStates.end())
+				{
+					TURBO_CHECK_MSG(use.mbWrite, "Pass tries to read non existent resource")
+
+					// This pass creates new texture. Transient textures come from the resource pool and could be
+					// still used by the previous frame or share memory with a texture used earlier in this frame,
+					// so this is also the aliasing barrier. Wait for all prior writes.
+					foundState = resourceStates.emplace(use.mResource, FRGResourceSyncState::Unknown(ETextureLayout::Undefined)).first;
+					foundState->second.mQueue = pass.mQueue;
+				}
+
+				FRGResourceSyncState& state = foundState->second;
+				if (state.mQueue != pass.mQueue)
+				{
+					const FRGResourceSyncState previousState = TransferResourceQueue(state, pass.mQueue, passId, mQueueDependencies);
+
+					// Texture without content (e.g. transient one written first time) is just transitioned by the new queue
+					if (previousState.mLayout != ETextureLayout::Undefined)
+					{
+						TransitionResource(state, use, true);
+
+						const auto [releaseBarrier, acquireBarrier] = MakeQueueTransferBarriers(
+							use.mResource, previousState, pass.mQueue,
+							use.mAccess.mLayout, use.mAccess.mStageMask, use.mAccess.mAccessMask
+						);
+
+						FRGPassTextureBarriers& releaseBarriers =
+							previousState.mLastPass == FRGQueueDependency::kGraphBegin
+								? mExternalTexturesReleaseBarriers
+								: mPerPassTextureReleaseBarriers[previousState.mLastPass];
+						releaseBarriers.push_back(releaseBarrier);
+						mPerPassTextureBarriers[passId].push_back(acquireBarrier);
+
+						TURBO_LOG(LogRenderGraph, Display, "[Queue Transfer] {}, {}", GetTextureInfo(use.mResource).mName, acquireBarrier.ToString())
+						continue;
+					}
+				}
+				state.mLastPass = passId;
+
+				const std::optional<FRGBarrierScope> scope = TransitionResource(state, use, true);
+				if (scope.has_value() == false)
+				{
+					continue;
+				}
+
+				FRGTextureMemoryBarrier& newBarrier = mPerPassTextureBarriers[passId].emplace_back();
+				newBarrier.mTexture = use.mResource;
+				newBarrier.mOldLayout = scope->mOldLayout;
+				newBarrier.mNewLayout = use.mAccess.mLayout;
+				newBarrier.mSrcStageMask = scope->mSrcStageMask;
+				newBarrier.mSrcAccessMask = scope->mSrcAccessMask;
+				newBarrier.mDstStageMask = scope->mDstStageMask;
+				newBarrier.mDstAccessMask = scope->mDstAccessMask;
+
+				TURBO_LOG(LogRenderGraph, Display, "[{}] {}, {}", use.mbWrite ? "Read Write" : "Read Only", GetTextureInfo(use.mResource).mName, newBarrier.ToString())
+			}
 		}
 
-		// Register external buffers
-		for (uint32 externalBufferId = 0; externalBufferId < mExternalBuffers.size(); ++externalBufferId)
+		// Add final exterior resources barriers
+		for (uint32 externalTextureId = 0; externalTextureId < mExternalTextures.size(); ++externalTextureId)
 		{
-			const THandle<FBuffer> buffer = mExternalBuffers[externalBufferId].mHandle;
-			TURBO_CHECK(buffer)
+			const FRGExternalTextureInfo& externalTexture = mExternalTextures[externalTextureId];
+			const FRGResourceHandle externalTextureHandle(ERGResourceType::Texture, externalTextureId, true);
+			const FRGResourceSyncState& state = resourceStates.at(externalTextureHandle);
 
-			const FRGResourceHandle handle(ERGResourceType::Buffer, externalBufferId, true);
-			renderResources.mBuffers.emplace(handle, buffer);
+			// Textures outside the graph belong to the graphics queue. Last async compute pass using it gives it back.
+			if (state.mQueue != ERGQueue::Graphics)
+			{
+				mQueueDependencies.push_back({.mSrcPass = state.mLastPass, .mDstPass = FRGQueueDependency::kGraphEnd});
+				if (state.mLayout == ETextureLayout::Undefined)
+				{
+					continue;
+				}
 
-			TURBO_LOG(LogRenderGraph, Display, "Registering external buffer: {}", mExternalBuffers[externalBufferId].mInfo.mName);
+				const ETextureLayout finalLayout =
+					externalTexture.mFinalLayout != ETextureLayout::Undefined ? externalTexture.mFinalLayout : state.mLayout;
+				const auto [releaseBarrier, acquireBarrier] = MakeQueueTransferBarriers(
+					externalTextureHandle, state, ERGQueue::Graphics,
+					finalLayout, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite
+				);
+
+				mPerPassTextureReleaseBarriers[state.mLastPass].push_back(releaseBarrier);
+				mExternalTexturesBarriers.push_back(acquireBarrier);
+				continue;
+			}
+
+			// Skip transitions to undefined. Next use of an external texture waits for all commands anyway, so the
+			// barrier is needed only to change the layout.
+			if (externalTexture.mFinalLayout == ETextureLayout::Undefined || externalTexture.mFinalLayout == state.mLayout)
+			{
+				continue;
+			}
+
+			FRGTextureMemoryBarrier& newBarrier = mExternalTexturesBarriers.emplace_back();
+			newBarrier.mSrcStageMask = state.mWriteStages | state.mReadStages;
+			newBarrier.mDstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+
+			newBarrier.mSrcAccessMask = state.mWriteAccess;
+			newBarrier.mDstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite;
+
+			newBarrier.mOldLayout = state.mLayout;
+			newBarrier.mNewLayout = externalTexture.mFinalLayout;
+
+			newBarrier.mTexture = externalTextureHandle;
 		}
+	}
+
+	void FRenderGraphBuilder::CompileBufferSynchronization()
+	{
+		FRGCompileScratch& scratch = GetCompileScratch();
+		entt::dense_map<FRGResourceHandle, FRGResourceSyncState>& resourceStates = scratch.mResourceStates;
+		resourceStates.clear();
 
-		// Upload buffers
-		for (FRGBufferUpload& bufferUpload : mQueuedBufferUploads)
+		// Register external buffers
+		for (uint32 externalBufferId = 0; externalBufferId < mExternalBuffers.size(); ++externalBufferId)
 		{
-			const FBuffer* buffer = gpu.AccessBuffer(renderResources.mBuffers.at(bufferUpload.mTargetBuffer));
-			std::memcpy(
-				static_cast<byte*>(buffer->mMappedAddress) + bufferUpload.mOffset,
-				bufferUpload.mData,
-				bufferUpload.mDataSize
-			);
+			FRGResourceHandle resourceHandle(ERGResourceType::Buffer, externalBufferId, true);
+			resourceStates[resourceHandle] = FRGResourceSyncState::Unknown(ETextureLayout::Undefined);
+		}
 
-			TURBO_LOG(LogRenderGraph, Display, "Uploading data to \"{}\" buffer", mBuffers[bufferUpload.mTargetBuffer.GetIndex()].mName);
+		mPerPassBufferBarriers.resize(mRenderPasses.size());
+		for (FRGPassBufferBarriers& passBarriers : mPerPassBufferBarriers)
+		{
+			passBarriers.clear();
 		}
 
+		std::vector<FRGResourceUse>& uses = scratch.mUses;
 		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
 		{
 			const FRGPassInfo& pass = mRenderPasses[passId];
-			DEBUG_LABEL_REGION(cmd, pass.mName);
+			if (pass.mbCulled)
+			{
+				continue;
+			}
+
+			GatherResourceUses(
+				pass, ERGResourceType::Buffer,
+				pass.mBufferReads, pass.mBufferReadUsages,
+				pass.mBufferWrites, pass.mBufferWriteUsages,
+				uses
+			);
 
-			TURBO_LOG(LogRenderGraph, Display, "Begin render pass: {}", pass.mName);
+			for (const FRGResourceUse& use : uses)
+			{
+				auto foundState = resourceStates.find(use.mResource);
+				if (foundState == resourceStates.end())
+				{
+					TURBO_CHECK_MSG(use.mbWrite, "Pass tries to read non existent resource")
 
-			// Add a barrier
-			FRGPassTextureBarriers& passImageBarriers = mPerPassTextureBarriers[passId];
+					// This pass creates a new buffer. It comes from the resource pool and may alias memory of
+					// another buffer, so wait for all prior writes.
+					foundState = resourceStates.emplace(use.mResource, FRGResourceSyncState::Unknown(ETextureLayout::Undefined)).first;
+					foundState->second.mQueue = pass.mQueue;
+				}
 
-			std::vector<vk::ImageMemoryBarrier2> imageBarriers;
-			imageBarriers.reserve(passImageBarriers.size());
+				// Buffers are shared by the queue families, so the semaphore is enough
+				FRGResourceSyncState& state = foundState->second;
+				if (state.mQueue != pass.mQueue)
+				{
+					TransferResourceQueue(state, pass.mQueue, passId, mQueueDependencies);
+				}
+				state.mLastPass = passId;
 
-			for (const FRGTextureMemoryBarrier& rgBarrier : passImageBarriers)
-			{
-				THandle<FTexture> textureHandle = renderResources.mTextures.at(rgBarrier.mTexture);
-				TURBO_LOG(
-					LogRenderGraph, Display, "[Image Barrier] Texture: {}; ({}, {}, {}) -> ({}, {}, {})",
-					gpu.AccessTextureCold(textureHandle)->mName,
-					magic_enum::enum_name(rgBarrier.mOldLayout),
-					vk::to_string(rgBarrier.mSrcStageMask),
-					vk::to_string(rgBarrier.mSrcAccessMask),
-					magic_enum::enum_name(rgBarrier.mNewLayout),
-					vk::to_string(rgBarrier.mSrcStageMask),
-					vk::to_string(rgBarrier.mDstAccessMask)
-				);
+				const std::optional<FRGBarrierScope> scope = TransitionResource(state, use, false);
+				if (scope.has_value() == false)
+				{
+					continue;
+				}
 
-				imageBarriers.push_back(rgBarrier.ToVkImageBarrier(gpu, textureHandle));
+				FRGBufferMemoryBarrier& newBarrier = mPerPassBufferBarriers[passId].emplace_back();
+				newBarrier.mBuffer = use.mResource;
+				newBarrier.mSrcStageMask = scope->mSrcStageMask;
+				newBarrier.mSrcAccessMask = scope->mSrcAccessMask;
+				newBarrier.mDstStageMask = scope->mDstStageMask;
+				newBarrier.mDstAccessMask = scope->mDstAccessMask;
 			}
+		}
 
-			FRGPassBufferBarriers& passBufferBarriers = mPerPassBufferBarriers[passId];
+		// External buffers written by the async compute queue have to be finished before the frame ends
+		for (uint32 externalBufferId = 0; externalBufferId < mExternalBuffers.size(); ++externalBufferId)
+		{
+			const FRGResourceSyncState& state = resourceStates.at(FRGResourceHandle(ERGResourceType::Buffer, externalBufferId, true));
+			if (state.mQueue != ERGQueue::Graphics)
+			{
+				mQueueDependencies.push_back({.mSrcPass = state.mLastPass, .mDstPass = FRGQueueDependency::kGraphEnd});
+			}
+		}
+	}
 
-			std::vector<vk::BufferMemoryBarrier2> bufferBarriers;
-			bufferBarriers.reserve(mPerPassBufferBarriers[passId].size());
+	void FRenderGraphBuilder::CompileSubmissions()
+	{
+		TRACE_ZONE_SCOPED()
 
-			for (const FRGBufferMemoryBarrier& rgBarrier : passBufferBarriers)
+		// Submissions of the previous compilation are reused, so their pass lists keep the capacity
+		uint32 numSubmissions = 0;
+		auto addSubmission = [this, &numSubmissions](ERGQueue queue)
+		{
+			if (numSubmissions == mSubmissions.size())
 			{
-				THandle<FBuffer> bufferHandle = renderResources.mBuffers.at(rgBarrier.mBuffer);
-				bufferBarriers.push_back(rgBarrier.ToVkBufferBarrier(gpu, bufferHandle));
-
-				TURBO_LOG(LogRenderGraph, Display, "[Buffer Barrier] Buffer: {}", gpu.AccessBufferCold(bufferHandle)->mName);
+				mSubmissions.emplace_back();
 			}
 
-			vk::DependencyInfo dependencyInfo = {};
-			dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
-			dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
-			dependencyInfo.bufferMemoryBarrierCount = bufferBarriers.size();
-			dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+			FRGSubmission& submission = mSubmissions[numSubmissions];
+			submission.mQueue = queue;
+			submission.mPasses.clear();
+			submission.mWaitSubmissions.clear();
+			submission.mbSignal = false;
+
+			return numSubmissions++;
+		};
 
-			cmd.PipelineBarrier(dependencyInfo);
+		addSubmission(ERGQueue::Graphics);
 
-			if (pass.mPassType == EPassType::Graphics)
+		if (mbUsesAsyncCompute == false)
+		{
+			for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
 			{
-				FRenderingAttachments renderingAttachments;
-
-				// Bind color attachments
-				for (uint32 attachmentId = 0; attachmentId < kMaxColorAttachments; ++attachmentId)
+				if (mRenderPasses[passId].mbCulled == false)
 				{
-					if (pass.mColorAttachments[attachmentId].IsValid())
-					{
-						const FRGAttachment attachment = pass.mColorAttachments[attachmentId];
-
-						FAttachment attachmentInfo = {
-							.mTexture = renderResources.mTextures.at(attachment.mTexture),
-							.mLoadOp = attachment.mLoadOp,
-							.mStoreOp = attachment.mStoreOp,
-							.mClearColor = attachment.mClearColor,
-						};
-
-						if (attachment.mResolveTexture.IsValid())
-						{
-							attachmentInfo.mResolveTexture = renderResources.mTextures.at(attachment.mResolveTexture),
-							attachmentInfo.mResolveMode = attachment.mResolveMode;
-						}
-
-						renderingAttachments.AddColorAttachment(attachmentInfo);
-
-						TURBO_LOG(
-							LogRenderGraph, Display, "[GraphicsPass] Bind {} as color attachment {}",
-							gpu.AccessTextureCold(renderResources.mTextures.at(attachment.mTexture))->mName,
-							attachmentId
-						);
-					}
+					mSubmissions.front().mPasses.push_back(passId);
 				}
+			}
 
-				// Bind depth stencil attachment (if valid)
-				if (pass.mDepthStencilAttachment.IsValid())
-				{
-					const FRGAttachment& attachment = pass.mDepthStencilAttachment;
+			mSubmissions.resize(numSubmissions);
+			return;
+		}
 
-					FAttachment attachmentInfo = {
-						.mTexture = renderResources.mTextures.at(attachment.mTexture),
-						.mLoadOp = attachment.mLoadOp,
-						.mStoreOp = attachment.mStoreOp,
-						.mClearColor = attachment.mClearColor,
-					};
+		// Async compute starts after the graphics work recorded before the graph, which also finishes previous frame use
+		// of the pooled resources. Last graphics submission waits for the async compute, so the frame timeline value covers both queues.
+		const auto firstAsyncPass = std::ranges::find(mRenderPasses, ERGQueue::AsyncCompute, &FRGPassInfo::mQueue);
+		const auto lastAsyncPass = std::ranges::find(std::ranges::reverse_view(mRenderPasses), ERGQueue::AsyncCompute, &FRGPassInfo::mQueue);
+		mQueueDependencies.push_back({.mSrcPass = FRGQueueDependency::kGraphBegin, .mDstPass = firstAsyncPass->mHandle.mIndex});
+		mQueueDependencies.push_back({.mSrcPass = lastAsyncPass->mHandle.mIndex, .mDstPass = FRGQueueDependency::kGraphEnd});
+
+		// Submission signals after its last pass and waits before its first pass. Splitting at the dependencies keeps the
+		// passes in between free to overlap with the other queue.
+		FRGCompileScratch& scratch = GetCompileScratch();
+		std::vector<bool>& splitBefore = scratch.mSplitBefore;
+		std::vector<bool>& splitAfter = scratch.mSplitAfter;
+		splitBefore.assign(mRenderPasses.size(), false);
+		splitAfter.assign(mRenderPasses.size(), false);
+		for (const FRGQueueDependency& dependency : mQueueDependencies)
+		{
+			if (dependency.mSrcPass != FRGQueueDependency::kGraphBegin)
+			{
+				splitAfter[dependency.mSrcPass] = true;
+			}
 
-					if (attachment.mResolveTexture.IsValid())
-					{
-						attachmentInfo.mResolveTexture = renderResources.mTextures.at(attachment.mResolveTexture),
-						attachmentInfo.mResolveMode = attachment.mResolveMode;
-					}
+			if (dependency.mDstPass != FRGQueueDependency::kGraphEnd)
+			{
+				splitBefore[dependency.mDstPass] = true;
+			}
+		}
 
-					renderingAttachments.SetDepthAttachment(attachmentInfo);
+		static constexpr uint32 kNoSubmission = std::numeric_limits<uint32>::max();
+		std::vector<uint32>& passSubmissions = scratch.mPassSubmissions;
+		passSubmissions.assign(mRenderPasses.size(), kNoSubmission);
 
-					TURBO_LOG(
-						LogRenderGraph, Display, "[GraphicsPass] Bind {} as depth attachment",
-						gpu.AccessTextureCold(renderResources.mTextures[pass.mDepthStencilAttachment.mTexture])->mName
-					);
-				}
+		// First submission holds only the work recorded before the graph
+		std::array<uint32, static_cast<size_t>(ERGQueue::Num)> openSubmissions;
+		openSubmissions.fill(kNoSubmission);
+
+		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		{
+			const FRGPassInfo& pass = mRenderPasses[passId];
+			if (pass.mbCulled)
+			{
+				continue;
+			}
 
-				const FRGResourceHandle mainTextureHandle =
-					pass.mColorAttachments[0].IsValid()
-						? pass.mColorAttachments[0].mTexture
-						: pass.mDepthStencilAttachment.mTexture;
+			uint32& openSubmission = openSubmissions[static_cast<uint32>(pass.mQueue)];
+			if (openSubmission == kNoSubmission || splitBefore[passId])
+			{
+				openSubmission = addSubmission(pass.mQueue);
+			}
 
-				TURBO_CHECK(mainTextureHandle.IsValid())
+			mSubmissions[openSubmission].mPasses.push_back(passId);
+			passSubmissions[passId] = openSubmission;
 
-				const FRGTextureInfo& textureInfo =
-					mainTextureHandle.IsExternal()
-						? mExternalTextures[mainTextureHandle.GetIndex()].mTextureInfo
-						: mTextures[mainTextureHandle.GetIndex()];
-				const glm::ivec2 outputSize = glm::ivec2(textureInfo.mWidth, textureInfo.mHeight);
+			if (splitAfter[passId])
+			{
+				openSubmission = kNoSubmission;
+			}
+		}
 
-				cmd.BeginRendering(renderingAttachments);
-				cmd.SetViewport(FViewport::FromSize(outputSize));
-				cmd.SetScissor(FRect2DInt::FromSize(outputSize));
+		// Last submission holds the final barriers of the external resources and is submitted by the gpu device with the frame
+		const uint32 lastSubmission = addSubmission(ERGQueue::Graphics);
+		mSubmissions.resize(numSubmissions);
 
-				TURBO_LOG(LogRenderGraph, Display, "[GraphicsPass] Begin rendering. Viewport: {} Scissors: {}", outputSize, outputSize);
+		auto findSubmission = [&](uint32 passId)
+		{
+			switch (passId)
+			{
+			case FRGQueueDependency::kGraphBegin:
+				return 0u;
+			case FRGQueueDependency::kGraphEnd:
+				return lastSubmission;
+			default:
+				return passSubmissions[passId];
 			}
+		};
 
-			TURBO_CHECK(pass.mExecutePass.IsBound());
+		// Binary semaphore can be waited only once. Waiting for it in the earliest dependent submission covers all later
+		// submissions of that queue.
+		std::vector<uint32>& waitingSubmissions = scratch.mWaitingSubmissions;
+		waitingSubmissions.assign(mSubmissions.size(), kNoSubmission);
+		for (const FRGQueueDependency& dependency : mQueueDependencies)
+		{
+			const uint32 srcSubmission = findSubmission(dependency.mSrcPass);
+			const uint32 dstSubmission = findSubmission(dependency.mDstPass);
+			TURBO_CHECK(srcSubmission < dstSubmission)
+			TURBO_CHECK(mSubmissions[srcSubmission].mQueue != mSubmissions[dstSubmission].mQueue)
 
-			TURBO_LOG(LogRenderGraph, Display, "Execute: {}", pass.mName);
-			pass.mExecutePass.Execute(gpu, cmd, renderResources);
+			waitingSubmissions[srcSubmission] = glm::min(waitingSubmissions[srcSubmission], dstSubmission);
+		}
 
-			if (pass.mPassType == EPassType::Graphics)
+		for (uint32 submissionId = 0; submissionId < mSubmissions.size(); ++submissionId)
+		{
+			if (waitingSubmissions[submissionId] != kNoSubmission)
 			{
-				TURBO_LOG(LogRenderGraph, Display, "[GraphicsPass] End rendering.");
-				cmd.EndRendering();
+				mSubmissions[submissionId].mbSignal = true;
+				mSubmissions[waitingSubmissions[submissionId]].mWaitSubmissions.push_back(submissionId);
+			}
+		}
+
+		static const cstring kSubmissions = "RG Submissions";
+		TRACE_PLOT_CONFIGURE(kSubmissions, EPlotFormat::Number, true, true, 0x0000FF)
+		TRACE_PLOT(kSubmissions, static_cast<int64>(mSubmissions.size()))
+	}
+
+	size_t FRenderGraphBuilder::HashGraphStructure() const
+	{
+		TRACE_ZONE_SCOPED()
+
+		size_t hash = 0;
+		CoreUtils::HashCombine(hash, CVarCulling.Get(), CVarAliasing.Get(), CVarAsyncCompute.Get());
+
+		// Sizes are hashed as well, so resources moved between the lists change the hash
+		auto hashResourceUses = [&hash](std::span<const FRGResourceHandle> resources, std::span<const ERGResourceUsage> usages)
+		{
+			CoreUtils::HashCombine(hash, resources.size());
+			for (uint32 useId = 0; useId < resources.size(); ++useId)
+			{
+				CoreUtils::HashCombine(hash, resources[useId], usages[useId]);
 			}
+		};
+
+		auto hashAttachment = [&hash](const FRGAttachment& attachment)
+		{
+			CoreUtils::HashCombine(
+				hash,
+				attachment.mTexture, attachment.mLoadOp, attachment.mStoreOp,
+				attachment.mResolveTexture, attachment.mResolveMode
+			);
+		};
+
+		CoreUtils::HashCombine(hash, mRenderPasses.size());
+		for (const FRGPassInfo& pass : mRenderPasses)
+		{
+			CoreUtils::HashCombine(hash, pass.mPassType, pass.mbNeverCull);
+			hashResourceUses(pass.mTextureReads, pass.mTextureReadUsages);
+			hashResourceUses(pass.mTextureWrites, pass.mTextureWriteUsages);
+			hashResourceUses(pass.mBufferReads, pass.mBufferReadUsages);
+			hashResourceUses(pass.mBufferWrites, pass.mBufferWriteUsages);
 
+			for (const FRGAttachment& attachment : pass.mColorAttachments)
+			{
+				hashAttachment(attachment);
+			}
+			hashAttachment(pass.mDepthStencilAttachment);
 		}
 
-		// Destroy resources
-		// Destroy textures
-		for (uint32 textureId = 0; textureId < mTextures.size(); ++textureId)
+		// Descriptions of transient resources select their memory requirements and aliasing
+		CoreUtils::HashCombine(hash, mTextures.size());
+		for (const FRGTextureInfo& texture : mTextures)
 		{
-			const FRGResourceHandle handle(ERGResourceType::Texture, textureId, false);
-			auto foundIt = renderResources.mTextures.find(handle);
-			TURBO_CHECK(foundIt != renderResources.mTextures.end())
+			CoreUtils::HashCombine(hash, texture.mWidth, texture.mHeight, texture.mFormat, texture.mFlags, texture.mNumSamples);
+		}
 
-			TURBO_LOG(LogRenderGraph, Display, "Destroying texture: {}", gpu.AccessTextureCold(foundIt->second)->mName);
-			gpu.DestroyTexture(foundIt->second);
+		CoreUtils::HashCombine(hash, mBuffers.size());
+		for (const FRGBufferInfo& buffer : mBuffers)
+		{
+			CoreUtils::HashCombine(hash, buffer.mSize, buffer.mBufferFlags);
 		}
 
-		// Destroy buffers
-		for (uint32 bufferId = 0; bufferId < mBuffers.size(); ++bufferId)
+		// External resources are referenced by the graph handles, so the actual textures and buffers can change between frames
+		CoreUtils::HashCombine(hash, mExternalTextures.size());
+		for (const FRGExternalTextureInfo& externalTexture : mExternalTextures)
 		{
-			const FRGResourceHandle handle(ERGResourceType::Buffer, bufferId, false);
-			auto foundIt = renderResources.mBuffers.find(handle);
-			TURBO_CHECK(foundIt != renderResources.mBuffers.end())
+			CoreUtils::HashCombine(hash, externalTexture.mInitialLayout, externalTexture.mFinalLayout);
+		}
 
-			TURBO_LOG(LogRenderGraph, Display, "Destroying buffer: {}", gpu.AccessBufferCold(foundIt->second)->mName);
-			gpu.DestroyBuffer(foundIt->second);
+		CoreUtils::HashCombine(hash, mExternalBuffers.size());
+
+		CoreUtils::HashCombine(hash, mExportedResources.size());
+		for (const FRGResourceHandle resource : mExportedResources)
+		{
+			CoreUtils::HashCombine(hash, resource);
 		}
 
-		// Transition external resources to their target layouts
-		TURBO_LOG(LogRenderGraph, Display, "Final external resources barrier.");
-		std::vector<vk::ImageMemoryBarrier2> imageBarriers;
-		imageBarriers.reserve(mExternalTexturesBarriers.size());
+		return hash;
+	}
 
-		for (const FRGTextureMemoryBarrier& rgBarrier : mExternalTexturesBarriers)
+	void FRenderGraphBuilder::Compile()
+	{
+		TRACE_ZONE_SCOPED()
+
+		const size_t graphHash = HashGraphStructure();
+		if (CVarCompileCache.Get() && mbCompiledGraphValid && graphHash == mCompiledGraphHash)
 		{
-			const THandle<FTexture> textureHandle = renderResources.mTextures.at(rgBarrier.mTexture);
-			imageBarriers.push_back(rgBarrier.ToVkImageBarrier(gpu, textureHandle));
+			TURBO_CHECK(mCompiledPasses.size() == mRenderPasses.size())
+			for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+			{
+				mRenderPasses[passId].mbCulled = mCompiledPasses[passId].mbCulled;
+				mRenderPasses[passId].mQueue = mCompiledPasses[passId].mQueue;
+			}
 
-			TURBO_LOG(
-				LogRenderGraph, Display, "[External Image Barrier] Texture: {}; ({}, {}, {}) -> ({}, {}, {})",
-				gpu.AccessTextureCold(textureHandle)->mName,
-				magic_enum::enum_name(rgBarrier.mOldLayout),
-				vk::to_string(rgBarrier.mSrcStageMask),
-				vk::to_string(rgBarrier.mSrcAccessMask),
-				magic_enum::enum_name(rgBarrier.mNewLayout),
-				vk::to_string(rgBarrier.mSrcStageMask),
-				vk::to_string(rgBarrier.mDstAccessMask)
-			);
+			++mNumCompileCacheHits;
+			TURBO_LOG(LogRenderGraph, Display, "Reusing compiled render graph. Hash: {:#x}", graphHash)
+			return;
 		}
 
-		vk::DependencyInfo dependencyInfo = {};
-		dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
-		dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+		++mNumCompileCacheMisses;
+		TURBO_LOG(LogRenderGraph, Display, "Compiling render graph. Hash: {:#x}", graphHash)
 
-		cmd.PipelineBarrier(dependencyInfo);
+		CullPasses();
+		CompileQueues();
+		CompileResourceLifetimes();
+		CompileResourceAliasing();
+		CompileTextureSynchronization();
+		CompileBufferSynchronization();
+		CompileSubmissions();
+
+		mCompiledPasses.resize(mRenderPasses.size());
+		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		{
+			mCompiledPasses[passId] = {
+				.mbCulled = mRenderPasses[passId].mbCulled,
+				.mQueue = mRenderPasses[passId].mQueue,
+			};
+		}
+
+		mCompiledGraphHash = graphHash;
+		mbCompiledGraphValid = true;
 	}
 
-	void FRenderGraphBuilder::Reset()
+   void FRenderGraphBuilder::Execute(FGPUDevice& gpu, FCommandBuffer& cmd)
 	{
-		mRenderPasses.clear();
-		mPerPassTextureBarriers.clear();
-		mExternalTexturesBarriers.clear();
+		TRACE_ZONE_SCOPED()
+		TURBO_LOG(LogRenderGraph, Display, "Executing render graph");
 
-		mTextures.clear();
-		mExternalTextures.clear();
-		mBuffers.clear();
-		mExternalBuffers.clear();
-		mQueuedBufferUploads.clear();
+		mNumBarriers = 0;
+		mNumBarrierBatches = 0;
 
-		mAllocator.Clear();
+		mPassCommandStats.assign(mRenderPasses.size(), {});
+		for (uint32 passId = 0; passId < mRenderPasses.size(); ++passId)
+		{
+			mPassCommandStats[passId].mPassName = mRenderPasses[passId].mName;
+		}
+
+		FRenderResources& renderResources = mRenderResources;
+		renderResources.mTextures.Reset(mTextures.size(), mExternalTextures.size());
+		renderResources.mBuffers.Reset(mBuffers.size(), mExternalBuffers.size());
+
+		mResourcePool.PrepareHeaps(gpu, mTransientHeaps);
+
+		// Acquire textures
+		for (uint32 textureId = 0; textureId < mTextures.size(); ++textureId)
+		{
+			if (mTextureLifetimes[textureId].IsValid() == false)
+			{
+				continue;
+			}
+
+			const FRGTextureInfo& textureInfo = mTextures[textureId];
+			const FRGResourcePlacement& placement = mTexturePlacements[textureId];
+			TURBO_LOG(LogRenderGraph, Display, "Acquiring texture: {}", textureInfo.mName);
+
+			const FRGResourceHandle handle(ERGResourceType::Texture, textureId, false);
+			const THandle<FTexture> texture =
+				placement.mbAliased
+					? mResourcePool.AcquireAliasedTexture(gpu, textureInfo, placement.mOffset)
+					: mResourcePool.AcquireTexture(gpu, textureInfo);
+			TURBO_CHECK(texture)
+
+			renderResources.mTextures[handle] = texture;
+		}
+
+		// Acquire buffers
+		for (uint32 bufferId = 0; bufferId < mBuffers.size(); ++bufferId)
+		{
+			if (mBufferLifetimes[bufferId].IsValid() == false)
+			{
+				continue;
+			}
+
+			const FRGBufferInfo& bufferInfo = mBuffers[bufferId];
+			const FRGResourcePlacement& placement = mBufferPlacements[bufferId];
+
+			const FRGResourceHandle handle(ERGResourceType::Buffer, bufferId, false);
+			const THandle<FBuffer> buffer =
+				placement.mbAliased
+					? mResourcePool.AcquireAliasedBuffer(gpu, bufferInfo, placement.mOffset)
+					: mResourcePool.AcquireBuffer(gpu, bufferInfo);
+			TURBO_CHECK(buffer)
+
+			renderResources.mBuffers[handle] = buffer;
+		}
+
+		// Register external textures
+		for (uint32 externalTextureId = 0; externalTextureId < mExternalTextures.size(); ++externalTextureId)
+		{
+			const THandle<FTexture> texture = mExternalTextures[externalTextureId].mTextureHandle;
+			TURBO_CHECK(texture)
+
+			const FRGResourceHandle handle(ERGResourceType::Texture, externalTextureId, true);
+			renderResources.mTextures[handle] = texture;
+
+			TURBO_LOG(LogRenderGraph, Display, "Registering external texture: {}", mExternalTextures[externalTextureId].mTextureInfo.mName);
+		}
+
+		// Register external buffers
+		for (uint32 externalBufferId = 0; externalBufferId < mExternalBuffers.size(); ++externalBufferId)
+		{
+			const THandle<FBuffer> buffer = mExternalBuffers[externalBufferId].mHandle;
+			TURBO_CHECK(buffer)
+
+			const FRGResourceHandle handle(ERGResourceType::Buffer, externalBufferId, true);
+			renderResources.mBuffers[handle] = buffer;
+
+			TURBO_LOG(LogRenderGraph, Display, "Registering external buffer: {}", mExternalBuffers[externalBufferId].mInfo.mName);
+		}
+
+		// Each submission continues in a new main command buffer. Secondary command buffers come from the graphics queue
+		// family pools, so async compute passes are recorded serially.
+		const bool bParallelRecording = CVarParallelRecording.Get() && gpu.GetNumRenderingThreads() > 1 && mbForceSerialRecording == false;
+		const THandle<FTexture> presentImage = gpu.GetPresentImage();
+		auto usesPresentImage = [&](const FRGPassInfo& pass)
+		{
+			auto isPresentImage = [&](FRGResourceHandle texture) { return renderResources.mTextures.at(texture) == presentImage; };
+			return std::ranges::any_of(pass.mTextureReads, isPresentImage) || std::ranges::any_of(pass.mTextureWrites, isPresentImage);
+		};
+
+		FCommandBuffer* graphicsCmd = &cmd;
+		std::vector<vk::Semaphore>& submissionSemaphores = mSubmissionSemaphores;
+		std::vector<vk::Semaphore>& waitSemaphores = mWaitSemaphores;
+		submissionSemaphores.assign(mSubmissions.size(), {});
+
+		for (uint32 submissionId = 0; submissionId < mSubmissions.size(); ++submissionId)
+		{
+			const FRGSubmission& submission = mSubmissions[submissionId];
+			const bool bAsyncCompute = submission.mQueue == ERGQueue::AsyncCompute;
+
+			FCommandBuffer& submissionCmd = bAsyncCompute ? gpu.BeginAsyncComputeCommandBuffer() : *graphicsCmd;
+			if (submissionId == 0)
+			{
+				RecordReleaseBarriers(gpu, submissionCmd, mExternalTexturesReleaseBarriers, renderResources);
+			}
+
+			if (bParallelRecording && bAsyncCompute == false && submission.mPasses.empty() == false)
+			{
+				RecordPassesParallel(gpu, submissionCmd, submission.mPasses, renderResources);
+			}
+			else
+			{
+				for (const uint32 passId : submission.mPasses)
+				{
+					RecordPass(gpu, submissionCmd, passId, renderResources);
+				}
+			}
+
+			waitSemaphores.clear();
+			for (const uint32 waitSubmission : submission.mWaitSubmissions)
+			{
+				waitSemaphores.push_back(submissionSemaphores[waitSubmission]);
+			}
+
+			// Last submission is submitted by the gpu device together with the rest of the frame
+			if (submissionId == mSubmissions.size() - 1)
+			{
+				for (const vk::Semaphore semaphore : waitSemaphores)
+				{
+					gpu.AddMainCommandBufferWait(semaphore);
+				}
+				break;
+			}
+
+			if (submission.mbSignal)
+			{
+				submissionSemaphores[submissionId] = gpu.AcquireQueueSemaphore();
+			}
+
+			if (bAsyncCompute)
+			{
+				gpu.SubmitAsyncComputeCommandBuffer(submissionCmd, waitSemaphores, submissionSemaphores[submissionId]);
+				continue;
+			}
+
+			// Swapchain image is waited for by the first graphics submission touching it. Async compute work starts after
+			// the first submission, so it waits for the image when any async compute pass uses it.
+			bool bUsesPresentImage = false;
+			for (const uint32 passId : submission.mPasses)
+			{
+				bUsesPresentImage |= usesPresentImage(mRenderPasses[passId]);
+			}
+
+			if (submissionId == 0)
+			{
+				for (const FRGPassInfo& pass : mRenderPasses)
+				{
+					bUsesPresentImage |= pass.mQueue == ERGQueue::AsyncCompute && pass.mbCulled == false && usesPresentImage(pass);
+				}
+			}
+
+			for (const vk::Semaphore semaphore : waitSemaphores)
+			{
+				gpu.AddMainCommandBufferWait(semaphore);
+			}
+			gpu.SubmitMainCommandBuffer(submissionSemaphores[submissionId], bUsesPresentImage);
+			graphicsCmd = &gpu.GetMainCommandBuffer();
+		}
+
+		// Return resources to the pool
+		// Release textures
+		for (uint32 textureId = 0; textureId < mTextures.size(); ++textureId)
+		{
+			if (mTextureLifetimes[textureId].IsValid() == false)
+			{
+				continue;
+			}
+
+			const THandle<FTexture> texture = renderResources.mTextures.at(FRGResourceHandle(ERGResourceType::Texture, textureId, false));
+			TURBO_CHECK(texture)
+
+			TURBO_LOG(LogRenderGraph, Display, "Releasing texture: {}", mTextures[textureId].mName);
+			mResourcePool.ReleaseTexture(texture);
+		}
+
+		// Release buffers
+		for (uint32 bufferId = 0; bufferId < mBuffers.size(); ++bufferId)
+		{
+			if (mBufferLifetimes[bufferId].IsValid() == false)
+			{
+				continue;
+			}
+
+			const THandle<FBuffer> buffer = renderResources.mBuffers.at(FRGResourceHandle(ERGResourceType::Buffer, bufferId, false));
+			TURBO_CHECK(buffer)
+
+			TURBO_LOG(LogRenderGraph, Display, "Releasing buffer: {}", mBuffers[bufferId].mName);
+			mResourcePool.ReleaseBuffer(buffer);
+		}
+
+		mResourcePool.Tick(gpu);
+
+		// Transition external resources to their target layouts
+		TURBO_LOG(LogRenderGraph, Display, "Final external resources barrier.");
+		std::vector<vk::ImageMemoryBarrier2>& imageBarriers = GetImageBarriersScratch();
+
+		for (const FRGTextureMemoryBarrier& rgBarrier : mExternalTexturesBarriers)
+		{
+			const THandle<FTexture> textureHandle = renderResources.mTextures.at(rgBarrier.mTexture);
+			imageBarriers.push_back(rgBarrier.ToVkImageBarrier(gpu, textureHandle));
+
+			TURBO_LOG(
+				LogRenderGraph, Display, "[External Image Barrier] Texture: {}; ({}, {}, {}) -> ({}, {}, {})",
+				gpu.AccessTextureCold(textureHandle)->mName,
+				magic_enum::enum_name(rgBarrier.mOldLayout),
+				vk::to_string(rgBarrier.mSrcStageMask),
+				vk::to_string(rgBarrier.mSrcAccessMask),
+				magic_enum::enum_name(rgBarrier.mNewLayout),
+				vk::to_string(rgBarrier.mDstStageMask),
+				vk::to_string(rgBarrier.mDstAccessMask)
+			);
+		}
+
+		RecordBarriers(*graphicsCmd, imageBarriers, {});
+
+		static const cstring kBarriers = "RG Barriers";
+		TRACE_PLOT_CONFIGURE(kBarriers, EPlotFormat::Number, true, true, 0x00FFFF)
+		TRACE_PLOT(kBarriers, static_cast<int64>(mNumBarriers.load()))
+
+		static const cstring kBarrierBatches = "RG Barrier Batches";
+		TRACE_PLOT_CONFIGURE(kBarrierBatches, EPlotFormat::Number, true, true, 0xFF00FF)
+		TRACE_PLOT(kBarrierBatches, static_cast<int64>(mNumBarrierBatches.load()))
+
+#if WITH_PROFILER
+		FCommandBufferStats totalCommandStats = {};
+		for (const FRGPassCommandStats& passStats : mPassCommandStats)
+		{
+			totalCommandStats += passStats.mStats;
+		}
+
+		static const cstring kIssuedStateCommands = "RG Issued State Commands";
+		TRACE_PLOT_CONFIGURE(kIssuedStateCommands, EPlotFormat::Number, true, true, 0x4080FF)
+		TRACE_PLOT(kIssuedStateCommands, static_cast<int64>(totalCommandStats.GetNumIssued()))
+
+		static const cstring kSkippedStateCommands = "RG Skipped State Commands";
+		TRACE_PLOT_CONFIGURE(kSkippedStateCommands, EPlotFormat::Number, true, true, 0x40C040)
+		TRACE_PLOT(kSkippedStateCommands, static_cast<int64>(totalCommandStats.GetNumSkipped()))
+#endif // WITH_PROFILER
+	}
+
+	void FRenderGraphBuilder::RecordPassBarriers(FGPUDevice& gpu, FCommandBuffer& cmd, uint32 passId, const FRenderResources& renderResources)
+	{
+		// Barriers which don't change layout are merged into a single global memory barrier
+		vk::MemoryBarrier2 memoryBarrier = {};
+
+		const FRGPassTextureBarriers& passImageBarriers = mPerPassTextureBarriers[passId];
+		std::vector<vk::ImageMemoryBarrier2>& imageBarriers = GetImageBarriersScratch();
+
+		for (const FRGTextureMemoryBarrier& rgBarrier : passImageBarriers)
+		{
+			THandle<FTexture> textureHandle = renderResources.mTextures.at(rgBarrier.mTexture);
+			TURBO_LOG(
+				LogRenderGraph, Display, "[Image Barrier] Texture: {}; ({}, {}, {}) -> ({}, {}, {})",
+				gpu.AccessTextureCold(textureHandle)->mName,
+				magic_enum::enum_name(rgBarrier.mOldLayout),
+				vk::to_string(rgBarrier.mSrcStageMask),
+				vk::to_string(rgBarrier.mSrcAccessMask),
+				magic_enum::enum_name(rgBarrier.mNewLayout),
+				vk::to_string(rgBarrier.mDstStageMask),
+				vk::to_string(rgBarrier.mDstAccessMask)
+			);
+
+			if (rgBarrier.mOldLayout == rgBarrier.mNewLayout && rgBarrier.mSrcQueue == rgBarrier.mDstQueue)
+			{
+				MergeMemoryBarrier(memoryBarrier, rgBarrier.mSrcStageMask, rgBarrier.mSrcAccessMask, rgBarrier.mDstStageMask, rgBarrier.mDstAccessMask);
+				continue;
+			}
+
+			imageBarriers.push_back(rgBarrier.ToVkImageBarrier(gpu, textureHandle));
+		}
+
+		// Buffers are shared by the queue families, so buffer barriers don't need to know the buffer
+		for (const FRGBufferMemoryBarrier& rgBarrier : mPerPassBufferBarriers[passId])
+		{
+			MergeMemoryBarrier(memoryBarrier, rgBarrier.mSrcStageMask, rgBarrier.mSrcAccessMask, rgBarrier.mDstStageMask, rgBarrier.mDstAccessMask);
+
+			TURBO_LOG(
+				LogRenderGraph, Display, "[Buffer Barrier] Buffer: {}; ({}, {}) -> ({}, {})",
+				gpu.AccessBufferCold(renderResources.mBuffers.at(rgBarrier.mBuffer))->mName,
+				vk::to_string(rgBarrier.mSrcStageMask),
+				vk::to_string(rgBarrier.mSrcAccessMask),
+				vk::to_string(rgBarrier.mDstStageMask),
+				vk::to_string(rgBarrier.mDstAccessMask)
+			);
+		}
+
+		RecordBarriers(cmd, imageBarriers, memoryBarrier);
+	}
+
+	FRenderingAttachments FRenderGraphBuilder::MakeRenderingAttachments(FGPUDevice& gpu, const FRGPassInfo& pass, const FRenderResources& renderResources) const
+	{
+		FRenderingAttachments renderingAttachments;
+
+		// Bind color attachments
+		for (uint32 attachmentId = 0; attachmentId < kMaxColorAttachments; ++attachmentId)
+		{
+			if (pass.mColorAttachments[attachmentId].IsValid())
+			{
+				const FRGAttachment attachment = pass.mColorAttachments[attachmentId];
+
+				FAttachment attachmentInfo = {
+					.mTexture = renderResources.mTextures.at(attachment.mTexture),
+					.mLoadOp = attachment.mLoadOp,
+					.mStoreOp = attachment.mStoreOp,
+					.mClearColor = attachment.mClearColor,
+				};
+
+				if (attachment.mResolveTexture.IsValid())
+				{
+					attachmentInfo.mResolveTexture = renderResources.mTextures.at(attachment.mResolveTexture),
+					attachmentInfo.mResolveMode = attachment.mResolveMode;
+				}
+
+				renderingAttachments.AddColorAttachment(attachmentInfo);
+
+				TURBO_LOG(
+					LogRenderGraph, Display, "[GraphicsPass] Bind {} as color attachment {}",
+					gpu.AccessTextureCold(renderResources.mTextures.at(attachment.mTexture))->mName,
+					attachmentId
+				);
+			}
+		}
+
+		// Bind depth stencil attachment (if valid)
+		if (pass.mDepthStencilAttachment.IsValid())
+		{
+			const FRGAttachment& attachment = pass.mDepthStencilAttachment;
+
+			FAttachment attachmentInfo = {
+				.mTexture = renderResources.mTextures.at(attachment.mTexture),
+				.mLoadOp = attachment.mLoadOp,
+				.mStoreOp = attachment.mStoreOp,
+				.mClearColor = attachment.mClearColor,
+			};
+
+			if (attachment.mResolveTexture.IsValid())
+			{
+				attachmentInfo.mResolveTexture = renderResources.mTextures.at(attachment.mResolveTexture),
+				attachmentInfo.mResolveMode = attachment.mResolveMode;
+			}
+
+			renderingAttachments.SetDepthAttachment(attachmentInfo);
+
+			TURBO_LOG(
+				LogRenderGraph, Display, "[GraphicsPass] Bind {} as depth attachment",
+				gpu.AccessTextureCold(renderResources.mTextures.at(pass.mDepthStencilAttachment.mTexture))->mName
+			);
+		}
+
+		return renderingAttachments;
+	}
+
+	const FRGTextureInfo& FRenderGraphBuilder::GetRenderTargetInfo(const FRGPassInfo& pass) const
+	{
+		const FRGResourceHandle mainTextureHandle =
+			pass.mColorAttachments[0].IsValid()
+				? pass.mColorAttachments[0].mTexture
+				: pass.mDepthStencilAttachment.mTexture;
+
+		TURBO_CHECK(mainTextureHandle.IsValid())
+
+		return mainTextureHandle.IsExternal()
+			? mExternalTextures[mainTextureHandle.GetIndex()].mTextureInfo
+			: mTextures[mainTextureHandle.GetIndex()];
+	}
+
+	void FRenderGraphBuilder::SetViewportAndScissor(FCommandBuffer& cmd, const FRGPassInfo& pass) const
+	{
+		const FRGTextureInfo& textureInfo = GetRenderTargetInfo(pass);
+		const glm::ivec2 outputSize = glm::ivec2(textureInfo.mWidth, textureInfo.mHeight);
+
+		cmd.SetViewport(FViewport::FromSize(outputSize));
+		cmd.SetScissor(FRect2DInt::FromSize(outputSize));
+
+		TURBO_LOG(LogRenderGraph, Display, "[GraphicsPass] Viewport: {} Scissors: {}", outputSize, outputSize);
+	}
+
+	void FRenderGraphBuilder::RecordPass(FGPUDevice& gpu, FCommandBuffer& cmd, uint32 passId, FRenderResources& renderResources)
+	{
+		const FRGPassInfo& pass = mRenderPasses[passId];
+		DEBUG_LABEL_REGION(cmd, pass.mName);
+
+		TURBO_LOG(LogRenderGraph, Display, "Begin render pass: {}", pass.mName);
+
+		const FCommandBufferStats commandStatsBegin = cmd.GetStats();
+
+		RecordPassBarriers(gpu, cmd, passId, renderResources);
+
+		FGPUProfiler& profiler = gpu.GetGPUProfiler();
+		const uint32 profilerScope = profiler.BeginScope(cmd, GetPassQueueType(pass), pass.mName);
+
+		if (pass.mPassType == EPassType::Graphics)
+		{
+			cmd.BeginRendering(MakeRenderingAttachments(gpu, pass, renderResources));
+			SetViewportAndScissor(cmd, pass);
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Execute: {}", pass.mName);
+		if (pass.mExecutePassRange.IsBound())
+		{
+			pass.mExecutePassRange.Execute(gpu, cmd, renderResources, 0, pass.mNumWorkItems);
+		}
+		else
+		{
+			pass.mExecutePass.Execute(gpu, cmd, renderResources);
+		}
+
+		if (pass.mPassType == EPassType::Graphics)
+		{
+			TURBO_LOG(LogRenderGraph, Display, "[GraphicsPass] End rendering.");
+			cmd.EndRendering();
+		}
+
+		profiler.EndScope(cmd, profilerScope);
+
+		mPassCommandStats[passId].mStats += cmd.GetStats() - commandStatsBegin;
+
+		RecordReleaseBarriers(gpu, cmd, mPerPassTextureReleaseBarriers[passId], renderResources);
+	}
+
+	void FRenderGraphBuilder::RecordReleaseBarriers(FGPUDevice& gpu, FCommandBuffer& cmd, std::span<const FRGTextureMemoryBarrier> releaseBarriers, const FRenderResources& renderResources)
+	{
+		if (releaseBarriers.empty())
+		{
+			return;
+		}
+
+		std::vector<vk::ImageMemoryBarrier2>& imageBarriers = GetImageBarriersScratch();
+
+		for (const FRGTextureMemoryBarrier& rgBarrier : releaseBarriers)
+		{
+			const THandle<FTexture> textureHandle = renderResources.mTextures.at(rgBarrier.mTexture);
+			imageBarriers.push_back(rgBarrier.ToVkImageBarrier(gpu, textureHandle));
+
+			TURBO_LOG(LogRenderGraph, Display, "[Release Image Barrier] Texture: {}; {}", gpu.AccessTextureCold(textureHandle)->mName, rgBarrier.ToString())
+		}
+
+		RecordBarriers(cmd, imageBarriers, {});
+	}
+
+	void FRenderGraphBuilder::RecordPassesParallel(FGPUDevice& gpu, FCommandBuffer& cmd, std::span<const uint32> passIds, FRenderResources& renderResources)
+	{
+		TRACE_ZONE_SCOPED()
+
+		static constexpr uint32 kNotSplit = std::numeric_limits<uint32>::max();
+
+		const uint32 numThreads = gpu.GetNumRenderingThreads();
+		const uint32 minWorkItemsPerTask = glm::max(CVarParallelMinWorkItems.Get(), 1);
+
+		// Secondary command buffers are executed by the primary one in the order of steps
+		struct FRecordingStep
+		{
+			/** Pass split into work items. Its barriers and rendering scope are recorded in the primary command buffer. */
+			uint32 mSplitPass = kNotSplit;
+			FRenderingAttachments mRenderingAttachments = {};
+
+			uint32 mFirstTask = 0;
+			uint32 mNumTasks = 0;
+		};
+
+		// Part of the graph recorded by a single task into its own secondary command buffer
+		struct FRecordingTask
+		{
+			uint32 mStep = 0;
+			/** Range of passOrder */
+			uint32 mFirstPass = 0;
+			uint32 mNumPasses = 0;
+			/** Range of work items, when the step is a split pass */
+			uint32 mFirstWorkItem = 0;
+			uint32 mNumWorkItems = 0;
+
+			FCommandBuffer* mCommandBuffer = nullptr;
+			/** Commands recorded by a split pass task */
+			FCommandBufferStats mCommandStats = {};
+		};
+
+		// Recording data lives in the frame arena. Task threads only read it.
+		TArenaArray<uint32> passOrder = AllocateArray<uint32>();
+		passOrder.reserve(passIds.size());
+
+		TArenaArray<FRecordingStep> steps = AllocateArray<FRecordingStep>();
+		TArenaArray<FRecordingTask> tasks = AllocateArray<FRecordingTask>();
+
+		// Passes recorded one after another are split into one chunk per thread
+		uint32 runBegin = 0;
+		auto flushRun = [&]()
+		{
+			const uint32 runLength = passOrder.size() - runBegin;
+			if (runLength == 0)
+			{
+				return;
+			}
+
+			const uint32 numChunks = glm::min(numThreads, runLength);
+			steps.push_back({
+				.mFirstTask = static_cast<uint32>(tasks.size()),
+				.mNumTasks = numChunks
+			});
+
+			for (uint32 chunkId = 0; chunkId < numChunks; ++chunkId)
+			{
+				const uint32 chunkBegin = runBegin + runLength * chunkId / numChunks;
+				const uint32 chunkEnd = runBegin + runLength * (chunkId + 1) / numChunks;
+				tasks.push_back({
+					.mStep = static_cast<uint32>(steps.size() - 1),
+					.mFirstPass = chunkBegin,
+					.mNumPasses = chunkEnd - chunkBegin
+				});
+			}
+
+			runBegin = passOrder.size();
+		};
+
+		for (const uint32 passId : passIds)
+		{
+			const FRGPassInfo& pass = mRenderPasses[passId];
+			const bool bSplit = pass.mExecutePassRange.IsBound() && pass.mNumWorkItems >= 2 * minWorkItemsPerTask;
+			if (bSplit == false)
+			{
+				passOrder.push_back(passId);
+				continue;
+			}
+
+			flushRun();
+
+			const uint32 numTasks = glm::min(numThreads, pass.mNumWorkItems / minWorkItemsPerTask);
+			FRecordingStep& step = steps.emplace_back();
+			step.mSplitPass = passId;
+			step.mFirstTask = tasks.size();
+			step.mNumTasks = numTasks;
+			if (pass.mPassType == EPassType::Graphics)
+			{
+				step.mRenderingAttachments = MakeRenderingAttachments(gpu, pass, renderResources);
+			}
+
+			for (uint32 taskId = 0; taskId < numTasks; ++taskId)
+			{
+				const uint32 workBegin = pass.mNumWorkItems * taskId / numTasks;
+				const uint32 workEnd = pass.mNumWorkItems * (taskId + 1) / numTasks;
+				tasks.push_back({
+					.mStep = static_cast<uint32>(steps.size() - 1),
+					.mFirstWorkItem = workBegin,
+					.mNumWorkItems = workEnd - workBegin
+				});
+			}
+		}
+		flushRun();
+
+		auto recordTask = [&](FRecordingTask& task)
+		{
+			const FRecordingStep& step = steps[task.mStep];
+			if (step.mSplitPass == kNotSplit)
+			{
+				FCommandBuffer& secondaryCmd = gpu.BeginSecondaryCommandBuffer();
+				for (uint32 orderId = task.mFirstPass; orderId < task.mFirstPass + task.mNumPasses; ++orderId)
+				{
+					RecordPass(gpu, secondaryCmd, passOrder[orderId], renderResources);
+				}
+				gpu.EndSecondaryCommandBuffer(secondaryCmd);
+
+				task.mCommandBuffer = &secondaryCmd;
+				return;
+			}
+
+			const FRGPassInfo& pass = mRenderPasses[step.mSplitPass];
+			const bool bGraphics = pass.mPassType == EPassType::Graphics;
+
+			FCommandBuffer& secondaryCmd =
+				bGraphics
+					? gpu.BeginSecondaryCommandBuffer(&step.mRenderingAttachments, GetRenderTargetInfo(pass).mNumSamples)
+					: gpu.BeginSecondaryCommandBuffer();
+
+			// Dynamic state is not inherited from the primary command buffer
+			if (bGraphics)
+			{
+				SetViewportAndScissor(secondaryCmd, pass);
+			}
+
+			pass.mExecutePassRange.Execute(gpu, secondaryCmd, renderResources, task.mFirstWorkItem, task.mFirstWorkItem + task.mNumWorkItems);
+			gpu.EndSecondaryCommandBuffer(secondaryCmd);
+
+			// Tasks of a split pass record the same pass, their stats are summed after recording
+			task.mCommandStats = secondaryCmd.GetStats();
+
+			task.mCommandBuffer = &secondaryCmd;
+		};
+
+		enki::TaskSet recordingTaskSet(
+			tasks.size(),
+			[&](enki::TaskSetPartition range, uint32 threadNum)
+			{
+				TRACE_ZONE_SCOPED_N("Record Render Graph")
+				for (uint32 taskId = range.start; taskId < range.end; ++taskId)
+				{
+					recordTask(tasks[taskId]);
+				}
+			});
+
+		enki::TaskScheduler& taskScheduler = entt::locator<enki::TaskScheduler>::value();
+		taskScheduler.AddTaskSetToPipe(&recordingTaskSet);
+		// Pipeline compiles are low priority, picking one up here would stall the frame
+		taskScheduler.WaitforTask(&recordingTaskSet, enki::TASK_PRIORITY_HIGH);
+
+		// Stitch secondary command buffers into the primary one
+		std::array<FCommandBuffer*, kMaxRenderingThreads> stepCommandBuffers;
+		for (const FRecordingStep& step : steps)
+		{
+			TURBO_CHECK(step.mNumTasks <= stepCommandBuffers.size())
+			for (uint32 taskId = 0; taskId < step.mNumTasks; ++taskId)
+			{
+				stepCommandBuffers[taskId] = tasks[step.mFirstTask + taskId].mCommandBuffer;
+			}
+
+			const std::span<FCommandBuffer* const> commandBuffers(stepCommandBuffers.data(), step.mNumTasks);
+			if (step.mSplitPass == kNotSplit)
+			{
+				cmd.ExecuteCommands(commandBuffers);
+				continue;
+			}
+
+			const FRGPassInfo& pass = mRenderPasses[step.mSplitPass];
+			DEBUG_LABEL_REGION(cmd, pass.mName);
+
+			for (uint32 taskId = 0; taskId < step.mNumTasks; ++taskId)
+			{
+				mPassCommandStats[step.mSplitPass].mStats += tasks[step.mFirstTask + taskId].mCommandStats;
+			}
+
+			RecordPassBarriers(gpu, cmd, step.mSplitPass, renderResources);
+
+			// Split pass is measured as a whole, its secondary command buffers inherit the pipeline statistics query
+			FGPUProfiler& profiler = gpu.GetGPUProfiler();
+			const uint32 profilerScope = profiler.BeginScope(cmd, GetPassQueueType(pass), pass.mName);
+
+			if (pass.mPassType == EPassType::Graphics)
+			{
+				cmd.BeginRendering(step.mRenderingAttachments, true);
+				cmd.ExecuteCommands(commandBuffers);
+				cmd.EndRendering();
+			}
+			else
+			{
+				cmd.ExecuteCommands(commandBuffers);
+			}
+
+			profiler.EndScope(cmd, profilerScope);
+
+			RecordReleaseBarriers(gpu, cmd, mPerPassTextureReleaseBarriers[step.mSplitPass], renderResources);
+		}
+	}
+
+	void FRenderGraphBuilder::RecordBarriers(FCommandBuffer& cmd, std::span<const vk::ImageMemoryBarrier2> imageBarriers, const vk::MemoryBarrier2& memoryBarrier)
+	{
+		const bool bHasMemoryBarrier = memoryBarrier.srcStageMask != vk::PipelineStageFlagBits2::eNone;
+		if (imageBarriers.empty() && bHasMemoryBarrier == false)
+		{
+			return;
+		}
+
+		vk::DependencyInfo dependencyInfo = {};
+		dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
+		dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+		dependencyInfo.memoryBarrierCount = bHasMemoryBarrier ? 1 : 0;
+		dependencyInfo.pMemoryBarriers = &memoryBarrier;
+
+		cmd.PipelineBarrier(dependencyInfo);
+
+		mNumBarriers += dependencyInfo.imageMemoryBarrierCount + dependencyInfo.memoryBarrierCount;
+		++mNumBarrierBatches;
+	}
+
+	void FRenderGraphBuilder::Reset(FGPUDevice& gpu)
+	{
+		// Compilation results are kept, the next graph will likely have the same structure
+		mRenderPasses.clear();
+
+		mTextures.clear();
+		mExternalTextures.clear();
+		mBuffers.clear();
+		mExternalBuffers.clear();
+		mExportedResources.clear();
+		mbForceSerialRecording = false;
+
+		mAllocator.Clear();
+		mUploadRing.BeginFrame(gpu, gpu.GetBufferedFrameId());
+	}
+
+	void FRenderGraphBuilder::ReleaseResources(FGPUDevice& gpu)
+	{
+		mResourcePool.Flush(gpu);
+		mUploadRing.Destroy(gpu);
+		mbCompiledGraphValid = false;
 	}
 
 	vk::Format FRenderGraphBuilder::GetTextureFormat(FRGResourceHandle resourceHandle) const
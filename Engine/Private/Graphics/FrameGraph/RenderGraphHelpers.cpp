@@ -26,6 +26,11 @@ namespace Turbo
 		return VkInit::ImageSubresourceRange(aspectFlags);
 	}
 
+	uint32 FindQueueFamily(const FGPUDevice& gpu, ERGQueue queue)
+	{
+		return queue == ERGQueue::AsyncCompute ? gpu.GetComputeQueueFamily() : gpu.GetGraphicsQueueFamily();
+	}
+
 	bool FRGTextureInfo::IsValid() const
 	{
 		return mWidth * mHeight > 1
@@ -66,8 +71,8 @@ namespace Turbo
 		vkBarrier.dstAccessMask = mDstAccessMask;
 		vkBarrier.oldLayout = ToVkImageLayout(mOldLayout);
 		vkBarrier.newLayout = ToVkImageLayout(mNewLayout);
-		vkBarrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
-		vkBarrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+		vkBarrier.srcQueueFamilyIndex = mSrcQueue != mDstQueue ? FindQueueFamily(gpu, mSrcQueue) : vk::QueueFamilyIgnored;
+		vkBarrier.dstQueueFamilyIndex = mSrcQueue != mDstQueue ? FindQueueFamily(gpu, mDstQueue) : vk::QueueFamilyIgnored;
 
 		const FTexture* texture = gpu.AccessTexture(textureHandle);
 		const FTextureCold* textureCold = gpu.AccessTextureCold(textureHandle);
@@ -82,13 +87,15 @@ namespace Turbo
 	std::string FRGTextureMemoryBarrier::ToString() const
 	{
 		return fmt::format(
-			"({}, {}, {}) -> ({}, {}, {})",
+			"({}, {}, {}, {}) -> ({}, {}, {}, {})",
 			magic_enum::enum_name(mOldLayout),
 			vk::to_string(mSrcAccessMask),
 			vk::to_string(mSrcStageMask),
+			magic_enum::enum_name(mSrcQueue),
 			magic_enum::enum_name(mNewLayout),
 			vk::to_string(mDstAccessMask),
-			vk::to_string(mDstStageMask)
+			vk::to_string(mDstStageMask),
+			magic_enum::enum_name(mDstQueue)
 		);
 	}
 }
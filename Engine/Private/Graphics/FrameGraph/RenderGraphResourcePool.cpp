@@ -0,0 +1,471 @@
+#include "Graphics/FrameGraph/RenderGraphResourcePool.h"
+
+#include "Debug/IConsoleManager.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/FrameGraph/RenderGraph.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/Resources.h"
+#include "vulkan/vulkan_format_traits.hpp"
+
+namespace Turbo
+{
+	static TAutoConsoleVariable<int32> CVarPoolMaxUnusedFrames(
+		"rg.pool.maxUnusedFrames",
+		8,
+		"Number of frames a render graph transient resource can stay unused before it is destroyed."
+	);
+
+	static TAutoConsoleVariable<int32> CVarPoolBudgetMiB(
+		"rg.pool.budgetMiB",
+		1024,
+		"Memory budget of unused render graph transient resources (in MiB)."
+	);
+
+	static FAutoConsoleCommand gRGPoolStatsCommand(
+		"rg.pool.stats",
+		"Prints render graph transient resource pool stats.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRGResourcePool& pool = entt::locator<FRenderGraphBuilder>::value().GetResourcePool();
+			consoleManager.Printf(
+				"Pooled textures: {}, pooled buffers: {}, estimated memory: {} MiB",
+				pool.GetNumPooledTextures(),
+				pool.GetNumPooledBuffers(),
+				pool.GetPooledMemorySize() / Constants::kMebi
+			);
+		}));
+
+	static FDeviceSize EstimateTextureSize(const FRGTextureInfo& textureInfo)
+	{
+		return static_cast<FDeviceSize>(textureInfo.mWidth)
+			* textureInfo.mHeight
+			* vk::blockSize(textureInfo.mFormat)
+			* static_cast<uint32>(textureInfo.mNumSamples);
+	}
+
+	static bool IsCompatible(const FRGTextureInfo& lhs, const FRGTextureInfo& rhs)
+	{
+		return lhs.mWidth == rhs.mWidth
+			&& lhs.mHeight == rhs.mHeight
+			&& lhs.mFormat == rhs.mFormat
+			&& lhs.mFlags == rhs.mFlags
+			&& lhs.mNumSamples == rhs.mNumSamples;
+	}
+
+	static bool IsCompatible(const FRGBufferInfo& lhs, const FRGBufferInfo& rhs)
+	{
+		return lhs.mSize == rhs.mSize
+			&& lhs.mBufferFlags == rhs.mBufferFlags;
+	}
+
+	THandle<FTexture> FRGResourcePool::AcquireTexture(FGPUDevice& gpu, const FRGTextureInfo& textureInfo)
+	{
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+
+		for (FPooledTexture& pooledTexture : mTextures)
+		{
+			if (pooledTexture.mbInUse == false && pooledTexture.mHeapOffset == kNotAliased && IsCompatible(pooledTexture.mInfo, textureInfo))
+			{
+				pooledTexture.mbInUse = true;
+				pooledTexture.mLastUsedFrame = currentFrame;
+				return pooledTexture.mHandle;
+			}
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Allocating pooled texture: {}", textureInfo.mName);
+
+		const FTextureBuilder builder = {
+			.mWidth = textureInfo.mWidth,
+			.mHeight = textureInfo.mHeight,
+			.mFlags = textureInfo.mFlags,
+			.mFormat = textureInfo.mFormat,
+			.mType = ETextureType::Texture2D,
+			.mNumSamples = textureInfo.mNumSamples,
+			.mName = textureInfo.mName,
+			.mMemoryCategory = EGPUMemoryCategory::TransientRenderTarget
+		};
+
+		const THandle<FTexture> texture = gpu.CreateTexture(builder);
+		TURBO_CHECK(texture)
+
+		FPooledTexture& newEntry = mTextures.emplace_back();
+		newEntry.mInfo = textureInfo;
+		newEntry.mHandle = texture;
+		newEntry.mSize = EstimateTextureSize(textureInfo);
+		newEntry.mLastUsedFrame = currentFrame;
+		newEntry.mbInUse = true;
+
+		mPooledMemorySize += newEntry.mSize;
+		++mNumAllocationsThisFrame;
+
+		return texture;
+	}
+
+	THandle<FBuffer> FRGResourcePool::AcquireBuffer(FGPUDevice& gpu, const FRGBufferInfo& bufferInfo)
+	{
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+		const bool bHostVisible = (bufferInfo.mBufferFlags & EBufferFlags::CreateMapped) != EBufferFlags::None;
+
+		for (FPooledBuffer& pooledBuffer : mBuffers)
+		{
+			if (pooledBuffer.mbInUse || pooledBuffer.mHeapOffset != kNotAliased || IsCompatible(pooledBuffer.mInfo, bufferInfo) == false)
+			{
+				continue;
+			}
+
+			// Mapped buffers are written by the CPU before the frame is submitted, so they can be reused only
+			// after every frame in flight that could read them has finished.
+			if (bHostVisible && currentFrame - pooledBuffer.mLastUsedFrame < gpu.GetNumBufferedFrames())
+			{
+				continue;
+			}
+
+			pooledBuffer.mbInUse = true;
+			pooledBuffer.mLastUsedFrame = currentFrame;
+			return pooledBuffer.mHandle;
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Allocating pooled buffer: {}", bufferInfo.mName);
+
+		const FBufferBuilder builder = {
+			.mBufferFlags = bufferInfo.mBufferFlags,
+			.mSize = bufferInfo.mSize,
+			.mName = bufferInfo.mName,
+			.mMemoryCategory = EGPUMemoryCategory::TransientRenderTarget
+		};
+
+		const THandle<FBuffer> buffer = gpu.CreateBuffer(builder);
+		TURBO_CHECK(buffer)
+
+		FPooledBuffer& newEntry = mBuffers.emplace_back();
+		newEntry.mInfo = bufferInfo;
+		newEntry.mHandle = buffer;
+		newEntry.mLastUsedFrame = currentFrame;
+		newEntry.mbInUse = true;
+
+		mPooledMemorySize += bufferInfo.mSize;
+		++mNumAllocationsThisFrame;
+
+		return buffer;
+	}
+
+	void FRGResourcePool::PrepareHeaps(FGPUDevice& gpu, const std::array<FRGTransientHeapInfo, static_cast<size_t>(ERGTransientHeap::Num)>& heapInfos)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+
+		for (uint32 heapId = 0; heapId < mHeaps.size(); ++heapId)
+		{
+			const FRGTransientHeapInfo& requiredInfo = heapInfos[heapId];
+			if (requiredInfo.mSize == 0)
+			{
+				continue;
+			}
+
+			FTransientHeap& heap = mHeaps[heapId];
+			const ERGTransientHeap heapType = static_cast<ERGTransientHeap>(heapId);
+
+			// Reallocate when the heap is too small, wastes more than a half of its memory or is incompatible.
+			if (heap.mMemory
+				&& (heap.mInfo.mSize < requiredInfo.mSize
+					|| heap.mInfo.mSize / 2 > requiredInfo.mSize
+					|| heap.mInfo.mAlignment % requiredInfo.mAlignment != 0
+					|| heap.mInfo.mMemoryTypeBits != requiredInfo.mMemoryTypeBits))
+			{
+				DestroyHeap(gpu, heapType);
+			}
+
+			if (heap.mMemory == nullptr)
+			{
+				TURBO_LOG(LogRenderGraph, Display, "Allocating transient heap {}: {} bytes", magic_enum::enum_name(heapType), requiredInfo.mSize);
+
+				vk::MemoryRequirements requirements = {};
+				requirements.size = requiredInfo.mSize;
+				requirements.alignment = requiredInfo.mAlignment;
+				requirements.memoryTypeBits = requiredInfo.mMemoryTypeBits;
+
+				heap.mMemory = gpu.AllocateMemory(
+					requirements,
+					FName(heapType == ERGTransientHeap::Textures ? "RGTransientTextures" : "RGTransientBuffers"),
+					EGPUMemoryCategory::TransientRenderTarget);
+				heap.mInfo = requiredInfo;
+
+				mPooledMemorySize += requiredInfo.mSize;
+				++mNumAllocationsThisFrame;
+			}
+
+			heap.mLastUsedFrame = currentFrame;
+		}
+	}
+
+	THandle<FTexture> FRGResourcePool::AcquireAliasedTexture(FGPUDevice& gpu, const FRGTextureInfo& textureInfo, FDeviceSize heapOffset)
+	{
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+		const FTransientHeap& heap = mHeaps[static_cast<uint32>(ERGTransientHeap::Textures)];
+		TURBO_CHECK(heap.mMemory)
+
+		for (FPooledTexture& pooledTexture : mTextures)
+		{
+			if (pooledTexture.mbInUse == false && pooledTexture.mHeapOffset == heapOffset && IsCompatible(pooledTexture.mInfo, textureInfo))
+			{
+				pooledTexture.mbInUse = true;
+				pooledTexture.mLastUsedFrame = currentFrame;
+				return pooledTexture.mHandle;
+			}
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Placing aliased texture: {} at {}", textureInfo.mName, heapOffset);
+
+		FTextureBuilder builder = {
+			.mWidth = textureInfo.mWidth,
+			.mHeight = textureInfo.mHeight,
+			.mFlags = textureInfo.mFlags,
+			.mFormat = textureInfo.mFormat,
+			.mType = ETextureType::Texture2D,
+			.mNumSamples = textureInfo.mNumSamples,
+			.mName = textureInfo.mName,
+			.mMemoryCategory = EGPUMemoryCategory::TransientRenderTarget
+		};
+		builder.SetAliasedMemory(heap.mMemory, heapOffset);
+
+		const THandle<FTexture> texture = gpu.CreateTexture(builder);
+		TURBO_CHECK(texture)
+
+		FPooledTexture& newEntry = mTextures.emplace_back();
+		newEntry.mInfo = textureInfo;
+		newEntry.mHandle = texture;
+		newEntry.mHeapOffset = heapOffset;
+		newEntry.mLastUsedFrame = currentFrame;
+		newEntry.mbInUse = true;
+
+		return texture;
+	}
+
+	THandle<FBuffer> FRGResourcePool::AcquireAliasedBuffer(FGPUDevice& gpu, const FRGBufferInfo& bufferInfo, FDeviceSize heapOffset)
+	{
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+		const FTransientHeap& heap = mHeaps[static_cast<uint32>(ERGTransientHeap::Buffers)];
+		TURBO_CHECK(heap.mMemory)
+
+		for (FPooledBuffer& pooledBuffer : mBuffers)
+		{
+			if (pooledBuffer.mbInUse == false && pooledBuffer.mHeapOffset == heapOffset && IsCompatible(pooledBuffer.mInfo, bufferInfo))
+			{
+				pooledBuffer.mbInUse = true;
+				pooledBuffer.mLastUsedFrame = currentFrame;
+				return pooledBuffer.mHandle;
+			}
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Placing aliased buffer: {} at {}", bufferInfo.mName, heapOffset);
+
+		FBufferBuilder builder = {
+			.mBufferFlags = bufferInfo.mBufferFlags,
+			.mSize = bufferInfo.mSize,
+			.mName = bufferInfo.mName,
+			.mMemoryCategory = EGPUMemoryCategory::TransientRenderTarget
+		};
+		builder.SetAliasedMemory(heap.mMemory, heapOffset);
+
+		const THandle<FBuffer> buffer = gpu.CreateBuffer(builder);
+		TURBO_CHECK(buffer)
+
+		FPooledBuffer& newEntry = mBuffers.emplace_back();
+		newEntry.mInfo = bufferInfo;
+		newEntry.mHandle = buffer;
+		newEntry.mHeapOffset = heapOffset;
+		newEntry.mLastUsedFrame = currentFrame;
+		newEntry.mbInUse = true;
+
+		return buffer;
+	}
+
+	void FRGResourcePool::ReleaseTexture(THandle<FTexture> texture)
+	{
+		const auto foundIt = std::ranges::find(mTextures, texture, &FPooledTexture::mHandle);
+		TURBO_CHECK(foundIt != mTextures.end() && foundIt->mbInUse)
+
+		foundIt->mbInUse = false;
+	}
+
+	void FRGResourcePool::ReleaseBuffer(THandle<FBuffer> buffer)
+	{
+		const auto foundIt = std::ranges::find(mBuffers, buffer, &FPooledBuffer::mHandle);
+		TURBO_CHECK(foundIt != mBuffers.end() && foundIt->mbInUse)
+
+		foundIt->mbInUse = false;
+	}
+
+	void FRGResourcePool::Tick(FGPUDevice& gpu)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const uint32 currentFrame = gpu.GetNumRenderedFrames();
+		const uint32 maxUnusedFrames = glm::max(CVarPoolMaxUnusedFrames.Get(), 1);
+		const FDeviceSize budget = static_cast<FDeviceSize>(glm::max(CVarPoolBudgetMiB.Get(), 0)) * Constants::kMebi;
+
+		// Remove stale entries
+		std::erase_if(mTextures, [&](const FPooledTexture& pooledTexture)
+		{
+			if (pooledTexture.mbInUse || currentFrame - pooledTexture.mLastUsedFrame < maxUnusedFrames)
+			{
+				return false;
+			}
+
+			TURBO_LOG(LogRenderGraph, Display, "Releasing pooled texture: {}", pooledTexture.mInfo.mName);
+			gpu.DestroyTexture(pooledTexture.mHandle);
+			mPooledMemorySize -= pooledTexture.mSize;
+			return true;
+		});
+
+		std::erase_if(mBuffers, [&](const FPooledBuffer& pooledBuffer)
+		{
+			if (pooledBuffer.mbInUse || currentFrame - pooledBuffer.mLastUsedFrame < maxUnusedFrames)
+			{
+				return false;
+			}
+
+			TURBO_LOG(LogRenderGraph, Display, "Releasing pooled buffer: {}", pooledBuffer.mInfo.mName);
+			gpu.DestroyBuffer(pooledBuffer.mHandle);
+			mPooledMemorySize -= pooledBuffer.mHeapOffset == kNotAliased ? pooledBuffer.mInfo.mSize : 0;
+			return true;
+		});
+
+		for (uint32 heapId = 0; heapId < mHeaps.size(); ++heapId)
+		{
+			if (mHeaps[heapId].mMemory && currentFrame - mHeaps[heapId].mLastUsedFrame >= maxUnusedFrames)
+			{
+				DestroyHeap(gpu, static_cast<ERGTransientHeap>(heapId));
+			}
+		}
+
+		// Trim to budget. Resources used in this frame are never released here, so the budget is a soft limit.
+		while (mPooledMemorySize > budget)
+		{
+			auto oldestTexture = mTextures.end();
+			for (auto it = mTextures.begin(); it != mTextures.end(); ++it)
+			{
+				if (it->mLastUsedFrame != currentFrame && it->mHeapOffset == kNotAliased
+					&& (oldestTexture == mTextures.end() || it->mLastUsedFrame < oldestTexture->mLastUsedFrame))
+				{
+					oldestTexture = it;
+				}
+			}
+
+			auto oldestBuffer = mBuffers.end();
+			for (auto it = mBuffers.begin(); it != mBuffers.end(); ++it)
+			{
+				if (it->mLastUsedFrame != currentFrame && it->mHeapOffset == kNotAliased
+					&& (oldestBuffer == mBuffers.end() || it->mLastUsedFrame < oldestBuffer->mLastUsedFrame))
+				{
+					oldestBuffer = it;
+				}
+			}
+
+			const bool bHasTexture = oldestTexture != mTextures.end();
+			const bool bHasBuffer = oldestBuffer != mBuffers.end();
+			if (bHasTexture == false && bHasBuffer == false)
+			{
+				break;
+			}
+
+			if (bHasTexture && (bHasBuffer == false || oldestTexture->mLastUsedFrame <= oldestBuffer->mLastUsedFrame))
+			{
+				TURBO_CHECK(oldestTexture->mbInUse == false)
+				gpu.DestroyTexture(oldestTexture->mHandle);
+				mPooledMemorySize -= oldestTexture->mSize;
+				mTextures.erase(oldestTexture);
+			}
+			else
+			{
+				TURBO_CHECK(oldestBuffer->mbInUse == false)
+				gpu.DestroyBuffer(oldestBuffer->mHandle);
+				mPooledMemorySize -= oldestBuffer->mInfo.mSize;
+				mBuffers.erase(oldestBuffer);
+			}
+		}
+
+		static const cstring kPooledMemory = "RG Pooled Memory";
+		TRACE_PLOT_CONFIGURE(kPooledMemory, EPlotFormat::Memory, true, true, 0x00FFFF)
+		TRACE_PLOT(kPooledMemory, static_cast<int64>(mPooledMemorySize))
+
+		static const cstring kPoolAllocations = "RG Pool Allocations";
+		TRACE_PLOT_CONFIGURE(kPoolAllocations, EPlotFormat::Number, true, true, 0xFF00FF)
+		TRACE_PLOT(kPoolAllocations, static_cast<int64>(mNumAllocationsThisFrame))
+
+		mNumAllocationsThisFrame = 0;
+	}
+
+	void FRGResourcePool::Flush(FGPUDevice& gpu)
+	{
+		for (const FPooledTexture& pooledTexture : mTextures)
+		{
+			TURBO_CHECK(pooledTexture.mbInUse == false)
+			gpu.DestroyTexture(pooledTexture.mHandle);
+		}
+
+		for (const FPooledBuffer& pooledBuffer : mBuffers)
+		{
+			TURBO_CHECK(pooledBuffer.mbInUse == false)
+			gpu.DestroyBuffer(pooledBuffer.mHandle);
+		}
+
+		mTextures.clear();
+		mBuffers.clear();
+
+		for (FTransientHeap& heap : mHeaps)
+		{
+			if (heap.mMemory)
+			{
+				gpu.FreeMemory(heap.mMemory);
+			}
+
+			heap = {};
+		}
+
+		mPooledMemorySize = 0;
+	}
+
+	void FRGResourcePool::DestroyHeap(FGPUDevice& gpu, ERGTransientHeap heapType)
+	{
+		FTransientHeap& heap = mHeaps[static_cast<uint32>(heapType)];
+		TURBO_CHECK(heap.mMemory)
+
+		TURBO_LOG(LogRenderGraph, Display, "Releasing transient heap {}", magic_enum::enum_name(heapType));
+
+		// Resources placed in the heap can't outlive it
+		if (heapType == ERGTransientHeap::Textures)
+		{
+			std::erase_if(mTextures, [&gpu](const FPooledTexture& pooledTexture)
+			{
+				if (pooledTexture.mHeapOffset == kNotAliased)
+				{
+					return false;
+				}
+
+				TURBO_CHECK(pooledTexture.mbInUse == false)
+				gpu.DestroyTexture(pooledTexture.mHandle);
+				return true;
+			});
+		}
+		else
+		{
+			std::erase_if(mBuffers, [&gpu](const FPooledBuffer& pooledBuffer)
+			{
+				if (pooledBuffer.mHeapOffset == kNotAliased)
+				{
+					return false;
+				}
+
+				TURBO_CHECK(pooledBuffer.mbInUse == false)
+				gpu.DestroyBuffer(pooledBuffer.mHandle);
+				return true;
+			});
+		}
+
+		gpu.FreeMemory(heap.mMemory);
+		mPooledMemorySize -= heap.mInfo.mSize;
+		heap = {};
+	}
+} // Turbo
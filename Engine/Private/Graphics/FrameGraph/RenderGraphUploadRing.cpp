@@ -0,0 +1,204 @@
+#include "Graphics/FrameGraph/RenderGraphUploadRing.h"
+
+#include "Core/Memory.h"
+#include "Debug/IConsoleManager.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/FrameGraph/RenderGraph.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/Resources.h"
+
+namespace Turbo
+{
+	static TAutoConsoleVariable<int32> CVarUploadRingInitialSizeKiB(
+		"rg.uploadRing.initialSizeKiB",
+		1024,
+		"Initial size of the per-frame upload ring buffers (in KiB). The ring grows when a frame overflows it."
+	);
+
+	static FAutoConsoleCommand gRGUploadRingStatsCommand(
+		"rg.uploadRing.stats",
+		"Prints render graph upload ring usage of the current frame.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FRGUploadRing& uploadRing = entt::locator<FRenderGraphBuilder>::value().GetUploadRing();
+			consoleManager.Printf(
+				"Upload ring used: {} KiB, capacity: {} KiB",
+				uploadRing.GetUsedSize() / Constants::kKibi,
+				uploadRing.GetCapacity() / Constants::kKibi
+			);
+		}));
+
+	void FRGUploadRing::BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId)
+	{
+		TRACE_ZONE_SCOPED()
+
+		mGpu = &gpu;
+		mCurrentRing = &mFrameRings[bufferedFrameId];
+		FFrameRing& ring = *mCurrentRing;
+
+		if (ring.mOverflowBlocks.empty() == false)
+		{
+			FDeviceSize usedSize = ring.mBlock.mUsedSize;
+			for (FBlock& overflowBlock : ring.mOverflowBlocks)
+			{
+				usedSize += overflowBlock.mUsedSize;
+				DestroyBlock(gpu, overflowBlock);
+			}
+			ring.mOverflowBlocks.clear();
+
+			const FDeviceSize requiredSize = std::bit_ceil(usedSize);
+			TURBO_LOG(LogRenderGraph, Display, "Growing upload ring {} to {} KiB", bufferedFrameId, requiredSize / Constants::kKibi);
+
+			DestroyBlock(gpu, ring.mBlock);
+			ring.mBlock = CreateBlock(gpu, requiredSize);
+		}
+
+		ring.mBlock.mUsedSize = 0;
+	}
+
+	FRGUploadAllocation FRGUploadRing::Allocate(FDeviceSize size, FDeviceSize alignment)
+	{
+		TURBO_CHECK_MSG(mCurrentRing, "Upload ring is used before the frame began")
+		TURBO_CHECK(size > 0 && std::has_single_bit(alignment))
+
+		FFrameRing& ring = *mCurrentRing;
+
+		// Created on the first use, so graphs without uploads never touch the device
+		if (ring.mBlock.mBuffer.IsValid() == false)
+		{
+			const FDeviceSize initialSize = CVarUploadRingInitialSizeKiB.Get() * Constants::kKibi;
+			ring.mBlock = CreateBlock(*mGpu, glm::max(initialSize, std::bit_ceil(size + alignment)));
+		}
+
+		FRGUploadAllocation allocation = AllocateFromBlock(ring.mBlock, size, alignment);
+		if (allocation.IsValid())
+		{
+			return allocation;
+		}
+
+		if (ring.mOverflowBlocks.empty() == false)
+		{
+			allocation = AllocateFromBlock(ring.mOverflowBlocks.back(), size, alignment);
+			if (allocation.IsValid())
+			{
+				return allocation;
+			}
+		}
+
+		TURBO_LOG(LogRenderGraph, Display, "Upload ring overflow, allocating {} bytes", size);
+
+		// Buffer device addresses are aligned well beyond kDefaultAlignment, so the first allocation always fits
+		const FDeviceSize overflowBlockSize = glm::max(std::bit_ceil(size), ring.mBlock.mSize);
+		FBlock& overflowBlock = ring.mOverflowBlocks.emplace_back(CreateBlock(*mGpu, overflowBlockSize));
+
+		allocation = AllocateFromBlock(overflowBlock, size, alignment);
+		TURBO_CHECK(allocation.IsValid())
+
+		return allocation;
+	}
+
+	void FRGUploadRing::Destroy(FGPUDevice& gpu)
+	{
+		for (FFrameRing& ring : mFrameRings)
+		{
+			DestroyBlock(gpu, ring.mBlock);
+			for (FBlock& overflowBlock : ring.mOverflowBlocks)
+			{
+				DestroyBlock(gpu, overflowBlock);
+			}
+			ring.mOverflowBlocks.clear();
+		}
+
+		mCurrentRing = nullptr;
+		mGpu = nullptr;
+	}
+
+	FDeviceSize FRGUploadRing::GetCapacity() const
+	{
+		if (mCurrentRing == nullptr)
+		{
+			return 0;
+		}
+
+		FDeviceSize capacity = mCurrentRing->mBlock.mSize;
+		for (const FBlock& overflowBlock : mCurrentRing->mOverflowBlocks)
+		{
+			capacity += overflowBlock.mSize;
+		}
+
+		return capacity;
+	}
+
+	FDeviceSize FRGUploadRing::GetUsedSize() const
+	{
+		if (mCurrentRing == nullptr)
+		{
+			return 0;
+		}
+
+		FDeviceSize usedSize = mCurrentRing->mBlock.mUsedSize;
+		for (const FBlock& overflowBlock : mCurrentRing->mOverflowBlocks)
+		{
+			usedSize += overflowBlock.mUsedSize;
+		}
+
+		return usedSize;
+	}
+
+	FRGUploadRing::FBlock FRGUploadRing::CreateBlock(FGPUDevice& gpu, FDeviceSize size)
+	{
+		const static FName uploadRingName("RGUploadRing");
+
+		FBufferBuilder builder;
+		builder.Init(
+			EBufferFlags::CreateMapped | EBufferFlags::StorageBuffer | EBufferFlags::AccelerationStructureInput,
+			size
+		)
+		.SetName(uploadRingName)
+		.SetMemoryCategory(EGPUMemoryCategory::Staging);
+
+		FBlock block;
+		block.mBuffer = gpu.CreateBuffer(builder);
+
+		const FBuffer* buffer = gpu.AccessBuffer(block.mBuffer);
+		TURBO_CHECK(buffer->mMappedAddress)
+
+		block.mMappedAddress = buffer->mMappedAddress;
+		block.mDeviceAddress = buffer->mDeviceAddress;
+		block.mSize = size;
+
+		return block;
+	}
+
+	void FRGUploadRing::DestroyBlock(FGPUDevice& gpu, FBlock& block)
+	{
+		if (block.mBuffer)
+		{
+			// Deferred until the frames using the block are completed
+			gpu.DestroyBuffer(block.mBuffer);
+		}
+
+		block = {};
+	}
+
+	FRGUploadAllocation FRGUploadRing::AllocateFromBlock(FBlock& block, FDeviceSize size, FDeviceSize alignment)
+	{
+		// Align the device address, the mapped address is offset by the same amount
+		const FDeviceAddress alignedAddress = Memory::Align(block.mDeviceAddress + block.mUsedSize, alignment);
+		const FDeviceSize offset = alignedAddress - block.mDeviceAddress;
+		if (block.mBuffer.IsValid() == false || offset + size > block.mSize)
+		{
+			return {};
+		}
+
+		block.mUsedSize = offset + size;
+
+		return FRGUploadAllocation{
+			.mMappedAddress = block.mMappedAddress + offset,
+			.mDeviceAddress = alignedAddress,
+			.mBuffer = block.mBuffer,
+			.mOffset = offset,
+			.mSize = size
+		};
+	}
+} // Turbo
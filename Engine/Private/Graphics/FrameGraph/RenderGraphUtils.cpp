@@ -6,11 +6,13 @@ namespace Turbo
 {
 	void RenderGraphUtils::AddClearTexturePass(FRenderGraphBuilder& graphBuilder, FRGResourceHandle texture, glm::float4 color)
 	{
-		const FName passName(fmt::format("Clear {} to {}", graphBuilder.GetTextureInfo(texture).mName, color));
+		fmt::memory_buffer passNameBuffer;
+		fmt::format_to(std::back_inserter(passNameBuffer), "Clear {} to {}", graphBuilder.GetTextureInfo(texture).mName, color);
+		const FName passName(std::string_view(passNameBuffer.data(), passNameBuffer.size()));
 		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Transfer);
 		pass->WriteTexture(texture);
 
-		pass->mExecutePass.BindLambda(
+		pass->BindExecute(
 			[texture, color](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
 				const THandle<FTexture> handle = resources.mTextures[texture];
@@ -23,17 +25,20 @@ namespace Turbo
 	{
 		TURBO_CHECK(srcTexture != dstTexture)
 
-		const FName passName(fmt::format(
+		fmt::memory_buffer passNameBuffer;
+		fmt::format_to(
+			std::back_inserter(passNameBuffer),
 			"Blit {} to {}",
 			graphBuilder.GetTextureInfo(srcTexture).mName,
-			graphBuilder.GetTextureInfo(dstTexture).mName)
+			graphBuilder.GetTextureInfo(dstTexture).mName
 		);
+		const FName passName(std::string_view(passNameBuffer.data(), passNameBuffer.size()));
 
 		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Transfer);
 		pass->ReadTexture(srcTexture);
 		pass->WriteTexture(dstTexture);
 
-		pass->mExecutePass.BindLambda(
+		pass->BindExecute(
 			[srcTexture, dstTexture](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
 				const THandle<FTexture> srcHandle = resources.mTextures[srcTexture];
@@ -58,18 +63,21 @@ namespace Turbo
 		uint32 value
 	)
 	{
-		const FName passName(fmt::format(
+		fmt::memory_buffer passNameBuffer;
+		fmt::format_to(
+			std::back_inserter(passNameBuffer),
 			"Fill {} (0x{:x}->0x{:x}) with 0x{:x}",
 			graphBuilder.GetBufferInfo(srcBuffer).mName,
 			offset,
 			size,
 			value
-		));
+		);
+		const FName passName(std::string_view(passNameBuffer.data(), passNameBuffer.size()));
 
 		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Transfer);
 		pass->WriteBuffer(srcBuffer);
 
-		pass->mExecutePass.BindLambda(
+		pass->BindExecute(
 			[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
 				const THandle<FBuffer> srcHandle = resources.mBuffers[srcBuffer];
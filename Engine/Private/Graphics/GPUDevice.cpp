@@ -3,7 +3,10 @@
 #include "Assets/EngineResources.h"
 #include "CommonMacros.h"
 #include "Core/Allocators/StackAllocator.h"
+#include "Core/CoreUtils.h"
 #include "Core/Engine.h"
+#include "Core/FileSystem.h"
+#include "Core/Memory.h"
 #include "Graphics/CommandBuffer.h"
 #include "Graphics/GraphicsCore.h"
 #include "Graphics/ResourceBuilders.h"
@@ -20,6 +23,7 @@
 #include "Debug/IConsoleManager.h"
 #include "vulkan/vulkan.hpp"
 #include "vulkan/vulkan_core.h"
+#include "vulkan/vulkan_format_traits.hpp"
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -41,29 +45,151 @@ namespace Turbo
 			entt::locator<FGPUDevice>::value().RecompileShaders();
 		}));
 
-	void FGPUDevice::RecreatePipelines()
+	static FAutoConsoleCommand gBindlessStatsCommand(
+		"gpu.bindless.stats",
+		"Prints the bindless descriptor updates of the last frame.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FBindlessUpdateStats& stats = entt::locator<FGPUDevice>::value().GetBindlessUpdateStats();
+			consoleManager.Printf(
+				"Bindless requests: {}, skipped: {}, descriptors written: {}, write entries: {}",
+				stats.mNumRequests,
+				stats.mNumSkippedRequests,
+				stats.mNumDescriptorWrites,
+				stats.mNumWriteEntries
+			);
+		}));
+
+	static TAutoConsoleVariable<bool> CVarPipelineCache(
+		"gpu.pipelineCache",
+		true,
+		"Loads the pipeline cache from disk at startup and saves it at shutdown.");
+
+	static TAutoConsoleVariable<bool> CVarHeadlessReadback(
+		"gpu.headless.readback",
+		false,
+		"Copies present images of a headless device to host memory, see FGPUDevice::OnHeadlessFrameReadback.");
+
+	static const std::string kPipelineCacheFilePath = FileSystem::PathCombine(FileSystem::kCachePath, "PipelineCache.bin");
+
+	/**
+	 * Written in front of the driver data. The driver data starts with vk::PipelineCacheHeaderVersionOne,
+	 * but it doesn't contain the driver version and drivers don't always reject stale data on their own.
+	 */
+	struct FPipelineCacheFileHeader
 	{
-		CHECK_VULKAN_HPP(mVkDevice.waitIdle())
+		static constexpr uint32 kMagic = 'T' | 'P' << 8 | 'S' << 16 | 'O' << 24;
+		static constexpr uint32 kVersion = 1;
+
+		uint32 mMagic = kMagic;
+		uint32 mVersion = kVersion;
+		uint32 mVendorId = 0;
+		uint32 mDeviceId = 0;
+		uint32 mDriverVersion = 0;
+		std::array<uint8, VK_UUID_SIZE> mPipelineCacheUUID = {};
+		uint32 mDataSize = 0;
+		uint32 mDataHash = 0;
+	};
+
+	static FPipelineCacheFileHeader MakePipelineCacheFileHeader(const vk::PhysicalDeviceProperties& properties)
+	{
+		FPipelineCacheFileHeader header = {};
+		header.mVendorId = properties.vendorID;
+		header.mDeviceId = properties.deviceID;
+		header.mDriverVersion = properties.driverVersion;
+		std::ranges::copy(properties.pipelineCacheUUID, header.mPipelineCacheUUID.begin());
+		return header;
+	}
+
+	/** Returns the driver data of the cache file or an empty span if the file was written by a different device or driver */
+	static std::span<byte> ValidatePipelineCacheFile(std::span<byte> fileData, const vk::PhysicalDeviceProperties& properties)
+	{
+		if (fileData.size() < sizeof(FPipelineCacheFileHeader) + sizeof(vk::PipelineCacheHeaderVersionOne))
+		{
+			return {};
+		}
+
+		FPipelineCacheFileHeader fileHeader;
+		std::memcpy(&fileHeader, fileData.data(), sizeof(FPipelineCacheFileHeader));
+
+		const FPipelineCacheFileHeader expectedHeader = MakePipelineCacheFileHeader(properties);
+		if (fileHeader.mMagic != expectedHeader.mMagic
+			|| fileHeader.mVersion != expectedHeader.mVersion
+			|| fileHeader.mVendorId != expectedHeader.mVendorId
+			|| fileHeader.mDeviceId != expectedHeader.mDeviceId
+			|| fileHeader.mDriverVersion != expectedHeader.mDriverVersion
+			|| fileHeader.mPipelineCacheUUID != expectedHeader.mPipelineCacheUUID)
+		{
+			return {};
+		}
+
+		const std::span<byte> driverData = fileData.subspan(sizeof(FPipelineCacheFileHeader));
+		if (driverData.size() != fileHeader.mDataSize || CoreUtils::Adler32Hash(driverData) != fileHeader.mDataHash)
+		{
+			return {};
+		}
+
+		vk::PipelineCacheHeaderVersionOne driverHeader;
+		std::memcpy(&driverHeader, driverData.data(), sizeof(vk::PipelineCacheHeaderVersionOne));
+		if (driverHeader.headerSize < sizeof(vk::PipelineCacheHeaderVersionOne)
+			|| driverHeader.headerVersion != vk::PipelineCacheHeaderVersion::eOne
+			|| driverHeader.vendorID != properties.vendorID
+			|| driverHeader.deviceID != properties.deviceID
+			|| std::ranges::equal(driverHeader.pipelineCacheUUID, properties.pipelineCacheUUID) == false)
+		{
+			return {};
+		}
+
+		return driverData;
+	}
+
+	static TAutoConsoleVariable<bool> CVarAsyncPipelines(
+		"gpu.asyncPipelines",
+		true,
+		"Compiles pipelines created with CreatePipelineAsync and recreated pipelines on worker threads.");
+
+	void FPipelineCompileTask::ExecuteRange(enki::TaskSetPartition range, uint32_t threadNum)
+	{
+		TRACE_ZONE_SCOPED_N("Compile Pipeline")
+		mGpu->CompilePipeline(mBuilder, mBindlessLayout, mResult);
+	}
+
+	static void WaitForPipelineCompileTask(const FPipelineCompileTask& task)
+	{
+		// The task scheduler is gone at the engine exit, but all tasks are complete by then
+		if (task.GetIsComplete() == false)
+		{
+			entt::locator<enki::TaskScheduler>::value().WaitforTask(&task);
+		}
+	}
 
+	void FGPUDevice::RecreatePipelines()
+	{
 		TURBO_LOG(LogGPUDevice, Info, "Recompiling pipelines")
 
-		mPipelinePool->ForEachEntry(
+		mPipelinePool.ForEachEntry(
 			[&](THandle<FPipeline> pipelineHandle)
 			{
-				FPipeline* pipeline = mPipelinePool->Access(pipelineHandle);
-				FPipelineCold* pipelineCold = mPipelinePool->AccessCold(pipelineHandle);
+				const bool bAlreadyCompiling = std::ranges::any_of(mPipelineCompileTasks,
+					[&](const TUniquePtr<FPipelineCompileTask>& task) { return task->mHandle == pipelineHandle; });
 
-				DestroyShaderState(pipelineCold->mShaderState);
-
-				mVkDevice.destroyPipelineLayout(pipeline->mVkLayout);
-				mVkDevice.destroyPipeline(pipeline->mVkPipeline);
-
-				InitPipeline(*pipelineCold->mPipelineBuilder, pipelineHandle);
+				if (bAlreadyCompiling == false)
+				{
+					RequestPipelineCompilation(pipelineHandle);
+				}
 			});
+
+		if (CVarAsyncPipelines.Get() == false)
+		{
+			WaitForPendingPipelines();
+		}
 	}
 
 	void FGPUDevice::RecompileShaders()
 	{
+		// The compiler session can't be replaced while workers are using it
+		WaitForPendingPipelines();
+
 		IShaderCompiler::Get().ClearRuntimeCache();
 		RecreatePipelines();
 	}
@@ -76,26 +202,42 @@ namespace Turbo
 		mNumRenderingThreads = glm::min(kMaxRenderingThreads, taskScheduler.GetNumTaskThreads());
 		TURBO_LOG(LogGPUDevice, Info, "Num rendering threads: {}", mNumRenderingThreads);
 
+		mbHeadless = gpuDeviceBuilder.mbHeadless;
+		TURBO_LOG(LogGPUDevice, Info, "Headless: {}", mbHeadless);
+
 		FWindow& window = entt::locator<FWindow>::value();
-		window.InitForVulkan();
+		std::vector<cstring> instanceRequiredExtensions;
+		if (mbHeadless == false)
+		{
+			window.InitForVulkan();
+		}
 		window.Init();
 
-		std::vector<cstring> instanceRequiredExtensions = window.GetVulkanRequiredExtensions();
+		if (mbHeadless == false)
+		{
+			instanceRequiredExtensions = window.GetVulkanRequiredExtensions();
+		}
 
 		VULKAN_HPP_DEFAULT_DISPATCHER.init();
 		const vkb::Instance builtInstance = CreateVkInstance(instanceRequiredExtensions);
 		VULKAN_HPP_DEFAULT_DISPATCHER.init(mVkInstance);
 
-		TURBO_CHECK(window.CreateVulkanSurface(mVkInstance));
-		mVkWindowSurface = window.GetVulkanSurface();
+		if (mbHeadless == false)
+		{
+			TURBO_CHECK(window.CreateVulkanSurface(mVkInstance));
+			mVkWindowSurface = window.GetVulkanSurface();
+		}
 
 		const vkb::PhysicalDevice selectedPhysicalDevice = SelectPhysicalDevice(builtInstance);
 		const vkb::Device device = CreateDevice(selectedPhysicalDevice);
 		VULKAN_HPP_DEFAULT_DISPATCHER.init(mVkDevice);
 
 		CreateVulkanMemoryAllocator();
+		CreatePipelineCache();
+		CreateTimelineSemaphore();
 
 		InitializeImmediateCommands();
+		mUploadManager.Init(*this);
 
 		EngineResources::InitEngineSamplers();
 		EngineResources::InitEngineTextures();
@@ -119,13 +261,12 @@ namespace Turbo
 
 		CreateSwapchain();
 		CreateFrameDatas();
+
+		mGPUProfiler.Init(*this);
 	}
 
 	void FGPUDevice::InitializeImmediateCommands()
 	{
-		const vk::FenceCreateInfo fenceCreateInfo = VulkanInitializers::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled);
-		CHECK_VULKAN_RESULT(mImmediateCommandsFence, mVkDevice.createFence(fenceCreateInfo));
-
 		mImmediateCommandsPool = CreateCommandPool(mVkGraphicsQueueFamilyIndex, vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
 		mImmediateCommandsBuffer = CreateCommandBuffer({
 			.mVkCommandPool = mImmediateCommandsPool,
@@ -140,10 +281,10 @@ namespace Turbo
 		FDescriptorPoolBuilder descriptorPoolBuilder;
 		descriptorPoolBuilder
 			.SetMaxSets(1)
-			.SetPoolRatio(vk::DescriptorType::eSampledImage, kTexturePoolSize)
-			.SetPoolRatio(vk::DescriptorType::eStorageImage, kTexturePoolSize)
-			.SetPoolRatio(vk::DescriptorType::eSampler, kSamplerPoolSize)
-			.SetPoolRatio(vk::DescriptorType::eAccelerationStructureKHR, kTLASPoolSize)
+			.SetPoolRatio(vk::DescriptorType::eSampledImage, mBindlessCapacity.mNumTextures)
+			.SetPoolRatio(vk::DescriptorType::eStorageImage, mBindlessCapacity.mNumTextures)
+			.SetPoolRatio(vk::DescriptorType::eSampler, mBindlessCapacity.mNumSamplers)
+			.SetPoolRatio(vk::DescriptorType::eAccelerationStructureKHR, mBindlessCapacity.mNumTLAS)
 			.SetFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind)
 			.SetName(FName("BindlessResources"));
 		mBindlessResourcesPool = CreateDescriptorPool(descriptorPoolBuilder);
@@ -155,10 +296,10 @@ namespace Turbo
 		layoutBuilder
 			.SetIndex(0)
 			.SetFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool)
-			.AddBinding(vk::DescriptorType::eSampledImage, BindlessResourcesBindings::kSampledImage, kTexturePoolSize, bindingFlags, FName("texturePool"))
-			.AddBinding(vk::DescriptorType::eStorageImage, BindlessResourcesBindings::kStorageImage, kTexturePoolSize, bindingFlags, FName("rwTexturePool"))
-			.AddBinding(vk::DescriptorType::eSampler, BindlessResourcesBindings::kSampler, kSamplerPoolSize, bindingFlags, FName("samplerPool"))
-			.AddBinding(vk::DescriptorType::eAccelerationStructureKHR, BindlessResourcesBindings::kTLAS, kTLASPoolSize, bindingFlags, FName("tlasPool"))
+			.AddBinding(vk::DescriptorType::eSampledImage, BindlessResourcesBindings::kSampledImage, mBindlessCapacity.mNumTextures, bindingFlags, FName("texturePool"))
+			.AddBinding(vk::DescriptorType::eStorageImage, BindlessResourcesBindings::kStorageImage, mBindlessCapacity.mNumTextures, bindingFlags, FName("rwTexturePool"))
+			.AddBinding(vk::DescriptorType::eSampler, BindlessResourcesBindings::kSampler, mBindlessCapacity.mNumSamplers, bindingFlags, FName("samplerPool"))
+			.AddBinding(vk::DescriptorType::eAccelerationStructureKHR, BindlessResourcesBindings::kTLAS, mBindlessCapacity.mNumTLAS, bindingFlags, FName("tlasPool"))
 			.SetName(FName("BindlessResources"));
 		mBindlessResourcesLayout = CreateDescriptorSetLayout(layoutBuilder);
 		TURBO_CHECK(mBindlessResourcesLayout)
@@ -171,39 +312,20 @@ namespace Turbo
 
 		mBindlessResourcesSet = CreateDescriptorSet(descriptorSetBuilder);
 
-		mBindlessResourcesToUpdate.reserve(kTexturePoolSize);
+		mBindlessResourcesToUpdate.reserve(mTexturePool.GetCapacity());
 
 #if 0
-		for (uint32 textureBindId = 0; textureBindId < kTexturePoolSize; ++textureBindId)
+		for (uint32 textureBindId = 0; textureBindId < mBindlessCapacity.mNumTextures; ++textureBindId)
 		{
 			mBindlessResourcesToUpdate.emplace_back(EResourceType::Texture, textureBindId, EngineResources::GetBlackTexture());
 		}
 #endif // 0
 	}
 
-	THandle<FBuffer> FGPUDevice::CreateBuffer(const FBufferBuilder& builder)
+	static vk::BufferCreateInfo MakeBufferCreateInfo(const FBufferBuilder& builder, std::span<const uint32> queueFamilies)
 	{
-		TRACE_ZONE_SCOPED()
-
-		const THandle<FBuffer> handle = mBufferPool->Acquire();
-		TURBO_CHECK(handle)
-
-#if TURBO_BUILD_DEVELOPMENT
-		if ((builder.mBufferFlags & EBufferFlags::UniformBuffer) != EBufferFlags::None)
-		{
-			TURBO_ENSURE(builder.mSize < kMaxUniformBufferSize);
-		}
-#endif
-
-		FBuffer* buffer = AccessBuffer(handle);
-		FBufferCold* bufferCold = AccessBufferCold(handle);
-		buffer->mDeviceSize = builder.mSize;
-
-		bufferCold->mName = builder.mName;
-		bufferCold->mBufferFlags = builder.mBufferFlags;
-
 		vk::BufferCreateInfo createInfo = {};
-		createInfo.size = buffer->mDeviceSize;
+		createInfo.size = builder.mSize;
 		createInfo.usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress;
 		createInfo.usage |=
 			(builder.mBufferFlags & EBufferFlags::UniformBuffer) != EBufferFlags::None
@@ -234,13 +356,67 @@ namespace Turbo
 				? vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR
 				: static_cast<vk::BufferUsageFlagBits>(0);
 
+		// Buffers are accessed through device addresses outside of the render graph, so they are shared between
+		// queue families instead of transferring the ownership.
+		if (queueFamilies.size() > 1)
+		{
+			createInfo.sharingMode = vk::SharingMode::eConcurrent;
+			createInfo.queueFamilyIndexCount = queueFamilies.size();
+			createInfo.pQueueFamilyIndices = queueFamilies.data();
+		}
+
+		return createInfo;
+	}
+
+	THandle<FBuffer> FGPUDevice::CreateBuffer(const FBufferBuilder& builder)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const THandle<FBuffer> handle = mBufferPool.Acquire();
+		TURBO_CHECK(handle)
+
+#if TURBO_BUILD_DEVELOPMENT
+		if ((builder.mBufferFlags & EBufferFlags::UniformBuffer) != EBufferFlags::None)
+		{
+			TURBO_ENSURE(builder.mSize < kMaxUniformBufferSize);
+		}
+#endif
+
+		FBuffer* buffer = AccessBuffer(handle);
+		FBufferCold* bufferCold = AccessBufferCold(handle);
+		buffer->mDeviceSize = builder.mSize;
+
+		bufferCold->mName = builder.mName;
+		bufferCold->mBufferFlags = builder.mBufferFlags;
+
+		if (IsNullDevice())
+		{
+			TURBO_CHECK_MSG(
+				builder.mAliasedMemory == nullptr && builder.mInitialData == nullptr && (builder.mBufferFlags & EBufferFlags::CreateMapped) == EBufferFlags::None,
+				"Null device buffers have no memory."
+			)
+			return handle;
+		}
+
+		const vk::BufferCreateInfo createInfo = MakeBufferCreateInfo(builder, mBufferQueueFamilies);
+
+		EGPUMemoryCategory memoryCategory = builder.mMemoryCategory;
+		if (memoryCategory == EGPUMemoryCategory::Other && (builder.mBufferFlags & EBufferFlags::AccelerationStructureStorage) != EBufferFlags::None)
+		{
+			memoryCategory = EGPUMemoryCategory::AccelerationStructure;
+		}
+
 		vma::AllocationCreateInfo allocationCreateInfo = {};
 		allocationCreateInfo.usage = vma::MemoryUsage::eAuto;
+		allocationCreateInfo.pUserData = FGPUMemoryBudget::ToUserData(memoryCategory);
 
 		const bool bCreateMapped = (builder.mBufferFlags & EBufferFlags::CreateMapped) != EBufferFlags::None;
+		const bool bReadback = (builder.mBufferFlags & EBufferFlags::Readback) != EBufferFlags::None;
+		TURBO_CHECK_MSG(bReadback == false || bCreateMapped, "Readback buffers have to be mapped.")
 		if (bCreateMapped)
 		{
-			allocationCreateInfo.flags |= vma::AllocationCreateFlagBits::eHostAccessSequentialWrite;
+			// Sequential write memory can be uncached, reading it is slow
+			allocationCreateInfo.flags |= bReadback ? vma::AllocationCreateFlagBits::eHostAccessRandom : vma::AllocationCreateFlagBits::eHostAccessSequentialWrite;
 			allocationCreateInfo.flags |= vma::AllocationCreateFlagBits::eMapped;
 		}
 
@@ -252,11 +428,20 @@ namespace Turbo
 		}
 
 		vma::AllocationInfo allocationInfo;
-		std::pair<vma::Allocation, vk::Buffer> allocationResult;
-		CHECK_VULKAN_RESULT(allocationResult, mVmaAllocator.createBufferWithAlignment(createInfo, allocationCreateInfo, minAlignment, allocationInfo));
+		if (builder.mAliasedMemory)
+		{
+			TURBO_CHECK_MSG(bCreateMapped == false && builder.mInitialData == nullptr, "Aliased buffers can't be accessed by the host.")
+			CHECK_VULKAN_RESULT(buffer->mVkBuffer, mVmaAllocator.createAliasingBuffer2(builder.mAliasedMemory, builder.mAliasedMemoryOffset, createInfo));
+		}
+		else
+		{
+			std::pair<vma::Allocation, vk::Buffer> allocationResult;
+			CHECK_VULKAN_RESULT(allocationResult, mVmaAllocator.createBufferWithAlignment(createInfo, allocationCreateInfo, minAlignment, allocationInfo));
 
-		bufferCold->mAllocation = allocationResult.first;
-		buffer->mVkBuffer = allocationResult.second;
+			bufferCold->mAllocation = allocationResult.first;
+			buffer->mVkBuffer = allocationResult.second;
+			mMemoryBudget.OnAllocated(bufferCold->mAllocation, allocationInfo, memoryCategory);
+		}
 
 		vk::BufferDeviceAddressInfo deviceAddressInfo = {};
 		deviceAddressInfo.buffer = buffer->mVkBuffer;
@@ -270,10 +455,9 @@ namespace Turbo
 			buffer->mMappedAddress = static_cast<byte*>(allocationInfo.pMappedData);
 		}
 
-		const vk::MemoryPropertyFlags& allocationMemoryProperties = mVmaAllocator.getAllocationMemoryProperties(bufferCold->mAllocation);
-
 		if (builder.mInitialData)
 		{
+			const vk::MemoryPropertyFlags& allocationMemoryProperties = mVmaAllocator.getAllocationMemoryProperties(bufferCold->mAllocation);
 			if (allocationMemoryProperties & vk::MemoryPropertyFlagBits::eHostVisible)
 			{
 				TRACE_ZONE_SCOPED_N("Copy mapped")
@@ -284,25 +468,61 @@ namespace Turbo
 			{
 				TRACE_ZONE_SCOPED_N("Copy staging buffer")
 
-				ImmediateSubmit(FOnImmediateSubmit::CreateLambda([&](FCommandBuffer& cmd)
-				{
-					const FBufferBuilder stagingBufferBuilder = FBufferBuilder::CreateStagingBuffer(builder.mInitialData, builder.mSize);
-					const THandle<FBuffer> stagingBuffer = CreateBuffer(stagingBufferBuilder);
-
-					cmd.CopyBuffer(stagingBuffer, handle, builder.mSize);
-					DestroyBuffer(stagingBuffer);
-				}));
+				mUploadManager.UploadBuffer(*this, handle, 0, std::span(static_cast<const byte*>(builder.mInitialData), builder.mSize));
 			}
 		}
 
 		return handle;
 	}
 
+	static vk::ImageCreateInfo MakeImageCreateInfo(const FTextureBuilder& builder)
+	{
+		vk::ImageCreateInfo imageCreateInfo = {};
+		imageCreateInfo.format = builder.mFormat;
+		imageCreateInfo.imageType = ToVkImageType(builder.mType);
+		imageCreateInfo.extent.width = builder.mWidth;
+		imageCreateInfo.extent.height = builder.mHeight;
+		imageCreateInfo.extent.depth = builder.mDepth;
+		imageCreateInfo.mipLevels = builder.mNumMips;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = ToVkSampleCountBits(builder.mNumSamples);
+		imageCreateInfo.tiling = vk::ImageTiling::eOptimal;
+
+		const bool bRenderTarget = (builder.mFlags & ETextureFlags::RenderTarget) != ETextureFlags::Invalid;
+		const bool bStorageImage = (builder.mFlags & ETextureFlags::StorageImage) != ETextureFlags::Invalid;
+
+		using EImgUsage = vk::ImageUsageFlagBits;
+
+		imageCreateInfo.usage = EImgUsage::eSampled;
+		imageCreateInfo.usage |= bStorageImage ? EImgUsage::eStorage : static_cast<EImgUsage>(0);
+		if (TextureFormat::HasDepthOrStencil(builder.mFormat))
+		{
+			imageCreateInfo.usage |= EImgUsage::eDepthStencilAttachment;
+		}
+		else
+		{
+			imageCreateInfo.usage |= EImgUsage::eTransferDst;
+			imageCreateInfo.usage |= bRenderTarget || bStorageImage ? EImgUsage::eTransferSrc : static_cast<EImgUsage>(0);
+			imageCreateInfo.usage |= bRenderTarget ? EImgUsage::eColorAttachment : static_cast<EImgUsage>(0);
+		}
+
+		if ((builder.mFlags & ETextureFlags::TransientAttachment) != ETextureFlags::Invalid)
+		{
+			TURBO_CHECK(bRenderTarget)
+			imageCreateInfo.usage |= EImgUsage::eTransientAttachment;
+		}
+
+		imageCreateInfo.sharingMode = vk::SharingMode::eExclusive;
+		imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
+
+		return imageCreateInfo;
+	}
+
 	THandle<FTexture> FGPUDevice::CreateTexture(const FTextureBuilder& builder)
 	{
 		TRACE_ZONE_SCOPED()
 
-		const THandle<FTexture> handle = mTexturePool->Acquire();
+		const THandle<FTexture> handle = mTexturePool.Acquire();
 		TURBO_CHECK(handle)
 
 		FTexture* texture = AccessTexture(handle);
@@ -315,7 +535,7 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		const THandle<FSampler> handle = mSamplerPool->Acquire();
+		const THandle<FSampler> handle = mSamplerPool.Acquire();
 		TURBO_CHECK(handle);
 
 		FSampler* sampler = AccessSampler(handle);
@@ -356,10 +576,41 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		THandle<FPipeline> handle = mPipelinePool->Acquire();
+		THandle<FPipeline> handle = mPipelinePool.Acquire();
+		TURBO_CHECK(handle)
+
+		*mPipelinePool.Access(handle) = {};
+		FPipelineCold* pipelineCold = mPipelinePool.AccessCold(handle);
+		pipelineCold->mShaderState = {};
+		pipelineCold->mPipelineBuilder = new FPipelineBuilder(builder);
+
+		FCompiledPipeline compiledPipeline;
+		CompilePipeline(builder, mDescriptorSetLayoutPool.Access(mBindlessResourcesLayout)->mVkLayout, compiledPipeline);
+		TURBO_CHECK_MSG(compiledPipeline.mbSucceeded, "Failed to compile {} pipeline.", builder.mName)
+
+		FinishPipeline(handle, compiledPipeline);
+
+		return handle;
+	}
+
+	THandle<FPipeline> FGPUDevice::CreatePipelineAsync(const FPipelineBuilder& builder)
+	{
+		TRACE_ZONE_SCOPED()
+
+		THandle<FPipeline> handle = mPipelinePool.Acquire();
 		TURBO_CHECK(handle)
 
-		InitPipeline(builder, handle);
+		*mPipelinePool.Access(handle) = {};
+		FPipelineCold* pipelineCold = mPipelinePool.AccessCold(handle);
+		pipelineCold->mShaderState = {};
+		pipelineCold->mPipelineBuilder = new FPipelineBuilder(builder);
+
+		RequestPipelineCompilation(handle);
+
+		if (CVarAsyncPipelines.Get() == false)
+		{
+			WaitForPendingPipelines();
+		}
 
 		return handle;
 	}
@@ -368,10 +619,10 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		THandle<FDescriptorPool> handle = mDescriptorPoolPool->Acquire();
+		THandle<FDescriptorPool> handle = mDescriptorPoolPool.Acquire();
 		TURBO_CHECK(handle)
 
-		FDescriptorPool* pool = mDescriptorPoolPool->Access(handle);
+		FDescriptorPool* pool = mDescriptorPoolPool.Access(handle);
 		pool->mDescriptorSets.clear();
 		pool->mName = builder.mName;
 
@@ -397,10 +648,10 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		THandle<FDescriptorSetLayout> handle = mDescriptorSetLayoutPool->Acquire();
+		THandle<FDescriptorSetLayout> handle = mDescriptorSetLayoutPool.Acquire();
 		TURBO_CHECK(handle)
 
-		FDescriptorSetLayout* layout = mDescriptorSetLayoutPool->Access(handle);
+		FDescriptorSetLayout* layout = mDescriptorSetLayoutPool.Access(handle);
 		layout->mNumBindings = builder.mNumBindings;
 		layout->mHandle = handle;
 		layout->mSetIndex = builder.mSetIndex;
@@ -440,14 +691,14 @@ namespace Turbo
 
 	THandle<FDescriptorSet> FGPUDevice::CreateDescriptorSet(const FDescriptorSetBuilder& builder)
 	{
-		THandle<FDescriptorSet> handle = mDescriptorSetPool->Acquire();
+		THandle<FDescriptorSet> handle = mDescriptorSetPool.Acquire();
 		TURBO_CHECK(handle);
 
-		FDescriptorSet* set = mDescriptorSetPool->Access(handle);
-		const FDescriptorSetLayout* layout = mDescriptorSetLayoutPool->Access(builder.mLayout);
+		FDescriptorSet* set = mDescriptorSetPool.Access(handle);
+		const FDescriptorSetLayout* layout = mDescriptorSetLayoutPool.Access(builder.mLayout);
 		TURBO_CHECK(set && layout)
 
-		FDescriptorPool* pool = mDescriptorPoolPool->Access(builder.mDescriptorPool);
+		FDescriptorPool* pool = mDescriptorPoolPool.Access(builder.mDescriptorPool);
 
 		// Allocate set
 		vk::DescriptorSetAllocateInfo allocateInfo = {};
@@ -519,7 +770,7 @@ namespace Turbo
 					}
 				case vk::DescriptorType::eSampler:
 					{
-						const FSampler* sampler = mSamplerPool->Access(THandle<FSampler>(resource));
+						const FSampler* sampler = mSamplerPool.Access(THandle<FSampler>(resource));
 
 						vk::DescriptorImageInfo& imageInfo = imageInfos.emplace_back();
 						imageInfo.sampler = sampler->mVkSampler;
@@ -530,7 +781,7 @@ namespace Turbo
 				case vk::DescriptorType::eStorageBuffer:
 				case vk::DescriptorType::eUniformBuffer:
 					{
-						const FBuffer* buffer = mBufferPool->Access(THandle<FBuffer>(resource));
+						const FBuffer* buffer = mBufferPool.Access(THandle<FBuffer>(resource));
 
 						vk::DescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back();
 						bufferInfo.buffer = buffer->mVkBuffer;
@@ -555,29 +806,39 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		THandle<FShaderState> handle = {};
-
-		if (builder.mStagesCount == 0)
+		FShaderState shaderState;
+		if (CompileShaderState(builder, shaderState) == false)
 		{
-			TURBO_LOG(LogGPUDevice, Warn, "Shader {} doesn't contain any shader stage.", builder.mName);
-			return handle;
+			return {};
 		}
 
-		handle = mShaderStatePool->Acquire();
+		THandle<FShaderState> handle = mShaderStatePool.Acquire();
 		TURBO_CHECK(handle)
 
-		FShaderState* shaderState = mShaderStatePool->Access(handle);
-		TURBO_CHECK(shaderState)
+		*mShaderStatePool.Access(handle) = shaderState;
+
+		return handle;
+	}
+
+	bool FGPUDevice::CompileShaderState(const FShaderStateBuilder& builder, FShaderState& outShaderState) const
+	{
+		TRACE_ZONE_SCOPED()
+
+		if (builder.mStagesCount == 0)
+		{
+			TURBO_LOG(LogGPUDevice, Warn, "Shader {} doesn't contain any shader stage.", builder.mName);
+			return false;
+		}
 
-		shaderState->mShaderStageCrateInfo = {};
+		outShaderState.mShaderStageCrateInfo = {};
 
-		shaderState->mbGraphicsPipeline = true;
-		shaderState->mNumActiveShaders = 0;
+		outShaderState.mbGraphicsPipeline = true;
+		outShaderState.mNumActiveShaders = 0;
 
 		if (builder.mStages[0].mStage == vk::ShaderStageFlagBits::eCompute)
 		{
 			TURBO_CHECK_MSG(builder.mStagesCount == 1, "ComputePipeline supports only 1 compute shader.")
-			shaderState->mbGraphicsPipeline = false;
+			outShaderState.mbGraphicsPipeline = false;
 		}
 
 		std::unordered_set<vk::ShaderStageFlagBits> processedStages;
@@ -591,112 +852,153 @@ namespace Turbo
 			TURBO_CHECK_MSG(insertionResult.second, "Only one shader per stage is supported.")
 
 			const vk::ShaderModule shaderModule = shaderCompiler.CompileShader(mVkDevice, shaderStage);
-			TURBO_CHECK(shaderModule);
+			if (!shaderModule)
+			{
+				for (uint32 compiledStageId = 0; compiledStageId < shaderStageId; ++compiledStageId)
+				{
+					mVkDevice.destroyShaderModule(outShaderState.mShaderStageCrateInfo[compiledStageId].module);
+				}
+
+				return false;
+			}
 
 			SetResourceName(shaderModule, shaderStage.mShaderName);
 
-			vk::PipelineShaderStageCreateInfo& stageCreateInfo = shaderState->mShaderStageCrateInfo[shaderStageId];
+			vk::PipelineShaderStageCreateInfo& stageCreateInfo = outShaderState.mShaderStageCrateInfo[shaderStageId];
 			*stageCreateInfo = vk::PipelineShaderStageCreateInfo();
 			stageCreateInfo.pName = "main";
 			stageCreateInfo.setStage(shaderStage.mStage);
 			stageCreateInfo.module = shaderModule;
 		}
 
-		shaderState->mNumActiveShaders = builder.mStagesCount;
-		shaderState->mName = builder.mName;
+		outShaderState.mNumActiveShaders = builder.mStagesCount;
+		outShaderState.mName = builder.mName;
 
-		return handle;
+		return true;
 	}
 
 	THandle<FBLAS> FGPUDevice::CreateBLAS(const FBLASBuilder& builder)
 	{
-		THandle<FBLAS> handle = mBLASPool->Acquire();
-		FBLAS* blas = mBLASPool->Access(handle);
-		blas->mName = builder.mName;
-		blas->mType = EAccelerationStructureType::BLAS;
-
-		const FBuffer* vertexBuffer = AccessBuffer(builder.mVertexBuffer);
-		const FBuffer* indexBuffer = AccessBuffer(builder.mIndexBuffer);
-		TURBO_CHECK(vertexBuffer && indexBuffer)
-
-		vk::AccelerationStructureGeometryKHR geometry = {};
-		geometry.geometryType = vk::GeometryTypeKHR::eTriangles;
-		geometry.flags = builder.mGeometryFlags;
-
-		vk::AccelerationStructureGeometryTrianglesDataKHR& triangleData = geometry.geometry.triangles;
-		triangleData.vertexFormat = builder.mVertexFormat;
-		triangleData.vertexData = vertexBuffer->mDeviceAddress;
-		triangleData.vertexStride = sizeof(glm::float3);
-		triangleData.maxVertex = builder.mNumVertices - 1;
-		triangleData.indexType = builder.mIndexType;
-		triangleData.indexData = indexBuffer->mDeviceAddress;
-		triangleData.transformData = {};
-
-		vk::AccelerationStructureBuildGeometryInfoKHR buildGeometryInfo = {};
-		buildGeometryInfo.type = vk::AccelerationStructureTypeKHR::eBottomLevel;
-		buildGeometryInfo.flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
-		buildGeometryInfo.mode = vk::BuildAccelerationStructureModeKHR::eBuild;
-		buildGeometryInfo.geometryCount = 1;
-		buildGeometryInfo.pGeometries = &geometry;
+		THandle<FBLAS> handle = {};
+		CreateBLAS(std::span(&builder, 1), std::span(&handle, 1));
+		return handle;
+	}
 
-		// Compute requested size
-		const vk::AccelerationStructureBuildSizesInfoKHR sizeInfo = mVkDevice.getAccelerationStructureBuildSizesKHR(
-			vk::AccelerationStructureBuildTypeKHR::eDevice,
-			buildGeometryInfo,
-			{builder.mNumVertices / 3}
-		);
+	void FGPUDevice::CreateBLAS(std::span<const FBLASBuilder> builders, std::span<THandle<FBLAS>> outHandles)
+	{
+		TRACE_ZONE_SCOPED()
+		TURBO_CHECK(builders.size() == outHandles.size())
 
-		// Create storage buffer
-		const std::string storageBufferName = fmt::format("{}_Storage", builder.mName);
-		FBufferBuilder bufferBuilder = {
-			.mBufferFlags = EBufferFlags::AccelerationStructureStorage,
-			.mSize = sizeInfo.accelerationStructureSize,
-			.mName = builder.mName
-		};
-		blas->mBuffer = CreateBuffer(bufferBuilder);
-		const FBuffer* storageBuffer = AccessBuffer(blas->mBuffer);
-		vk::AccelerationStructureCreateInfoKHR createInfo = {};
-		createInfo.buffer = storageBuffer->mVkBuffer;
-		createInfo.size = sizeInfo.accelerationStructureSize;
-		createInfo.type = vk::AccelerationStructureTypeKHR::eBottomLevel;
+		const uint32 numBuilders = static_cast<uint32>(builders.size());
+		std::vector<vk::AccelerationStructureGeometryKHR> geometries(numBuilders);
+		std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildGeometryInfos(numBuilders);
+		std::vector<vk::AccelerationStructureBuildRangeInfoKHR> buildRangeInfos(numBuilders);
+		std::vector<FDeviceSize> scratchOffsets(numBuilders);
 
-		// Create blas
-		CHECK_VULKAN_RESULT(blas->mVkAccelerationStructure, mVkDevice.createAccelerationStructureKHR(createInfo));
-		SetResourceName(blas->mVkAccelerationStructure, blas->mName);
-		buildGeometryInfo.dstAccelerationStructure = blas->mVkAccelerationStructure;
+		// Every build uses its own range of one scratch buffer, so the builds don't have to wait for each other
+		const FDeviceSize scratchAlignment = mVkAccelerationStructureProperties.minAccelerationStructureScratchOffsetAlignment;
+		FDeviceSize scratchSize = 0;
 
-		blas->mDeviceAddress = mVkDevice.getAccelerationStructureAddressKHR(blas->mVkAccelerationStructure);
-		TURBO_CHECK(blas->mDeviceAddress != 0)
+		for (uint32 builderId = 0; builderId < numBuilders; ++builderId)
+		{
+			const FBLASBuilder& builder = builders[builderId];
+
+			THandle<FBLAS> handle = mBLASPool.Acquire();
+			FBLAS* blas = mBLASPool.Access(handle);
+			blas->mName = builder.mName;
+			blas->mType = EAccelerationStructureType::BLAS;
+			outHandles[builderId] = handle;
+
+			const FBuffer* vertexBuffer = AccessBuffer(builder.mVertexBuffer);
+			const FBuffer* indexBuffer = AccessBuffer(builder.mIndexBuffer);
+			TURBO_CHECK(vertexBuffer && indexBuffer)
+
+			vk::AccelerationStructureGeometryKHR& geometry = geometries[builderId];
+			geometry.geometryType = vk::GeometryTypeKHR::eTriangles;
+			geometry.flags = builder.mGeometryFlags;
+
+			vk::AccelerationStructureGeometryTrianglesDataKHR& triangleData = geometry.geometry.triangles;
+			triangleData.vertexFormat = builder.mVertexFormat;
+			triangleData.vertexData = vertexBuffer->mDeviceAddress;
+			triangleData.vertexStride = sizeof(glm::float3);
+			triangleData.maxVertex = builder.mMaxVertex != 0 ? builder.mMaxVertex : builder.mNumVertices - 1;
+			triangleData.indexType = builder.mIndexType;
+			triangleData.indexData = indexBuffer->mDeviceAddress;
+			triangleData.transformData = {};
+
+			vk::AccelerationStructureBuildGeometryInfoKHR& buildGeometryInfo = buildGeometryInfos[builderId];
+			buildGeometryInfo.type = vk::AccelerationStructureTypeKHR::eBottomLevel;
+			buildGeometryInfo.flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
+			buildGeometryInfo.mode = vk::BuildAccelerationStructureModeKHR::eBuild;
+			buildGeometryInfo.geometryCount = 1;
+			buildGeometryInfo.pGeometries = &geometry;
+
+			// Compute requested size
+			const vk::AccelerationStructureBuildSizesInfoKHR sizeInfo = mVkDevice.getAccelerationStructureBuildSizesKHR(
+				vk::AccelerationStructureBuildTypeKHR::eDevice,
+				buildGeometryInfo,
+				{builder.mNumVertices / 3}
+			);
+
+			// Create storage buffer
+			FBufferBuilder bufferBuilder = {
+				.mBufferFlags = EBufferFlags::AccelerationStructureStorage,
+				.mSize = sizeInfo.accelerationStructureSize,
+				.mName = builder.mName
+			};
+			blas->mBuffer = CreateBuffer(bufferBuilder);
+			const FBuffer* storageBuffer = AccessBuffer(blas->mBuffer);
+			vk::AccelerationStructureCreateInfoKHR createInfo = {};
+			createInfo.buffer = storageBuffer->mVkBuffer;
+			createInfo.size = sizeInfo.accelerationStructureSize;
+			createInfo.type = vk::AccelerationStructureTypeKHR::eBottomLevel;
+
+			// Create blas
+			CHECK_VULKAN_RESULT(blas->mVkAccelerationStructure, mVkDevice.createAccelerationStructureKHR(createInfo));
+			SetResourceName(blas->mVkAccelerationStructure, blas->mName);
+			buildGeometryInfo.dstAccelerationStructure = blas->mVkAccelerationStructure;
+
+			blas->mDeviceAddress = mVkDevice.getAccelerationStructureAddressKHR(blas->mVkAccelerationStructure);
+			TURBO_CHECK(blas->mDeviceAddress != 0)
+
+			scratchSize = Memory::Align(scratchSize, scratchAlignment);
+			scratchOffsets[builderId] = scratchSize;
+			scratchSize += sizeInfo.buildScratchSize;
+
+			// Fill build range info
+			vk::AccelerationStructureBuildRangeInfoKHR& buildRangeInfo = buildRangeInfos[builderId];
+			buildRangeInfo.primitiveCount = builder.mNumVertices / 3;
+			buildRangeInfo.primitiveOffset = builder.mFirstIndex * (builder.mIndexType == vk::IndexType::eUint16 ? sizeof(uint16) : sizeof(uint32));
+			buildRangeInfo.firstVertex = 0;
+			buildRangeInfo.transformOffset = 0;
+		}
 
 		// Create temp scratch data buffer
-		const FBufferBuilder scratchBufferBuilder = FBufferBuilder::CreateScratchBuffer(sizeInfo.buildScratchSize);
+		const FBufferBuilder scratchBufferBuilder = FBufferBuilder::CreateScratchBuffer(static_cast<uint32>(scratchSize));
 		const THandle<FBuffer> scratchBufferHandle = CreateBuffer(scratchBufferBuilder);
 		const FBuffer* scratchBuffer = AccessBuffer(scratchBufferHandle);
-		buildGeometryInfo.scratchData = scratchBuffer->mDeviceAddress;
 
-		// Fill build range info
-		vk::AccelerationStructureBuildRangeInfoKHR buildRangeInfo = {};
-		buildRangeInfo.primitiveCount = builder.mNumVertices / 3;
-		buildRangeInfo.primitiveOffset = 0;
-		buildRangeInfo.firstVertex = 0;
-		buildRangeInfo.transformOffset = 0;
+		std::vector<const vk::AccelerationStructureBuildRangeInfoKHR*> buildRangeInfoPtrs(numBuilders);
+		for (uint32 builderId = 0; builderId < numBuilders; ++builderId)
+		{
+			buildGeometryInfos[builderId].scratchData = scratchBuffer->mDeviceAddress + scratchOffsets[builderId];
+			buildRangeInfoPtrs[builderId] = &buildRangeInfos[builderId];
+		}
 
 		ImmediateSubmit(
 			FOnImmediateSubmit::CreateLambda([&](FCommandBuffer& cmd)
 			{
-				const vk::AccelerationStructureBuildRangeInfoKHR* buildRangeInfoPtr = &buildRangeInfo;
-				cmd.mVkCommandBuffer.buildAccelerationStructuresKHR(1, &buildGeometryInfo, &buildRangeInfoPtr);
+				cmd.mVkCommandBuffer.buildAccelerationStructuresKHR(numBuilders, buildGeometryInfos.data(), buildRangeInfoPtrs.data());
 			})
 		);
 
 		DestroyBuffer(scratchBufferHandle);
-		return handle;
 	}
 
 	THandle<FTLAS> FGPUDevice::CreateTLAS(const FTLASBuilder& builder)
 	{
-		THandle<FTLAS> handle = mTLASPool->Acquire();
-		FTLAS* tlas = mTLASPool->Access(handle);
+		THandle<FTLAS> handle = mTLASPool.Acquire();
+		FTLAS* tlas = mTLASPool.Access(handle);
 		tlas->mName = builder.mName;
 		tlas->mType = EAccelerationStructureType::TLAS;
 
@@ -784,47 +1086,123 @@ namespace Turbo
 
 		for (const THandle<FDescriptorSet>& descriptorSet : descriptorPool->mDescriptorSets)
 		{
-			mDescriptorSetPool->Release(descriptorSet);
+			mDescriptorSetPool.Release(descriptorSet);
 		}
 
 		descriptorPool->mDescriptorSets.clear();
 	}
 
-	void FGPUDevice::DestroyBuffer(THandle<FBuffer> handle)
+	vk::MemoryRequirements FGPUDevice::GetTextureMemoryRequirements(const FTextureBuilder& builder) const
 	{
-		const FBuffer* buffer = AccessBuffer(handle);
-		const FBufferCold* bufferCold = AccessBufferCold(handle);
-		TURBO_CHECK(buffer);
+		if (IsNullDevice())
+		{
+			// Typical requirements of optimal tiling images
+			vk::MemoryRequirements requirements = {};
+			requirements.alignment = 64 * Constants::kKibi;
+			requirements.size = Memory::Align(
+				static_cast<FDeviceSize>(builder.mWidth) * builder.mHeight * vk::blockSize(builder.mFormat) * static_cast<uint32>(builder.mNumSamples),
+				requirements.alignment
+			);
+			requirements.memoryTypeBits = std::numeric_limits<uint32>::max();
+			return requirements;
+		}
 
-		TURBO_LOG(LogGPUDevice, Display, "Destroying {} buffer.", bufferCold->mName);
+		const vk::ImageCreateInfo imageCreateInfo = MakeImageCreateInfo(builder);
 
-		FBufferDestroyer destroyer;
-		destroyer.mHandle = handle;
-		destroyer.mVkBuffer = buffer->mVkBuffer;
-		destroyer.mAllocation = bufferCold->mAllocation;
+		vk::DeviceImageMemoryRequirements requirementsInfo = {};
+		requirementsInfo.pCreateInfo = &imageCreateInfo;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		return mVkDevice.getImageMemoryRequirements(requirementsInfo).memoryRequirements;
 	}
 
-	void FGPUDevice::DestroyTexture(THandle<FTexture> handle)
+	vk::MemoryRequirements FGPUDevice::GetBufferMemoryRequirements(const FBufferBuilder& builder) const
 	{
-		const FTexture* texture = AccessTexture(handle);
-		TURBO_CHECK(texture)
+		if (IsNullDevice())
+		{
+			vk::MemoryRequirements requirements = {};
+			requirements.alignment = 256;
+			requirements.size = Memory::Align(static_cast<FDeviceSize>(builder.mSize), requirements.alignment);
+			requirements.memoryTypeBits = std::numeric_limits<uint32>::max();
+			return requirements;
+		}
 
-#if TURBO_BUILD_DEVELOPMENT
-		const FTextureCold* textureCold = AccessTextureCold(handle);
-		TURBO_LOG(LogGPUDevice, Display, "Destroying {} texture.", textureCold->mName);
-#endif // TURBO_BUILD_DEVELOPMENT
+		const vk::BufferCreateInfo bufferCreateInfo = MakeBufferCreateInfo(builder, mBufferQueueFamilies);
 
-		FTextureDestroyer destroyer = {};
-		destroyer.mHandle = handle;
-		destroyer.mImage = texture->mVkImage;
-		destroyer.mImageView = texture->mVkImageView;
-		destroyer.mImageAllocation = texture->mImageAllocation;
+		vk::DeviceBufferMemoryRequirements requirementsInfo = {};
+		requirementsInfo.pCreateInfo = &bufferCreateInfo;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		vk::MemoryRequirements requirements = mVkDevice.getBufferMemoryRequirements(requirementsInfo).memoryRequirements;
+
+		// Keep in sync with CreateBuffer alignment
+		if ((builder.mBufferFlags & EBufferFlags::AccelerationStructureStorage) != EBufferFlags::None)
+		{
+			requirements.alignment = glm::max(requirements.alignment, static_cast<vk::DeviceSize>(mVkAccelerationStructureProperties.minAccelerationStructureScratchOffsetAlignment));
+		}
+
+		return requirements;
+	}
+
+	vma::Allocation FGPUDevice::AllocateMemory(const vk::MemoryRequirements& requirements, FName name, EGPUMemoryCategory category)
+	{
+		TRACE_ZONE_SCOPED()
+
+		vma::AllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.requiredFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
+		allocationCreateInfo.pUserData = FGPUMemoryBudget::ToUserData(category);
+
+		vma::AllocationInfo allocationInfo;
+		vma::Allocation allocation;
+		CHECK_VULKAN_RESULT(allocation, mVmaAllocator.allocateMemory(requirements, allocationCreateInfo, allocationInfo));
+
+		mVmaAllocator.setAllocationName(allocation, name.ToCString());
+		mMemoryBudget.OnAllocated(allocation, allocationInfo, category);
+
+		return allocation;
+	}
+
+	void FGPUDevice::FreeMemory(vma::Allocation allocation)
+	{
+		TURBO_CHECK(allocation)
+
+		FMemoryDestroyer destroyer;
+		destroyer.mAllocation = allocation;
+
+		mDestroyQueue.RequestDestroy(destroyer);
+	}
+
+	void FGPUDevice::DestroyBuffer(THandle<FBuffer> handle)
+	{
+		const FBuffer* buffer = AccessBuffer(handle);
+		const FBufferCold* bufferCold = AccessBufferCold(handle);
+		TURBO_CHECK(buffer);
+
+		TURBO_LOG(LogGPUDevice, Display, "Destroying {} buffer.", bufferCold->mName);
+
+		FBufferDestroyer destroyer;
+		destroyer.mHandle = handle;
+		destroyer.mVkBuffer = buffer->mVkBuffer;
+		destroyer.mAllocation = bufferCold->mAllocation;
+
+		mDestroyQueue.RequestDestroy(destroyer);
+	}
+
+	void FGPUDevice::DestroyTexture(THandle<FTexture> handle)
+	{
+		const FTexture* texture = AccessTexture(handle);
+		TURBO_CHECK(texture)
+
+#if TURBO_BUILD_DEVELOPMENT
+		const FTextureCold* textureCold = AccessTextureCold(handle);
+		TURBO_LOG(LogGPUDevice, Display, "Destroying {} texture.", textureCold->mName);
+#endif // TURBO_BUILD_DEVELOPMENT
+
+		FTextureDestroyer destroyer = {};
+		destroyer.mHandle = handle;
+		destroyer.mImage = texture->mVkImage;
+		destroyer.mImageView = texture->mVkImageView;
+		destroyer.mImageAllocation = texture->mImageAllocation;
+
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::DestroySampler(THandle<FSampler> handle)
@@ -841,12 +1219,13 @@ namespace Turbo
 		destroyer.mHandle = handle;
 		destroyer.mVkSampler = sampler->mVkSampler;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::DestroyPipeline(THandle<FPipeline> handle)
 	{
+		CancelPipelineCompilation(handle);
+
 		const FPipeline* pipeline = AccessPipeline(handle);
 		const FPipelineCold* pipelineCold = AccessPipelineCold(handle);
 		TURBO_CHECK(pipeline && pipelineCold);
@@ -856,10 +1235,13 @@ namespace Turbo
 		destroyer.mLayout = pipeline->mVkLayout;
 		destroyer.mHandle = handle;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 
-		DestroyShaderState(pipelineCold->mShaderState);
+		// Pipelines which never finished compiling have no shader state
+		if (pipelineCold->mShaderState)
+		{
+			DestroyShaderState(pipelineCold->mShaderState);
+		}
 	}
 
 	void FGPUDevice::DestroyDescriptorPool(THandle<FDescriptorPool> handle)
@@ -871,8 +1253,7 @@ namespace Turbo
 		destroyer.mVkDescriptorPool = descriptorPool->mVkDescriptorPool;
 		destroyer.mhandle = handle;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::DestroyDescriptorSetLayout(THandle<FDescriptorSetLayout> handle)
@@ -884,8 +1265,7 @@ namespace Turbo
 		destroyer.mVkLayout = layout->mVkLayout;
 		destroyer.mHandle = layout->mHandle;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::DestroyShaderState(THandle<FShaderState> handle)
@@ -902,13 +1282,12 @@ namespace Turbo
 			destroyer.mModules[shaderId] = shaderState->mShaderStageCrateInfo[shaderId].module;
 		}
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::DestroyBLAS(THandle<FBLAS> handle)
 	{
-      FBLAS* blas = mBLASPool->Access(handle);
+      FBLAS* blas = mBLASPool.Access(handle);
       TURBO_CHECK(blas)
 
       DestroyAccelerationStructure(handle, blas);
@@ -916,7 +1295,7 @@ namespace Turbo
 
 	void FGPUDevice::DestroyTLAS(THandle<FTLAS> handle)
 	{
-      FTLAS* tlas = mTLASPool->Access(handle);
+      FTLAS* tlas = mTLASPool.Access(handle);
       TURBO_CHECK(tlas)
 
       DestroyAccelerationStructure(handle, tlas);
@@ -932,14 +1311,12 @@ namespace Turbo
 		destroyer.mHandle = handle;
 		destroyer.mType = accelerationStructure->mType;
 
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.RequestDestroy(destroyer);
+		mDestroyQueue.RequestDestroy(destroyer);
 	}
 
 	void FGPUDevice::AddOnDestroyCallback(FOnDestroy::Delegate&& delegate)
 	{
-		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		frameData.mDestroyQueue.OnDestroy().Add(std::move(delegate));
+		mDestroyQueue.AddOnDestroy(std::move(delegate));
 	}
 
 	vkb::Instance FGPUDevice::CreateVkInstance(const std::vector<cstring>& requiredExtensions)
@@ -956,6 +1333,7 @@ namespace Turbo
 			.set_app_name("TurboEngine")
 			.set_app_version(TURBO_VERSION())
 			.enable_extensions(enableExtensions)
+			.set_headless(mbHeadless)
 #if WITH_VALIDATION_LAYERS
 			.request_validation_layers(true)
 			.set_debug_callback(&FGPUDevice::ValidationLayerCallback)
@@ -974,7 +1352,7 @@ namespace Turbo
 
 	vkb::PhysicalDevice FGPUDevice::SelectPhysicalDevice(const vkb::Instance& builtInstance)
 	{
-		TURBO_CHECK(mVkWindowSurface)
+		TURBO_CHECK(mVkWindowSurface || mbHeadless)
 
 		vk::PhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.textureCompressionBC = true;
@@ -996,6 +1374,8 @@ namespace Turbo
 		device12Features.storagePushConstant8 = true;
 		device12Features.shaderInt8 = true;
 		device12Features.drawIndirectCount = true;
+		device12Features.hostQueryReset = true;
+		device12Features.timelineSemaphore = true;
 
 		vk::PhysicalDeviceVulkan13Features device13Features = {};
 		device13Features.dynamicRendering = true;
@@ -1013,16 +1393,12 @@ namespace Turbo
 
 		vkb::PhysicalDeviceSelector physicalDeviceSelector(builtInstance);
 		physicalDeviceSelector
-			.set_surface(mVkWindowSurface)
-			.require_present(true)
 			.set_required_features(deviceFeatures)
 			.set_required_features_11(device11Features)
 			.set_required_features_12(device12Features)
 			.set_required_features_13(device13Features)
 			.set_minimum_version(1, 3)
 			.prefer_gpu_device_type(vkb::PreferredDeviceType::discrete)
-		// Required to present image
-			.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
 		// Ray tracing required extensions
 			.add_required_extension(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME)
 			.add_required_extension(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME)
@@ -1033,6 +1409,19 @@ namespace Turbo
 			.add_required_extension_features(rayQueryFeatures)
 		;
 
+		// Headless devices don't present, so software implementations without WSI support can be selected
+		if (mbHeadless == false)
+		{
+			physicalDeviceSelector
+				.set_surface(mVkWindowSurface)
+				.require_present(true)
+				.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
+		else
+		{
+			physicalDeviceSelector.require_present(false);
+		}
+
 		vkb::Result<vkb::PhysicalDevice> selectPhysicalDeviceResult = physicalDeviceSelector.select();
 		TURBO_CHECK_MSG(selectPhysicalDeviceResult, "Physical device selection failed. Reason: {}", selectPhysicalDeviceResult.error().message())
 
@@ -1041,12 +1430,51 @@ namespace Turbo
 		mVkPhysicalDevice = physicalDevice;
 		TURBO_LOG(LogGPUDevice, Info, "Selected {} as primary physical device.", physicalDevice.name);
 
+		const bool bMemoryBudgetExtension = physicalDevice.enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		mMemoryBudget.Init(*this, bMemoryBudgetExtension);
+
+		// Only the GPU profiler uses pipeline statistics, secondary command buffers inherit them inside its scopes
+		vk::PhysicalDeviceFeatures pipelineStatisticsFeatures = {};
+		pipelineStatisticsFeatures.pipelineStatisticsQuery = true;
+		pipelineStatisticsFeatures.inheritedQueries = true;
+		mbPipelineStatisticsQueries = physicalDevice.enable_features_if_present(pipelineStatisticsFeatures);
+		if (mbPipelineStatisticsQueries == false)
+		{
+			TURBO_LOG(LogGPUDevice, Warn, "Pipeline statistics queries are not supported, the GPU profiler will measure only time.")
+		}
+
 		mVkPhysicalDeviceProperties = mVkPhysicalDevice.getProperties();
+		vk::PhysicalDeviceVulkan12Properties vulkan12Properties = {};
+		mVkAccelerationStructureProperties.pNext = &vulkan12Properties;
 		mVkRayTracingPipelineProperties.pNext = &mVkAccelerationStructureProperties;
 
 		vk::PhysicalDeviceProperties2 properties2 = {};
 		properties2.pNext = &mVkRayTracingPipelineProperties;
 		mVkPhysicalDevice.getProperties2(&properties2);
+		mVkAccelerationStructureProperties.pNext = nullptr;
+
+		// Bindless arrays are as large as the device allows, within the engine bounds
+		mBindlessCapacity.mNumTextures = std::min({
+			kMaxBindlessTextures,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageImages,
+			vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageImages});
+		mBindlessCapacity.mNumSamplers = std::min({
+			kMaxBindlessSamplers,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+			vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers});
+		mBindlessCapacity.mNumTLAS = std::min({
+			kMaxBindlessTLAS,
+			mVkAccelerationStructureProperties.maxDescriptorSetUpdateAfterBindAccelerationStructures,
+			mVkAccelerationStructureProperties.maxPerStageDescriptorUpdateAfterBindAccelerationStructures});
+
+		mTexturePool.SetMaxCapacity(mBindlessCapacity.mNumTextures);
+		mSamplerPool.SetMaxCapacity(mBindlessCapacity.mNumSamplers);
+		mTLASPool.SetMaxCapacity(mBindlessCapacity.mNumTLAS);
+
+		TURBO_LOG(LogGPUDevice, Info, "Bindless capacity: {} textures, {} samplers, {} TLAS.",
+			mBindlessCapacity.mNumTextures, mBindlessCapacity.mNumSamplers, mBindlessCapacity.mNumTLAS)
 
 		// Get max supported MSAA samples.
 		const vk::Flags<vk::SampleCountFlagBits> supportedSamples =
@@ -1096,18 +1524,47 @@ namespace Turbo
 			OutFamilyIndex = getQueueIndexResult.value();
 		};
 
+		// Compute and transfer work is submitted to the graphics queue when the device has no separate family for it
+		auto GetQueueOrGraphics = [&](vkb::QueueType queueType, vk::Queue& OutQueue, uint32& OutFamilyIndex)
+		{
+			if (buildDeviceResult->get_queue_index(queueType).has_value() == false)
+			{
+				TURBO_LOG(LogGPUDevice, Warn, "Device has no separate {} queue family. Using graphics queue instead.", magic_enum::enum_name(queueType))
+				OutQueue = mVkGraphicsQueue;
+				OutFamilyIndex = mVkGraphicsQueueFamilyIndex;
+				return;
+			}
+
+			GetQueue(queueType, OutQueue, OutFamilyIndex);
+		};
+
 		GetQueue(vkb::QueueType::graphics, mVkGraphicsQueue, mVkGraphicsQueueFamilyIndex);
-		GetQueue(vkb::QueueType::compute, mVkComputeQueue, mVkComputeQueueFamilyIndex);
-		GetQueue(vkb::QueueType::transfer, mVkTransferQueue, mVkTransferQueueFamilyIndex);
+		GetQueueOrGraphics(vkb::QueueType::compute, mVkComputeQueue, mVkComputeQueueFamilyIndex);
+		GetQueueOrGraphics(vkb::QueueType::transfer, mVkTransferQueue, mVkTransferQueueFamilyIndex);
+
+		mBufferQueueFamilies = {mVkGraphicsQueueFamilyIndex};
+		if (HasAsyncComputeQueue())
+		{
+			mBufferQueueFamilies.push_back(mVkComputeQueueFamilyIndex);
+		}
+		// Uploaded buffers are written by the transfer queue, so they don't need ownership transfers
+		if (std::ranges::find(mBufferQueueFamilies, mVkTransferQueueFamilyIndex) == mBufferQueueFamilies.end())
+		{
+			mBufferQueueFamilies.push_back(mVkTransferQueueFamilyIndex);
+		}
+		TURBO_LOG(LogGPUDevice, Info, "Async compute queue: {}", HasAsyncComputeQueue() ? "available" : "not available")
 
-		const uint32 presentQueueFamily = buildDeviceResult->get_queue_index(vkb::QueueType::present).value();
+		if (mbHeadless == false)
+		{
+			const uint32 presentQueueFamily = buildDeviceResult->get_queue_index(vkb::QueueType::present).value();
 
-		TURBO_CHECK_MSG(
-			mVkGraphicsQueueFamilyIndex == presentQueueFamily,
-			"Graphics queue family ({}) is different than present queue family ({}).",
-			mVkGraphicsQueueFamilyIndex,
-			presentQueueFamily
-		)
+			TURBO_CHECK_MSG(
+				mVkGraphicsQueueFamilyIndex == presentQueueFamily,
+				"Graphics queue family ({}) is different than present queue family ({}).",
+				mVkGraphicsQueueFamilyIndex,
+				presentQueueFamily
+			)
+		}
 
 		return buildDeviceResult.value();
 	}
@@ -1125,8 +1582,6 @@ namespace Turbo
 
 	vkb::Swapchain FGPUDevice::CreateSwapchain()
 	{
-		TURBO_CHECK(mVkWindowSurface)
-
 		const FWindow& window = entt::locator<FWindow>::value();
 		mFramebufferSize = window.GetFrameBufferSize();
 
@@ -1135,6 +1590,14 @@ namespace Turbo
 			mViewportSize = mFramebufferSize;
 		}
 
+		if (mbHeadless)
+		{
+			CreateHeadlessPresentImages();
+			return {};
+		}
+
+		TURBO_CHECK(mVkWindowSurface)
+
 		TURBO_LOG(LogGPUDevice, Info, "Creating swapchain of size: {}", mFramebufferSize);
 
 		vkb::SwapchainBuilder swapchainBuilder {mVkPhysicalDevice, mVkDevice, mVkWindowSurface};
@@ -1164,9 +1627,9 @@ namespace Turbo
 
 		for (uint32 imageId = 0; imageId < mNumSwapChainImages; ++imageId)
 		{
-			THandle<FTexture> handle = mTexturePool->Acquire();
-			FTexture* texture = mTexturePool->Access(handle);
-			FTextureCold* textureCold = mTexturePool->AccessCold(handle);
+			THandle<FTexture> handle = mTexturePool.Acquire();
+			FTexture* texture = mTexturePool.Access(handle);
+			FTextureCold* textureCold = mTexturePool.AccessCold(handle);
 			*texture = {};
 			texture->mVkImage = builtImages[imageId];
 			texture->mVkImageView = builtImageViews[imageId];
@@ -1191,6 +1654,39 @@ namespace Turbo
 		return builtSwapchain;
 	}
 
+	void FGPUDevice::CreateHeadlessPresentImages()
+	{
+		TURBO_LOG(LogGPUDevice, Info, "Creating headless present images of size: {}", mFramebufferSize);
+
+		// Same format as the preferred swapchain format, so pipelines don't depend on the mode
+		mVkSurfaceFormat = vk::SurfaceFormatKHR{ vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear };
+
+		// Frames don't wait for a presentation engine, one image per buffered frame is enough
+		mNumSwapChainImages = kMaxBufferedFrames;
+		static_assert(kMaxBufferedFrames <= kMaxSwapChainImages);
+
+		static const std::array<FName, kMaxSwapChainImages> swapChainTextureNames = CreateSwapChainTexturesNames();
+		for (uint32 imageId = 0; imageId < mNumSwapChainImages; ++imageId)
+		{
+			FTextureBuilder textureBuilder = {};
+			textureBuilder
+				.Init(mVkSurfaceFormat.format, ETextureType::Texture2D, ETextureFlags::RenderTarget)
+				.SetSize(glm::uint3(mFramebufferSize, 1))
+				.SetBindTexture(false)
+				.SetName(swapChainTextureNames[imageId]);
+			mSwapChainTextures[imageId] = CreateTexture(textureBuilder);
+
+			const FDeviceSize readbackSize = static_cast<FDeviceSize>(mFramebufferSize.x) * mFramebufferSize.y * vk::blockSize(mVkSurfaceFormat.format);
+			FBufferBuilder bufferBuilder = {};
+			bufferBuilder
+				.Init(EBufferFlags::CreateMapped | EBufferFlags::Readback, readbackSize)
+				.SetName(FName(fmt::format("HeadlessReadback_{}", imageId)))
+				.SetMemoryCategory(EGPUMemoryCategory::Staging);
+			mHeadlessReadbacks[imageId] = {};
+			mHeadlessReadbacks[imageId].mBuffer = CreateBuffer(bufferBuilder);
+		}
+	}
+
 	void FGPUDevice::CreateVulkanMemoryAllocator()
 	{
 		vma::AllocatorCreateInfo createInfo = {};
@@ -1199,6 +1695,10 @@ namespace Turbo
 		createInfo.setInstance(mVkInstance);
 
 		createInfo.flags = vma::AllocatorCreateFlagBits::eBufferDeviceAddress;
+		if (mMemoryBudget.HasMemoryBudgetExtension())
+		{
+			createInfo.flags |= vma::AllocatorCreateFlagBits::eExtMemoryBudget;
+		}
 
 		vma::VulkanFunctions vulkanFunctions{};
 		vulkanFunctions.setVkGetInstanceProcAddr(VULKAN_HPP_DEFAULT_DISPATCHER.vkGetInstanceProcAddr);
@@ -1209,18 +1709,66 @@ namespace Turbo
 		CHECK_VULKAN_RESULT(mVmaAllocator, vma::createAllocator(createInfo));
 	}
 
+	void FGPUDevice::CreatePipelineCache()
+	{
+		TRACE_ZONE_SCOPED()
+
+		std::vector<byte> fileData;
+		std::span<byte> driverData = {};
+		if (CVarPipelineCache.Get() && FileSystem::LoadData(kPipelineCacheFilePath, fileData))
+		{
+			driverData = ValidatePipelineCacheFile(fileData, mVkPhysicalDeviceProperties);
+			if (driverData.empty())
+			{
+				TURBO_LOG(LogGPUDevice, Warn, "Pipeline cache {} was created by a different device or driver, or is corrupted. Discarding it.", kPipelineCacheFilePath)
+			}
+		}
+
+		vk::PipelineCacheCreateInfo createInfo = {};
+		createInfo.initialDataSize = driverData.size();
+		createInfo.pInitialData = driverData.data();
+
+		vk::Result result;
+		std::tie(result, mVkPipelineCache) = mVkDevice.createPipelineCache(createInfo);
+		if (result != vk::Result::eSuccess && driverData.empty() == false)
+		{
+			// The driver may still refuse the data, start with an empty cache then
+			TURBO_LOG(LogGPUDevice, Warn, "Driver rejected the pipeline cache {} ({}). Discarding it.", kPipelineCacheFilePath, result)
+			CHECK_VULKAN_RESULT(mVkPipelineCache, mVkDevice.createPipelineCache(vk::PipelineCacheCreateInfo{}));
+		}
+		else
+		{
+			CHECK_VULKAN_HPP(result)
+		}
+
+		if (driverData.empty() == false)
+		{
+			TURBO_LOG(LogGPUDevice, Info, "Loaded pipeline cache {} ({} KiB).", kPipelineCacheFilePath, driverData.size() / Constants::kKibi)
+		}
+	}
+
+	void FGPUDevice::CreateTimelineSemaphore()
+	{
+		vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+		semaphoreTypeCreateInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+		semaphoreTypeCreateInfo.initialValue = 0;
+
+		vk::SemaphoreCreateInfo semaphoreCreateInfo = {};
+		semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		CHECK_VULKAN_RESULT(mVkTimelineSemaphore, mVkDevice.createSemaphore(semaphoreCreateInfo));
+		mLastSubmittedTimelineValue = 0;
+	}
+
 	void FGPUDevice::CreateFrameDatas()
 	{
 		TURBO_LOG(LogGPUDevice, Info, "Creating frames data")
 
-		const vk::FenceCreateInfo fenceCreateInfo = VulkanInitializers::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled);
 		const vk::SemaphoreCreateInfo semaphoreCreateInfo = VulkanInitializers::SemaphoreCreateInfo();
 
 		for (uint32 frameDataId = 0; frameDataId < mFrameDatas.size(); ++frameDataId)
 		{
 			FBufferedFrameData& frameData = mFrameDatas[frameDataId];
 
-			CHECK_VULKAN_RESULT(frameData.mCommandBufferExecutedFence, mVkDevice.createFence(fenceCreateInfo));
 			CHECK_VULKAN_RESULT(frameData.mImageAcquiredSemaphore, mVkDevice.createSemaphore(semaphoreCreateInfo));
 
 			for (uint32 threadId = 0; threadId < mNumRenderingThreads; ++threadId)
@@ -1228,10 +1776,15 @@ namespace Turbo
 				frameData.mVkCommandPools[threadId] = CreateCommandPool(mVkGraphicsQueueFamilyIndex);
 			}
 
-			frameData.mMainCommandBuffer = CreateCommandBuffer({
+			frameData.mMainCommandBuffers.push_back(CreateCommandBuffer({
 				.mVkCommandPool = frameData.mVkCommandPools[0],
 				.mName = FName(fmt::format("Frame{}", frameDataId))
-			});
+			}));
+
+			if (HasAsyncComputeQueue())
+			{
+				frameData.mVkAsyncComputeCommandPool = CreateCommandPool(mVkComputeQueueFamilyIndex);
+			}
 		}
 	}
 
@@ -1266,6 +1819,52 @@ namespace Turbo
 		return result;
 	}
 
+	template <typename... TArgs>
+	static VKAPI_ATTR void VKAPI_CALL NullCommand(VkCommandBuffer, TArgs...) {}
+
+	FGPUDevice* FGPUDevice::CreateNullDevice()
+	{
+		// Commands recorded by FCommandBuffer go nowhere, so the render graph can be executed on the CPU
+		auto& dispatcher = VULKAN_HPP_DEFAULT_DISPATCHER;
+		dispatcher.vkCmdPipelineBarrier2 = &NullCommand;
+		dispatcher.vkCmdClearColorImage = &NullCommand;
+		dispatcher.vkCmdBlitImage2 = &NullCommand;
+		dispatcher.vkCmdCopyBuffer2 = &NullCommand;
+		dispatcher.vkCmdCopyBufferToImage2 = &NullCommand;
+		dispatcher.vkCmdCopyImageToBuffer2 = &NullCommand;
+		dispatcher.vkCmdFillBuffer = &NullCommand;
+		dispatcher.vkCmdBindDescriptorSets = &NullCommand;
+		dispatcher.vkCmdBindPipeline = &NullCommand;
+		dispatcher.vkCmdBindIndexBuffer = &NullCommand;
+		dispatcher.vkCmdPushConstants = &NullCommand;
+		dispatcher.vkCmdDispatch = &NullCommand;
+		dispatcher.vkCmdBeginRendering = &NullCommand;
+		dispatcher.vkCmdEndRendering = &NullCommand;
+		dispatcher.vkCmdExecuteCommands = &NullCommand;
+		dispatcher.vkCmdSetViewport = &NullCommand;
+		dispatcher.vkCmdSetScissor = &NullCommand;
+		dispatcher.vkCmdDraw = &NullCommand;
+		dispatcher.vkCmdDrawIndexed = &NullCommand;
+		dispatcher.vkCmdDrawIndirect = &NullCommand;
+		dispatcher.vkCmdDrawIndirectCount = &NullCommand;
+		dispatcher.vkCmdBuildAccelerationStructuresKHR = &NullCommand;
+		dispatcher.vkCmdBeginDebugUtilsLabelEXT = &NullCommand;
+		dispatcher.vkCmdEndDebugUtilsLabelEXT = &NullCommand;
+
+		return new FGPUDevice();
+	}
+
+	TUniquePtr<FCommandBuffer> FGPUDevice::CreateNullCommandBuffer()
+	{
+		TURBO_CHECK(IsNullDevice())
+
+		TUniquePtr<FCommandBuffer> result = MakeUnique<FCommandBuffer>();
+		result->mGpu = this;
+		result->mbRecording = true;
+
+		return result;
+	}
+
 	vk::PresentModeKHR FGPUDevice::GetBestPresentMode()
 	{
 		TURBO_CHECK(mVkWindowSurface)
@@ -1305,12 +1904,24 @@ namespace Turbo
 
 		TURBO_LOG(LogGPUDevice, Info, "Starting Gpu Device shutdown.")
 
+		mGPUProfiler.Destroy(*this);
+		mUploadManager.Destroy(*this);
 		DestroyBindlessResources();
 		DestroyImmediateCommands();
-		DestroyFrameDatas();
+		// Headless present images are destroyed through the destroy queue, which is flushed with the frame datas
 		DestroySwapChain();
+		DestroyFrameDatas();
+		DestroyTimelineSemaphore();
+
+		for (const TUniquePtr<FPipelineCompileTask>& task : mPipelineCompileTasks)
+		{
+			WaitForPipelineCompileTask(*task);
+			DestroyCompiledPipeline(task->mResult);
+		}
+		mPipelineCompileTasks.clear();
 
 		IShaderCompiler::Get().Destroy();
+		DestroyPipelineCache();
 
 #if WITH_PROFILER
 		if (mTraceGpuCtx)
@@ -1329,7 +1940,10 @@ namespace Turbo
 			mVkDevice.destroy();
 		}
 
-		entt::locator<FWindow>::value().DestroyVulkanSurface(mVkInstance);
+		if (mbHeadless == false)
+		{
+			entt::locator<FWindow>::value().DestroyVulkanSurface(mVkInstance);
+		}
 
 		if (mVkInstance)
 		{
@@ -1353,33 +1967,62 @@ namespace Turbo
 
 		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
 
-		// Wait for previous frame fence, and reset it
-		const vk::Fence renderCompleteFence = frameData.mCommandBufferExecutedFence;
-		CHECK_VULKAN_HPP(mVkDevice.waitForFences({renderCompleteFence}, vk::True, kMaxTimeout));
-
-		frameData.mDestroyQueue.Flush(*this);
+		// Requests made between frames release resources used by the submitted work, or by the uploads which the next
+		// submission waits for
+		mDestroyQueue.Seal(mUploadManager.HasPendingUploads() ? mLastSubmittedTimelineValue + 1 : mLastSubmittedTimelineValue);
 
-		// Acquire next swapchain image
-		const vk::Semaphore imageAcquiredSemaphore = frameData.mImageAcquiredSemaphore;
+		// Wait for the last frame which used the buffered frame data
+		WaitForTimelineValue(frameData.mTimelineValue);
+		mDestroyQueue.Flush(*this, GetCompletedTimelineValue());
 
-		vk::Result acquireImageResult;
-		std::tie(acquireImageResult, mCurrentSwapchainImageIndex) =
-			mVkDevice.acquireNextImageKHR(mVkSwapchain, kMaxTimeout, imageAcquiredSemaphore, nullptr);
+		UpdatePendingPipelines();
 
-		if (acquireImageResult == vk::Result::eErrorOutOfDateKHR)
+		if (mbHeadless)
 		{
-			mbRequestedSwapchainResize = true;
-			return false;
+			// The present image of the buffered frame is free once its timeline value is waited
+			BroadcastHeadlessReadback(mBufferedFrameId);
+			mCurrentSwapchainImageIndex = mBufferedFrameId;
+		}
+		else
+		{
+			// Acquire next swapchain image
+			const vk::Semaphore imageAcquiredSemaphore = frameData.mImageAcquiredSemaphore;
+
+			vk::Result acquireImageResult;
+			std::tie(acquireImageResult, mCurrentSwapchainImageIndex) =
+				mVkDevice.acquireNextImageKHR(mVkSwapchain, kMaxTimeout, imageAcquiredSemaphore, nullptr);
+
+			if (acquireImageResult == vk::Result::eErrorOutOfDateKHR)
+			{
+				mbRequestedSwapchainResize = true;
+				return false;
+			}
 		}
 
-		CHECK_VULKAN_HPP(mVkDevice.resetFences({renderCompleteFence}));
+		// Queries of the frame are complete once its timeline value is signaled
+		mGPUProfiler.BeginFrame(*this, mBufferedFrameId);
+		mUploadManager.BeginFrame(*this, mBufferedFrameId);
+		mMemoryBudget.Update(*this);
 
 		for (uint32 threadId = 0; threadId < mNumRenderingThreads; ++threadId)
 		{
 			CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(frameData.mVkCommandPools[threadId]));
 		}
+		frameData.mNumUsedSecondaryCommandBuffers = {};
+
+		if (frameData.mVkAsyncComputeCommandPool)
+		{
+			CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(frameData.mVkAsyncComputeCommandPool));
+		}
+		frameData.mNumUsedAsyncComputeCommandBuffers = 0;
 
-		frameData.mMainCommandBuffer->Begin();
+		// Async compute work of the frame is joined with the last graphics submission, so its timeline value covers the semaphores as well
+		frameData.mNumUsedQueueSemaphores = 0;
+		frameData.mPendingMainCommandBufferWaits.clear();
+		frameData.mbSwapchainImageWaitPending = mbHeadless == false;
+
+		frameData.mMainCommandBufferId = 0;
+		frameData.mMainCommandBuffers.front()->Begin();
 
 		return true;
 	}
@@ -1388,26 +2031,45 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		const FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
 
-		FCommandBuffer& cmd = *frameData.mMainCommandBuffer;
+		FCommandBuffer& cmd = GetMainCommandBuffer();
 		TRACE_GPU_COLLECT(mTraceGpuCtx, cmd);
 
+		if (mbHeadless)
+		{
+			RecordHeadlessReadback(cmd);
+		}
+
 		cmd.End();
 
 		UpdateBindlessResources();
 
+		static const cstring kBindlessDescriptorWrites = "Bindless Descriptor Writes";
+		TRACE_PLOT_CONFIGURE(kBindlessDescriptorWrites, EPlotFormat::Number, true, true, 0xFF8000)
+		TRACE_PLOT(kBindlessDescriptorWrites, static_cast<int64>(mBindlessUpdateStats.mNumDescriptorWrites))
+		mLastFrameBindlessUpdateStats = std::exchange(mBindlessUpdateStats, {});
+
 		// Submit command buffer
-		const vk::Semaphore submitSemaphore = mSubmitSemaphores[mCurrentSwapchainImageIndex];
+		const vk::Semaphore submitSemaphore = mbHeadless ? nullptr : mSubmitSemaphores[mCurrentSwapchainImageIndex];
 
-		const vk::CommandBufferSubmitInfo bufferSubmitInfo = cmd.CreateSubmitInfo();
-		const vk::SemaphoreSubmitInfo waitSemaphore = VkInit::SemaphoreSubmitInfo(frameData.mImageAcquiredSemaphore, vk::PipelineStageFlagBits2::eColorAttachmentOutput);
+		std::vector<vk::SemaphoreSubmitInfo> waitSemaphores = MakeMainCommandBufferWaits(true);
 		const vk::SemaphoreSubmitInfo signalSemaphore = VkInit::SemaphoreSubmitInfo(submitSemaphore, vk::PipelineStageFlagBits2::eAllGraphics);
-		const vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(bufferSubmitInfo, &signalSemaphore, &waitSemaphore);
 		TRACE_ZONE(QueueSubmit, "Vulkan Queue Submit (Wait for GPU)")
-		CHECK_VULKAN_HPP(mVkGraphicsQueue.submit2(1, &submitInfo, frameData.mCommandBufferExecutedFence));
+		SubmitToGraphicsQueue(cmd, waitSemaphores, submitSemaphore ? &signalSemaphore : nullptr);
 		TRACE_ZONE_END(QueueSubmit)
 
+		frameData.mTimelineValue = mLastSubmittedTimelineValue;
+		mDestroyQueue.Seal(mLastSubmittedTimelineValue);
+
+		if (mbHeadless)
+		{
+			mBufferedFrameId = (mBufferedFrameId + 1) % kMaxBufferedFrames;
+			++mRenderedFrames;
+
+			return true;
+		}
+
 		// Present swapchain texture
 		const vk::PresentInfoKHR presentInfo = VkInit::PresentInfo(mVkSwapchain, submitSemaphore, mCurrentSwapchainImageIndex);
 
@@ -1430,6 +2092,55 @@ namespace Turbo
 		return true;
 	}
 
+	void FGPUDevice::RecordHeadlessReadback(FCommandBuffer& cmd)
+	{
+		FHeadlessReadback& readback = mHeadlessReadbacks[mBufferedFrameId];
+		readback.mbPending = false;
+
+		if (CVarHeadlessReadback.Get() == false)
+		{
+			return;
+		}
+
+		TRACE_GPU_SCOPED(*this, cmd, "Headless Readback")
+
+		// The render graph leaves the present image in eTransferSrcOptimal, the barrier only orders the copy after its writes
+		const THandle<FTexture> presentImage = GetPresentImage();
+		cmd.TransitionImage(presentImage, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eTransferSrcOptimal);
+		cmd.CopyTextureToBuffer(presentImage, readback.mBuffer, 0);
+		cmd.BufferBarrier(
+			readback.mBuffer,
+			vk::AccessFlagBits2::eTransferWrite,
+			vk::PipelineStageFlagBits2::eCopy,
+			vk::AccessFlagBits2::eHostRead,
+			vk::PipelineStageFlagBits2::eHost
+		);
+
+		readback.mFrame = mRenderedFrames;
+		readback.mbPending = true;
+	}
+
+	void FGPUDevice::BroadcastHeadlessReadback(uint32 bufferedFrameId)
+	{
+		FHeadlessReadback& readback = mHeadlessReadbacks[bufferedFrameId];
+		if (readback.mbPending == false)
+		{
+			return;
+		}
+
+		readback.mbPending = false;
+
+		InvalidateMappedBuffer(readback.mBuffer);
+		const FBuffer* buffer = AccessBuffer(readback.mBuffer);
+		const FHeadlessFrameReadback frameReadback = {
+			.mFrame = readback.mFrame,
+			.mSize = mFramebufferSize,
+			.mFormat = mVkSurfaceFormat.format,
+			.mData = std::span<const byte>(buffer->mMappedAddress, buffer->mDeviceSize),
+		};
+		OnHeadlessFrameReadback.Broadcast(frameReadback);
+	}
+
 	vk::CommandPool FGPUDevice::GetCommandPool() const
 	{
 		const enki::TaskScheduler& taskScheduler = entt::locator<enki::TaskScheduler>::value();
@@ -1438,142 +2149,439 @@ namespace Turbo
 
 	FCommandBuffer& FGPUDevice::GetMainCommandBuffer() const
 	{
-		return *mFrameDatas[mBufferedFrameId].mMainCommandBuffer;
+		const FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
+		return *frameData.mMainCommandBuffers[frameData.mMainCommandBufferId];
 	}
 
-	void FGPUDevice::UpdateBindlessResources()
+	std::vector<vk::SemaphoreSubmitInfo> FGPUDevice::MakeMainCommandBufferWaits(bool bWaitForSwapchainImage)
 	{
-		TRACE_ZONE_SCOPED()
-
-		// todo: sort `mBindlessTexturesToUpdate` to reduce memory jumps (?)
-		std::vector<vk::WriteDescriptorSet> descriptorWrites;
-		descriptorWrites.reserve(mBindlessResourcesToUpdate.size() * 2);
-
-		const FDescriptorSet* targetDescriptorSet = AccessDescriptorSet(mBindlessResourcesSet);
-
-		std::vector<vk::DescriptorImageInfo> imageBindings;
-		imageBindings.reserve(mBindlessResourcesToUpdate.size() * 2);
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
 
-		vk::WriteDescriptorSet writeDescriptorSet;
-		writeDescriptorSet.descriptorCount = 1;
-		writeDescriptorSet.dstSet = targetDescriptorSet->mVkDescriptorSet;
+		std::vector<vk::SemaphoreSubmitInfo> result;
+		result.reserve(frameData.mPendingMainCommandBufferWaits.size() + 1);
 
-		for (const FBindlessResourceUpdateRequest& request : mBindlessResourcesToUpdate)
+		if (bWaitForSwapchainImage && frameData.mbSwapchainImageWaitPending)
 		{
-			writeDescriptorSet.dstArrayElement = request.mBindingIndex;
-
-			switch (request.mType)
-			{
-			case EResourceType::RWTexture:
-				{
-					const FTexture* textureToBind = AccessTexture(THandle<FTexture>(request.mHandle));
-					writeDescriptorSet.descriptorType = vk::DescriptorType::eStorageImage;
-					writeDescriptorSet.dstBinding = BindlessResourcesBindings::kStorageImage;
-
-					vk::DescriptorImageInfo& imageBinding = imageBindings.emplace_back();
-					imageBinding.imageView = textureToBind->mVkImageView;
-					imageBinding.imageLayout = vk::ImageLayout::eGeneral;
-					imageBinding.sampler = nullptr;
-
-					writeDescriptorSet.setImageInfo(imageBinding);
+			result.push_back(VkInit::SemaphoreSubmitInfo(frameData.mImageAcquiredSemaphore, vk::PipelineStageFlagBits2::eColorAttachmentOutput));
+			frameData.mbSwapchainImageWaitPending = false;
+		}
 
-					descriptorWrites.push_back(writeDescriptorSet);
+		// Waits for the other queues make their memory writes visible to all commands
+		for (const vk::Semaphore semaphore : frameData.mPendingMainCommandBufferWaits)
+		{
+			result.push_back(VkInit::SemaphoreSubmitInfo(semaphore, vk::PipelineStageFlagBits2::eAllCommands));
+		}
+		frameData.mPendingMainCommandBufferWaits.clear();
 
-					break;
-				}
-			case EResourceType::Texture:
-				{
-					const FTexture* textureToBind = AccessTexture(THandle<FTexture>(request.mHandle));
-					writeDescriptorSet.descriptorType = vk::DescriptorType::eSampledImage;
-					writeDescriptorSet.dstBinding = BindlessResourcesBindings::kSampledImage;
+		return result;
+	}
 
-					vk::DescriptorImageInfo& imageBinding = imageBindings.emplace_back();
-					imageBinding.imageView = textureToBind->mVkImageView;
-					imageBinding.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-					imageBinding.sampler = nullptr;
+	void FGPUDevice::SubmitMainCommandBuffer(vk::Semaphore signalSemaphore, bool bWaitForSwapchainImage)
+	{
+		TRACE_ZONE_SCOPED()
 
-					writeDescriptorSet.setImageInfo(imageBinding);
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
 
-					descriptorWrites.push_back(writeDescriptorSet);
+		FCommandBuffer& cmd = GetMainCommandBuffer();
+		cmd.End();
 
-					break;
-				}
-			case EResourceType::Sampler:
-				{
-					const FSampler* samplerToBind = AccessSampler(THandle<FSampler>(request.mHandle));
-					writeDescriptorSet.descriptorType = vk::DescriptorType::eSampler;
-					writeDescriptorSet.dstBinding = BindlessResourcesBindings::kSampler;
+		UpdateBindlessResources();
 
-					vk::DescriptorImageInfo& samplerBinding = imageBindings.emplace_back();
-					samplerBinding.imageLayout = vk::ImageLayout::eUndefined;
-					samplerBinding.imageView = nullptr;
-					samplerBinding.sampler = samplerToBind->mVkSampler;
+		std::vector<vk::SemaphoreSubmitInfo> waitSemaphores = MakeMainCommandBufferWaits(bWaitForSwapchainImage);
+		const vk::SemaphoreSubmitInfo signalSemaphoreInfo = VkInit::SemaphoreSubmitInfo(signalSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+		SubmitToGraphicsQueue(cmd, waitSemaphores, signalSemaphore ? &signalSemaphoreInfo : nullptr);
 
-					writeDescriptorSet.setImageInfo(samplerBinding);
+		// Continue the frame in the next main command buffer
+		++frameData.mMainCommandBufferId;
+		if (frameData.mMainCommandBufferId == frameData.mMainCommandBuffers.size())
+		{
+			frameData.mMainCommandBuffers.push_back(CreateCommandBuffer({
+				.mVkCommandPool = frameData.mVkCommandPools[0],
+				.mName = FName(fmt::format("Frame{}Part{}", mBufferedFrameId, frameData.mMainCommandBufferId))
+			}));
+		}
 
-					descriptorWrites.push_back(writeDescriptorSet);
+		GetMainCommandBuffer().Begin();
+	}
 
-					break;
-				}
-			case Turbo::EResourceType::TLAS:
-				{
-					const FTLAS* asToBind = AccessTLAS(THandle<FTLAS>(request.mHandle));
-					writeDescriptorSet.descriptorType = vk::DescriptorType::eAccelerationStructureKHR;
-					writeDescriptorSet.dstBinding = BindlessResourcesBindings::kTLAS;
+	void FGPUDevice::SubmitToGraphicsQueue(FCommandBuffer& cmd, std::vector<vk::SemaphoreSubmitInfo>& waitSemaphores, const vk::SemaphoreSubmitInfo* signalSemaphore)
+	{
+		// Commands may use resources uploaded so far, the upload acquire barriers go before them
+		std::array<vk::CommandBufferSubmitInfo, 2> bufferSubmitInfos;
+		uint32 numBufferSubmitInfos = 0;
+		if (const FCommandBuffer* uploadAcquireCmd = mUploadManager.PrepareGraphicsSubmit(*this, waitSemaphores))
+		{
+			bufferSubmitInfos[numBufferSubmitInfos++] = uploadAcquireCmd->CreateSubmitInfo();
+		}
+		bufferSubmitInfos[numBufferSubmitInfos++] = cmd.CreateSubmitInfo();
+
+		// Every submission advances the device timeline, the binary semaphore is signaled along with it
+		std::array<vk::SemaphoreSubmitInfo, 2> signalSemaphoreInfos;
+		uint32 numSignalSemaphoreInfos = 0;
+		signalSemaphoreInfos[numSignalSemaphoreInfos] = VkInit::SemaphoreSubmitInfo(mVkTimelineSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+		signalSemaphoreInfos[numSignalSemaphoreInfos++].value = ++mLastSubmittedTimelineValue;
+		if (signalSemaphore)
+		{
+			signalSemaphoreInfos[numSignalSemaphoreInfos++] = *signalSemaphore;
+		}
 
-               auto* asWrite = mPerFrameArena.AllocateDefaulted<vk::WriteDescriptorSetAccelerationStructureKHR>();
-               asWrite->accelerationStructureCount = 1;
-               asWrite->pAccelerationStructures = &asToBind->mVkAccelerationStructure;
+		vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(bufferSubmitInfos.front(), nullptr, nullptr);
+		submitInfo.setCommandBufferInfoCount(numBufferSubmitInfos);
+		submitInfo.setPCommandBufferInfos(bufferSubmitInfos.data());
+		submitInfo.setSignalSemaphoreInfoCount(numSignalSemaphoreInfos);
+		submitInfo.setPSignalSemaphoreInfos(signalSemaphoreInfos.data());
+		submitInfo.setWaitSemaphoreInfos(waitSemaphores);
+		CHECK_VULKAN_HPP(mVkGraphicsQueue.submit2(1, &submitInfo, nullptr));
+	}
 
-					writeDescriptorSet.pNext = asWrite;
+	void FGPUDevice::AddMainCommandBufferWait(vk::Semaphore semaphore)
+	{
+		TURBO_CHECK(semaphore)
+		mFrameDatas[mBufferedFrameId].mPendingMainCommandBufferWaits.push_back(semaphore);
+	}
 
-					descriptorWrites.push_back(writeDescriptorSet);
-					break;
-				}
-			default: ;
-			}
-		}
+	FCommandBuffer& FGPUDevice::BeginAsyncComputeCommandBuffer()
+	{
+		TURBO_CHECK(HasAsyncComputeQueue())
 
-		if (descriptorWrites.empty() == false)
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
+		if (frameData.mNumUsedAsyncComputeCommandBuffers == frameData.mAsyncComputeCommandBuffers.size())
 		{
-			mVkDevice.updateDescriptorSets(descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+			frameData.mAsyncComputeCommandBuffers.push_back(CreateCommandBuffer({
+				.mVkCommandPool = frameData.mVkAsyncComputeCommandPool,
+				.mName = FName(fmt::format("Frame{}AsyncCompute{}", mBufferedFrameId, frameData.mAsyncComputeCommandBuffers.size()))
+			}));
 		}
 
-		mBindlessResourcesToUpdate.clear();
+		FCommandBuffer& cmd = *frameData.mAsyncComputeCommandBuffers[frameData.mNumUsedAsyncComputeCommandBuffers++];
+		cmd.Begin();
+		return cmd;
 	}
 
-	void FGPUDevice::WaitIdle() const
+	void FGPUDevice::SubmitAsyncComputeCommandBuffer(FCommandBuffer& cmd, std::span<const vk::Semaphore> waitSemaphores, vk::Semaphore signalSemaphore)
+	{
+		TRACE_ZONE_SCOPED()
+
+		cmd.End();
+
+		UpdateBindlessResources();
+
+		std::vector<vk::SemaphoreSubmitInfo> waitSemaphoreInfos;
+		waitSemaphoreInfos.reserve(waitSemaphores.size() + 1);
+		for (const vk::Semaphore semaphore : waitSemaphores)
+		{
+			waitSemaphoreInfos.push_back(VkInit::SemaphoreSubmitInfo(semaphore, vk::PipelineStageFlagBits2::eAllCommands));
+		}
+
+		// The TLAS build and the culling read uploaded buffers (instances, mesh bounds) on this queue
+		mUploadManager.PrepareAsyncComputeSubmit(*this, waitSemaphoreInfos);
+
+		const vk::CommandBufferSubmitInfo bufferSubmitInfo = cmd.CreateSubmitInfo();
+		const vk::SemaphoreSubmitInfo signalSemaphoreInfo = VkInit::SemaphoreSubmitInfo(signalSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+		vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(bufferSubmitInfo, signalSemaphore ? &signalSemaphoreInfo : nullptr, nullptr);
+		submitInfo.setWaitSemaphoreInfos(waitSemaphoreInfos);
+		CHECK_VULKAN_HPP(mVkComputeQueue.submit2(1, &submitInfo, nullptr));
+	}
+
+	vk::Semaphore FGPUDevice::AcquireQueueSemaphore()
+	{
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
+		if (frameData.mNumUsedQueueSemaphores == frameData.mQueueSemaphores.size())
+		{
+			const vk::SemaphoreCreateInfo semaphoreCreateInfo = VulkanInitializers::SemaphoreCreateInfo();
+			vk::Semaphore semaphore;
+			CHECK_VULKAN_RESULT(semaphore, mVkDevice.createSemaphore(semaphoreCreateInfo));
+
+			frameData.mQueueSemaphores.push_back(semaphore);
+		}
+
+		return frameData.mQueueSemaphores[frameData.mNumUsedQueueSemaphores++];
+	}
+
+	FCommandBuffer& FGPUDevice::BeginSecondaryCommandBuffer(const FRenderingAttachments* inheritedRendering, EMSAASamples numSamples)
+	{
+		const enki::TaskScheduler& taskScheduler = entt::locator<enki::TaskScheduler>::value();
+		const uint32 threadId = taskScheduler.GetThreadNum();
+		TURBO_CHECK(threadId < mNumRenderingThreads)
+
+		FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
+		std::vector<TUniquePtr<FCommandBuffer>>& commandBuffers = frameData.mSecondaryCommandBuffers[threadId];
+		uint32& numUsedCommandBuffers = frameData.mNumUsedSecondaryCommandBuffers[threadId];
+
+		if (numUsedCommandBuffers == commandBuffers.size())
+		{
+			commandBuffers.push_back(CreateCommandBuffer({
+				.mVkCommandPool = frameData.mVkCommandPools[threadId],
+				.bPrimaryBuffer = false,
+				.mName = FName(fmt::format("Frame{}Thread{}Secondary{}", mBufferedFrameId, threadId, commandBuffers.size()))
+			}));
+		}
+
+		FCommandBuffer& cmd = *commandBuffers[numUsedCommandBuffers++];
+
+		std::array<vk::Format, kMaxColorAttachments> colorFormats;
+		vk::CommandBufferInheritanceRenderingInfo renderingInheritanceInfo = {};
+		vk::CommandBufferInheritanceInfo inheritanceInfo = {};
+		// Secondary command buffers may run inside a GPU profiler pipeline statistics scope
+		if (mbPipelineStatisticsQueries)
+		{
+			inheritanceInfo.pipelineStatistics = FGPUProfiler::GetPipelineStatisticsFlags();
+		}
+
+		if (inheritedRendering)
+		{
+			for (uint32 attachmentId = 0; attachmentId < inheritedRendering->mNumColorAttachments; ++attachmentId)
+			{
+				colorFormats[attachmentId] = AccessTextureCold(inheritedRendering->mColorAttachments[attachmentId].mTexture)->GetFormat();
+			}
+
+			renderingInheritanceInfo.colorAttachmentCount = inheritedRendering->mNumColorAttachments;
+			renderingInheritanceInfo.pColorAttachmentFormats = colorFormats.data();
+			if (inheritedRendering->mDepthAttachment.mTexture.IsValid())
+			{
+				// BeginRendering binds only the depth aspect, so there is no stencil attachment to inherit
+				renderingInheritanceInfo.depthAttachmentFormat = AccessTextureCold(inheritedRendering->mDepthAttachment.mTexture)->GetFormat();
+			}
+			renderingInheritanceInfo.rasterizationSamples = ToVkSampleCountBits(numSamples);
+
+			inheritanceInfo.pNext = &renderingInheritanceInfo;
+		}
+
+		cmd.BeginSecondary(inheritanceInfo);
+		return cmd;
+	}
+
+	void FGPUDevice::EndSecondaryCommandBuffer(FCommandBuffer& cmd)
+	{
+		cmd.End();
+	}
+
+	static uint32 GetBindlessBinding(EResourceType type)
+	{
+		switch (type)
+		{
+		case EResourceType::Texture: return BindlessResourcesBindings::kSampledImage;
+		case EResourceType::RWTexture: return BindlessResourcesBindings::kStorageImage;
+		case EResourceType::Sampler: return BindlessResourcesBindings::kSampler;
+		case EResourceType::TLAS: return BindlessResourcesBindings::kTLAS;
+		default:
+			TURBO_UNINPLEMENTED()
+			return kInvalidBinding;
+		}
+	}
+
+	void FGPUDevice::UpdateBindlessResources()
+	{
+		TRACE_ZONE_SCOPED()
+
+		if (mBindlessResourcesToUpdate.empty())
+		{
+			return;
+		}
+
+		const size_t numRequests = mBindlessResourcesToUpdate.size();
+		mBindlessUpdateStats.mNumRequests += static_cast<uint32>(numRequests);
+
+		// Requests of the same array element end up next to each other, in the order they were made
+		std::ranges::stable_sort(mBindlessResourcesToUpdate, {},
+			[](const FBindlessResourceUpdateRequest& request)
+			{
+				return std::make_pair(GetBindlessBinding(request.mType), request.mBindingIndex);
+			});
+
+		// Writes point into these, they must not reallocate once the writes are built
+		std::vector<vk::WriteDescriptorSet>& descriptorWrites = mBindlessUpdateScratch.mDescriptorWrites;
+		std::vector<vk::DescriptorImageInfo>& imageInfos = mBindlessUpdateScratch.mImageInfos;
+		std::vector<vk::AccelerationStructureKHR>& accelerationStructures = mBindlessUpdateScratch.mAccelerationStructures;
+		std::vector<vk::WriteDescriptorSetAccelerationStructureKHR>& accelerationStructureWrites = mBindlessUpdateScratch.mAccelerationStructureWrites;
+		descriptorWrites.clear();
+		descriptorWrites.reserve(numRequests);
+		imageInfos.clear();
+		imageInfos.reserve(numRequests);
+		accelerationStructures.clear();
+		accelerationStructures.reserve(numRequests);
+		accelerationStructureWrites.clear();
+		accelerationStructureWrites.reserve(numRequests);
+
+		const FDescriptorSet* targetDescriptorSet = AccessDescriptorSet(mBindlessResourcesSet);
+
+		for (size_t requestId = 0; requestId < numRequests; ++requestId)
+		{
+			const FBindlessResourceUpdateRequest& request = mBindlessResourcesToUpdate[requestId];
+			const uint32 binding = GetBindlessBinding(request.mType);
+
+			if (requestId + 1 < numRequests)
+			{
+				const FBindlessResourceUpdateRequest& nextRequest = mBindlessResourcesToUpdate[requestId + 1];
+				if (GetBindlessBinding(nextRequest.mType) == binding && nextRequest.mBindingIndex == request.mBindingIndex)
+				{
+					++mBindlessUpdateStats.mNumSkippedRequests;
+					continue;
+				}
+			}
+
+			FBindlessDescriptor descriptor = {};
+			vk::DescriptorType descriptorType = {};
+			vk::ImageLayout imageLayout = vk::ImageLayout::eUndefined;
+
+			switch (request.mType)
+			{
+			case EResourceType::Texture:
+			case EResourceType::RWTexture:
+				{
+					const FTexture* textureToBind = AccessTexture(THandle<FTexture>(request.mHandle));
+					descriptor.mVkImageView = textureToBind ? textureToBind->mVkImageView : nullptr;
+
+					const bool bStorage = request.mType == EResourceType::RWTexture;
+					descriptorType = bStorage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+					imageLayout = bStorage ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal;
+					break;
+				}
+			case EResourceType::Sampler:
+				{
+					const FSampler* samplerToBind = AccessSampler(THandle<FSampler>(request.mHandle));
+					descriptor.mVkSampler = samplerToBind ? samplerToBind->mVkSampler : nullptr;
+					descriptorType = vk::DescriptorType::eSampler;
+					break;
+				}
+			case EResourceType::TLAS:
+				{
+					const FTLAS* asToBind = AccessTLAS(THandle<FTLAS>(request.mHandle));
+					descriptor.mVkAccelerationStructure = asToBind ? asToBind->mVkAccelerationStructure : nullptr;
+					descriptorType = vk::DescriptorType::eAccelerationStructureKHR;
+					break;
+				}
+			default: ;
+			}
+
+			// Resource was destroyed before its descriptor was written
+			if (descriptor == FBindlessDescriptor())
+			{
+				++mBindlessUpdateStats.mNumSkippedRequests;
+				continue;
+			}
+
+			std::vector<FBindlessDescriptor>& writtenDescriptors = mBindlessDescriptors[binding];
+			if (writtenDescriptors.size() <= request.mBindingIndex)
+			{
+				writtenDescriptors.resize(request.mBindingIndex + 1);
+			}
+
+			if (writtenDescriptors[request.mBindingIndex] == descriptor)
+			{
+				++mBindlessUpdateStats.mNumSkippedRequests;
+				continue;
+			}
+			writtenDescriptors[request.mBindingIndex] = descriptor;
+
+			// Contiguous array elements of the binding extend the previous write
+			const bool bExtendsPreviousWrite =
+				descriptorWrites.empty() == false
+				&& descriptorWrites.back().dstBinding == binding
+				&& descriptorWrites.back().dstArrayElement + descriptorWrites.back().descriptorCount == request.mBindingIndex;
+
+			if (bExtendsPreviousWrite == false)
+			{
+				vk::WriteDescriptorSet& writeDescriptorSet = descriptorWrites.emplace_back();
+				writeDescriptorSet.dstSet = targetDescriptorSet->mVkDescriptorSet;
+				writeDescriptorSet.dstBinding = binding;
+				writeDescriptorSet.dstArrayElement = request.mBindingIndex;
+				writeDescriptorSet.descriptorCount = 0;
+				writeDescriptorSet.descriptorType = descriptorType;
+
+				if (request.mType == EResourceType::TLAS)
+				{
+					vk::WriteDescriptorSetAccelerationStructureKHR& asWrite = accelerationStructureWrites.emplace_back();
+					asWrite.accelerationStructureCount = 0;
+					asWrite.pAccelerationStructures = accelerationStructures.data() + accelerationStructures.size();
+					writeDescriptorSet.pNext = &asWrite;
+				}
+				else
+				{
+					writeDescriptorSet.pImageInfo = imageInfos.data() + imageInfos.size();
+				}
+			}
+
+			vk::WriteDescriptorSet& writeDescriptorSet = descriptorWrites.back();
+			++writeDescriptorSet.descriptorCount;
+
+			if (request.mType == EResourceType::TLAS)
+			{
+				accelerationStructures.push_back(descriptor.mVkAccelerationStructure);
+				++accelerationStructureWrites.back().accelerationStructureCount;
+			}
+			else
+			{
+				vk::DescriptorImageInfo& imageInfo = imageInfos.emplace_back();
+				imageInfo.imageView = descriptor.mVkImageView;
+				imageInfo.imageLayout = imageLayout;
+				imageInfo.sampler = descriptor.mVkSampler;
+			}
+		}
+
+		if (descriptorWrites.empty() == false)
+		{
+			mVkDevice.updateDescriptorSets(descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+		}
+
+		mBindlessUpdateStats.mNumDescriptorWrites += static_cast<uint32>(imageInfos.size() + accelerationStructures.size());
+		mBindlessUpdateStats.mNumWriteEntries += static_cast<uint32>(descriptorWrites.size());
+
+		mBindlessResourcesToUpdate.clear();
+	}
+
+	void FGPUDevice::ForgetBindlessDescriptor(uint32 binding, uint32 arrayElement)
+	{
+		std::vector<FBindlessDescriptor>& writtenDescriptors = mBindlessDescriptors[binding];
+		if (arrayElement < writtenDescriptors.size())
+		{
+			writtenDescriptors[arrayElement] = {};
+		}
+	}
+
+	void FGPUDevice::WaitIdle() const
 	{
 		TRACE_ZONE_SCOPED()
 
 		CHECK_VULKAN_HPP(mVkDevice.waitIdle());
 	}
 
+	uint64 FGPUDevice::GetCompletedTimelineValue() const
+	{
+		uint64 completedValue;
+		CHECK_VULKAN_RESULT(completedValue, mVkDevice.getSemaphoreCounterValue(mVkTimelineSemaphore));
+		return completedValue;
+	}
+
+	void FGPUDevice::WaitForTimelineValue(uint64 value) const
+	{
+		TRACE_ZONE_SCOPED()
+
+		vk::SemaphoreWaitInfo waitInfo = {};
+		waitInfo.setSemaphores(mVkTimelineSemaphore);
+		waitInfo.setValues(value);
+		CHECK_VULKAN_HPP(mVkDevice.waitSemaphores(waitInfo, kMaxTimeout));
+	}
+
 	void FGPUDevice::ImmediateSubmit(const FOnImmediateSubmit& immediateSubmitDelegate)
 	{
 		if (immediateSubmitDelegate.IsBound())
 		{
 			TRACE_ZONE_SCOPED_N("Immediate submit")
 
-			CHECK_VULKAN_HPP(mVkDevice.resetFences({mImmediateCommandsFence}));
 			CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(mImmediateCommandsPool));
 
 			mImmediateCommandsBuffer->Begin();
 			immediateSubmitDelegate.Execute(*mImmediateCommandsBuffer);
 			mImmediateCommandsBuffer->End();
 
-			const vk::CommandBufferSubmitInfo bufferSubmitInfo = mImmediateCommandsBuffer->CreateSubmitInfo();
-			const vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(bufferSubmitInfo, nullptr, nullptr);
-
 			{
 				TRACE_ZONE_SCOPED_N("Queue submit")
-				CHECK_VULKAN_HPP(mVkGraphicsQueue.submit2(1, &submitInfo, mImmediateCommandsFence));
+				std::vector<vk::SemaphoreSubmitInfo> waitSemaphores;
+				SubmitToGraphicsQueue(*mImmediateCommandsBuffer, waitSemaphores, nullptr);
 			}
 
-			{
-				TRACE_ZONE_SCOPED_N("Wait for fence")
-				CHECK_VULKAN_HPP(mVkDevice.waitForFences({mImmediateCommandsFence}, vk::True, kDefaultTimeout));
-			}
+			WaitForTimelineValue(mLastSubmittedTimelineValue);
 		}
 	}
 
@@ -1581,16 +2589,12 @@ namespace Turbo
 	{
 		TRACE_ZONE_SCOPED()
 
-		const FBufferedFrameData& frameData = mFrameDatas[mBufferedFrameId];
-		FCommandBuffer& cmd = *frameData.mMainCommandBuffer;
+		FCommandBuffer& cmd = GetMainCommandBuffer();
 		cmd.End();
 
-		const vk::CommandBufferSubmitInfo cmdSubmitInfo = cmd.CreateSubmitInfo();
-		vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(cmdSubmitInfo, nullptr, nullptr);
-
-		CHECK_VULKAN_HPP(mVkGraphicsQueue.submit2(1, &submitInfo, frameData.mCommandBufferExecutedFence))
-		CHECK_VULKAN_HPP(mVkDevice.waitForFences({frameData.mCommandBufferExecutedFence}, vk::True, kMaxTimeout));
-		CHECK_VULKAN_HPP(mVkDevice.resetFences({frameData.mCommandBufferExecutedFence}));
+		std::vector<vk::SemaphoreSubmitInfo> waitSemaphores;
+		SubmitToGraphicsQueue(cmd, waitSemaphores, nullptr);
+		WaitForTimelineValue(mLastSubmittedTimelineValue);
 
 		cmd.Begin();
 
@@ -1599,13 +2603,19 @@ namespace Turbo
 
 	void FGPUDevice::DestroySwapChain()
 	{
+		if (mbHeadless)
+		{
+			DestroyHeadlessPresentImages();
+			return;
+		}
+
 		mVkDevice.destroySwapchainKHR(mVkSwapchain);
 
 		for (uint32 imageId = 0; imageId < mNumSwapChainImages; ++imageId)
 		{
 			FTexture* texture = AccessTexture(mSwapChainTextures[imageId]);
 			mVkDevice.destroyImageView(texture->mVkImageView);
-			mTexturePool->Release(mSwapChainTextures[imageId]);
+			mTexturePool.Release(mSwapChainTextures[imageId]);
 
 			mVkDevice.destroySemaphore(mSubmitSemaphores[imageId]);
 		}
@@ -1618,18 +2628,28 @@ namespace Turbo
 		mNumSwapChainImages = 0;
 	}
 
+	void FGPUDevice::DestroyHeadlessPresentImages()
+	{
+		for (uint32 imageId = 0; imageId < mNumSwapChainImages; ++imageId)
+		{
+			BroadcastHeadlessReadback(imageId);
+
+			DestroyTexture(mSwapChainTextures[imageId]);
+			DestroyBuffer(mHeadlessReadbacks[imageId].mBuffer);
+
+			mSwapChainTextures[imageId].Reset();
+			mHeadlessReadbacks[imageId] = {};
+		}
+
+		mNumSwapChainImages = 0;
+	}
+
 	void FGPUDevice::DestroyFrameDatas()
 	{
 		TURBO_LOG(LogGPUDevice, Info, "Destroying frames data")
 
 		for (FBufferedFrameData& frameData : mFrameDatas)
 		{
-			if (frameData.mCommandBufferExecutedFence)
-			{
-				mVkDevice.destroyFence(frameData.mCommandBufferExecutedFence);
-				frameData.mCommandBufferExecutedFence = nullptr;
-			}
-
 			if (frameData.mImageAcquiredSemaphore)
 			{
 				mVkDevice.destroySemaphore(frameData.mImageAcquiredSemaphore);
@@ -1640,19 +2660,39 @@ namespace Turbo
 			{
 				CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(frameData.mVkCommandPools[renderThreadId]));
 				mVkDevice.destroyCommandPool(frameData.mVkCommandPools[renderThreadId]);
+				frameData.mSecondaryCommandBuffers[renderThreadId].clear();
+			}
+			frameData.mMainCommandBuffers.clear();
+
+			if (frameData.mVkAsyncComputeCommandPool)
+			{
+				CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(frameData.mVkAsyncComputeCommandPool));
+				mVkDevice.destroyCommandPool(frameData.mVkAsyncComputeCommandPool);
+				frameData.mVkAsyncComputeCommandPool = nullptr;
+				frameData.mAsyncComputeCommandBuffers.clear();
+			}
+
+			for (const vk::Semaphore semaphore : frameData.mQueueSemaphores)
+			{
+				mVkDevice.destroySemaphore(semaphore);
 			}
+			frameData.mQueueSemaphores.clear();
 		}
 
 		FlushDestroyQueues();
 	}
 
-	void FGPUDevice::DestroyImmediateCommands()
+	void FGPUDevice::DestroyTimelineSemaphore()
 	{
-		if (mImmediateCommandsFence)
+		if (mVkTimelineSemaphore)
 		{
-			mVkDevice.destroyFence(mImmediateCommandsFence);
+			mVkDevice.destroySemaphore(mVkTimelineSemaphore);
+			mVkTimelineSemaphore = nullptr;
 		}
+	}
 
+	void FGPUDevice::DestroyImmediateCommands()
+	{
 		if (mImmediateCommandsPool)
 		{
 			CHECK_VULKAN_HPP(mVkDevice.resetCommandPool(mImmediateCommandsPool));
@@ -1671,12 +2711,45 @@ namespace Turbo
 		mBindlessResourcesSet.Reset();
 	}
 
-	void FGPUDevice::FlushDestroyQueues()
+	void FGPUDevice::DestroyPipelineCache()
 	{
-		for (FBufferedFrameData& frameData : mFrameDatas)
+		TRACE_ZONE_SCOPED()
+
+		if (!mVkPipelineCache)
+		{
+			return;
+		}
+
+		if (CVarPipelineCache.Get())
 		{
-			frameData.mDestroyQueue.Flush(*this);
+			std::vector<uint8> driverData;
+			CHECK_VULKAN_RESULT(driverData, mVkDevice.getPipelineCacheData(mVkPipelineCache));
+
+			FPipelineCacheFileHeader header = MakePipelineCacheFileHeader(mVkPhysicalDeviceProperties);
+			header.mDataSize = static_cast<uint32>(driverData.size());
+			header.mDataHash = CoreUtils::Adler32Hash(std::as_writable_bytes(std::span(driverData)));
+
+			std::vector<byte> fileData(sizeof(FPipelineCacheFileHeader) + driverData.size());
+			std::memcpy(fileData.data(), &header, sizeof(FPipelineCacheFileHeader));
+			std::memcpy(fileData.data() + sizeof(FPipelineCacheFileHeader), driverData.data(), driverData.size());
+
+			if (FileSystem::SaveData(kPipelineCacheFilePath, fileData))
+			{
+				TURBO_LOG(LogGPUDevice, Info, "Saved pipeline cache {} ({} KiB).", kPipelineCacheFilePath, driverData.size() / Constants::kKibi)
+			}
+			else
+			{
+				TURBO_LOG(LogGPUDevice, Warn, "Failed to save pipeline cache {}.", kPipelineCacheFilePath)
+			}
 		}
+
+		mVkDevice.destroyPipelineCache(mVkPipelineCache);
+		mVkPipelineCache = nullptr;
+	}
+
+	void FGPUDevice::FlushDestroyQueues()
+	{
+		mDestroyQueue.FlushAll(*this);
 	}
 
 	void FGPUDevice::InitVulkanTexture(const FTextureBuilder& builder, THandle<FTexture> handle)
@@ -1698,52 +2771,30 @@ namespace Turbo
 		textureCold->mHandle = handle;
 		textureCold->mName = builder.mName;
 
-		vk::ImageCreateInfo imageCreateInfo = {};
-		imageCreateInfo.format = builder.mFormat;
-		imageCreateInfo.imageType = ToVkImageType(builder.mType);
-		imageCreateInfo.extent.width = builder.mWidth;
-		imageCreateInfo.extent.height = builder.mHeight;
-		imageCreateInfo.extent.depth = builder.mDepth;
-		imageCreateInfo.mipLevels = builder.mNumMips;
-		imageCreateInfo.arrayLayers = 1;
-		imageCreateInfo.samples = ToVkSampleCountBits(builder.mNumSamples);
-		imageCreateInfo.tiling = vk::ImageTiling::eOptimal;
-
-		const bool bRenderTarget = (builder.mFlags & ETextureFlags::RenderTarget) != ETextureFlags::Invalid;
-		const bool bStorageImage = (builder.mFlags & ETextureFlags::StorageImage) != ETextureFlags::Invalid;
-
-		using EImgUsage = vk::ImageUsageFlagBits;
-
-		imageCreateInfo.usage = EImgUsage::eSampled;
-		imageCreateInfo.usage |= bStorageImage ? EImgUsage::eStorage : static_cast<EImgUsage>(0);
-		if (TextureFormat::HasDepthOrStencil(builder.mFormat))
-		{
-			imageCreateInfo.usage |= EImgUsage::eDepthStencilAttachment;
-		}
-		else
-		{
-			imageCreateInfo.usage |= EImgUsage::eTransferDst;
-			imageCreateInfo.usage |= bRenderTarget || bStorageImage ? EImgUsage::eTransferSrc : static_cast<EImgUsage>(0);
-			imageCreateInfo.usage |= bRenderTarget ? EImgUsage::eColorAttachment : static_cast<EImgUsage>(0);
-		}
-
-		if ((builder.mFlags & ETextureFlags::TransientAttachment) != ETextureFlags::Invalid)
+		if (IsNullDevice())
 		{
-			TURBO_CHECK(bRenderTarget)
-			imageCreateInfo.usage |= EImgUsage::eTransientAttachment;
+			TURBO_CHECK_MSG(builder.mAliasedMemory == nullptr, "Null device textures have no memory.")
+			return;
 		}
 
-		imageCreateInfo.sharingMode = vk::SharingMode::eExclusive;
-		imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
+		const vk::ImageCreateInfo imageCreateInfo = MakeImageCreateInfo(builder);
 
 		vma::AllocationCreateInfo imageAllocationInfo = {};
 		imageAllocationInfo.usage = vma::MemoryUsage::eAutoPreferDevice;
 		imageAllocationInfo.requiredFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
+		imageAllocationInfo.pUserData = FGPUMemoryBudget::ToUserData(builder.mMemoryCategory);
 
+		if (builder.mAliasedMemory)
+		{
+			CHECK_VULKAN_RESULT(texture->mVkImage, mVmaAllocator.createAliasingImage2(builder.mAliasedMemory, builder.mAliasedMemoryOffset, imageCreateInfo))
+		}
+		else
 		{
+			vma::AllocationInfo allocationInfo;
 			std::pair<vma::Allocation, vk::Image> allocationResult;
-			CHECK_VULKAN_RESULT(allocationResult, mVmaAllocator.createImage(imageCreateInfo, imageAllocationInfo))
+			CHECK_VULKAN_RESULT(allocationResult, mVmaAllocator.createImage(imageCreateInfo, imageAllocationInfo, allocationInfo))
 			std::tie(texture->mImageAllocation, texture->mVkImage) = allocationResult;
+			mMemoryBudget.OnAllocated(texture->mImageAllocation, allocationInfo, builder.mMemoryCategory);
 		}
 
 		SetResourceName(texture->mVkImage, textureCold->mName);
@@ -1775,33 +2826,29 @@ namespace Turbo
 		}
 	}
 
-	void FGPUDevice::InitPipeline(const FPipelineBuilder& builder, THandle<FPipeline> handle)
+	void FGPUDevice::CompilePipeline(const FPipelineBuilder& builder, vk::DescriptorSetLayout bindlessLayout, FCompiledPipeline& outPipeline) const
 	{
-		FPipeline* pipeline = mPipelinePool->Access(handle);
-		FPipelineCold* pipelineCold = mPipelinePool->AccessCold(handle);
-		TURBO_CHECK(pipeline && pipelineCold)
-
-		THandle<FShaderState> shaderStateHandle = CreateShaderState(builder.mShaderStateBuilder);
-		TURBO_CHECK(shaderStateHandle)
+		TRACE_ZONE_SCOPED()
 
-		FShaderState* shaderState = AccessShaderState(shaderStateHandle);
-		TURBO_CHECK(shaderState)
+		outPipeline = {};
+		if (CompileShaderState(builder.mShaderStateBuilder, outPipeline.mShaderState) == false)
+		{
+			TURBO_LOG(LogGPUDevice, Error, "Failed to compile shaders of {} pipeline.", builder.mName)
+			return;
+		}
 
-		pipelineCold->mPipelineBuilder = new FPipelineBuilder(builder);
-		pipelineCold->mShaderState = shaderStateHandle;
-		pipeline->mbGraphicsPipeline = shaderState->mbGraphicsPipeline;
+		const FShaderState& shaderState = outPipeline.mShaderState;
 
 		std::array<vk::DescriptorSetLayout, kMaxDescriptorSetLayouts> vkLayouts;
 
 		// Bind bindless descriptor set layout
-		const FDescriptorSetLayout* bindlessSetLayout = mDescriptorSetLayoutPool->Access(mBindlessResourcesLayout);
-		vkLayouts[0] = bindlessSetLayout->mVkLayout;
+		vkLayouts[0] = bindlessLayout;
 
 		vk::PushConstantRange pushConstantRange = {};
 		pushConstantRange.offset = 0;
 		pushConstantRange.size = builder.mPushConstantSize;
 
-		if (shaderState->mbGraphicsPipeline)
+		if (shaderState.mbGraphicsPipeline)
 		{
 			pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eAllGraphics;
 		}
@@ -1815,15 +2862,23 @@ namespace Turbo
 		pipelineLayoutCreateInfo.setLayoutCount = builder.mNumActiveLayouts;
 		pipelineLayoutCreateInfo.setPushConstantRanges({pushConstantRange});
 
-		CHECK_VULKAN_RESULT(pipeline->mVkLayout, mVkDevice.createPipelineLayout(pipelineLayoutCreateInfo))
+		CHECK_VULKAN_RESULT(outPipeline.mVkLayout, mVkDevice.createPipelineLayout(pipelineLayoutCreateInfo))
+
+		// Layouts created from the same set layouts and push constant range are compatible. Layouts with additional
+		// sets are keyed by their handle, they are compatible only with themselves.
+		CoreUtils::HashCombine(outPipeline.mLayoutKey, static_cast<uint32>(pushConstantRange.stageFlags), pushConstantRange.size, bindlessLayout);
+		if (builder.mNumActiveLayouts > 1)
+		{
+			CoreUtils::HashCombine(outPipeline.mLayoutKey, outPipeline.mVkLayout);
+		}
 
-		if (shaderState->mbGraphicsPipeline)
+		if (shaderState.mbGraphicsPipeline)
 		{
 			vk::StructureChain<vk::GraphicsPipelineCreateInfo, vk::PipelineRenderingCreateInfo> chain;
 			vk::GraphicsPipelineCreateInfo& pipelineCreateInfo = chain.get<vk::GraphicsPipelineCreateInfo>();
-			pipelineCreateInfo.pStages = shaderState->mShaderStageCrateInfo.data();
-			pipelineCreateInfo.stageCount = shaderState->mNumActiveShaders;
-			pipelineCreateInfo.layout = pipeline->mVkLayout;
+			pipelineCreateInfo.pStages = shaderState.mShaderStageCrateInfo.data();
+			pipelineCreateInfo.stageCount = shaderState.mNumActiveShaders;
+			pipelineCreateInfo.layout = outPipeline.mVkLayout;
 
 			// Vertex input
 			constexpr vk::PipelineVertexInputStateCreateInfo vertexInputState = {};
@@ -1933,64 +2988,190 @@ namespace Turbo
 				"It must be at least 1 attachment.")
 
 			TRACE_ZONE(DriverCreatePipeline, "Driver: Create Pipeline")
-			CHECK_VULKAN_RESULT(pipeline->mVkPipeline, mVkDevice.createGraphicsPipeline(nullptr, pipelineCreateInfo));
+			CHECK_VULKAN_RESULT(outPipeline.mVkPipeline, mVkDevice.createGraphicsPipeline(mVkPipelineCache, pipelineCreateInfo));
 			TRACE_ZONE_END(DriverCreatePipeline)
-			pipeline->mVkBindPoint = vk::PipelineBindPoint::eGraphics;
+			outPipeline.mVkBindPoint = vk::PipelineBindPoint::eGraphics;
 		}
 		else
 		{
 			vk::ComputePipelineCreateInfo pipelineCreateInfo = {};
-			pipelineCreateInfo.stage = shaderState->mShaderStageCrateInfo[0];
-			pipelineCreateInfo.layout = pipeline->mVkLayout;
+			pipelineCreateInfo.stage = shaderState.mShaderStageCrateInfo[0];
+			pipelineCreateInfo.layout = outPipeline.mVkLayout;
 
 			TRACE_ZONE(DriverCreatePipeline, "Driver: Create Pipeline")
-			CHECK_VULKAN_RESULT(pipeline->mVkPipeline, mVkDevice.createComputePipeline(nullptr, pipelineCreateInfo));
+			CHECK_VULKAN_RESULT(outPipeline.mVkPipeline, mVkDevice.createComputePipeline(mVkPipelineCache, pipelineCreateInfo));
 			TRACE_ZONE_END(DriverCreatePipeline)
-			pipeline->mVkBindPoint = vk::PipelineBindPoint::eCompute;
+			outPipeline.mVkBindPoint = vk::PipelineBindPoint::eCompute;
+		}
+
+		SetResourceName(outPipeline.mVkPipeline, builder.mName);
+		outPipeline.mbSucceeded = true;
+	}
+
+	void FGPUDevice::RequestPipelineCompilation(THandle<FPipeline> handle)
+	{
+		const FPipelineCold* pipelineCold = AccessPipelineCold(handle);
+		TURBO_CHECK(pipelineCold && pipelineCold->mPipelineBuilder)
+
+		TUniquePtr<FPipelineCompileTask> task = std::make_unique<FPipelineCompileTask>();
+		task->mGpu = this;
+		task->mBuilder = *pipelineCold->mPipelineBuilder;
+		task->mHandle = handle;
+		task->mBindlessLayout = mDescriptorSetLayoutPool.Access(mBindlessResourcesLayout)->mVkLayout;
+		// Don't delay the frame work, e.g. the parallel render graph recording
+		task->m_Priority = enki::TASK_PRIORITY_LOW;
+
+		entt::locator<enki::TaskScheduler>::value().AddTaskSetToPipe(task.get());
+		mPipelineCompileTasks.push_back(std::move(task));
+	}
+
+	void FGPUDevice::FinishPipeline(THandle<FPipeline> handle, FCompiledPipeline& compiledPipeline)
+	{
+		FPipeline* pipeline = mPipelinePool.Access(handle);
+		FPipelineCold* pipelineCold = mPipelinePool.AccessCold(handle);
+		TURBO_CHECK(pipeline && pipelineCold)
+
+		if (compiledPipeline.mbSucceeded == false)
+		{
+			if (pipeline->mState == EPipelineState::Pending)
+			{
+				pipeline->mState = EPipelineState::Failed;
+			}
+			else
+			{
+				TURBO_LOG(LogGPUDevice, Error, "Failed to recompile {} pipeline. Keeping the previous one.", pipelineCold->mPipelineBuilder->GetName())
+			}
+
+			DestroyCompiledPipeline(compiledPipeline);
+			return;
+		}
+
+		if (pipeline->mVkPipeline)
+		{
+			// Frames in flight can still use the previous pipeline
+			FPipelineDestroyer destroyer = {};
+			destroyer.mPipeline = pipeline->mVkPipeline;
+			destroyer.mLayout = pipeline->mVkLayout;
+
+			mDestroyQueue.RequestDestroy(destroyer);
+
+			DestroyShaderState(pipelineCold->mShaderState);
+		}
+
+		pipelineCold->mShaderState = mShaderStatePool.Acquire();
+		TURBO_CHECK(pipelineCold->mShaderState)
+		*mShaderStatePool.Access(pipelineCold->mShaderState) = compiledPipeline.mShaderState;
+
+		pipeline->mVkPipeline = compiledPipeline.mVkPipeline;
+		pipeline->mVkLayout = compiledPipeline.mVkLayout;
+		pipeline->mLayoutKey = compiledPipeline.mLayoutKey;
+		pipeline->mVkBindPoint = compiledPipeline.mVkBindPoint;
+		pipeline->mbGraphicsPipeline = compiledPipeline.mShaderState.mbGraphicsPipeline;
+		pipeline->mState = EPipelineState::Ready;
+	}
+
+	void FGPUDevice::UpdatePendingPipelines()
+	{
+		TRACE_ZONE_SCOPED()
+
+		std::erase_if(mPipelineCompileTasks, [&](const TUniquePtr<FPipelineCompileTask>& task)
+		{
+			if (task->GetIsComplete() == false)
+			{
+				return false;
+			}
+
+			FinishPipeline(task->mHandle, task->mResult);
+			return true;
+		});
+	}
+
+	void FGPUDevice::WaitForPendingPipelines()
+	{
+		TRACE_ZONE_SCOPED()
+
+		for (const TUniquePtr<FPipelineCompileTask>& task : mPipelineCompileTasks)
+		{
+			WaitForPipelineCompileTask(*task);
+		}
+
+		UpdatePendingPipelines();
+	}
+
+	bool FGPUDevice::IsPipelineReady(THandle<FPipeline> handle) const
+	{
+		const FPipeline* pipeline = AccessPipeline(handle);
+		return pipeline && pipeline->mState == EPipelineState::Ready;
+	}
+
+	void FGPUDevice::DestroyCompiledPipeline(const FCompiledPipeline& compiledPipeline)
+	{
+		for (uint32 shaderId = 0; shaderId < compiledPipeline.mShaderState.mNumActiveShaders; ++shaderId)
+		{
+			mVkDevice.destroyShaderModule(compiledPipeline.mShaderState.mShaderStageCrateInfo[shaderId].module);
 		}
 
-		SetResourceName(pipeline->mVkPipeline, builder.mName);
+		mVkDevice.destroyPipelineLayout(compiledPipeline.mVkLayout);
+		mVkDevice.destroyPipeline(compiledPipeline.mVkPipeline);
+	}
+
+	void FGPUDevice::CancelPipelineCompilation(THandle<FPipeline> handle)
+	{
+		const auto taskIt = std::ranges::find_if(mPipelineCompileTasks,
+			[&](const TUniquePtr<FPipelineCompileTask>& task) { return task->mHandle == handle; });
+
+		if (taskIt != mPipelineCompileTasks.end())
+		{
+			WaitForPipelineCompileTask(**taskIt);
+			DestroyCompiledPipeline((*taskIt)->mResult);
+			mPipelineCompileTasks.erase(taskIt);
+		}
 	}
 
 	void FGPUDevice::UploadTextureUsingStagingBuffer(THandle<FTexture> handle, std::span<const byte> data)
 	{
-		// Create staging buffer
-		const FBufferBuilder stagingBufferBuilder = FBufferBuilder::CreateStagingBuffer(data.size());
+		mUploadManager.UploadTexture(*this, handle, data);
+	}
 
-		const THandle<FBuffer> stagingBuffer = CreateBuffer(stagingBufferBuilder);
-		void* stagingMappedAddress = AccessBuffer(stagingBuffer)->mMappedAddress;
-		std::memcpy(stagingMappedAddress, data.data(), data.size_bytes());
+	void FGPUDevice::InvalidateMappedBuffer(THandle<FBuffer> handle)
+	{
+		const FBufferCold* bufferCold = AccessBufferCold(handle);
+		TURBO_CHECK((bufferCold->mBufferFlags & EBufferFlags::Readback) != EBufferFlags::None)
 
-		// copy buffer to image
-		ImmediateSubmit(FOnImmediateSubmit::CreateLambda(
-				[&](FCommandBuffer& cmd)
-				{
-					cmd.TransitionImage(handle, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-					cmd.CopyBufferToTexture(stagingBuffer, handle, 0, 0);
-					cmd.TransitionImage(handle, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-				})
-		);
+		// No-op on host coherent memory
+		CHECK_VULKAN_HPP(mVmaAllocator.invalidateAllocation(bufferCold->mAllocation, 0, vk::WholeSize));
+	}
 
-		DestroyBuffer(stagingBuffer);
+	void FGPUDevice::FlushMappedBuffer(THandle<FBuffer> handle)
+	{
+		const FBufferCold* bufferCold = AccessBufferCold(handle);
+		CHECK_VULKAN_HPP(mVmaAllocator.flushAllocation(bufferCold->mAllocation, 0, vk::WholeSize));
 	}
 
 	void FGPUDevice::DestroyBufferImmediate(const FBufferDestroyer& destroyer)
 	{
+		mMemoryBudget.OnFreed(*this, destroyer.mAllocation);
 		mVmaAllocator.destroyBuffer(destroyer.mVkBuffer, destroyer.mAllocation);
-		mBufferPool->Release(destroyer.mHandle);
+		mBufferPool.Release(destroyer.mHandle);
 	}
 
 	void FGPUDevice::DestroyTextureImmediate(const FTextureDestroyer& destroyer)
 	{
+		mMemoryBudget.OnFreed(*this, destroyer.mImageAllocation);
 		mVmaAllocator.destroyImage(destroyer.mImage, destroyer.mImageAllocation);
 		mVkDevice.destroyImageView(destroyer.mImageView);
-		mTexturePool->Release(destroyer.mHandle);
+		mTexturePool.Release(destroyer.mHandle);
+
+		// A new view may get the same Vulkan handle, its descriptor still has to be written
+		ForgetBindlessDescriptor(BindlessResourcesBindings::kSampledImage, destroyer.mHandle.GetIndex());
+		ForgetBindlessDescriptor(BindlessResourcesBindings::kStorageImage, destroyer.mHandle.GetIndex());
 	}
 
 	void FGPUDevice::DestroySamplerImmediate(const FSamplerDestroyer& destroyer)
 	{
 		mVkDevice.destroySampler(destroyer.mVkSampler);
-		mSamplerPool->Release(destroyer.mHandle);
+		mSamplerPool.Release(destroyer.mHandle);
+		ForgetBindlessDescriptor(BindlessResourcesBindings::kSampler, destroyer.mHandle.GetIndex());
 	}
 
 	void FGPUDevice::DestroyPipelineImmediate(const FPipelineDestroyer& destroyer)
@@ -1999,24 +3180,28 @@ namespace Turbo
 		mVkDevice.destroyPipelineLayout(destroyer.mLayout);
 		mVkDevice.destroyPipeline(destroyer.mPipeline);
 
-		FPipelineCold* pipelineCold = AccessPipelineCold(destroyer.mHandle);
-		delete pipelineCold->mPipelineBuilder;
-		pipelineCold = nullptr;
+		// Replaced Vulkan objects of a recompiled pipeline don't own the handle
+		if (destroyer.mHandle)
+		{
+			FPipelineCold* pipelineCold = AccessPipelineCold(destroyer.mHandle);
+			delete pipelineCold->mPipelineBuilder;
+			pipelineCold->mPipelineBuilder = nullptr;
 
-		mPipelinePool->Release(destroyer.mHandle);
+			mPipelinePool.Release(destroyer.mHandle);
+		}
 	}
 
 	void FGPUDevice::DestroyDescriptorPoolImmediate(const FDescriptorPoolDestroyer& destroyer)
 	{
 		ResetDescriptorPool(destroyer.mhandle);
 		mVkDevice.destroyDescriptorPool(destroyer.mVkDescriptorPool);
-		mDescriptorPoolPool->Release(destroyer.mhandle);
+		mDescriptorPoolPool.Release(destroyer.mhandle);
 	}
 
 	void FGPUDevice::DestroyDescriptorSetLayoutImmediate(const FDescriptorSetLayoutDestroyer& destroyer)
 	{
 		mVkDevice.destroyDescriptorSetLayout(destroyer.mVkLayout);
-		mDescriptorSetLayoutPool->Release(destroyer.mHandle);
+		mDescriptorSetLayoutPool.Release(destroyer.mHandle);
 	}
 
 	void FGPUDevice::DestroyShaderStateImmediate(const FShaderStateDestroyer& destroyer)
@@ -2026,7 +3211,7 @@ namespace Turbo
 			mVkDevice.destroyShaderModule(destroyer.mModules[shaderId]);
 		}
 
-		mShaderStatePool->Release(destroyer.mHandle);
+		mShaderStatePool.Release(destroyer.mHandle);
 	}
 
 	void FGPUDevice::DestroyAccelerationStructureImmediate(const FAccelerationStructureDestroyer& destroyer)
@@ -2046,10 +3231,11 @@ namespace Turbo
 		switch (destroyer.mType)
 		{
 		case Turbo::EAccelerationStructureType::BLAS:
-   		mBLASPool->Release(THandle<FBLAS>(destroyer.mHandle));
+   		mBLASPool.Release(THandle<FBLAS>(destroyer.mHandle));
 			break;
 		case Turbo::EAccelerationStructureType::TLAS:
-   		mTLASPool->Release(THandle<FTLAS>(destroyer.mHandle));
+   		mTLASPool.Release(THandle<FTLAS>(destroyer.mHandle));
+			ForgetBindlessDescriptor(BindlessResourcesBindings::kTLAS, destroyer.mHandle.GetIndex());
 			break;
 		default:
 			TURBO_UNINPLEMENTED()
@@ -2057,6 +3243,12 @@ namespace Turbo
 		}
 	}
 
+	void FGPUDevice::FreeMemoryImmediate(const FMemoryDestroyer& destroyer)
+	{
+		mMemoryBudget.OnFreed(*this, destroyer.mAllocation);
+		mVmaAllocator.freeMemory(destroyer.mAllocation);
+	}
+
 	VkBool32 FGPUDevice::ValidationLayerCallback(
 		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 		VkDebugUtilsMessageTypeFlagsEXT messageType,
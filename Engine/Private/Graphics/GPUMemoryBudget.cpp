@@ -0,0 +1,154 @@
+#include "Graphics/GPUMemoryBudget.h"
+
+#include "Debug/IConsoleManager.h"
+#include "Graphics/GPUDevice.h"
+
+namespace Turbo
+{
+	static TAutoConsoleVariable<float> CVarMemoryBudgetThreshold(
+		"gpu.memory.budgetThreshold",
+		0.9f,
+		"Fraction of a heap budget above which FGPUMemoryBudget::OnOverBudget is broadcast."
+	);
+
+	static FAutoConsoleCommand gGPUMemoryCommand(
+		"gpu.memory",
+		"Prints usage and budget of the memory heaps and the memory allocated by each category.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FGPUMemoryBudget& memoryBudget = entt::locator<FGPUDevice>::value().GetMemoryBudget();
+
+			std::string message = fmt::format("{:<24}{:>14}{:>14}{:>14}{:>14}", "Heap", "Usage MiB", "Budget MiB", "Blocks MiB", "Allocs MiB");
+			for (const FGPUHeapBudget& heap : memoryBudget.GetHeapBudgets())
+			{
+				message += fmt::format("\n{:<24}{:>14}{:>14}{:>14}{:>14}{}",
+					fmt::format("{} ({})", heap.mHeapIndex, heap.mbDeviceLocal ? "device" : "host"),
+					heap.mUsage / Constants::kMebi,
+					heap.mBudget / Constants::kMebi,
+					heap.mBlockBytes / Constants::kMebi,
+					heap.mAllocationBytes / Constants::kMebi,
+					heap.mbOverThreshold ? "   over threshold" : "");
+			}
+
+			message += fmt::format("\n\n{:<24}{:>14}{:>14}", "Category", "Size MiB", "Allocations");
+			for (uint32 categoryId = 0; categoryId < kNumGPUMemoryCategories; ++categoryId)
+			{
+				const EGPUMemoryCategory category = static_cast<EGPUMemoryCategory>(categoryId);
+				message += fmt::format("\n{:<24}{:>14}{:>14}",
+					magic_enum::enum_name(category),
+					memoryBudget.GetCategorySize(category) / Constants::kMebi,
+					memoryBudget.GetNumCategoryAllocations(category));
+			}
+
+			if (memoryBudget.HasMemoryBudgetExtension() == false)
+			{
+				message += "\nVK_EXT_memory_budget is not supported, budgets are estimated from the heap sizes.";
+			}
+
+			consoleManager.Print(message);
+		}));
+
+	void FGPUMemoryBudget::Init(FGPUDevice& gpu, bool bMemoryBudgetExtension)
+	{
+		mbMemoryBudgetExtension = bMemoryBudgetExtension;
+
+		const vk::PhysicalDeviceMemoryProperties memoryProperties = gpu.GetVkPhysicalDevice().getMemoryProperties();
+
+		mHeapBudgets.resize(memoryProperties.memoryHeapCount);
+		mHeapPlotNames.resize(memoryProperties.memoryHeapCount * 2);
+		for (uint32 heapId = 0; heapId < memoryProperties.memoryHeapCount; ++heapId)
+		{
+			FGPUHeapBudget& heap = mHeapBudgets[heapId];
+			heap.mHeapIndex = heapId;
+			heap.mbDeviceLocal = static_cast<bool>(memoryProperties.memoryHeaps[heapId].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+
+			mHeapPlotNames[heapId * 2] = fmt::format("GPU Heap {} Usage", heapId);
+			mHeapPlotNames[heapId * 2 + 1] = fmt::format("GPU Heap {} Budget", heapId);
+		}
+
+		TURBO_LOG(LogGPUMemory, Info, "{} memory heaps, VK_EXT_memory_budget: {}", mHeapBudgets.size(), mbMemoryBudgetExtension);
+	}
+
+	void FGPUMemoryBudget::Update(FGPUDevice& gpu)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const vma::Allocator allocator = gpu.GetVmaAllocator();
+		allocator.setCurrentFrameIndex(gpu.GetNumRenderedFrames());
+
+		std::vector<vma::Budget> budgets(mHeapBudgets.size());
+		allocator.getHeapBudgets(budgets.data());
+
+		const float threshold = CVarMemoryBudgetThreshold.Get();
+		for (uint32 heapId = 0; heapId < mHeapBudgets.size(); ++heapId)
+		{
+			FGPUHeapBudget& heap = mHeapBudgets[heapId];
+			const vma::Budget& budget = budgets[heapId];
+			heap.mUsage = budget.usage;
+			heap.mBudget = budget.budget;
+			heap.mBlockBytes = budget.statistics.blockBytes;
+			heap.mAllocationBytes = budget.statistics.allocationBytes;
+
+			TRACE_PLOT_CONFIGURE(mHeapPlotNames[heapId * 2].c_str(), EPlotFormat::Memory, true, true, 0x4080FF)
+			TRACE_PLOT(mHeapPlotNames[heapId * 2].c_str(), static_cast<int64>(heap.mUsage))
+			TRACE_PLOT_CONFIGURE(mHeapPlotNames[heapId * 2 + 1].c_str(), EPlotFormat::Memory, true, false, 0xFF4040)
+			TRACE_PLOT(mHeapPlotNames[heapId * 2 + 1].c_str(), static_cast<int64>(heap.mBudget))
+
+			const bool bWasOverThreshold = heap.mbOverThreshold;
+			heap.mbOverThreshold = heap.mBudget > 0 && static_cast<double>(heap.mUsage) > static_cast<double>(heap.mBudget) * threshold;
+
+			// Listeners react once per crossing, not every frame the heap stays above the threshold
+			if (heap.mbOverThreshold && bWasOverThreshold == false)
+			{
+				TURBO_LOG(LogGPUMemory, Warn, "Heap {} usage {} MiB is over {:.0f}% of its budget {} MiB.",
+					heapId, heap.mUsage / Constants::kMebi, threshold * 100.f, heap.mBudget / Constants::kMebi);
+				OnOverBudget.Broadcast(heap);
+			}
+		}
+
+#if WITH_PROFILER
+		for (uint32 categoryId = 0; categoryId < kNumGPUMemoryCategories; ++categoryId)
+		{
+			static constexpr std::array<cstring, kNumGPUMemoryCategories> kCategoryPlotNames = {
+				"GPU Memory Other",
+				"GPU Memory Transient RT",
+				"GPU Memory Mesh",
+				"GPU Memory Texture",
+				"GPU Memory BLAS/TLAS",
+				"GPU Memory Staging",
+				"GPU Memory Material",
+				"GPU Memory Scene",
+			};
+
+			TRACE_PLOT_CONFIGURE(kCategoryPlotNames[categoryId], EPlotFormat::Memory, true, true, 0x40C040)
+			TRACE_PLOT(kCategoryPlotNames[categoryId], static_cast<int64>(mCategorySizes[categoryId].load(std::memory_order_relaxed)))
+		}
+#endif // WITH_PROFILER
+	}
+
+	void FGPUMemoryBudget::OnAllocated(vma::Allocation allocation, const vma::AllocationInfo& allocationInfo, EGPUMemoryCategory category)
+	{
+		TURBO_CHECK(allocation)
+		TURBO_CHECK(allocationInfo.pUserData == ToUserData(category))
+
+		const uint32 categoryId = static_cast<uint32>(category);
+		mCategorySizes[categoryId].fetch_add(allocationInfo.size, std::memory_order_relaxed);
+		mNumCategoryAllocations[categoryId].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void FGPUMemoryBudget::OnFreed(FGPUDevice& gpu, vma::Allocation allocation)
+	{
+		// Aliased resources don't own their memory
+		if (allocation == nullptr)
+		{
+			return;
+		}
+
+		const vma::AllocationInfo allocationInfo = gpu.GetVmaAllocator().getAllocationInfo(allocation);
+		const uint32 categoryId = static_cast<uint32>(reinterpret_cast<uintptr_t>(allocationInfo.pUserData));
+		TURBO_CHECK(categoryId < kNumGPUMemoryCategories)
+
+		mCategorySizes[categoryId].fetch_sub(allocationInfo.size, std::memory_order_relaxed);
+		mNumCategoryAllocations[categoryId].fetch_sub(1, std::memory_order_relaxed);
+	}
+} // Turbo
@@ -0,0 +1,359 @@
+#include "Graphics/GPUProfiler.h"
+
+#include "Debug/IConsoleManager.h"
+#include "Graphics/CommandBuffer.h"
+#include "Graphics/GPUDevice.h"
+#include "vulkan/vulkan_to_string.hpp"
+
+namespace Turbo
+{
+	static TAutoConsoleVariable<bool> CVarGPUProfiler(
+		"gpu.profiler",
+		true,
+		"Measures GPU time of render graph passes with timestamp queries."
+	);
+
+	static TAutoConsoleVariable<bool> CVarGPUProfilerPipelineStatistics(
+		"gpu.profiler.pipelineStatistics",
+		false,
+		"Collects pipeline statistics (primitives, shader invocations) of graphics queue passes. Adds some GPU overhead."
+	);
+
+	static FAutoConsoleCommand gGPUProfilerStatsCommand(
+		"gpu.profiler.stats",
+		"Prints GPU time of render graph passes averaged over the last frames.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FGPUProfiler& profiler = entt::locator<FGPUDevice>::value().GetGPUProfiler();
+
+			std::string message = fmt::format("{:<48}{:>10}{:>10}{:>10}", "Scope", "Avg ms", "P95 ms", "P99 ms");
+			if (profiler.IsPipelineStatisticsEnabled())
+			{
+				message += fmt::format("{:>14}{:>14}{:>14}{:>14}", "Primitives", "VS", "FS", "CS");
+			}
+
+			float totalTimeMs = 0.f;
+			for (const FGPUProfilerScopeStats& stats : profiler.GetScopeStats())
+			{
+				message += fmt::format("\n{:<48}{:>10.3f}{:>10.3f}{:>10.3f}", stats.mName, stats.mAverageTimeMs, stats.mP95TimeMs, stats.mP99TimeMs);
+				if (profiler.IsPipelineStatisticsEnabled())
+				{
+					for (const uint64 statistic : stats.mAveragePipelineStatistics)
+					{
+						message += fmt::format("{:>14}", statistic);
+					}
+				}
+
+				totalTimeMs += stats.mAverageTimeMs;
+			}
+
+			message += fmt::format("\n{:<48}{:>10.3f}", "Total", totalTimeMs);
+			consoleManager.Print(message);
+		}));
+
+	static FAutoConsoleCommand gGPUProfilerResetCommand(
+		"gpu.profiler.reset",
+		"Clears the GPU profiler history.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			entt::locator<FGPUDevice>::value().GetGPUProfiler().ResetStats();
+		}));
+
+	vk::QueryPipelineStatisticFlags FGPUProfiler::GetPipelineStatisticsFlags()
+	{
+		return vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives
+			| vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations
+			| vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations
+			| vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+	}
+
+	void FGPUProfiler::Init(FGPUDevice& gpu)
+	{
+		TURBO_LOG(LogGPUProfiler, Info, "Initializing GPU profiler.")
+
+		const vk::PhysicalDevice physicalDevice = gpu.GetVkPhysicalDevice();
+		mTimestampPeriodNs = physicalDevice.getProperties().limits.timestampPeriod;
+
+		const std::vector<vk::QueueFamilyProperties> queueFamilies = physicalDevice.getQueueFamilyProperties();
+		auto getTimestampMask = [&](uint32 queueFamily) -> uint64
+		{
+			const uint32 validBits = queueFamilies[queueFamily].timestampValidBits;
+			return validBits >= 64 ? std::numeric_limits<uint64>::max() : (uint64{1} << validBits) - 1;
+		};
+
+		mTimestampMasks[static_cast<uint32>(EQueueType::Graphics)] = getTimestampMask(gpu.GetGraphicsQueueFamily());
+		mTimestampMasks[static_cast<uint32>(EQueueType::Compute)] = getTimestampMask(gpu.GetComputeQueueFamily());
+		mTimestampMasks[static_cast<uint32>(EQueueType::CopyTransfer)] = getTimestampMask(gpu.GetTransferQueueFamily());
+		mbPipelineStatisticsSupported = gpu.HasPipelineStatisticsQueries();
+
+		const vk::Device device = gpu.GetVkDevice();
+		for (FFrameQueries& frameQueries : mFrameQueries)
+		{
+			vk::QueryPoolCreateInfo timestampPoolCreateInfo = {};
+			timestampPoolCreateInfo.queryType = vk::QueryType::eTimestamp;
+			timestampPoolCreateInfo.queryCount = kMaxGPUProfilerScopes * 2;
+			CHECK_VULKAN_RESULT(frameQueries.mTimestampPool, device.createQueryPool(timestampPoolCreateInfo));
+			device.resetQueryPool(frameQueries.mTimestampPool, 0, timestampPoolCreateInfo.queryCount);
+
+			if (mbPipelineStatisticsSupported == false)
+			{
+				continue;
+			}
+
+			vk::QueryPoolCreateInfo pipelineStatisticsPoolCreateInfo = {};
+			pipelineStatisticsPoolCreateInfo.queryType = vk::QueryType::ePipelineStatistics;
+			pipelineStatisticsPoolCreateInfo.queryCount = kMaxGPUProfilerScopes;
+			pipelineStatisticsPoolCreateInfo.pipelineStatistics = GetPipelineStatisticsFlags();
+			CHECK_VULKAN_RESULT(frameQueries.mPipelineStatisticsPool, device.createQueryPool(pipelineStatisticsPoolCreateInfo));
+			device.resetQueryPool(frameQueries.mPipelineStatisticsPool, 0, pipelineStatisticsPoolCreateInfo.queryCount);
+		}
+
+		mTimestampResults.resize(kMaxGPUProfilerScopes * 2 * 2);
+		mPipelineStatisticsResults.resize(kMaxGPUProfilerScopes * (kNumGPUPipelineStatistics + 1));
+	}
+
+	void FGPUProfiler::Destroy(FGPUDevice& gpu)
+	{
+		const vk::Device device = gpu.GetVkDevice();
+		for (FFrameQueries& frameQueries : mFrameQueries)
+		{
+			device.destroyQueryPool(frameQueries.mTimestampPool);
+			device.destroyQueryPool(frameQueries.mPipelineStatisticsPool);
+			frameQueries.mTimestampPool = nullptr;
+			frameQueries.mPipelineStatisticsPool = nullptr;
+			frameQueries.mNumScopes = 0;
+		}
+
+		mCurrentFrameQueries = nullptr;
+		mbEnabled = false;
+	}
+
+	void FGPUProfiler::BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId)
+	{
+		TRACE_ZONE_SCOPED()
+
+		FFrameQueries& frameQueries = mFrameQueries[bufferedFrameId];
+		const uint32 numScopes = glm::min(frameQueries.mNumScopes.load(), kMaxGPUProfilerScopes);
+		if (numScopes > 0)
+		{
+			ReadBackQueries(gpu, frameQueries);
+
+			const vk::Device device = gpu.GetVkDevice();
+			device.resetQueryPool(frameQueries.mTimestampPool, 0, numScopes * 2);
+			if (mbPipelineStatisticsSupported)
+			{
+				device.resetQueryPool(frameQueries.mPipelineStatisticsPool, 0, numScopes);
+			}
+		}
+
+		frameQueries.mNumScopes = 0;
+		frameQueries.mFrame = gpu.GetNumRenderedFrames();
+
+		mCurrentFrameQueries = &frameQueries;
+		mbEnabled = CVarGPUProfiler.Get();
+		mbPipelineStatisticsEnabled = mbEnabled && mbPipelineStatisticsSupported && CVarGPUProfilerPipelineStatistics.Get();
+	}
+
+	uint32 FGPUProfiler::BeginScope(FCommandBuffer& cmd, EQueueType queue, FName name)
+	{
+		if (mbEnabled == false || mTimestampMasks[static_cast<uint32>(queue)] == 0)
+		{
+			return kInvalidScope;
+		}
+
+		FFrameQueries& frameQueries = *mCurrentFrameQueries;
+		const uint32 scopeId = frameQueries.mNumScopes.fetch_add(1, std::memory_order_relaxed);
+		if (scopeId >= kMaxGPUProfilerScopes)
+		{
+			return kInvalidScope;
+		}
+
+		// Pipeline statistics pool counts graphics stages, so it can't be used on a compute only queue
+		FScope& scope = frameQueries.mScopes[scopeId];
+		scope.mName = name;
+		scope.mQueue = queue;
+		scope.mbPipelineStatistics = mbPipelineStatisticsEnabled && queue == EQueueType::Graphics;
+
+		const vk::CommandBuffer vkCommandBuffer = cmd.GetVkCommandBuffer();
+		vkCommandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, frameQueries.mTimestampPool, scopeId * 2);
+		if (scope.mbPipelineStatistics)
+		{
+			vkCommandBuffer.beginQuery(frameQueries.mPipelineStatisticsPool, scopeId, {});
+		}
+
+		return scopeId;
+	}
+
+	void FGPUProfiler::EndScope(FCommandBuffer& cmd, uint32 scopeId)
+	{
+		if (scopeId == kInvalidScope)
+		{
+			return;
+		}
+
+		FFrameQueries& frameQueries = *mCurrentFrameQueries;
+		const vk::CommandBuffer vkCommandBuffer = cmd.GetVkCommandBuffer();
+		if (frameQueries.mScopes[scopeId].mbPipelineStatistics)
+		{
+			vkCommandBuffer.endQuery(frameQueries.mPipelineStatisticsPool, scopeId);
+		}
+		vkCommandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, frameQueries.mTimestampPool, scopeId * 2 + 1);
+	}
+
+	void FGPUProfiler::ResetStats()
+	{
+		mScopeStats.clear();
+		mScopeStatsLookUp.clear();
+	}
+
+	void FGPUProfiler::ReadBackQueries(FGPUDevice& gpu, FFrameQueries& frameQueries)
+	{
+		const uint32 numScopes = glm::min(frameQueries.mNumScopes.load(), kMaxGPUProfilerScopes);
+		const vk::Device device = gpu.GetVkDevice();
+
+		// Frame timeline value is signaled, so all submitted queries are available. Queries which were never written stay
+		// unavailable and are skipped, eNotReady only reports them.
+		constexpr vk::QueryResultFlags kResultFlags = vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+
+		const vk::Result timestampResult = device.getQueryPoolResults(
+			frameQueries.mTimestampPool,
+			0,
+			numScopes * 2,
+			numScopes * 2 * 2 * sizeof(uint64),
+			mTimestampResults.data(),
+			2 * sizeof(uint64),
+			kResultFlags
+		);
+
+		if (timestampResult != vk::Result::eSuccess && timestampResult != vk::Result::eNotReady)
+		{
+			TURBO_LOG(LogGPUProfiler, Error, "Cannot read back timestamp queries: {}", vk::to_string(timestampResult))
+			return;
+		}
+
+		constexpr uint32 kPipelineStatisticsStride = kNumGPUPipelineStatistics + 1;
+		bool bHasPipelineStatistics = false;
+		for (uint32 scopeId = 0; scopeId < numScopes; ++scopeId)
+		{
+			bHasPipelineStatistics |= frameQueries.mScopes[scopeId].mbPipelineStatistics;
+		}
+
+		if (bHasPipelineStatistics)
+		{
+			const vk::Result pipelineStatisticsResult = device.getQueryPoolResults(
+				frameQueries.mPipelineStatisticsPool,
+				0,
+				numScopes,
+				numScopes * kPipelineStatisticsStride * sizeof(uint64),
+				mPipelineStatisticsResults.data(),
+				kPipelineStatisticsStride * sizeof(uint64),
+				kResultFlags
+			);
+
+			bHasPipelineStatistics = pipelineStatisticsResult == vk::Result::eSuccess || pipelineStatisticsResult == vk::Result::eNotReady;
+		}
+
+		for (uint32 scopeId = 0; scopeId < numScopes; ++scopeId)
+		{
+			const FScope& scope = frameQueries.mScopes[scopeId];
+
+			// Each timestamp is followed by its availability
+			const uint64* beginTimestamp = &mTimestampResults[scopeId * 4];
+			const uint64* endTimestamp = &mTimestampResults[scopeId * 4 + 2];
+			if (beginTimestamp[1] == 0 || endTimestamp[1] == 0)
+			{
+				continue;
+			}
+
+			const uint64 timestampMask = mTimestampMasks[static_cast<uint32>(scope.mQueue)];
+			const uint64 numTicks = (endTimestamp[0] - beginTimestamp[0]) & timestampMask;
+
+			FGPUProfilerSample sample = {};
+			sample.mTimeMs = static_cast<float>(static_cast<double>(numTicks) * mTimestampPeriodNs * 1e-6);
+
+			if (bHasPipelineStatistics && scope.mbPipelineStatistics)
+			{
+				const uint64* pipelineStatistics = &mPipelineStatisticsResults[scopeId * kPipelineStatisticsStride];
+				if (pipelineStatistics[kNumGPUPipelineStatistics] != 0)
+				{
+					std::copy_n(pipelineStatistics, kNumGPUPipelineStatistics, sample.mPipelineStatistics.begin());
+				}
+			}
+
+			AddSample(scope.mName, frameQueries.mFrame, sample);
+		}
+
+		for (FGPUProfilerScopeStats& stats : mScopeStats)
+		{
+			if (stats.mLatestFrame == frameQueries.mFrame)
+			{
+				UpdateSummary(stats);
+			}
+		}
+	}
+
+	void FGPUProfiler::AddSample(FName name, uint32 frame, const FGPUProfilerSample& sample)
+	{
+		auto [statsIt, bInserted] = mScopeStatsLookUp.try_emplace(name, static_cast<uint32>(mScopeStats.size()));
+		if (bInserted)
+		{
+			FGPUProfilerScopeStats& newStats = mScopeStats.emplace_back();
+			newStats.mName = name;
+		}
+
+		FGPUProfilerScopeStats& stats = mScopeStats[statsIt->second];
+		if (stats.mLatestFrame == frame)
+		{
+			FGPUProfilerSample& latestSample = stats.mHistory[stats.mLatestSample];
+			latestSample.mTimeMs += sample.mTimeMs;
+			for (uint32 statisticId = 0; statisticId < kNumGPUPipelineStatistics; ++statisticId)
+			{
+				latestSample.mPipelineStatistics[statisticId] += sample.mPipelineStatistics[statisticId];
+			}
+			return;
+		}
+
+		stats.mLatestSample = stats.mNumSamples == 0 ? 0 : (stats.mLatestSample + 1) % kGPUProfilerHistorySize;
+		stats.mHistory[stats.mLatestSample] = sample;
+		stats.mNumSamples = glm::min(stats.mNumSamples + 1, kGPUProfilerHistorySize);
+		stats.mLatestFrame = frame;
+	}
+
+	void FGPUProfiler::UpdateSummary(FGPUProfilerScopeStats& stats)
+	{
+		const uint32 numSamples = stats.mNumSamples;
+		TURBO_CHECK(numSamples > 0)
+
+		std::array<float, kGPUProfilerHistorySize> sortedTimes;
+		double timeSum = 0.0;
+		std::array<uint64, kNumGPUPipelineStatistics> pipelineStatisticsSum = {};
+
+		for (uint32 sampleId = 0; sampleId < numSamples; ++sampleId)
+		{
+			const FGPUProfilerSample& sample = stats.mHistory[sampleId];
+			sortedTimes[sampleId] = sample.mTimeMs;
+			timeSum += sample.mTimeMs;
+
+			for (uint32 statisticId = 0; statisticId < kNumGPUPipelineStatistics; ++statisticId)
+			{
+				pipelineStatisticsSum[statisticId] += sample.mPipelineStatistics[statisticId];
+			}
+		}
+
+		std::sort(sortedTimes.begin(), sortedTimes.begin() + numSamples);
+		auto percentile = [&](float fraction)
+		{
+			const uint32 index = static_cast<uint32>(glm::ceil(fraction * static_cast<float>(numSamples))) - 1;
+			return sortedTimes[glm::min(index, numSamples - 1)];
+		};
+
+		stats.mAverageTimeMs = static_cast<float>(timeSum / numSamples);
+		stats.mP95TimeMs = percentile(0.95f);
+		stats.mP99TimeMs = percentile(0.99f);
+
+		for (uint32 statisticId = 0; statisticId < kNumGPUPipelineStatistics; ++statisticId)
+		{
+			stats.mAveragePipelineStatistics[statisticId] = pipelineStatisticsSum[statisticId] / numSamples;
+		}
+	}
+} // Turbo
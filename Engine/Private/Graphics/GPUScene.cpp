@@ -0,0 +1,305 @@
+#include "Graphics/GPUScene.h"
+
+#include "Assets/AssetManager.h"
+#include "Core/Math/Math.h"
+#include "Graphics/CommandBuffer.h"
+#include "Graphics/DrawCalls.h"
+#include "Graphics/FrameGraph/RenderGraph.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/Shaders/GPUSceneUpdateCS.h"
+#include "ProfilingMacros.h"
+#include "World/MeshComponent.h"
+#include "World/SceneGraph.h"
+
+namespace Turbo
+{
+	namespace
+	{
+		constexpr uint32 kMinInstanceCapacity = 1024;
+
+		/** Mesh entities without their own transform are drawn with the transform of the parent */
+		const glm::float4x4& GetInstanceWorldTransform(const entt::registry& registry, entt::entity entity)
+		{
+			if (const FWorldTransform* worldTransform = registry.try_get<FWorldTransform>(entity))
+			{
+				return worldTransform->mTransform;
+			}
+
+			const FRelationship& relationship = registry.get<FRelationship>(entity);
+			return registry.get<FWorldTransform>(relationship.mParent).mTransform;
+		}
+	}
+
+	void FGPUScene::Init(FGPUDevice& gpu, entt::registry& registry)
+	{
+		mUpdatePipeline = GPUSceneUpdateCS::CreatePipeline(gpu);
+		CreateInstanceBuffer(gpu, kMinInstanceCapacity);
+
+		registry.on_update<FMeshComponent>().connect<&FGPUScene::OnMeshComponentUpdated>(*this);
+		registry.on_destroy<FMeshComponent>().connect<&FGPUScene::OnMeshComponentDestroyed>(*this);
+		registry.on_destroy<FGPUSceneInstanceId>().connect<&FGPUScene::OnInstanceIdDestroyed>(*this);
+	}
+
+	void FGPUScene::Destroy(FGPUDevice& gpu, entt::registry& registry)
+	{
+		registry.on_update<FMeshComponent>().disconnect(*this);
+		registry.on_destroy<FMeshComponent>().disconnect(*this);
+		registry.on_destroy<FGPUSceneInstanceId>().disconnect(*this);
+
+		gpu.DestroyPipeline(mUpdatePipeline);
+		gpu.DestroyBuffer(mInstanceBuffer);
+	}
+
+	void FGPUScene::Update(FGPUDevice& gpu, FRenderGraphBuilder& graphBuilder, entt::registry& registry)
+	{
+		TRACE_ZONE_SCOPED()
+
+		{
+			TRACE_ZONE_SCOPED_N("Register new instances")
+
+			mUpdatedEntities.clear();
+			const auto newMeshView = registry.view<FMeshComponent>(entt::exclude<FGPUSceneInstanceId>);
+			mUpdatedEntities.insert(mUpdatedEntities.end(), newMeshView.begin(), newMeshView.end());
+
+			for (entt::entity entity : mUpdatedEntities)
+			{
+				registry.emplace<FGPUSceneInstanceId>(entity, AcquireInstanceId());
+				registry.emplace_or_replace<FGPUSceneDirty>(entity);
+			}
+
+			mbDrawListsDirty |= mUpdatedEntities.empty() == false;
+		}
+
+		mInstanceBufferHandle = {};
+		ReserveInstances(gpu, graphBuilder);
+		if (mInstanceBufferHandle.IsValid() == false)
+		{
+			mInstanceBufferHandle = graphBuilder.RegisterExternalBuffer(mInstanceBuffer);
+		}
+
+		{
+			TRACE_ZONE_SCOPED_N("Gather dirty instances")
+
+			mUpdatedEntities.clear();
+			const auto dirtyView = registry.view<FGPUSceneInstanceId, FGPUSceneDirty>();
+			mUpdatedEntities.insert(mUpdatedEntities.end(), dirtyView.begin(), dirtyView.end());
+
+			const auto movedView = registry.view<FGPUSceneInstanceId, FWorldTransformDirty>(entt::exclude<FGPUSceneDirty>);
+			mUpdatedEntities.insert(mUpdatedEntities.end(), movedView.begin(), movedView.end());
+
+			const auto dirtyTagView = registry.view<FGPUSceneDirty>();
+			registry.remove<FGPUSceneDirty>(dirtyTagView.begin(), dirtyTagView.end());
+		}
+
+		mNumUpdatedInstances = mUpdatedEntities.size();
+		static const cstring kUpdatedInstancesPlot = "GPU Scene Updated Instances";
+		TRACE_PLOT_CONFIGURE(kUpdatedInstancesPlot, EPlotFormat::Number, true, true, 0x40C0C0)
+		TRACE_PLOT(kUpdatedInstancesPlot, static_cast<int64>(mNumUpdatedInstances))
+
+		if (mUpdatedEntities.empty() == false)
+		{
+			AddUpdatePass(graphBuilder, mUpdatedEntities, registry);
+		}
+
+		if (mbDrawListsDirty)
+		{
+			RebuildDrawLists(registry);
+			mbDrawListsDirty = false;
+		}
+	}
+
+	FDeviceAddress FGPUScene::GetInstancesAddress(const FGPUDevice& gpu) const
+	{
+		return gpu.AccessBuffer(mInstanceBuffer)->mDeviceAddress;
+	}
+
+	void FGPUScene::FillInstanceTransforms(const glm::float4x4& modelToWorld, const FBounds& meshBounds, FGPUSceneInstance& outInstance)
+	{
+		const glm::float4x4 modelToWorldRows = glm::transpose(modelToWorld);
+		outInstance.mModelToWorldRows = {modelToWorldRows[0], modelToWorldRows[1], modelToWorldRows[2]};
+
+		const glm::float3 boundsCenter = (meshBounds.mMin + meshBounds.mMax) * 0.5f;
+		const glm::float3 worldCenter = glm::float3(modelToWorld * glm::float4(boundsCenter, 1.f));
+
+		// Non-uniform scale stretches the sphere by the largest axis scale
+		const glm::float3 axisX = glm::float3(modelToWorld[0]);
+		const glm::float3 axisY = glm::float3(modelToWorld[1]);
+		const glm::float3 axisZ = glm::float3(modelToWorld[2]);
+		const float maxScaleSquared = glm::max(glm::dot(axisX, axisX), glm::max(glm::dot(axisY, axisY), glm::dot(axisZ, axisZ)));
+
+		outInstance.mBoundingSphere = glm::float4(worldCenter, meshBounds.mRadius * glm::sqrt(maxScaleSquared));
+	}
+
+	void FGPUScene::OnMeshComponentUpdated(entt::registry& registry, entt::entity entity)
+	{
+		registry.emplace_or_replace<FGPUSceneDirty>(entity);
+		mbDrawListsDirty = true;
+	}
+
+	void FGPUScene::OnMeshComponentDestroyed(entt::registry& registry, entt::entity entity)
+	{
+		registry.remove<FGPUSceneDirty>(entity);
+		registry.remove<FGPUSceneInstanceId>(entity);
+	}
+
+	void FGPUScene::OnInstanceIdDestroyed(entt::registry& registry, entt::entity entity)
+	{
+		mFreeIds.push_back(registry.get<FGPUSceneInstanceId>(entity).mId);
+		mbDrawListsDirty = true;
+	}
+
+	uint32 FGPUScene::AcquireInstanceId()
+	{
+		if (mFreeIds.empty() == false)
+		{
+			const uint32 id = mFreeIds.back();
+			mFreeIds.pop_back();
+			return id;
+		}
+
+		return mNumUsedIds++;
+	}
+
+	void FGPUScene::ReserveInstances(FGPUDevice& gpu, FRenderGraphBuilder& graphBuilder)
+	{
+		if (mNumUsedIds <= mInstanceCapacity)
+		{
+			return;
+		}
+
+		TRACE_ZONE_SCOPED()
+
+		const THandle<FBuffer> oldInstanceBuffer = mInstanceBuffer;
+		const FDeviceSize oldSize = static_cast<FDeviceSize>(mInstanceCapacity) * sizeof(FGPUSceneInstance);
+
+		CreateInstanceBuffer(gpu, glm::max(std::bit_ceil(mNumUsedIds), mInstanceCapacity * 2));
+		TURBO_LOG(LogGPUScene, Info, "Instance buffer grown to {} instances.", mInstanceCapacity);
+
+		// Instances which weren't touched this frame are valid only in the old buffer
+		const FRGResourceHandle oldBufferHandle = graphBuilder.RegisterExternalBuffer(oldInstanceBuffer);
+		mInstanceBufferHandle = graphBuilder.RegisterExternalBuffer(mInstanceBuffer);
+
+		const static FName passName("GPUScene Grow");
+		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Transfer);
+		pass->ReadBuffer(oldBufferHandle, ERGResourceUsage::TransferSrc);
+		pass->WriteBuffer(mInstanceBufferHandle, ERGResourceUsage::TransferDst);
+
+		pass->BindExecute(
+			[=, newInstanceBuffer = mInstanceBuffer](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+			{
+				cmd.CopyBuffer(oldInstanceBuffer, newInstanceBuffer, oldSize);
+			});
+
+		gpu.DestroyBuffer(oldInstanceBuffer);
+	}
+
+	void FGPUScene::CreateInstanceBuffer(FGPUDevice& gpu, uint32 capacity)
+	{
+		FBufferBuilder bufferBuilder = {};
+		bufferBuilder
+			.Init(EBufferFlags::StorageBuffer | EBufferFlags::TransferSrc, sizeof(FGPUSceneInstance) * capacity)
+			.SetName(FName("GPUSceneInstances"))
+			.SetMemoryCategory(EGPUMemoryCategory::Scene);
+
+		mInstanceBuffer = gpu.CreateBuffer(bufferBuilder);
+		mInstanceCapacity = capacity;
+	}
+
+	void FGPUScene::RebuildDrawLists(entt::registry& registry)
+	{
+		TRACE_ZONE_SCOPED()
+
+		FDrawCallStorage drawCalls;
+		DrawCalls::GatherDrawCalls(registry, drawCalls);
+
+		std::vector<FMaterialBucket> materialBuckets;
+		DrawCalls::CreateMaterialBuckets(drawCalls, materialBuckets);
+
+		mBuckets.clear();
+		mBuckets.reserve(materialBuckets.size());
+		mDrawInstanceIds.clear();
+		mDrawInstanceIds.reserve(drawCalls.size());
+		mDrawClusterOffsets.clear();
+		mDrawClusterOffsets.reserve(drawCalls.size());
+
+		const FAssetManager& assetManager = entt::locator<FAssetManager>::value();
+
+		for (const FMaterialBucket& materialBucket : materialBuckets)
+		{
+			FGPUSceneBucket& bucket = mBuckets.emplace_back();
+			bucket.mMaterial = materialBucket.mTargetMaterial;
+			bucket.mFirstDraw = mDrawInstanceIds.size();
+
+			for (FDrawCallIt drawCallIt = materialBucket.mStartIt; drawCallIt != materialBucket.mEndIt; ++drawCallIt)
+			{
+				mDrawInstanceIds.push_back(drawCallIt->mInstanceId);
+				mDrawClusterOffsets.push_back(bucket.mNumClusters);
+
+				const FMesh* mesh = assetManager.AccessMesh(drawCallIt->mMesh);
+				TURBO_CHECK(mesh)
+				bucket.mNumClusters += mesh->mNumClusters;
+			}
+
+			bucket.mNumDraws = mDrawInstanceIds.size() - bucket.mFirstDraw;
+		}
+	}
+
+	void FGPUScene::AddUpdatePass(FRenderGraphBuilder& graphBuilder, std::span<const entt::entity> entities, entt::registry& registry)
+	{
+		TRACE_ZONE_SCOPED()
+
+		const FAssetManager& assetManager = entt::locator<FAssetManager>::value();
+		const FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
+
+		const uint32 numUpdates = entities.size();
+		const FRGUploadAllocation idsUpload = graphBuilder.AllocateUpload<uint32>(numUpdates);
+		const FRGUploadAllocation instancesUpload = graphBuilder.AllocateUpload<FGPUSceneInstance>(numUpdates);
+		uint32* updateIds = idsUpload.GetMapped<uint32>();
+		FGPUSceneInstance* updates = instancesUpload.GetMapped<FGPUSceneInstance>();
+
+		// Instances are composed on the stack and written once, the upload memory is write-combined
+		for (uint32 updateId = 0; updateId < numUpdates; ++updateId)
+		{
+			const entt::entity entity = entities[updateId];
+			const FMeshComponent& meshComponent = registry.get<FMeshComponent>(entity);
+			const FMesh* mesh = assetManager.AccessMesh(meshComponent.mMesh);
+			TURBO_CHECK(mesh)
+			TURBO_CHECK(mesh->mBounds.mRadius >= 0.f)
+
+			const FMaterial::Instance* materialInstance = materialManager.AccessInstance(meshComponent.mMaterialInstance);
+
+			FGPUSceneInstance instance;
+			FillInstanceTransforms(GetInstanceWorldTransform(registry, entity), mesh->mBounds, instance);
+			instance.mMeshIndex = meshComponent.mMesh.GetIndex();
+			instance.mMaterialIndex = meshComponent.mMaterial.GetIndex();
+			instance.mMaterialInstanceIndex = materialInstance ? materialInstance->mUniformBufferIndex : 0;
+
+			updateIds[updateId] = registry.get<FGPUSceneInstanceId>(entity).mId;
+			updates[updateId] = instance;
+		}
+
+		const FRGResourceHandle instanceBufferHandle = mInstanceBufferHandle;
+
+		const static FName passName("GPUScene Update");
+		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Compute);
+		pass->WriteBuffer(instanceBufferHandle);
+
+		pass->BindExecute(
+			[=, pipeline = mUpdatePipeline](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+			{
+				const FBuffer* instanceBuffer = gpu.AccessBuffer(resources.mBuffers.at(instanceBufferHandle));
+
+				const GPUSceneUpdateCS::FPushConstants pushConstants = {
+					.mInstances = instanceBuffer->mDeviceAddress,
+					.mUpdateIds = idsUpload.mDeviceAddress,
+					.mUpdates = instancesUpload.mDeviceAddress,
+					.mNumUpdates = numUpdates,
+				};
+
+				cmd.BindPipeline(pipeline);
+				cmd.PushConstants(pushConstants);
+				cmd.Dispatch(glm::uint3(Math::DivideAndRoundUp<uint32>(numUpdates, 64), 1, 1));
+			});
+	}
+} // Turbo
@@ -0,0 +1,431 @@
+#include "Graphics/GPUUploadManager.h"
+
+#include "Core/Memory.h"
+#include "Debug/IConsoleManager.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/VulkanInitializers.h"
+
+namespace Turbo
+{
+	static TAutoConsoleVariable<int32> CVarUploadStagingSizeMiB(
+		"gpu.upload.stagingSizeMiB",
+		64,
+		"Size of the staging ring used by resource uploads (in MiB). Read at startup."
+	);
+
+	static FAutoConsoleCommand gGPUUploadStatsCommand(
+		"gpu.upload.stats",
+		"Prints the number of upload batches submitted to the transfer queue and the staging ring usage.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FGPUUploadManager& uploadManager = entt::locator<FGPUDevice>::value().GetUploadManager();
+			const FGPUUploadStats& stats = uploadManager.GetStats();
+			consoleManager.Printf(
+				"Upload batches: {}, copies: {}, uploaded: {} MiB, stalls: {}, staging used: {} KiB of {} KiB",
+				stats.mNumBatches,
+				stats.mNumCopies,
+				stats.mNumBytes / Constants::kMebi,
+				stats.mNumStalls,
+				uploadManager.GetUsedStagingSize() / Constants::kKibi,
+				uploadManager.GetStagingSize() / Constants::kKibi
+			);
+		}));
+
+	/** Buffer offsets of texture copies have to be a multiple of the texel block size */
+	static constexpr FDeviceSize kStagingAlignment = 16;
+
+	void FGPUUploadManager::Init(FGPUDevice& gpu)
+	{
+		const vk::Device device = gpu.GetVkDevice();
+
+		vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+		semaphoreTypeCreateInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+		semaphoreTypeCreateInfo.initialValue = 0;
+
+		vk::SemaphoreCreateInfo semaphoreCreateInfo = {};
+		semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		CHECK_VULKAN_RESULT(mTimelineSemaphore, device.createSemaphore(semaphoreCreateInfo));
+
+		mbQueueFamilyTransfer = gpu.GetTransferQueueFamily() != gpu.GetGraphicsQueueFamily();
+
+		mStagingSize = glm::max(CVarUploadStagingSizeMiB.Get(), 1) * Constants::kMebi;
+		FBufferBuilder stagingBufferBuilder = FBufferBuilder::CreateStagingBuffer(static_cast<uint32>(mStagingSize));
+		stagingBufferBuilder.SetName(FName("UploadStagingRing"));
+		mStagingBuffer = gpu.CreateBuffer(stagingBufferBuilder);
+		mStagingMappedAddress = gpu.AccessBuffer(mStagingBuffer)->mMappedAddress;
+		mStagingHead = 0;
+		mStagingTail = 0;
+
+		for (FFrameAcquire& frameAcquire : mFrameAcquires)
+		{
+			frameAcquire.mVkCommandPool = gpu.CreateCommandPool(gpu.GetGraphicsQueueFamily());
+		}
+	}
+
+	void FGPUUploadManager::Destroy(FGPUDevice& gpu)
+	{
+		const vk::Device device = gpu.GetVkDevice();
+
+		if (mRecordingBatch)
+		{
+			mFreeBatches.push_back(std::move(mRecordingBatch));
+		}
+
+		for (TUniquePtr<FBatch>& batch : mSubmittedBatches)
+		{
+			mFreeBatches.push_back(std::move(batch));
+		}
+		mSubmittedBatches.clear();
+
+		for (const TUniquePtr<FBatch>& batch : mFreeBatches)
+		{
+			for (const THandle<FBuffer> stagingBuffer : batch->mDedicatedStagingBuffers)
+			{
+				gpu.DestroyBuffer(stagingBuffer);
+			}
+
+			batch->mCommandBuffer = nullptr;
+			device.destroyCommandPool(batch->mVkCommandPool);
+		}
+		mFreeBatches.clear();
+
+		for (FFrameAcquire& frameAcquire : mFrameAcquires)
+		{
+			frameAcquire.mCommandBuffers.clear();
+			frameAcquire.mNumUsedCommandBuffers = 0;
+			device.destroyCommandPool(frameAcquire.mVkCommandPool);
+			frameAcquire.mVkCommandPool = nullptr;
+		}
+
+		gpu.DestroyBuffer(mStagingBuffer);
+		mStagingBuffer = {};
+		mStagingMappedAddress = nullptr;
+
+		device.destroySemaphore(mTimelineSemaphore);
+		mTimelineSemaphore = nullptr;
+
+		mPendingAcquireBarriers.clear();
+	}
+
+	void FGPUUploadManager::BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId)
+	{
+		TRACE_ZONE_SCOPED()
+
+		FFrameAcquire& frameAcquire = mFrameAcquires[bufferedFrameId];
+		if (frameAcquire.mNumUsedCommandBuffers > 0)
+		{
+			CHECK_VULKAN_HPP(gpu.GetVkDevice().resetCommandPool(frameAcquire.mVkCommandPool));
+			frameAcquire.mNumUsedCommandBuffers = 0;
+		}
+
+		RetireBatches(gpu, false);
+	}
+
+	void FGPUUploadManager::UploadBuffer(FGPUDevice& gpu, THandle<FBuffer> dst, FDeviceSize dstOffset, std::span<const byte> data)
+	{
+		TRACE_ZONE_SCOPED()
+		TURBO_CHECK(data.empty() == false)
+
+		const FStagingAllocation staging = AllocateStaging(gpu, data.size());
+		std::memcpy(staging.mMappedAddress, data.data(), data.size());
+
+		FCommandBuffer& cmd = GetRecordingCommandBuffer(gpu);
+		cmd.CopyBuffer({
+			.mSrc = staging.mBuffer,
+			.mSrcOffset = staging.mOffset,
+			.mDst = dst,
+			.mDstOffset = dstOffset,
+			.mSize = data.size()
+		});
+
+		++mStats.mNumCopies;
+		mStats.mNumBytes += data.size();
+	}
+
+	void FGPUUploadManager::UploadTexture(FGPUDevice& gpu, THandle<FTexture> dst, std::span<const std::span<const byte>> mips)
+	{
+		TRACE_ZONE_SCOPED()
+		TURBO_CHECK(mips.empty() == false)
+
+		// All mips share one staging range, so they can't be split between batches
+		FDeviceSize stagingSize = 0;
+		for (const std::span<const byte> mip : mips)
+		{
+			stagingSize = Memory::Align(stagingSize, kStagingAlignment) + mip.size();
+		}
+
+		const FStagingAllocation staging = AllocateStaging(gpu, stagingSize);
+		FCommandBuffer& cmd = GetRecordingCommandBuffer(gpu);
+
+		vk::ImageMemoryBarrier2 imageBarrier = {};
+		imageBarrier.image = gpu.AccessTexture(dst)->mVkImage;
+		imageBarrier.subresourceRange = VkInit::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor);
+		imageBarrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+		imageBarrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+
+		vk::DependencyInfo dependencyInfo = {};
+		dependencyInfo.setImageMemoryBarriers(imageBarrier);
+
+		// Previous content is discarded
+		imageBarrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		imageBarrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+		imageBarrier.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+		imageBarrier.dstAccessMask = vk::AccessFlagBits2::eTransferWrite;
+		imageBarrier.oldLayout = vk::ImageLayout::eUndefined;
+		imageBarrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+		cmd.PipelineBarrier(dependencyInfo);
+
+		FDeviceSize mipOffset = 0;
+		for (uint32 mipIndex = 0; mipIndex < mips.size(); ++mipIndex)
+		{
+			mipOffset = Memory::Align(mipOffset, kStagingAlignment);
+			std::memcpy(staging.mMappedAddress + mipOffset, mips[mipIndex].data(), mips[mipIndex].size());
+			cmd.CopyBufferToTexture(staging.mBuffer, dst, mipIndex, staging.mOffset + mipOffset);
+
+			mipOffset += mips[mipIndex].size();
+		}
+
+		imageBarrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+		imageBarrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+		imageBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		imageBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+		if (mbQueueFamilyTransfer)
+		{
+			// Release, access masks of the destination are ignored
+			imageBarrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			imageBarrier.dstAccessMask = vk::AccessFlagBits2::eNone;
+			imageBarrier.srcQueueFamilyIndex = gpu.GetTransferQueueFamily();
+			imageBarrier.dstQueueFamilyIndex = gpu.GetGraphicsQueueFamily();
+			cmd.PipelineBarrier(dependencyInfo);
+
+			// Acquire, recorded on the graphics queue after the batch is submitted. The layout transition has to match.
+			vk::ImageMemoryBarrier2 acquireBarrier = imageBarrier;
+			acquireBarrier.srcStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			acquireBarrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+			acquireBarrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			acquireBarrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+			mPendingAcquireBarriers.push_back(acquireBarrier);
+		}
+		else
+		{
+			imageBarrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			imageBarrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+			cmd.PipelineBarrier(dependencyInfo);
+		}
+
+		mStats.mNumCopies += mips.size();
+		mStats.mNumBytes += stagingSize;
+	}
+
+	void FGPUUploadManager::UploadTexture(FGPUDevice& gpu, THandle<FTexture> dst, std::span<const byte> data)
+	{
+		UploadTexture(gpu, dst, std::span(&data, 1));
+	}
+
+	void FGPUUploadManager::Flush(FGPUDevice& gpu)
+	{
+		if (mRecordingBatch == nullptr)
+		{
+			return;
+		}
+
+		TRACE_ZONE_SCOPED()
+
+		TUniquePtr<FBatch> batch = std::move(mRecordingBatch);
+		batch->mCommandBuffer->End();
+		batch->mTimelineValue = ++mLastSubmittedValue;
+		batch->mStagingEnd = mStagingHead;
+
+		vk::SemaphoreSubmitInfo signalSemaphoreInfo = VkInit::SemaphoreSubmitInfo(mTimelineSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+		signalSemaphoreInfo.value = batch->mTimelineValue;
+
+		const vk::CommandBufferSubmitInfo bufferSubmitInfo = batch->mCommandBuffer->CreateSubmitInfo();
+		const vk::SubmitInfo2 submitInfo = VkInit::SubmitInfo(bufferSubmitInfo, &signalSemaphoreInfo, nullptr);
+		CHECK_VULKAN_HPP(gpu.GetVkTransferQueue().submit2(1, &submitInfo, nullptr));
+
+		mSubmittedBatches.push_back(std::move(batch));
+		++mStats.mNumBatches;
+	}
+
+	FCommandBuffer* FGPUUploadManager::PrepareGraphicsSubmit(FGPUDevice& gpu, std::vector<vk::SemaphoreSubmitInfo>& outWaitSemaphores)
+	{
+		Flush(gpu);
+
+		if (mLastGraphicsWaitValue < mLastSubmittedValue)
+		{
+			vk::SemaphoreSubmitInfo waitSemaphoreInfo = VkInit::SemaphoreSubmitInfo(mTimelineSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+			waitSemaphoreInfo.value = mLastSubmittedValue;
+			outWaitSemaphores.push_back(waitSemaphoreInfo);
+
+			mLastGraphicsWaitValue = mLastSubmittedValue;
+		}
+
+		if (mPendingAcquireBarriers.empty())
+		{
+			return nullptr;
+		}
+
+		FFrameAcquire& frameAcquire = mFrameAcquires[gpu.GetBufferedFrameId()];
+		if (frameAcquire.mNumUsedCommandBuffers == frameAcquire.mCommandBuffers.size())
+		{
+			frameAcquire.mCommandBuffers.push_back(gpu.CreateCommandBuffer({
+				.mVkCommandPool = frameAcquire.mVkCommandPool,
+				.mName = FName(fmt::format("UploadAcquire{}", frameAcquire.mCommandBuffers.size()))
+			}));
+		}
+
+		FCommandBuffer& cmd = *frameAcquire.mCommandBuffers[frameAcquire.mNumUsedCommandBuffers++];
+		cmd.Begin();
+
+		vk::DependencyInfo dependencyInfo = {};
+		dependencyInfo.setImageMemoryBarriers(mPendingAcquireBarriers);
+		cmd.PipelineBarrier(dependencyInfo);
+
+		cmd.End();
+		mPendingAcquireBarriers.clear();
+
+		return &cmd;
+	}
+
+	void FGPUUploadManager::PrepareAsyncComputeSubmit(FGPUDevice& gpu, std::vector<vk::SemaphoreSubmitInfo>& outWaitSemaphores)
+	{
+		Flush(gpu);
+
+		if (mLastAsyncComputeWaitValue < mLastSubmittedValue)
+		{
+			vk::SemaphoreSubmitInfo waitSemaphoreInfo = VkInit::SemaphoreSubmitInfo(mTimelineSemaphore, vk::PipelineStageFlagBits2::eAllCommands);
+			waitSemaphoreInfo.value = mLastSubmittedValue;
+			outWaitSemaphores.push_back(waitSemaphoreInfo);
+
+			mLastAsyncComputeWaitValue = mLastSubmittedValue;
+		}
+	}
+
+	FGPUUploadManager::FStagingAllocation FGPUUploadManager::AllocateStaging(FGPUDevice& gpu, FDeviceSize size)
+	{
+		// Large uploads would stall the ring, they get their own buffer which is destroyed with the batch
+		if (size > mStagingSize / 4)
+		{
+			const THandle<FBuffer> stagingBuffer = gpu.CreateBuffer(FBufferBuilder::CreateStagingBuffer(static_cast<uint32>(size)));
+			(void)GetRecordingCommandBuffer(gpu);
+			mRecordingBatch->mDedicatedStagingBuffers.push_back(stagingBuffer);
+
+			return {
+				.mBuffer = stagingBuffer,
+				.mMappedAddress = gpu.AccessBuffer(stagingBuffer)->mMappedAddress,
+				.mOffset = 0
+			};
+		}
+
+		uint64 start;
+		while (true)
+		{
+			start = Memory::Align(mStagingHead, kStagingAlignment);
+
+			// Ranges don't wrap around the end of the buffer
+			if (start % mStagingSize + size > mStagingSize)
+			{
+				start = (start / mStagingSize + 1) * mStagingSize;
+			}
+
+			if (start + size - mStagingTail <= mStagingSize)
+			{
+				break;
+			}
+
+			if (mSubmittedBatches.empty() == false)
+			{
+				RetireBatches(gpu, true);
+			}
+			else if (mRecordingBatch)
+			{
+				Flush(gpu);
+			}
+			else
+			{
+				// Nothing reads the ring anymore
+				mStagingHead = 0;
+				mStagingTail = 0;
+			}
+		}
+
+		mStagingHead = start + size;
+
+		const FDeviceSize offset = start % mStagingSize;
+		return {
+			.mBuffer = mStagingBuffer,
+			.mMappedAddress = mStagingMappedAddress + offset,
+			.mOffset = offset
+		};
+	}
+
+	FCommandBuffer& FGPUUploadManager::GetRecordingCommandBuffer(FGPUDevice& gpu)
+	{
+		if (mRecordingBatch == nullptr)
+		{
+			if (mFreeBatches.empty())
+			{
+				TUniquePtr<FBatch> batch = MakeUnique<FBatch>();
+				batch->mVkCommandPool = gpu.CreateCommandPool(gpu.GetTransferQueueFamily());
+				batch->mCommandBuffer = gpu.CreateCommandBuffer({
+					.mVkCommandPool = batch->mVkCommandPool,
+					.mName = FName("UploadBatch")
+				});
+				mFreeBatches.push_back(std::move(batch));
+			}
+
+			mRecordingBatch = std::move(mFreeBatches.back());
+			mFreeBatches.pop_back();
+
+			CHECK_VULKAN_HPP(gpu.GetVkDevice().resetCommandPool(mRecordingBatch->mVkCommandPool));
+			mRecordingBatch->mCommandBuffer->Begin();
+		}
+
+		return *mRecordingBatch->mCommandBuffer;
+	}
+
+	void FGPUUploadManager::RetireBatches(FGPUDevice& gpu, bool bWait)
+	{
+		if (mSubmittedBatches.empty())
+		{
+			return;
+		}
+
+		const vk::Device device = gpu.GetVkDevice();
+
+		if (bWait)
+		{
+			TRACE_ZONE_SCOPED_N("Wait for upload batch")
+
+			const uint64 waitValue = mSubmittedBatches.front()->mTimelineValue;
+
+			vk::SemaphoreWaitInfo waitInfo = {};
+			waitInfo.setSemaphores(mTimelineSemaphore);
+			waitInfo.setValues(waitValue);
+			CHECK_VULKAN_HPP(device.waitSemaphores(waitInfo, kMaxTimeout));
+
+			++mStats.mNumStalls;
+		}
+
+		uint64 completedValue;
+		CHECK_VULKAN_RESULT(completedValue, device.getSemaphoreCounterValue(mTimelineSemaphore));
+
+		while (mSubmittedBatches.empty() == false && mSubmittedBatches.front()->mTimelineValue <= completedValue)
+		{
+			TUniquePtr<FBatch> batch = std::move(mSubmittedBatches.front());
+			mSubmittedBatches.pop_front();
+
+			mStagingTail = glm::max(mStagingTail, batch->mStagingEnd);
+
+			for (const THandle<FBuffer> stagingBuffer : batch->mDedicatedStagingBuffers)
+			{
+				gpu.DestroyBuffer(stagingBuffer);
+			}
+			batch->mDedicatedStagingBuffers.clear();
+
+			mFreeBatches.push_back(std::move(batch));
+		}
+	}
+} // Turbo
@@ -16,7 +16,8 @@ Turbo::FBufferBuilder Turbo::FBufferBuilder::CreateStagingBuffer(const void* dat
 	result
 		.Init(EBufferFlags::CreateMapped | EBufferFlags::TransferSrc, size)
 		.SetData(data)
-		.SetName(kStagingBufferName);
+		.SetName(kStagingBufferName)
+		.SetMemoryCategory(EGPUMemoryCategory::Staging);
 
 	return result;
 }
@@ -41,4 +41,9 @@ namespace Turbo {
 	{
 		GPUDevice.DestroyAccelerationStructureImmediate(*this);
 	}
+
+	void FMemoryDestroyer::Destroy(FGPUDevice& GPUDevice)
+	{
+		GPUDevice.FreeMemoryImmediate(*this);
+	}
 }
@@ -34,6 +34,12 @@ namespace Turbo
 	}
 
 	void FSlangShaderCompiler::ClearRuntimeCache()
+	{
+		std::scoped_lock lock(mSessionCS);
+		ResetSession();
+	}
+
+	void FSlangShaderCompiler::ResetSession()
 	{
 		mSession = nullptr;
 		CreateSession();
@@ -49,6 +55,8 @@ namespace Turbo
 
 		vk::ShaderModule result = nullptr;
 
+		std::scoped_lock lock(mSessionCS);
+
 		Slang::ComPtr<slang::IBlob> diagnosticsBlob;
 		Slang::ComPtr<slang::IModule> module;
 		bool bRuntimeShaderCacheInvalid = false;
@@ -162,7 +170,7 @@ namespace Turbo
 		// We need to clear runtime cache if any module was saved to persistent cache, to avoid ABI problems.
 		if (bRuntimeShaderCacheInvalid)
 		{
-   		ClearRuntimeCache();
+   		ResetSession();
 		}
 
 		return result;
@@ -36,6 +36,8 @@ namespace Turbo
 
 	private:
 		void CreateSession();
+		/** Expects mSessionCS to be locked */
+		void ResetSession();
 		void PreloadModules();
 
 		void PrintMessageIfNeeded(slang::IBlob* diagnosticsBlob);
@@ -47,5 +49,8 @@ namespace Turbo
 		Slang::ComPtr<slang::ISession> mSession;
 
 		std::set<std::string> mCachedModules;
+
+		/** Slang sessions aren't thread safe, pipelines are compiled on worker threads */
+		std::mutex mSessionCS;
 	};
 } // Turbo
@@ -261,10 +261,12 @@ namespace Turbo
 			pass->ReadTexture(imGuiTexture.mRGTexture);
 		}
 
-		pass->mExecutePass.BindLambda(
+		pass->BindExecute(
 			[](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
 				ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd.GetVkCommandBuffer());
+				// ImGui binds its own pipeline, descriptor sets, viewport and scissor
+				cmd.InvalidateBoundState();
 			}
 		);
 
@@ -8,6 +8,7 @@
 #include "Core/Engine.h"
 #include "Core/Math/MathTypes.h"
 #include "Core/Name.h"
+#include "Debug/IConsoleManager.h"
 #include "Graphics/Enums.h"
 #include "Graphics/FrameGraph/RenderGraphHelpers.h"
 #include "Graphics/GeometryBuffer.h"
@@ -27,38 +28,137 @@
 
 namespace Turbo
 {
+	static TAutoConsoleVariable<bool> CVarOcclusionCulling(
+		"r.occlusionCulling",
+		true,
+		"Culls instances hidden behind the depth of the instances visible in the last frame. Disabled, only the frustum is tested."
+	);
+
+	static TAutoConsoleVariable<float> CVarLodBias(
+		"r.lodBias",
+		0.f,
+		"Screen space error of the mesh LOD selection is allowed to be 2^bias pixels. Positive values select coarser LODs."
+	);
+
+	static TAutoConsoleVariable<bool> CVarClusterCulling(
+		"r.clusterCulling",
+		true,
+		"Tests the clusters of the visible instances against the frustum, their normal cone and the Hi-Z, and draws each visible cluster separately."
+	);
+
+	static FAutoConsoleCommand gCullingStatsCommand(
+		"r.cullingStats",
+		"Prints the number of draws emitted and culled by the scene culling phases in the last completed frame.",
+		FConsoleCommandDelegate::CreateLambda([](IConsoleManager& consoleManager, const FArgsVector args)
+		{
+			const FSceneRenderingLayer* sceneRenderingLayer = entt::locator<FLayersStack>::value().GetLayer<FSceneRenderingLayer>();
+			if (sceneRenderingLayer == nullptr)
+			{
+				consoleManager.Print("Scene rendering layer is not running.");
+				return;
+			}
+
+			const SceneCullingCS::FCullingStats& stats = sceneRenderingLayer->GetCullingStats();
+			consoleManager.Printf(
+				"Early draws: {}, late draws: {}, frustum culled: {}, occlusion culled: {}\n"
+				"Clusters frustum culled: {}, cone culled: {}, occlusion culled: {}",
+				stats.mNumEarlyDraws,
+				stats.mNumLateDraws,
+				stats.mNumFrustumCulled,
+				stats.mNumOcclusionCulled,
+				stats.mNumClustersFrustumCulled,
+				stats.mNumClustersConeCulled,
+				stats.mNumClustersOcclusionCulled
+			);
+		}));
+
 	struct FIndirectDrawBufferHeader
 	{
 		uint32 mNumDrawCalls = 0;
 		uint32 __PADDING[3];
 	};
 
-	struct FDrawCall
+	static void RecordBucketDraws(FCommandBuffer& cmd, FRenderResources& resources, const FDrawIndirectBucket& bucket, FRGResourceHandle commandBuffer)
+	{
+		const THandle<FBuffer> commandBufferHandle = resources.mBuffers.at(commandBuffer);
+		cmd.DrawIndirectCount(FDrawIndirectCountParams{
+			.mBuffer = commandBufferHandle,
+			.mOffset = sizeof(FIndirectDrawBufferHeader),
+			.mCountBuffer = commandBufferHandle,
+			.mCountOffset = offsetof(FIndirectDrawBufferHeader, mNumDrawCalls),
+			.mMaxDrawCount = bucket.mMaxDrawCommands,
+			.mStride = sizeof(vk::DrawIndirectCommand),
+		});
+	}
+
+	/** Same selection as SelectLod in SceneCulling.slang, so the ray queries trace the rasterized LOD */
+	static uint32 SelectInstanceLod(const FSceneView& sceneView, const FMesh& mesh, const glm::float4x4& modelToWorld)
 	{
-		glm::float4x4 mWorldTransform = glm::float4x4(1.f);
+		const float maxScale = glm::max(
+			glm::length(glm::float3(modelToWorld[0])),
+			glm::max(glm::length(glm::float3(modelToWorld[1])), glm::length(glm::float3(modelToWorld[2])))
+		);
+		float errorScale = sceneView.mLodErrorScale * maxScale;
 
-		THandle<FMesh> mMesh = {};
-		THandle<FMaterial> mMaterial = {};
-		THandle<FMaterial::Instance> mMaterialInstance = {};
+		const FViewData& viewData = *sceneView.mViewData;
+		if (viewData.mProjectionMatrix[3][3] == 0.f)
+		{
+			const glm::float3 boundsCenter = glm::float3(modelToWorld * glm::float4((mesh.mBounds.mMin + mesh.mBounds.mMax) * 0.5f, 1.f));
+			const float distanceToBounds = glm::distance(boundsCenter, viewData.mCameraPosition) - mesh.mBounds.mRadius * maxScale;
+			errorScale /= glm::max(distanceToBounds, static_cast<float>(TURBO_SMALL_NUMBER));
+		}
 
-		uint64 mDrawCallHash = std::numeric_limits<uint64>::max();
+		return MeshLods::SelectLod(std::span(mesh.mLods.data(), mesh.mNumLods), errorScale);
+	}
 
-		glm::float3 mBoundsMin = {};
-		glm::float3 mBoundsMax = {};
-	};
+	static std::array<FName, HiZBuildCS::kMaxLevels> CreateHiZLevelNames(std::string_view prefix)
+	{
+		std::array<FName, HiZBuildCS::kMaxLevels> result;
+		for (uint32 levelId = 0; levelId < result.size(); ++levelId)
+		{
+			result[levelId] = FName(fmt::format("{}{}", prefix, levelId));
+		}
+
+		return result;
+	}
 
 	void FSceneRenderingLayer::Start()
 	{
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 		mFrustumCullingPipeline = SceneCullingCS::CreatePipeline(gpu);
+		mClusterCullingPipeline = SceneCullingCS::CreateClusterPipeline(gpu);
+		mHiZBuildPipeline = HiZBuildCS::CreatePipeline(gpu);
 		mToneMapperPipeline = ToneMapperPostProcess::CreatePipeline(gpu);
+		mGPUScene.Init(gpu, gEngine->GetWorld()->mRegistry);
+
+		for (uint32 frameId = 0; frameId < kMaxBufferedFrames; ++frameId)
+		{
+			FBufferBuilder bufferBuilder = {};
+			bufferBuilder
+				.Init(EBufferFlags::CreateMapped | EBufferFlags::Readback | EBufferFlags::StorageBuffer, sizeof(SceneCullingCS::FCullingStats))
+				.SetName(FName(fmt::format("CullingStats_{}", frameId)))
+				.SetMemoryCategory(EGPUMemoryCategory::Scene);
+
+			mCullingStatsBuffers[frameId] = gpu.CreateBuffer(bufferBuilder);
+			*reinterpret_cast<SceneCullingCS::FCullingStats*>(gpu.AccessBuffer(mCullingStatsBuffers[frameId])->mMappedAddress) = {};
+			gpu.FlushMappedBuffer(mCullingStatsBuffers[frameId]);
+		}
 	}
 
 	void FSceneRenderingLayer::Shutdown()
 	{
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 		gpu.DestroyPipeline(mFrustumCullingPipeline);
+		gpu.DestroyPipeline(mClusterCullingPipeline);
+		gpu.DestroyPipeline(mHiZBuildPipeline);
 		gpu.DestroyPipeline(mToneMapperPipeline);
+		mGPUScene.Destroy(gpu, gEngine->GetWorld()->mRegistry);
+
+		for (THandle<FBuffer>& statsBuffer : mCullingStatsBuffers)
+		{
+			gpu.DestroyBuffer(statsBuffer);
+			statsBuffer = {};
+		}
 	}
 
 	FName FSceneRenderingLayer::GetName()
@@ -104,176 +204,84 @@ namespace Turbo
 
 	void FSceneRenderingLayer::CreateIndirectRenderBuffers(
 		FRenderGraphBuilder& graphBuilder,
-		FWorld* world,
 		FSceneView* sceneView,
-		std::vector<FDrawIndirectBucket>& outBuckets
-	)
+		bool bOcclusionCulling,
+		bool bClusterCulling,
+		TArenaArray<FDrawIndirectBucket>& outBuckets
+	) const
 	{
 		TRACE_ZONE_SCOPED()
 
-		entt::registry& registry = world->mRegistry;
-
-		entt::storage<FDrawCall> drawCalls;
-		using FDrawCallIt = entt::storage<FDrawCall>::iterator;
-
-		struct FMaterialBucket
+		const std::span<const FGPUSceneBucket> sceneBuckets = mGPUScene.GetBuckets();
+		const std::span<const uint32> drawInstanceIds = mGPUScene.GetDrawInstanceIds();
+		if (drawInstanceIds.empty())
 		{
-			THandle<FMaterial> mTargetMaterial = {};
-			FDrawCallIt mStartIt = {};
-			FDrawCallIt mEndIt = {};
-		};
-
-		std::vector<FMaterialBucket> materialBuckets;
-
-		{
-			TRACE_ZONE_SCOPED_N("Prepare drawcalls")
-
-			const auto meshView = registry.view<FMeshComponent>();
-
-			{
-				TRACE_ZONE_SCOPED_N("Reserve storage")
-				drawCalls.reserve(meshView.storage()->size());
-
-				for (entt::entity entity : meshView)
-				{
-					drawCalls.emplace(entity);
-				}
-			}
-
-			{
-				TRACE_ZONE_SCOPED_N("Calculate transforms")
-
-				const auto meshTransformView = registry.view<FMeshComponent, FWorldTransform>();
-				for (entt::entity entity : meshTransformView)
-				{
-					FWorldTransform& worldTransformComp = meshTransformView.get<FWorldTransform>(entity);
-					drawCalls.get(entity).mWorldTransform = worldTransformComp.mTransform;
-				}
-
-				const auto meshRelationView = registry.view<FMeshComponent, FRelationship>(entt::exclude<FWorldTransform>);
-				for (entt::entity entity : meshRelationView)
-				{
-					const FRelationship& relationship = meshRelationView.get<FRelationship>(entity);
-					drawCalls.get(entity).mWorldTransform = registry.get<FWorldTransform>(relationship.mParent).mTransform;
-				}
-			}
-
-			{
-				TRACE_ZONE_SCOPED_N("Fill draw calls")
-				for (entt::entity entity : meshView)
-				{
-					const FMeshComponent& meshComponent = meshView.get<FMeshComponent>(entity);
-
-					FDrawCall& currentDrawCall = drawCalls.get(entity);
-					currentDrawCall.mMesh = meshComponent.mMesh;
-					currentDrawCall.mMaterial = meshComponent.mMaterial;
-					currentDrawCall.mMaterialInstance = meshComponent.mMaterialInstance;
-
-					constexpr uint64 kMaterialMask = 0xFFFF000000000000;
-					constexpr uint64 kMaterialInstanceMask = 0x0000FFFF00000000;
-					constexpr uint64 kMeshMask = 0x00000000FFFF0000;
-
-					TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMaterialMask))
-					TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMaterialInstanceMask))
-					TURBO_CHECK(currentDrawCall.mMaterial.GetIndex() < 1 << std::popcount(kMeshMask))
-
-					currentDrawCall.mDrawCallHash =
-						static_cast<uint64>(currentDrawCall.mMaterial.GetIndex()) << std::countr_zero(kMaterialMask)
-						| static_cast<uint64>(currentDrawCall.mMaterialInstance.GetIndex()) << std::countr_zero(kMaterialInstanceMask)
-						| static_cast<uint64>(currentDrawCall.mMesh.GetIndex()) << std::countr_zero(kMeshMask);
-				}
-			}
+			return;
 		}
 
-		{
-			TRACE_ZONE_SCOPED_N("Sort draw calls")
-			drawCalls.sort([&](entt::entity left, const entt::entity& right)
-			{
-				return drawCalls.get(left).mDrawCallHash < drawCalls.get(right).mDrawCallHash;
-			});
-		}
+		// Draw lists are cached by the GPU scene, only their instance ids are copied to the upload ring
+		const FRGUploadAllocation drawInstanceIdsUpload = graphBuilder.AllocateUpload<uint32>(drawInstanceIds.size());
+		std::memcpy(drawInstanceIdsUpload.mMappedAddress, drawInstanceIds.data(), drawInstanceIds.size_bytes());
 
+		FRGUploadAllocation drawClusterOffsetsUpload = {};
+		if (bClusterCulling)
 		{
-			materialBuckets.emplace_back();
-			FMaterialBucket& currentBucket = materialBuckets.front();
-			currentBucket.mTargetMaterial = drawCalls.begin()->mMaterial;
-			currentBucket.mStartIt = drawCalls.begin();
-
-			TRACE_ZONE_SCOPED_N("Create material buckets")
-			for (FDrawCallIt drawCallIt = drawCalls.begin(); drawCallIt != drawCalls.end(); ++drawCallIt)
-			{
-				if (drawCallIt->mMaterial != currentBucket.mTargetMaterial)
-				{
-					currentBucket.mEndIt = drawCallIt;
-
-					materialBuckets.emplace_back();
-					currentBucket = materialBuckets.front();
-					currentBucket.mTargetMaterial = drawCallIt->mMaterial;
-					currentBucket.mStartIt = drawCallIt;
-				}
-			}
-
-			currentBucket.mEndIt = drawCalls.end();
+			const std::span<const uint32> drawClusterOffsets = mGPUScene.GetDrawClusterOffsets();
+			drawClusterOffsetsUpload = graphBuilder.AllocateUpload<uint32>(drawClusterOffsets.size());
+			std::memcpy(drawClusterOffsetsUpload.mMappedAddress, drawClusterOffsets.data(), drawClusterOffsets.size_bytes());
+
+			const static FName visibleDrawsName("VisibleDraws");
+			sceneView->mVisibleDrawsBuffer = graphBuilder.CreateBuffer(FRGBufferInfo{
+				.mSize = drawInstanceIds.size_bytes(),
+				.mBufferFlags = EBufferFlags::StorageBuffer,
+				.mName = visibleDrawsName
+			});
 		}
 
 		{
 			TRACE_ZONE_SCOPED_N("Initialize render buckets' buffers")
 			const FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
-			const FAssetManager& assetManager = entt::locator<FAssetManager>::value();
-			const FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
 
-			uint32 numBuckets = materialBuckets.size();
-			outBuckets.reserve(numBuckets);
+			outBuckets.reserve(sceneBuckets.size());
 
-			for (const FMaterialBucket& bucket : materialBuckets)
+			for (const FGPUSceneBucket& sceneBucket : sceneBuckets)
 			{
 				FDrawIndirectBucket& drawIndirectBucket = outBuckets.emplace_back();
-				drawIndirectBucket.mMaterialHandle = bucket.mTargetMaterial;
+				drawIndirectBucket.mMaterialHandle = sceneBucket.mMaterial;
+				drawIndirectBucket.mCount = sceneBucket.mNumDraws;
+				drawIndirectBucket.mFirstDraw = sceneBucket.mFirstDraw;
+				drawIndirectBucket.mMaxDrawCommands = sceneBucket.mNumDraws;
+				drawIndirectBucket.mDrawInstanceIdsAddress = drawInstanceIdsUpload.mDeviceAddress + sceneBucket.mFirstDraw * sizeof(uint32);
+
+				// Buckets of meshes without clusters keep a draw per instance
+				if (bClusterCulling && sceneBucket.mNumClusters > 0)
+				{
+					drawIndirectBucket.mNumClusters = sceneBucket.mNumClusters;
+					drawIndirectBucket.mMaxDrawCommands = sceneBucket.mNumClusters;
+					drawIndirectBucket.mDrawClusterOffsetsAddress = drawClusterOffsetsUpload.mDeviceAddress + sceneBucket.mFirstDraw * sizeof(uint32);
+				}
 
-				const FMaterial* material = materialManager.AccessMaterial(bucket.mTargetMaterial);
-				const uint32 numDraws = bucket.mEndIt - bucket.mStartIt;
-				drawIndirectBucket.mCount = numDraws;
+				const FMaterial* material = materialManager.AccessMaterial(sceneBucket.mMaterial);
 
-				// Initialize buffers
-				const FRGBufferInfo drawDataBufferInfo = {
-					.mSize = numDraws * sizeof(FMaterial::IndirectDrawData),
-					.mBufferFlags = EBufferFlags::CreateMapped | EBufferFlags::StorageBuffer,
-					.mName = FName(fmt::format("{}_DrawData", material->mName))
-				};
-				drawIndirectBucket.mDrawBuffer = graphBuilder.CreateBuffer(drawDataBufferInfo);
-
-				const FDeviceSize indirectCommandsBufferSize = sizeof(FIndirectDrawBufferHeader) + numDraws * sizeof(vk::DrawIndirectCommand);
+				// Initialize buffers. Names are formatted on the stack, FName only allocates for unseen strings
+				fmt::memory_buffer nameBuffer;
+				const FDeviceSize indirectCommandsBufferSize = sizeof(FIndirectDrawBufferHeader) + drawIndirectBucket.mMaxDrawCommands * sizeof(vk::DrawIndirectCommand);
+				fmt::format_to(std::back_inserter(nameBuffer), "{}_IndirectCommands", material->mName);
 				const FRGBufferInfo indirectCommandsBufferInfo = {
 					.mSize = indirectCommandsBufferSize,
-					.mBufferFlags = EBufferFlags::CreateMapped | EBufferFlags::StorageBuffer | EBufferFlags::IndirectBuffer,
-					.mName = FName(fmt::format("{}_IndirectCommands", material->mName))
+					.mBufferFlags = EBufferFlags::StorageBuffer | EBufferFlags::IndirectBuffer,
+					.mName = FName(std::string_view(nameBuffer.data(), nameBuffer.size()))
 				};
 				drawIndirectBucket.mIndirectCommandBuffer = graphBuilder.CreateBuffer(indirectCommandsBufferInfo);
 
-				FMaterial::IndirectDrawData* drawDatum = graphBuilder.AllocatePOD<FMaterial::IndirectDrawData>(numDraws);
-				graphBuilder.QueueBufferUpload({
-					.mTargetBuffer = drawIndirectBucket.mDrawBuffer,
-					.mData = drawDatum,
-					.mDataSize = numDraws * sizeof(FMaterial::IndirectDrawData),
-				});
-
-				const FViewData* viewData = sceneView->mViewData;
-
-				// Fill buffers
-				uint32 drawIndex = 0;
-				for (FDrawCallIt drawCallIt = bucket.mStartIt; drawCallIt != bucket.mEndIt; ++drawCallIt)
+				if (bOcclusionCulling)
 				{
-					FMaterial::IndirectDrawData& drawData = drawDatum[drawIndex];
-					drawData.mModelToProj = viewData->mWorldToProjection * drawCallIt->mWorldTransform;
-					drawData.mModelToView = viewData->mViewMatrix * drawCallIt->mWorldTransform;
-					drawData.mModelToWorld = drawCallIt->mWorldTransform;
-					drawData.mNormalModelToWorld = glm::float3x3(glm::transpose(glm::inverse(drawData.mModelToWorld)));
+					nameBuffer.clear();
+					fmt::format_to(std::back_inserter(nameBuffer), "{}_LateIndirectCommands", material->mName);
 
-					drawData.mMaterialInstance = materialManager.GetMaterialInstanceAddress(gpu, drawCallIt->mMaterialInstance);
-					drawData.mMaterialData = materialManager.GetMaterialDataAddress(gpu, bucket.mTargetMaterial);
-					drawData.mMeshData = assetManager.GetMeshPointersAddress(gpu, drawCallIt->mMesh);
-
-					drawIndex++;
+					FRGBufferInfo lateIndirectCommandsBufferInfo = indirectCommandsBufferInfo;
+					lateIndirectCommandsBufferInfo.mName = FName(std::string_view(nameBuffer.data(), nameBuffer.size()));
+					drawIndirectBucket.mLateIndirectCommandBuffer = graphBuilder.CreateBuffer(lateIndirectCommandsBufferInfo);
 				}
 			}
 		}
@@ -283,11 +291,18 @@ namespace Turbo
 	{
       TRACE_ZONE_SCOPED()
 
-		std::vector<vk::AccelerationStructureInstanceKHR> instances;
 		auto& registry = world->mRegistry;
-
 		const auto meshView = registry.view<FMeshComponent>();
-		instances.reserve(meshView.size());
+
+		// Instances are written straight to the upload ring
+		const uint32 numInstances = meshView.size();
+		FRGUploadAllocation instancesUpload = {};
+		if (numInstances > 0)
+		{
+			instancesUpload = graphBuilder.AllocateUpload<vk::AccelerationStructureInstanceKHR>(numInstances);
+		}
+		vk::AccelerationStructureInstanceKHR* instances = instancesUpload.GetMapped<vk::AccelerationStructureInstanceKHR>();
+		uint32 instanceId = 0;
 
 		FAssetManager& assetManager = entt::locator<FAssetManager>::value();
 		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
@@ -310,18 +325,20 @@ namespace Turbo
 			TURBO_CHECK(transform != nullptr)
 
 			const FMesh* mesh = assetManager.AccessMesh(meshComp.mMesh);
-			const FAccelerationStructure* blas = gpu.AccessBLAS(mesh->mBlas);
+			const FAccelerationStructure* blas = gpu.AccessBLAS(mesh->mBlas[SelectInstanceLod(*sceneView, *mesh, *transform)]);
 
-			vk::AccelerationStructureInstanceKHR& instance = instances.emplace_back();
+			vk::AccelerationStructureInstanceKHR instance = {};
 			std::memcpy(instance.transform, glm::value_ptr(glm::transpose(*transform)), sizeof(vk::TransformMatrixKHR));
 			instance.mask = 0xFF; // all for now
 			instance.instanceCustomIndex = meshComp.mMesh.GetIndex();
 			instance.accelerationStructureReference = blas->mDeviceAddress;
+
+			instances[instanceId++] = instance;
 		}
 
 		const static FName tlasName{"SceneTLAS"};
 		FTLASBuilder tlasBuilder = {
-			.mNumInstances = static_cast<uint32>(instances.size()),
+			.mNumInstances = numInstances,
 			.mName = tlasName
 		};
 		const FAccelerationStructureSizeInfo& tlasSizeInfo = gpu.CalculateTLASSize(tlasBuilder);
@@ -331,17 +348,6 @@ namespace Turbo
 		// As we regenerate TLAS each frame, we can enqueue it's deletion when the frame woudl be completed.
 		gpu.DestroyTLAS(sceneView->mTLAS);
 
-		// Create instances data buffer and queue for upload
-		const static FName instancesBufferName("SceneTLASInstanceData");
-		FRGResourceHandle instanceDataBufferHandle;
-		void* instanceDataPtr;
-      std::tie(instanceDataBufferHandle, instanceDataPtr) = graphBuilder.CreateAndQueueBufferUpload(FCreateAndUploadBuffer{
-         .mData = instances.data(),
-         .mSize = instances.size() * sizeof(vk::AccelerationStructureInstanceKHR),
-         .mBufferFlags = EBufferFlags::AccelerationStructureInput,
-         .mName = instancesBufferName,
-		});
-
 		// Create TLAS's scratch buffer
 		const static FName scratchBufferName("SceneTLASScratch");
 		const FRGResourceHandle scratchBufferHandle = graphBuilder.CreateBuffer(FRGBufferInfo{
@@ -354,20 +360,19 @@ namespace Turbo
 		sceneView->mTLASStorageBufferHandle = graphBuilder.RegisterExternalBuffer(sceneTLAS->mBuffer);
 
 		const FName passName("Build TLAS");
-		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Compute);
-		pass->ReadBuffer(instanceDataBufferHandle);
-		pass->WriteBuffer(scratchBufferHandle);
-		pass->WriteBuffer(sceneView->mTLASStorageBufferHandle);
+		FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::AsyncCompute);
+		pass->WriteBuffer(scratchBufferHandle, ERGResourceUsage::AccelerationStructureBuild);
+		pass->WriteBuffer(sceneView->mTLASStorageBufferHandle, ERGResourceUsage::AccelerationStructureBuild);
 
-		pass->mExecutePass.BindLambda(
+		pass->BindExecute(
 			[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
-				const THandle<FBuffer> instanceDataBuffer = resources.mBuffers.at(instanceDataBufferHandle);
 				const THandle<FBuffer> scratchBuffer = resources.mBuffers.at(scratchBufferHandle);
 
 				cmd.BuildTLAS({
 					.mTLAS = sceneView->mTLAS,
-					.mInstanceDataBuffer = instanceDataBuffer,
+					.mInstanceData = instancesUpload.mDeviceAddress,
+					.mNumInstances = numInstances,
 					.mScratchBuffer = scratchBuffer,
 				});
 			}
@@ -380,6 +385,9 @@ namespace Turbo
 		SceneGraph::UpdateWorldTransforms(world->mRegistry);
 		FCameraUtils::UpdateDirtyCameras(world->mRegistry);
 		FCameraUtils::UpdateCameraFrustum(world->mRegistry);
+
+		// Reads the dirty flags of the world transforms
+		mGPUScene.Update(entt::locator<FGPUDevice>::value(), graphBuilder, world->mRegistry);
 		SceneGraph::ClearDirtyFlags(world->mRegistry);
 
 		auto mainCameraView = world->mRegistry.view<FCamera>();
@@ -401,20 +409,25 @@ namespace Turbo
 
 		FWorld* world = gEngine->GetWorld();
 
-		// Create and upload view data
+		// Create and upload view data. The host copy is read while building the draw data.
 		sceneView->mViewData = graphBuilder.AllocatePOD<FViewData>();
-		sceneView->mViewDataBufferHandle = graphBuilder.CreateBuffer({
-			.mSize = sizeof(FViewData),
-			.mBufferFlags = EBufferFlags::CreateMapped | EBufferFlags::UniformBuffer,
-			.mName = FName("ViewDataBuffer")
-		});
-
 		UpdateViewData(world, *sceneView->mViewData);
-		graphBuilder.QueueBufferUpload({
-			.mTargetBuffer = sceneView->mViewDataBufferHandle,
-			.mData = sceneView->mViewData,
-			.mDataSize = sizeof(FViewData),
-		});
+
+		const FRGUploadAllocation viewDataUpload = graphBuilder.AllocateUpload<FViewData>();
+		std::memcpy(viewDataUpload.mMappedAddress, sceneView->mViewData, sizeof(FViewData));
+		sceneView->mViewDataAddress = viewDataUpload.mDeviceAddress;
+
+		// Pixels covered by a unit at unit distance, or at any distance with an orthographic projection
+		FGeometryBuffer& geometryBuffer = entt::locator<FGeometryBuffer>::value();
+		const float viewHeight = graphBuilder.GetTextureInfo(geometryBuffer.mDepthStencil).mHeight;
+		const float pixelsPerUnit = 0.5f * viewHeight * glm::abs(sceneView->mViewData->mProjectionMatrix[1][1]);
+		sceneView->mLodErrorScale = pixelsPerUnit / glm::exp2(CVarLodBias.Get());
+
+		const FGPUDevice& gpuDevice = entt::locator<FGPUDevice>::value();
+		sceneView->mInstancesAddress = mGPUScene.GetInstancesAddress(gpuDevice);
+		sceneView->mInstanceBuffer = mGPUScene.GetInstanceBuffer();
+		sceneView->mMeshTableAddress = entt::locator<FAssetManager>::value().GetMeshTableAddress(gpuDevice);
+		sceneView->mMaterialTableAddress = entt::locator<FMaterialManager>::value().GetMaterialTableAddress(gpuDevice);
 
 		CreateSceneTLAS(graphBuilder, world, sceneView);
 
@@ -439,31 +452,19 @@ namespace Turbo
 			}
 		}
 
-		if (lights.empty() == false)
-		{
-			std::tie(sceneView->mLightsBufferHandle, sceneView->mLights) =
-				graphBuilder.CreateAndQueueBufferUpload<FLight>(FCreateAndUploadBuffer{
-					.mData = lights.data(),
-					.mSize = lights.size() * sizeof(FLight),
-					.mBufferFlags = EBufferFlags::UniformBuffer,
-					.mName = FName("PointLightBuffer")
-				});
-		}
-		else
+		const uint32 numLights = lights.size();
+
+		// This is a completely invalid solution. Let's do it!
+		// TODO: Create dummy buffer in FEngineResources
+		if (lights.empty())
 		{
-			// This is a completely invalid solution. Let's do it!
-			// TODO: Create dummy buffer in FEngineResources
-			FLight dummyLight;
-
-			std::tie(sceneView->mLightsBufferHandle, sceneView->mLights) =
-				graphBuilder.CreateAndQueueBufferUpload<FLight>(FCreateAndUploadBuffer{
-					.mData = &dummyLight,
-					.mSize = sizeof(FLight),
-					.mBufferFlags = EBufferFlags::UniformBuffer,
-					.mName = FName("PointLightBuffer")
-				});
+			lights.emplace_back();
 		}
 
+		const FRGUploadAllocation lightsUpload = graphBuilder.AllocateUpload<FLight>(lights.size());
+		std::memcpy(lightsUpload.mMappedAddress, lights.data(), lights.size() * sizeof(FLight));
+		sceneView->mLightsAddress = lightsUpload.mDeviceAddress;
+
 		FWorldSettings worldSettings = {};
 		auto worldSettingsView = world->mRegistry.view<FWorldSettings>();
 		if (worldSettingsView->empty() == false)
@@ -472,60 +473,264 @@ namespace Turbo
 		}
 
 		// Create and upload scene data
-		FSceneData* sceneData = graphBuilder.AllocatePOD<FSceneData>();
-		sceneData->mNumLights = lights.size();
-		sceneData->mSceneTLAS = sceneView->mTLAS.GetIndex();
-		sceneData->mAmbientLight = worldSettings.mAmbientLight;
-
-		std::tie(sceneView->mSceneDataBufferHandle, sceneView->mSceneData) =
-			graphBuilder.CreateAndQueueBufferUpload<FSceneData>(FCreateAndUploadBuffer{
-				.mData = sceneData,
-				.mSize = sizeof(FSceneData),
-				.mBufferFlags = EBufferFlags::UniformBuffer,
-				.mName = FName("SceneDataBuffer")
-			});
+		FSceneData sceneData = {};
+		sceneData.mNumLights = numLights;
+		sceneData.mSceneTLAS = sceneView->mTLAS.GetIndex();
+		sceneData.mAmbientLight = worldSettings.mAmbientLight;
+
+		const FRGUploadAllocation sceneDataUpload = graphBuilder.AllocateUpload<FSceneData>();
+		*sceneDataUpload.GetMapped<FSceneData>() = sceneData;
+		sceneView->mSceneDataAddress = sceneDataUpload.mDeviceAddress;
 
-		std::vector<FDrawIndirectBucket> drawIndirectBuckets;
-		CreateIndirectRenderBuffers(graphBuilder, world, sceneView, drawIndirectBuckets);
+		TArenaArray<FDrawIndirectBucket> drawIndirectBuckets = graphBuilder.AllocateArray<FDrawIndirectBucket>();
+		const bool bOcclusionCulling = CVarOcclusionCulling.Get();
+		const bool bClusterCulling = CVarClusterCulling.Get();
+		CreateIndirectRenderBuffers(graphBuilder, sceneView, bOcclusionCulling, bClusterCulling, drawIndirectBuckets);
 
 		// Fill IndirectCommandsBuffer header
 		for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
 		{
 			RenderGraphUtils::AddFillBufferPass(graphBuilder, bucket.mIndirectCommandBuffer, 0, sizeof(FIndirectDrawBufferHeader), 0);
+			if (bucket.mLateIndirectCommandBuffer.IsValid())
+			{
+				RenderGraphUtils::AddFillBufferPass(graphBuilder, bucket.mLateIndirectCommandBuffer, 0, sizeof(FIndirectDrawBufferHeader), 0);
+			}
+		}
+
+		ReadCullingStats();
+		const FRGResourceHandle cullingStatsBuffer = graphBuilder.RegisterExternalBuffer(mCullingStatsBuffers[gpuDevice.GetBufferedFrameId()]);
+
+		// Instances visible in the last frame are drawn first, the newly visible ones are found by testing the rest
+		// against the Hi-Z of their depth
+		if (bOcclusionCulling)
+		{
+			AddCullingPass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::Early, nullptr, cullingStatsBuffer);
+			AddDepthPrepass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::Early);
+
+			const FHiZPyramid* hiZ = AddHiZBuildPasses(graphBuilder, geometryBuffer.mDepthStencil);
+			AddCullingPass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::Late, hiZ, cullingStatsBuffer);
+			AddDepthPrepass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::Late);
+		}
+		else
+		{
+			AddCullingPass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::FrustumOnly, nullptr, cullingStatsBuffer);
+			AddDepthPrepass(graphBuilder, sceneView, drawIndirectBuckets, SceneCullingCS::EPhase::FrustumOnly);
+		}
+
+		// Base Pass
+		{
+			const static FName geometryPassName = FName("GeometryPass");
+			FRGPassInitializer geometryPass = graphBuilder.AddPass(geometryPassName, EPassType::Graphics);
+
+			geometryPass->AddAttachment(
+				{
+					.mTexture = geometryBuffer.mSceneColor,
+					.mLoadOp = ELoadOp::Clear,
+					.mClearColor = EClearColor::OpaqueBlack
+				},
+				0);
+			geometryPass->SetDepthStencilAttachment({
+				.mTexture = geometryBuffer.mDepthStencil,
+				.mLoadOp = ELoadOp::Load,
+				.mStoreOp = EStoreOp::DontCare
+			});
+
+			geometryPass->ReadBuffer(sceneView->mInstanceBuffer);
+			// Shadow ray queries trace the TLAS built on the async compute queue
+			geometryPass->ReadBuffer(sceneView->mTLASStorageBufferHandle, ERGResourceUsage::AccelerationStructureRead);
+			for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
+			{
+				geometryPass->ReadBuffer(bucket.mIndirectCommandBuffer, ERGResourceUsage::IndirectArgument);
+				if (bucket.mLateIndirectCommandBuffer.IsValid())
+				{
+					geometryPass->ReadBuffer(bucket.mLateIndirectCommandBuffer, ERGResourceUsage::IndirectArgument);
+				}
+			}
+
+			static const cstring kRenderBuckets = "Render Buckets";
+			TRACE_PLOT_CONFIGURE(kRenderBuckets, EPlotFormat::Number, true, true, 0xFFFF00)
+			TRACE_PLOT(kRenderBuckets, static_cast<int64>(drawIndirectBuckets.size()))
+
+			geometryPass->mNumWorkItems = drawIndirectBuckets.size();
+			geometryPass->BindExecuteRange(
+				[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources, uint32 firstBucket, uint32 endBucket)
+				{
+					FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
+
+					for (uint32 bucketId = firstBucket; bucketId < endBucket; ++bucketId)
+					{
+						const FDrawIndirectBucket& bucket = drawIndirectBuckets[bucketId];
+						TRACE_ZONE_SCOPED_N("Render Bucket")
+						TRACE_GPU_SCOPED(gpu, cmd, "Render Bucket")
+
+						// Skipped until the material pipeline is compiled
+						const THandle<FPipeline> graphicsPipeline = materialManager.GetGraphicsPipeline(gpu, bucket.mMaterialHandle);
+						if (!graphicsPipeline)
+						{
+							continue;
+						}
+
+						cmd.BindPipeline(graphicsPipeline);
+						cmd.BindDescriptorSet(gpu.GetBindlessResourcesSet(), 0);
+
+						const FMaterial::PushConstants pushConstants = {
+							.mViewData = sceneView->mViewDataAddress,
+							.mSceneData = sceneView->mSceneDataAddress,
+							.mLightData = sceneView->mLightsAddress,
+							.mInstances = sceneView->mInstancesAddress,
+							.mDrawInstanceIds = bucket.mDrawInstanceIdsAddress,
+							.mMeshes = sceneView->mMeshTableAddress,
+							.mMaterials = sceneView->mMaterialTableAddress
+						};
+
+						cmd.PushConstants(pushConstants);
+						RecordBucketDraws(cmd, resources, bucket, bucket.mIndirectCommandBuffer);
+						if (bucket.mLateIndirectCommandBuffer.IsValid())
+						{
+							RecordBucketDraws(cmd, resources, bucket, bucket.mLateIndirectCommandBuffer);
+						}
+					}
+				}
+			);
+
 		}
+	}
+
+	void FSceneRenderingLayer::ReadCullingStats()
+	{
+		FGPUDevice& gpu = entt::locator<FGPUDevice>::value();
+
+		// Begin frame waited for the last frame which used this buffered frame, so its counters are complete
+		const THandle<FBuffer> statsBufferHandle = mCullingStatsBuffers[gpu.GetBufferedFrameId()];
+		gpu.InvalidateMappedBuffer(statsBufferHandle);
+
+		const FBuffer* statsBuffer = gpu.AccessBuffer(statsBufferHandle);
+		SceneCullingCS::FCullingStats* mappedStats = reinterpret_cast<SceneCullingCS::FCullingStats*>(statsBuffer->mMappedAddress);
+		mCullingStats = *mappedStats;
+		*mappedStats = {};
+		gpu.FlushMappedBuffer(statsBufferHandle);
+
+		static const cstring kEarlyDraws = "Culling Early Draws";
+		static const cstring kLateDraws = "Culling Late Draws";
+		static const cstring kFrustumCulled = "Culling Frustum Culled";
+		static const cstring kOcclusionCulled = "Culling Occlusion Culled";
+		static const cstring kClustersCulled = "Culling Clusters Culled";
+		TRACE_PLOT_CONFIGURE(kEarlyDraws, EPlotFormat::Number, true, true, 0x40C040)
+		TRACE_PLOT(kEarlyDraws, static_cast<int64>(mCullingStats.mNumEarlyDraws))
+		TRACE_PLOT_CONFIGURE(kLateDraws, EPlotFormat::Number, true, true, 0x4080FF)
+		TRACE_PLOT(kLateDraws, static_cast<int64>(mCullingStats.mNumLateDraws))
+		TRACE_PLOT_CONFIGURE(kFrustumCulled, EPlotFormat::Number, true, true, 0xFF8040)
+		TRACE_PLOT(kFrustumCulled, static_cast<int64>(mCullingStats.mNumFrustumCulled))
+		TRACE_PLOT_CONFIGURE(kOcclusionCulled, EPlotFormat::Number, true, true, 0xFF4040)
+		TRACE_PLOT(kOcclusionCulled, static_cast<int64>(mCullingStats.mNumOcclusionCulled))
+		TRACE_PLOT_CONFIGURE(kClustersCulled, EPlotFormat::Number, true, true, 0xC040C0)
+		TRACE_PLOT(kClustersCulled, static_cast<int64>(mCullingStats.mNumClustersFrustumCulled
+			+ mCullingStats.mNumClustersConeCulled + mCullingStats.mNumClustersOcclusionCulled))
+	}
+
+	void FSceneRenderingLayer::AddCullingPass(
+		FRenderGraphBuilder& graphBuilder,
+		FSceneView* sceneView,
+		const TArenaArray<FDrawIndirectBucket>& buckets,
+		SceneCullingCS::EPhase phase,
+		const FHiZPyramid* hiZ,
+		FRGResourceHandle statsBuffer
+	) const
+	{
+		const bool bLatePhase = phase == SceneCullingCS::EPhase::Late;
+		TURBO_CHECK(bLatePhase == (hiZ != nullptr))
 
-		// Geometry culling
+		// Late phase needs the Hi-Z of this frame, there is no work to overlap it with
 		static FName cullingPassName = FName("GeometryCullingPass");
-		FRGPassInitializer cullingPass = graphBuilder.AddPass(cullingPassName, EPassType::Compute);
+		static FName lateCullingPassName = FName("GeometryCullingPassLate");
+		FRGPassInitializer cullingPass = graphBuilder.AddPass(
+			bLatePhase ? lateCullingPassName : cullingPassName,
+			bLatePhase ? EPassType::Compute : EPassType::AsyncCompute
+		);
 
-		cullingPass->ReadBuffer(sceneView->mViewDataBufferHandle);
-		for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
+		// Late phase stores the visibility of the instances for the next frame
+		if (bLatePhase)
 		{
-			cullingPass->ReadBuffer(bucket.mDrawBuffer);
-			cullingPass->WriteBuffer(bucket.mIndirectCommandBuffer);
+			cullingPass->WriteBuffer(sceneView->mInstanceBuffer);
 		}
+		else
+		{
+			cullingPass->ReadBuffer(sceneView->mInstanceBuffer);
+		}
+		cullingPass->WriteBuffer(statsBuffer);
 
-		cullingPass->mExecutePass.BindLambda(
-			[drawIndirectBuckets, pipeline = mFrustumCullingPipeline, sceneView](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+		// Clusters of the accepted draws are tested in the same pass
+		const FRGResourceHandle visibleDrawsBuffer = sceneView->mVisibleDrawsBuffer;
+		if (visibleDrawsBuffer.IsValid())
+		{
+			cullingPass->WriteBuffer(visibleDrawsBuffer);
+		}
+
+		FHiZPyramid hiZPyramid = {};
+		FRGUploadAllocation hiZLevelsUpload = {};
+		if (bLatePhase)
+		{
+			hiZPyramid = *hiZ;
+			hiZLevelsUpload = graphBuilder.AllocateUpload<uint32>(hiZPyramid.mNumLevels);
+			for (uint32 levelId = 0; levelId < hiZPyramid.mNumLevels; ++levelId)
+			{
+				cullingPass->ReadTexture(hiZPyramid.mLevels[levelId], ERGResourceUsage::Sampled);
+			}
+		}
+
+		for (const FDrawIndirectBucket& bucket : buckets)
+		{
+			cullingPass->WriteBuffer(bLatePhase ? bucket.mLateIndirectCommandBuffer : bucket.mIndirectCommandBuffer);
+		}
+
+		cullingPass->BindExecute(
+			[buckets, phase, bLatePhase, hiZPyramid, hiZLevelsUpload, statsBuffer, visibleDrawsBuffer, sceneView,
+				pipeline = mFrustumCullingPipeline, clusterPipeline = mClusterCullingPipeline]
+			(FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 			{
+				// Bindless indices of the graph textures are known only when the pass executes
+				uint32* hiZLevels = hiZLevelsUpload.GetMapped<uint32>();
+				for (uint32 levelId = 0; levelId < hiZPyramid.mNumLevels; ++levelId)
+				{
+					hiZLevels[levelId] = resources.mTextures.at(hiZPyramid.mLevels[levelId]).GetIndex();
+				}
+
 				cmd.BindPipeline(pipeline);
+				cmd.BindDescriptorSet(gpu.GetBindlessResourcesSet(), 0);
 
-				const FAssetManager& assetManager = entt::locator<FAssetManager>::value();
-				const FBuffer* viewDataBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mViewDataBufferHandle));
+				const THandle<FBuffer> statsBufferHandle = resources.mBuffers.at(statsBuffer);
+
+				THandle<FBuffer> visibleDrawsHandle = {};
+				FDeviceAddress visibleDrawsAddress = kNullDeviceAddress;
+				if (visibleDrawsBuffer.IsValid())
+				{
+					visibleDrawsHandle = resources.mBuffers.at(visibleDrawsBuffer);
+					visibleDrawsAddress = gpu.AccessBuffer(visibleDrawsHandle)->mDeviceAddress;
+				}
 
 				SceneCullingCS::FPushConstants pushConstants = {
-					.mViewData = viewDataBuffer->mDeviceAddress,
-					.mBounds = assetManager.GetBoundsAddress(gpu)
+					.mViewData = sceneView->mViewDataAddress,
+					.mInstances = sceneView->mInstancesAddress,
+					.mMeshes = sceneView->mMeshTableAddress,
+					.mHiZLevels = hiZLevelsUpload.mDeviceAddress,
+					.mStats = gpu.AccessBuffer(statsBufferHandle)->mDeviceAddress,
+					.mDepthSize = hiZPyramid.mDepthSize,
+					.mNumHiZLevels = hiZPyramid.mNumLevels,
+					.mPhase = phase,
+					.mLodErrorScale = sceneView->mLodErrorScale
 				};
 
-				for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
+				for (const FDrawIndirectBucket& bucket : buckets)
 				{
-					const FBuffer* drawBuffer = gpu.AccessBuffer(resources.mBuffers.at(bucket.mDrawBuffer));
-					const FBuffer* indirectCommandBuffer = gpu.AccessBuffer(resources.mBuffers.at(bucket.mIndirectCommandBuffer));
+					const FRGResourceHandle commandBuffer = bLatePhase ? bucket.mLateIndirectCommandBuffer : bucket.mIndirectCommandBuffer;
+					const FBuffer* indirectCommandBuffer = gpu.AccessBuffer(resources.mBuffers.at(commandBuffer));
 
-					pushConstants.mDrawData = drawBuffer->mDeviceAddress;
+					pushConstants.mDrawInstanceIds = bucket.mDrawInstanceIdsAddress;
 					pushConstants.mDrawIndirectCommand = indirectCommandBuffer->mDeviceAddress;
 					pushConstants.mNumDraws = bucket.mCount;
+					pushConstants.mDrawClusterOffsets = bucket.mDrawClusterOffsetsAddress;
+					pushConstants.mVisibleDraws = visibleDrawsAddress + bucket.mFirstDraw * sizeof(uint32);
+					pushConstants.mNumClusters = bucket.mNumClusters;
 
 					cmd.PushConstants(pushConstants);
 
@@ -533,144 +738,180 @@ namespace Turbo
 
 					cmd.Dispatch(groupCount);
 				}
+
+				// Thread per cluster of the draws the instance dispatches accepted
+				if (visibleDrawsBuffer.IsValid())
+				{
+					cmd.BufferBarrier(
+						visibleDrawsHandle,
+						vk::AccessFlagBits2::eShaderWrite,
+						vk::PipelineStageFlagBits2::eComputeShader,
+						vk::AccessFlagBits2::eShaderRead,
+						vk::PipelineStageFlagBits2::eComputeShader
+					);
+
+					cmd.BindPipeline(clusterPipeline);
+
+					for (const FDrawIndirectBucket& bucket : buckets)
+					{
+						if (bucket.mNumClusters == 0)
+						{
+							continue;
+						}
+
+						const FRGResourceHandle commandBuffer = bLatePhase ? bucket.mLateIndirectCommandBuffer : bucket.mIndirectCommandBuffer;
+
+						pushConstants.mDrawInstanceIds = bucket.mDrawInstanceIdsAddress;
+						pushConstants.mDrawIndirectCommand = gpu.AccessBuffer(resources.mBuffers.at(commandBuffer))->mDeviceAddress;
+						pushConstants.mNumDraws = bucket.mCount;
+						pushConstants.mDrawClusterOffsets = bucket.mDrawClusterOffsetsAddress;
+						pushConstants.mVisibleDraws = visibleDrawsAddress + bucket.mFirstDraw * sizeof(uint32);
+						pushConstants.mNumClusters = bucket.mNumClusters;
+
+						cmd.PushConstants(pushConstants);
+						cmd.Dispatch(glm::uint3(Math::DivideAndRoundUp<uint32>(bucket.mNumClusters, 64), 1, 1));
+					}
+				}
+
+				// Counters are read by the host when this buffered frame is reused
+				if (phase != SceneCullingCS::EPhase::Early)
+				{
+					cmd.BufferBarrier(
+						statsBufferHandle,
+						vk::AccessFlagBits2::eShaderWrite,
+						vk::PipelineStageFlagBits2::eComputeShader,
+						vk::AccessFlagBits2::eHostRead,
+						vk::PipelineStageFlagBits2::eHost
+					);
+				}
 			}
 		);
+	}
 
-		FGeometryBuffer& geometryBuffer = entt::locator<FGeometryBuffer>::value();
+	const FHiZPyramid* FSceneRenderingLayer::AddHiZBuildPasses(FRenderGraphBuilder& graphBuilder, FRGResourceHandle depthTexture) const
+	{
+		TRACE_ZONE_SCOPED()
 
-		// Depth pre-pass
-		{
-			const static FName depthPrepassName = FName("DepthPrepass");
-			FRGPassInitializer depthPass = graphBuilder.AddPass(depthPrepassName, EPassType::Graphics);
+		static const std::array<FName, HiZBuildCS::kMaxLevels> levelNames = CreateHiZLevelNames("HiZ_");
+		static const std::array<FName, HiZBuildCS::kMaxLevels> passNames = CreateHiZLevelNames("HiZBuild_");
 
-			depthPass->SetDepthStencilAttachment({
-				.mTexture = geometryBuffer.mDepthStencil,
-				.mLoadOp = ELoadOp::Clear,
-				.mClearColor = EClearColor::Zero
-			});
+		const FRGTextureInfo depthInfo = graphBuilder.GetTextureInfo(depthTexture);
 
-			depthPass->ReadBuffer(sceneView->mViewDataBufferHandle);
+		FHiZPyramid* hiZ = graphBuilder.AllocatePOD<FHiZPyramid>();
+		*hiZ = {};
+		hiZ->mDepthSize = glm::uint2(depthInfo.mWidth, depthInfo.mHeight);
 
-			for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
-			{
-				depthPass->ReadBuffer(bucket.mIndirectCommandBuffer);
-				depthPass->ReadBuffer(bucket.mDrawBuffer);
-			}
+		// Each level halves the previous one down to 1x1, rounding up so the odd texels are kept
+		FRGResourceHandle source = depthTexture;
+		glm::uint2 sourceSize = hiZ->mDepthSize;
+		while (hiZ->mNumLevels < HiZBuildCS::kMaxLevels)
+		{
+			const uint32 levelId = hiZ->mNumLevels++;
+			const glm::uint2 levelSize = (sourceSize + 1u) / 2u;
+
+			const FRGResourceHandle level = graphBuilder.CreateTexture(FRGTextureInfo{
+				.mWidth = static_cast<uint16>(levelSize.x),
+				.mHeight = static_cast<uint16>(levelSize.y),
+				.mFormat = HiZBuildCS::kFormat,
+				.mFlags = ETextureFlags::StorageImage,
+				.mName = levelNames[levelId]
+			});
+			hiZ->mLevels[levelId] = level;
+
+			FRGPassInitializer pass = graphBuilder.AddPass(passNames[levelId], EPassType::Compute);
+			pass->ReadTexture(source, ERGResourceUsage::Sampled);
+			pass->WriteTexture(level);
 
-			depthPass->mExecutePass.BindLambda(
-				[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+			pass->BindExecute(
+				[=, pipeline = mHiZBuildPipeline](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 				{
-					FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
+					const HiZBuildCS::FPushConstants pushConstants = {
+						.mSource = resources.mTextures.at(source).GetIndex(),
+						.mDestination = resources.mTextures.at(level).GetIndex(),
+						.mSourceSize = sourceSize,
+						.mDestinationSize = levelSize,
+					};
 
-					for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
-					{
-						TRACE_ZONE_SCOPED_N("Render Depth Pre-Pass")
-						TRACE_GPU_SCOPED(gpu, cmd, "Render Depth Pre-Pass")
+					cmd.BindPipeline(pipeline);
+					cmd.PushConstants(pushConstants);
+					cmd.BindDescriptorSet(gpu.GetBindlessResourcesSet(), 0);
 
-						const FMaterial* material = materialManager.AccessMaterial(bucket.mMaterialHandle);
-						if (material->mDepthOnlyPipeline)
-						{
-							cmd.BindPipeline(material->mDepthOnlyPipeline);
-							cmd.BindDescriptorSet(gpu.GetBindlessResourcesSet(), 0);
-
-							const FBuffer* drawBuffer = gpu.AccessBuffer(resources.mBuffers.at(bucket.mDrawBuffer));
-							const FBuffer* viewDataBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mViewDataBufferHandle));
-
-							const FMaterial::PushConstants pushConstants = {
-								.mViewData = viewDataBuffer->mDeviceAddress,
-								.mDrawData = drawBuffer->mDeviceAddress
-							};
-
-							const THandle<FBuffer> commandBufferHandle = resources.mBuffers.at(bucket.mIndirectCommandBuffer);
-
-							cmd.PushConstants(pushConstants);
-							cmd.DrawIndirectCount(FDrawIndirectCountParams{
-								.mBuffer = commandBufferHandle,
-								.mOffset = sizeof(FIndirectDrawBufferHeader),
-								.mCountBuffer = commandBufferHandle,
-								.mCountOffset = offsetof(FIndirectDrawBufferHeader, mNumDrawCalls),
-								.mMaxDrawCount = bucket.mCount,
-								.mStride = sizeof(vk::DrawIndirectCommand),
-							});
-						}
-					}
+					const glm::uint3 groupCount = Math::DivideAndRoundUp<glm::uint3>(
+						glm::uint3(levelSize, 1),
+						glm::uint3(8, 8, 1)
+					);
+					cmd.Dispatch(groupCount);
 				});
+
+			if (levelSize == glm::uint2(1))
+			{
+				break;
+			}
+
+			source = level;
+			sourceSize = levelSize;
 		}
 
-		// Base Pass
-		{
-			const static FName geometryPassName = FName("GeometryPass");
-			FRGPassInitializer geometryPass = graphBuilder.AddPass(geometryPassName, EPassType::Graphics);
+		return hiZ;
+	}
 
-			geometryPass->AddAttachment(
-				{
-					.mTexture = geometryBuffer.mSceneColor,
-					.mLoadOp = ELoadOp::Clear,
-					.mClearColor = EClearColor::OpaqueBlack
-				},
-				0);
-			geometryPass->SetDepthStencilAttachment({
-				.mTexture = geometryBuffer.mDepthStencil,
-				.mLoadOp = ELoadOp::Load,
-				.mStoreOp = EStoreOp::DontCare
-			});
+	void FSceneRenderingLayer::AddDepthPrepass(
+		FRenderGraphBuilder& graphBuilder,
+		FSceneView* sceneView,
+		const TArenaArray<FDrawIndirectBucket>& buckets,
+		SceneCullingCS::EPhase phase
+	)
+	{
+		const bool bLatePhase = phase == SceneCullingCS::EPhase::Late;
 
-			geometryPass->ReadBuffer(sceneView->mViewDataBufferHandle);
-			geometryPass->ReadBuffer(sceneView->mSceneDataBufferHandle);
-			geometryPass->ReadBuffer(sceneView->mLightsBufferHandle);
+		const static FName depthPrepassName = FName("DepthPrepass");
+		const static FName lateDepthPrepassName = FName("DepthPrepassLate");
+		FRGPassInitializer depthPass = graphBuilder.AddPass(bLatePhase ? lateDepthPrepassName : depthPrepassName, EPassType::Graphics);
 
-			for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
+		const FGeometryBuffer& geometryBuffer = entt::locator<FGeometryBuffer>::value();
+		depthPass->SetDepthStencilAttachment({
+			.mTexture = geometryBuffer.mDepthStencil,
+			.mLoadOp = bLatePhase ? ELoadOp::Load : ELoadOp::Clear,
+			.mClearColor = EClearColor::Zero
+		});
+
+		depthPass->ReadBuffer(sceneView->mInstanceBuffer);
+		for (const FDrawIndirectBucket& bucket : buckets)
+		{
+			depthPass->ReadBuffer(bLatePhase ? bucket.mLateIndirectCommandBuffer : bucket.mIndirectCommandBuffer, ERGResourceUsage::IndirectArgument);
+		}
+
+		// Buckets can be recorded on multiple threads
+		depthPass->mNumWorkItems = buckets.size();
+		depthPass->BindExecuteRange(
+			[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources, uint32 firstBucket, uint32 endBucket)
 			{
-				geometryPass->ReadBuffer(bucket.mIndirectCommandBuffer);
-				geometryPass->ReadBuffer(bucket.mDrawBuffer);
-			}
+				FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
 
-			geometryPass->mExecutePass.BindLambda(
-				[=](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+				for (uint32 bucketId = firstBucket; bucketId < endBucket; ++bucketId)
 				{
-					FMaterialManager& materialManager = entt::locator<FMaterialManager>::value();
+					const FDrawIndirectBucket& bucket = buckets[bucketId];
+					TRACE_ZONE_SCOPED_N("Render Depth Pre-Pass")
+					TRACE_GPU_SCOPED(gpu, cmd, "Render Depth Pre-Pass")
 
-					for (const FDrawIndirectBucket& bucket : drawIndirectBuckets)
+					const THandle<FPipeline> depthOnlyPipeline = materialManager.GetDepthOnlyPipeline(gpu, bucket.mMaterialHandle);
+					if (depthOnlyPipeline)
 					{
-						TRACE_ZONE_SCOPED_N("Render Bucket")
-						TRACE_GPU_SCOPED(gpu, cmd, "Render Bucket")
-
-						const FMaterial* material = materialManager.AccessMaterial(bucket.mMaterialHandle);
-						cmd.BindPipeline(material->mGraphicsPipeline);
+						cmd.BindPipeline(depthOnlyPipeline);
 						cmd.BindDescriptorSet(gpu.GetBindlessResourcesSet(), 0);
 
-						const FBuffer* drawBuffer = gpu.AccessBuffer(resources.mBuffers.at(bucket.mDrawBuffer));
-						const FBuffer* viewDataBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mViewDataBufferHandle));
-						const FBuffer* sceneDataBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mSceneDataBufferHandle));
-						const FBuffer* lightsBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mLightsBufferHandle));
-
 						const FMaterial::PushConstants pushConstants = {
-							.mViewData = viewDataBuffer->mDeviceAddress,
-							.mSceneData = sceneDataBuffer->mDeviceAddress,
-							.mLightData = lightsBuffer->mDeviceAddress,
-							.mDrawData = drawBuffer->mDeviceAddress
+							.mViewData = sceneView->mViewDataAddress,
+							.mInstances = sceneView->mInstancesAddress,
+							.mDrawInstanceIds = bucket.mDrawInstanceIdsAddress,
+							.mMeshes = sceneView->mMeshTableAddress
 						};
 
-						THandle<FBuffer> commandBufferHandle = resources.mBuffers.at(bucket.mIndirectCommandBuffer);
-
 						cmd.PushConstants(pushConstants);
-						cmd.DrawIndirectCount(FDrawIndirectCountParams{
-							.mBuffer = commandBufferHandle,
-							.mOffset = sizeof(FIndirectDrawBufferHeader),
-							.mCountBuffer = commandBufferHandle,
-							.mCountOffset = offsetof(FIndirectDrawBufferHeader, mNumDrawCalls),
-							.mMaxDrawCount = bucket.mCount,
-							.mStride = sizeof(vk::DrawIndirectCommand),
-						});
+						RecordBucketDraws(cmd, resources, bucket, bLatePhase ? bucket.mLateIndirectCommandBuffer : bucket.mIndirectCommandBuffer);
 					}
-
-					static const cstring kRenderBuckets = "Render Buckets";
-					TRACE_PLOT_CONFIGURE(kRenderBuckets, EPlotFormat::Number, true, true, 0xFFFF00)
-					TRACE_PLOT(kRenderBuckets, static_cast<int64>(drawIndirectBuckets.size()))
 				}
-			);
-
-		}
+			});
 	}
 
 	void FSceneRenderingLayer::RenderPostProcess(FRenderGraphBuilder& graphBuilder, FSceneView* sceneView)
@@ -690,44 +931,35 @@ namespace Turbo
 				settings = settingsView.get<FPostProcessSettings>(*settingsView.begin());
 			}
 
-			ToneMapperPostProcess::FUniformBuffer* uniformBufferData = graphBuilder.AllocatePOD<ToneMapperPostProcess::FUniformBuffer>();
-			uniformBufferData->mOneOverPreExposure = glm::exp2(settings.mEV100);
-			uniformBufferData->mExposure = 1.f / uniformBufferData->mOneOverPreExposure;
-			uniformBufferData->mSaturation = settings.mAgXSaturation;
-			uniformBufferData->mOffset = settings.mAgXOffset;
-			uniformBufferData->mSlope = settings.mAgXSlope;
-			uniformBufferData->mPower = settings.mAgXPower;
-
-			const static FName uniformBufferName = FName("ToneMapper.UniformBuffer");
-			FRGResourceHandle uniformBufferHandle;
-			std::tie(uniformBufferHandle, uniformBufferData) =
-				graphBuilder.CreateAndQueueBufferUpload<ToneMapperPostProcess::FUniformBuffer>(FCreateAndUploadBuffer{
-					.mData = uniformBufferData,
-					.mSize = sizeof(ToneMapperPostProcess::FUniformBuffer),
-					.mBufferFlags = EBufferFlags::UniformBuffer,
-					.mName = uniformBufferName
-				});
+			ToneMapperPostProcess::FUniformBuffer uniformBufferData = {};
+			uniformBufferData.mOneOverPreExposure = glm::exp2(settings.mEV100);
+			uniformBufferData.mExposure = 1.f / uniformBufferData.mOneOverPreExposure;
+			uniformBufferData.mSaturation = settings.mAgXSaturation;
+			uniformBufferData.mOffset = settings.mAgXOffset;
+			uniformBufferData.mSlope = settings.mAgXSlope;
+			uniformBufferData.mPower = settings.mAgXPower;
+
+			const FRGUploadAllocation uniformBufferUpload = graphBuilder.AllocateUpload<ToneMapperPostProcess::FUniformBuffer>();
+			*uniformBufferUpload.GetMapped<ToneMapperPostProcess::FUniformBuffer>() = uniformBufferData;
+			const FDeviceAddress uniformBufferAddress = uniformBufferUpload.mDeviceAddress;
 
 			const static FName passName = FName("ToneMapping");
 			FRGPassInitializer pass = graphBuilder.AddPass(passName, EPassType::Compute);
-			pass->ReadBuffer(uniformBufferHandle);
 			pass->ReadTexture(geometryBuffer.mSceneColor);
 			pass->WriteTexture(geometryBuffer.mAfterToneMap);
 
-			pass->mExecutePass.BindLambda(
+			pass->BindExecute(
 				[=, pipeline = mToneMapperPipeline](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
 				{
 					const THandle<FTexture> sceneColorHandle = resources.mTextures.at(geometryBuffer.mSceneColor);
 					const FTextureCold* sceneColorCold = gpu.AccessTextureCold(sceneColorHandle);
 					const THandle<FTexture> afterToneMapHandle = resources.mTextures.at(geometryBuffer.mAfterToneMap);
-					const FBuffer* uniformBuffer = gpu.AccessBuffer(resources.mBuffers.at(uniformBufferHandle));
-					const FBuffer* viewDataBuffer = gpu.AccessBuffer(resources.mBuffers.at(sceneView->mViewDataBufferHandle));
 
 					const ToneMapperPostProcess::FPushConstants pushConstants = {
 						.mSceneColor = sceneColorHandle.GetIndex(),
 						.mOutput = afterToneMapHandle.GetIndex(),
 						.mTextureSize = sceneColorCold->GetSize2D(),
-						.mUniforms = uniformBuffer->mDeviceAddress,
+						.mUniforms = uniformBufferAddress,
 					};
 
 					cmd.BindPipeline(pipeline);
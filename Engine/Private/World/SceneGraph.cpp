@@ -69,6 +69,8 @@ namespace Turbo
 				{
 					if (processedEntities.insert(child).second)
 					{
+						// Children inherit the flag, so systems caching world transforms see them changed too
+						registry.emplace_or_replace<FWorldTransformDirty>(child);
 						entitiesToProcess.push_back(child);
 					}
 				});
@@ -2,8 +2,8 @@
 
 #include "Assets/StaticMesh.h"
 #include "Assets/AssetManagerHelpers.h"
-#include "Core/DataStructures/GenPoolGrowable.h"
 #include "Core/DataStructures/ManualPoolGrowable.h"
+#include "Core/DataStructures/PagedGenPool.h"
 #include "Graphics/Resources.h"
 
 DECLARE_LOG_CATEGORY(LogAssetManager, Display, Display)
@@ -44,6 +44,8 @@ namespace Turbo
 		[[nodiscard]] const FMesh* AccessMesh(THandle<FMesh> handle) const { return mMeshPool.Access(handle); }
 
 		[[nodiscard]] FDeviceAddress GetMeshPointersAddress(const FGPUDevice& gpu, THandle<FMesh> handle) const;
+		/** Array of FMeshData indexed by the mesh handle index */
+		[[nodiscard]] FDeviceAddress GetMeshTableAddress(const FGPUDevice& gpu) const;
 		[[nodiscard]] FDeviceAddress GetBoundsAddress(const FGPUDevice& gpu) const;
 
 		/** Mesh interface end */
@@ -58,6 +60,10 @@ namespace Turbo
 
 		/** Texture interface end */
 
+	private:
+		/** Recreates the mesh pointers and bounds buffers when the mesh pool outgrows them */
+		void ReserveMeshBuffers(FGPUDevice& gpu);
+
 	private:
 		template<typename AssetType>
 		THandle<AssetType> FindCachedAsset(uint32 hash)
@@ -73,9 +79,12 @@ namespace Turbo
 		}
 
 	private:
-		TGenPoolGrowable<FMesh> mMeshPool;
+		TPagedGenPool<FMesh, FDummyColdType, false, kMeshPoolPageSize> mMeshPool;
 		THandle<FBuffer> mMeshPointersPool;
 		THandle<FBuffer> mBoundsPool;
+		/** Host copies of the mesh pointers and bounds, uploaded again when the buffers grow */
+		std::vector<FMeshData> mMeshData;
+		std::vector<FBounds> mMeshBounds;
 
 		TManualPoolGrowable<FTextureAsset> mTexturePool;
 
@@ -4,8 +4,8 @@ namespace Turbo
 {
 	using FAssetHash = uint32;
 
-	// Replace with something more robust
-	constexpr uint32 kMaxMeshes = 1024;
+	/** Mesh pool grows by pages of this many meshes, the mesh pointers and bounds buffers grow with it */
+	constexpr uint32 kMeshPoolPageSize = 1024;
 
 	struct FMeshLoadSettings
 	{
@@ -1,8 +1,10 @@
 #pragma once
 
-#include "Core/DataStructures/GenPoolGrowable.h"
+#include "Core/DataStructures/PagedGenPool.h"
 #include "Graphics/ResourceBuilders.h"
 
+DECLARE_LOG_CATEGORY(LogMaterialManager, Display, Display)
+
 namespace Turbo
 {
 	struct FBuffer;
@@ -20,16 +22,12 @@ namespace Turbo
 			uint32 mUniformBufferIndex = kInvalidUniformBufferIndex;
 		};
 
-		struct IndirectDrawData final
+		/** Entry of the material table indexed by the material handle index, mirrored by FMaterialTableEntry in BasePassCommon.slang */
+		struct TableEntry final
 		{
-			glm::float4x4 mModelToProj;
-			glm::float4x4 mModelToView;
-			glm::float4x4 mModelToWorld;
-			glm::float3x3 mNormalModelToWorld;
-
-			FDeviceAddress mMaterialData = kNullDeviceAddress;
-			FDeviceAddress mMaterialInstance = kNullDeviceAddress;
-			FDeviceAddress mMeshData = kNullDeviceAddress;
+			FDeviceAddress mData = kNullDeviceAddress;
+			uint32 mInstancesOffset = 0;
+			uint32 mInstanceStride = 0;
 		};
 
 		struct PushConstants final
@@ -38,7 +36,13 @@ namespace Turbo
 			FDeviceAddress mSceneData = kNullDeviceAddress;
 			FDeviceAddress mLightData = kNullDeviceAddress;
 
-			FDeviceAddress mDrawData = kNullDeviceAddress;
+			/** FGPUScene instances and the instance ids of the bucket draws */
+			FDeviceAddress mInstances = kNullDeviceAddress;
+			FDeviceAddress mDrawInstanceIds = kNullDeviceAddress;
+
+			/** Tables indexed by the mesh and material indices of the instances */
+			FDeviceAddress mMeshes = kNullDeviceAddress;
+			FDeviceAddress mMaterials = kNullDeviceAddress;
 		};
 
 		THandle<FPipeline> mGraphicsPipeline = {};
@@ -55,6 +59,7 @@ namespace Turbo
 	{
 		FPipelineBuilder* mGraphicsPipeline = nullptr;
 		FPipelineBuilder* mDepthOnlyPipeline = nullptr;
+		/** Initial instance capacity, grows when more instances are created */
 		size_t mMaxInstances = 1;
 
 		size_t mMaterialDataSize = 0;
@@ -92,6 +97,14 @@ namespace Turbo
 		void UpdateMaterialData(FCommandBuffer& cmd, THandle<FMaterial> handle, MaterialData* data);
 		auto UpdateMaterialData(FCommandBuffer& cmd, THandle<FMaterial> handle, std::span<byte> data) -> void;
 		[[nodiscard]] FDeviceAddress GetMaterialDataAddress(const FGPUDevice& gpu, THandle<FMaterial> handle) const;
+		/** Array of FMaterial::TableEntry, shaders find material data and instances by indices through it */
+		[[nodiscard]] FDeviceAddress GetMaterialTableAddress(const FGPUDevice& gpu) const;
+
+	public:
+		/** Null while the material pipeline is compiling, the material should be skipped then */
+		[[nodiscard]] THandle<FPipeline> GetGraphicsPipeline(const FGPUDevice& gpu, THandle<FMaterial> handle) const;
+		/** Falls back to a shared depth pipeline while the material one is compiling. Null when the material isn't drawn. */
+		[[nodiscard]] THandle<FPipeline> GetDepthOnlyPipeline(const FGPUDevice& gpu, THandle<FMaterial> handle) const;
 
 	public:
 		[[nodiscard]] static size_t CalculateInstanceByteOffset(const FMaterial& material, uint32 instanceIndex);
@@ -107,18 +120,33 @@ namespace Turbo
 		void DestroyMaterialInstance(THandle<FMaterial::Instance> handle);
 
 	private:
-		TGenPoolGrowable<FMaterial> mMaterialPool;
-		TGenPoolGrowable<FMaterial::Instance> mMaterialInstancePool;
+		using FAvailableIndexes = std::vector<uint32>;
+
+		/** Doubles the instance capacity of the material, its data buffer is recreated */
+		void GrowMaterialInstances(FMaterial& material, FAvailableIndexes& availableIndexes);
+
+		/** Recreates the material table when the material pool outgrows it */
+		void ReserveMaterialTable(FGPUDevice& gpu);
+		void UpdateMaterialTableEntry(FGPUDevice& gpu, THandle<FMaterial> handle);
+
+	private:
+		TPagedGenPool<FMaterial, FDummyColdType, false, 64> mMaterialPool;
+		TPagedGenPool<FMaterial::Instance> mMaterialInstancePool;
 
 		using FMaterialInstanceArray = entt::dense_set<THandle<FMaterial::Instance>>;
 		using FMaterialToMaterialInstanceMap = entt::dense_map<THandle<FMaterial>, FMaterialInstanceArray>;
 		FMaterialToMaterialInstanceMap mMaterialToMaterialInstanceMap;
 
-		using FAvailableIndexes = std::vector<uint32>;
 		using FMaterialToAvailableIndexes = entt::dense_map<THandle<FMaterial>, FAvailableIndexes>;
 		FMaterialToAvailableIndexes mMaterialToAvailableIndexesMap;
 
 		entt::dense_map<FName, THandle<FMaterial>> mMaterialNameLookUp;
+
+		THandle<FPipeline> mFallbackDepthOnlyPipeline = {};
+
+		THandle<FBuffer> mMaterialTable = {};
+		/** Host copy of the table, uploaded again when the buffer grows */
+		std::vector<FMaterial::TableEntry> mMaterialTableEntries;
 	};
 
 	template <typename PerInstanceData>
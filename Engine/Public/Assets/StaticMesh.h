@@ -18,6 +18,54 @@ namespace Turbo
 		float mRadiusSquared = std::numeric_limits<float>::lowest();
 	};
 
+	/** Contiguous range of the mesh triangles culled as a unit on the GPU, mirrored by FMeshCluster in MeshRendering.slang */
+	struct FMeshCluster final
+	{
+		/** Mesh space center and radius */
+		glm::float4 mBoundingSphere = {};
+		/** Average front face normal. Viewers inside the cone around -mConeAxis given by mConeCutoff see only back faces. */
+		glm::float3 mConeAxis = {};
+		/** 1 disables the backface test */
+		float mConeCutoff = 1.f;
+
+		/** Range of the mesh index buffer */
+		uint32 mFirstIndex = 0;
+		uint32 mNumIndices = 0;
+
+		uint32 _PADDING[2] = {};
+	};
+	static_assert(sizeof(FMeshCluster) == 48, "Has to match the scalar layout of the shader struct");
+
+	/** Ranges of the mesh index buffer and clusters drawn at a level of detail, mirrored by FMeshLod in MeshRendering.slang */
+	struct FMeshLod final
+	{
+		uint32 mFirstIndex = 0;
+		uint32 mNumIndices = 0;
+		uint32 mFirstCluster = 0;
+		uint32 mNumClusters = 0;
+		/** Mesh space distance the simplified surface may be away from the source mesh, zero for the source mesh */
+		float mError = 0.f;
+	};
+	static_assert(sizeof(FMeshLod) == 20, "Has to match the scalar layout of the shader struct");
+
+	namespace MeshLods
+	{
+		/** Has to match kMaxMeshLods in MeshRendering.slang */
+		constexpr uint32 kMaxLods = 6;
+
+		/**
+		 * Appends simplified copies of the triangles to the indices. Each LOD has about half of the triangles of the previous
+		 * one and stores the accumulated quadric error of the simplification. The first LOD is the source mesh.
+		 */
+		void Build(std::vector<uint32>& indices, std::span<const glm::float3> positions, std::vector<FMeshLod>& outLods);
+
+		/**
+		 * Coarsest LOD whose error times the error scale is at most one. The scale converts mesh space errors to fractions
+		 * of the allowed screen space error. Has to match SelectLod in SceneCulling.slang.
+		 */
+		[[nodiscard]] uint32 SelectLod(std::span<const FMeshLod> lods, float errorScale);
+	}
+
 	struct FMesh final
 	{
 		THandle<FBuffer> mIndexBuffer = {};
@@ -27,17 +75,38 @@ namespace Turbo
 		THandle<FBuffer> mTangentBuffer = {};
 		THandle<FBuffer> mUVBuffer = {};
 		THandle<FBuffer> mColorBuffer = {};
+		THandle<FBuffer> mClusterBuffer = {};
 
-		THandle<FBLAS> mBlas = {};
+		/** One per LOD, ray queries trace the LOD the rasterization would draw */
+		std::array<THandle<FBLAS>, MeshLods::kMaxLods> mBlas = {};
 
 		FBounds mBounds;
 
+		/** Indices of the most detailed LOD */
 		uint32 mVertexCount = 0;
+		/** Clusters of the most detailed LOD, the most a draw of the mesh can emit */
+		uint32 mNumClusters = 0;
+
+		std::array<FMeshLod, MeshLods::kMaxLods> mLods = {};
+		uint32 mNumLods = 0;
 
 		FName mName;
 		FAssetHash mAssetHash;
 	};
 
+	namespace MeshClusters
+	{
+		/** Clusters fit a 64 thread group, triangle count is kept divisible by 4 as meshoptimizer prefers */
+		constexpr uint32 kMaxVertices = 64;
+		constexpr uint32 kMaxTriangles = 124;
+
+		/**
+		 * Splits the triangles into clusters of nearby triangles with similar normals and rewrites the indices, so each
+		 * cluster is a contiguous range of them. Cone axes follow the normals of counter-clockwise triangles.
+		 */
+		void Build(std::span<uint32> indices, std::span<const glm::float3> positions, std::vector<FMeshCluster>& outClusters);
+	}
+
 	struct FMeshData final
 	{
 		FDeviceAddress mIndexBuffer = kNullDeviceAddress;
@@ -45,9 +114,14 @@ namespace Turbo
 		FDeviceAddress mNormalBuffer = kNullDeviceAddress;
 		FDeviceAddress mTangentBuffer = kNullDeviceAddress;
 		FDeviceAddress mUVBuffer = kNullDeviceAddress;
+		FDeviceAddress mClusterBuffer = kNullDeviceAddress;
 
 		uint32 mVertexCount = 0;
 		uint32 mIndex = 0;
+		uint32 mNumClusters = 0;
+		uint32 mNumLods = 0;
+
+		std::array<FMeshLod, MeshLods::kMaxLods> mLods = {};
 	};
 
 } // Turbo
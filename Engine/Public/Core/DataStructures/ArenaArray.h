@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Core/Allocators/StackAllocator.h"
+
+namespace Turbo
+{
+	/**
+	 * Growable array allocated from an arena. Memory is never returned to the arena, it is released with the whole
+	 * arena instead, so the array suits data rebuilt every frame. Elements are moved with memcpy and never destroyed.
+	 */
+	template <typename T>
+	class TArenaArray final
+	{
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+		static constexpr uint32 kMinCapacity = 4;
+
+	public:
+		TArenaArray() = default;
+		explicit TArenaArray(FArenaAllocator& allocator) : mAllocator(&allocator) { }
+
+		void reserve(uint32 capacity)
+		{
+			if (capacity <= mCapacity)
+			{
+				return;
+			}
+
+			TURBO_CHECK_MSG(mAllocator != nullptr, "Arena array is not initialized")
+			T* newData = mAllocator->Allocate<T>(capacity);
+			if (mSize > 0)
+			{
+				std::memcpy(newData, mData, mSize * sizeof(T));
+			}
+
+			mData = newData;
+			mCapacity = capacity;
+		}
+
+		template <typename... ArgsType>
+		T& emplace_back(ArgsType&&... args)
+		{
+			if (mSize == mCapacity)
+			{
+				reserve(glm::max(mCapacity * 2, kMinCapacity));
+			}
+
+			return *new (mData + mSize++) T(std::forward<ArgsType>(args)...);
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void clear() { mSize = 0; }
+
+		[[nodiscard]] uint32 size() const { return mSize; }
+		[[nodiscard]] bool empty() const { return mSize == 0; }
+
+		T& operator[](uint32 index) { TURBO_CHECK_SLOW(index < mSize) return mData[index]; }
+		const T& operator[](uint32 index) const { TURBO_CHECK_SLOW(index < mSize) return mData[index]; }
+
+		T* data() { return mData; }
+		const T* data() const { return mData; }
+
+		T* begin() { return mData; }
+		T* end() { return mData + mSize; }
+		const T* begin() const { return mData; }
+		const T* end() const { return mData + mSize; }
+
+	private:
+		FArenaAllocator* mAllocator = nullptr;
+		T* mData = nullptr;
+		uint32 mSize = 0;
+		uint32 mCapacity = 0;
+	};
+} // Turbo
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "CommonMacros.h"
+#include "Core/DataStructures/GenPool.h"
+#include "Core/DataStructures/Handle.h"
+
+namespace Turbo
+{
+	/**
+	 * Generational pool which grows by fixed size pages. Pages are never moved or freed until the pool is destroyed, so
+	 * pointers returned by Access stay valid while other elements are acquired. Acquire and Release are O(1), released
+	 * indices are reused first so the pool stays dense.
+	 * Capacity can be limited, e.g. when handle indices are used as bindless descriptor indices.
+	 */
+	template<typename HotType, typename ColdType = FDummyColdType, bool bAllowGenReuse = false, FHandle::IndexType pageSize = 256>
+		requires (std::has_single_bit(pageSize) && pageSize < FHandle::kMaxIndex)
+	class TPagedGenPool
+	{
+		static constexpr bool kHasColdData = std::is_same_v<FDummyColdType, ColdType> == false;
+		static constexpr FHandle::IndexType kPageShift = std::countr_zero(pageSize);
+		static constexpr FHandle::IndexType kPageMask = pageSize - 1;
+		static constexpr FHandle::IndexType kMaxPages = (FHandle::kMaxIndex + pageSize - 1) / pageSize;
+
+		struct FPage
+		{
+			std::array<HotType, pageSize> mHotData;
+			std::array<ColdType, kHasColdData ? pageSize : 0> mColdData;
+			std::array<FHandle::GenerationType, pageSize> mGenerations = {};
+			std::array<bool, pageSize> mbAcquired = {};
+		};
+
+	public:
+		explicit TPagedGenPool(FHandle::IndexType maxCapacity = FHandle::kMaxIndex)
+			: mMaxCapacity(glm::min(maxCapacity, FHandle::kMaxIndex))
+		{
+			// The page table is never reallocated, readers of existing elements don't race with growth
+			mPages.resize(kMaxPages);
+		}
+
+		DELETE_COPY(TPagedGenPool);
+
+	public:
+		[[nodiscard]] static constexpr FHandle::IndexType GetPageSize() { return pageSize; }
+		/** Indices of the added pages within the max capacity */
+		[[nodiscard]] FHandle::IndexType GetCapacity() const { return glm::min(mNumPages * pageSize, mMaxCapacity); }
+		[[nodiscard]] FHandle::IndexType GetMaxCapacity() const { return mMaxCapacity; }
+		[[nodiscard]] FHandle::IndexType GetNumAcquiredResources() const { return mUsedIndices; }
+		[[nodiscard]] FHandle::IndexType GetNumPages() const { return mNumPages; }
+
+		/** Handles acquired so far have to be below the new limit */
+		void SetMaxCapacity(FHandle::IndexType maxCapacity)
+		{
+			maxCapacity = glm::min(maxCapacity, FHandle::kMaxIndex);
+			TURBO_CHECK_MSG(IsAnyAcquiredFrom(maxCapacity) == false, "Acquired resources exceed the new pool capacity!")
+
+			const FHandle::IndexType numPageIndices = mNumPages * pageSize;
+			const FHandle::IndexType oldEnd = glm::min(mMaxCapacity, numPageIndices);
+			const FHandle::IndexType newEnd = glm::min(maxCapacity, numPageIndices);
+			mMaxCapacity = maxCapacity;
+
+			if (newEnd < oldEnd)
+			{
+				std::erase_if(mFreeIndices, [this](FHandle::IndexType index) { return index >= mMaxCapacity; });
+			}
+			else if (newEnd > oldEnd)
+			{
+				// Indices of the added pages which the old limit cut off. They go to the bottom of the free list, so the
+				// lower free indices are still acquired first.
+				mFreeIndices.insert(mFreeIndices.begin(), newEnd - oldEnd, 0);
+				for (FHandle::IndexType index = oldEnd; index < newEnd; ++index)
+				{
+					mFreeIndices[newEnd - 1 - index] = index;
+				}
+			}
+		}
+
+		THandle<HotType> Acquire()
+		{
+			if (mFreeIndices.empty())
+			{
+				AddPage();
+			}
+
+			const FHandle::IndexType newIndex = mFreeIndices.back();
+			mFreeIndices.pop_back();
+
+			FPage& page = *mPages[newIndex >> kPageShift];
+			const FHandle::IndexType pageIndex = newIndex & kPageMask;
+			page.mbAcquired[pageIndex] = true;
+
+			THandle<HotType> newHandle {};
+			newHandle.mIndexAndGen = FHandle::CreateIndex(newIndex, page.mGenerations[pageIndex]);
+			TURBO_CHECK_MSG(newHandle.GetGeneration() < FHandle::kMaxGeneration, "No more resource generations left!")
+
+			++mUsedIndices;
+
+			return newHandle;
+		}
+
+		void Release(THandle<HotType> handle)
+		{
+			TURBO_CHECK(mUsedIndices > 0)
+			TURBO_CHECK(Access(handle))
+
+			FPage& page = *mPages[handle.GetIndex() >> kPageShift];
+			const FHandle::IndexType pageIndex = handle.GetIndex() & kPageMask;
+			page.mbAcquired[pageIndex] = false;
+
+			if constexpr (bAllowGenReuse)
+			{
+				page.mGenerations[pageIndex] = (page.mGenerations[pageIndex] + 1) % FHandle::kMaxGeneration;
+			}
+			else
+			{
+				++page.mGenerations[pageIndex];
+			}
+
+			--mUsedIndices;
+			mFreeIndices.push_back(handle.GetIndex());
+		}
+
+		HotType* Access(THandle<HotType> handle)
+		{
+			return const_cast<HotType*>(std::as_const(*this).Access(handle));
+		}
+
+		const HotType* Access(THandle<HotType> handle) const
+		{
+			if (const FPage* page = FindPage(handle))
+			{
+				return &page->mHotData[handle.GetIndex() & kPageMask];
+			}
+
+			return nullptr;
+		}
+
+		ColdType* AccessCold(THandle<HotType> handle)
+		{
+			return const_cast<ColdType*>(std::as_const(*this).AccessCold(handle));
+		}
+
+		const ColdType* AccessCold(THandle<HotType> handle) const
+		{
+			static_assert(kHasColdData);
+
+			if (const FPage* page = FindPage(handle))
+			{
+				return &page->mColdData[handle.GetIndex() & kPageMask];
+			}
+
+			return nullptr;
+		}
+
+		template<typename Function>
+		void ForEachEntry(Function function)
+		{
+			for (FHandle::IndexType pageId = 0; pageId < mNumPages; ++pageId)
+			{
+				const FPage& page = *mPages[pageId];
+				for (FHandle::IndexType pageIndex = 0; pageIndex < pageSize; ++pageIndex)
+				{
+					if (page.mbAcquired[pageIndex])
+					{
+						THandle<HotType> handle = {};
+						handle.mIndexAndGen = FHandle::CreateIndex((pageId << kPageShift) | pageIndex, page.mGenerations[pageIndex]);
+						function(handle);
+					}
+				}
+			}
+		}
+
+	private:
+		void AddPage()
+		{
+			const FHandle::IndexType firstIndex = mNumPages * pageSize;
+			TURBO_CHECK_MSG(firstIndex < mMaxCapacity, "No more resources left! Pool capacity: {}", mMaxCapacity)
+
+			mPages[mNumPages] = MakeUnique<FPage>();
+			++mNumPages;
+
+			// Lowest indices are acquired first
+			const FHandle::IndexType lastIndex = glm::min(firstIndex + pageSize, mMaxCapacity);
+			for (FHandle::IndexType index = lastIndex; index > firstIndex; --index)
+			{
+				mFreeIndices.push_back(index - 1);
+			}
+		}
+
+		[[nodiscard]] bool IsAnyAcquiredFrom(FHandle::IndexType firstIndex) const
+		{
+			if (mUsedIndices == 0)
+			{
+				return false;
+			}
+
+			for (FHandle::IndexType index = firstIndex; index < mNumPages * pageSize; ++index)
+			{
+				if (mPages[index >> kPageShift]->mbAcquired[index & kPageMask])
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		[[nodiscard]] const FPage* FindPage(THandle<HotType> handle) const
+		{
+			if (handle.IsValid() == false)
+			{
+				return nullptr;
+			}
+
+			const FHandle::IndexType pageId = handle.GetIndex() >> kPageShift;
+			if (pageId >= mNumPages)
+			{
+				return nullptr;
+			}
+
+			const FPage* page = mPages[pageId].get();
+			return page->mGenerations[handle.GetIndex() & kPageMask] == handle.GetGeneration() ? page : nullptr;
+		}
+
+	private:
+		std::vector<TUniquePtr<FPage>> mPages;
+		FHandle::IndexType mNumPages = 0;
+
+		std::vector<FHandle::IndexType> mFreeIndices;
+		FHandle::IndexType mUsedIndices = 0;
+		FHandle::IndexType mMaxCapacity = FHandle::kMaxIndex;
+	};
+} // Turbo
@@ -18,11 +18,14 @@ namespace Turbo
 		inline const std::string kShaderPath = "Shader";
 		inline const std::string kLogPath = PathCombine(kSavedPath, "Logs");
 		inline const std::string kConfigPath = PathCombine(kSavedPath, "Config");
+		inline const std::string kCachePath = PathCombine(kSavedPath, "Cache");
 
 		/** Use this to load asset data. It allows us to replace implementation
 		 * to use zip pack instead of files in the future */
 		bool LoadAssetData(FName filePath, std::vector<byte>& outData);
 		bool LoadData(std::string_view path, std::vector<byte>& outData);
+		/** Writes to a temporary file first, so the file is never left half written */
+		bool SaveData(std::string_view path, std::span<const byte> data);
 
 		bool CreateDirectory(std::string_view path);
 		void InitDirectories();
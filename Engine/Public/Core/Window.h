@@ -38,7 +38,8 @@ namespace Turbo
 
 		/** Static Interface */
 	public:
-		void InitBackend();
+		/** Headless backend uses the SDL offscreen video driver, the window has no Vulkan surface */
+		void InitBackend(bool bHeadless = false);
 		void StopBackend();
 
 		bool Init();
@@ -57,6 +58,7 @@ namespace Turbo
 
 		[[nodiscard]] glm::uint2 GetFrameBufferSize() const;
 		[[nodiscard]] SDL_Window* GetWindow() const { return mSDLWindow; }
+		[[nodiscard]] bool IsHeadless() const { return mbHeadless; }
 
 		float GetDisplayScale() const;
 
@@ -108,6 +110,7 @@ namespace Turbo
 		SDL_Surface* mWindowIconSurface = nullptr;
 
 		bool mbFullscreenEnabled = false;
+		bool mbHeadless = false;
 
 		// bool bFullscreen
 
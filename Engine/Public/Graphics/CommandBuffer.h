@@ -7,6 +7,8 @@
 #include "Graphics/Resources.h"
 #include "Graphics/VulkanHelpers.h"
 
+#include <numeric>
+
 namespace Turbo
 {
 	class FGPUDevice;
@@ -108,10 +110,55 @@ namespace Turbo
 	struct FBuildTLASParams
 	{
 		THandle<FTLAS> mTLAS;
-		THandle<FBuffer> mInstanceDataBuffer;
+		/** Tightly packed vk::AccelerationStructureInstanceKHR array, aligned to 16 bytes */
+		FDeviceAddress mInstanceData = kNullDeviceAddress;
+		uint32 mNumInstances = 0;
 		THandle<FBuffer> mScratchBuffer;
 	};
 
+	/** State commands FCommandBuffer skips when they wouldn't change the bound state */
+	enum class EStateCommand : uint8
+	{
+		BindPipeline,
+		BindDescriptorSet,
+		PushConstants,
+		SetViewport,
+		SetScissor,
+		Num
+	};
+
+	constexpr uint32 kNumStateCommands = static_cast<uint32>(EStateCommand::Num);
+
+	struct FCommandBufferStats
+	{
+		std::array<uint32, kNumStateCommands> mNumIssued = {};
+		std::array<uint32, kNumStateCommands> mNumSkipped = {};
+
+		[[nodiscard]] uint32 GetNumIssued() const { return std::accumulate(mNumIssued.begin(), mNumIssued.end(), 0u); }
+		[[nodiscard]] uint32 GetNumSkipped() const { return std::accumulate(mNumSkipped.begin(), mNumSkipped.end(), 0u); }
+
+		FCommandBufferStats& operator+=(const FCommandBufferStats& other)
+		{
+			for (uint32 commandId = 0; commandId < kNumStateCommands; ++commandId)
+			{
+				mNumIssued[commandId] += other.mNumIssued[commandId];
+				mNumSkipped[commandId] += other.mNumSkipped[commandId];
+			}
+			return *this;
+		}
+
+		FCommandBufferStats operator-(const FCommandBufferStats& other) const
+		{
+			FCommandBufferStats result = *this;
+			for (uint32 commandId = 0; commandId < kNumStateCommands; ++commandId)
+			{
+				result.mNumIssued[commandId] -= other.mNumIssued[commandId];
+				result.mNumSkipped[commandId] -= other.mNumSkipped[commandId];
+			}
+			return result;
+		}
+	};
+
 	class FCommandBuffer
 	{
 	public:
@@ -135,6 +182,8 @@ namespace Turbo
 		void CopyBuffer(THandle<FBuffer> src, THandle<FBuffer> dst, FDeviceSize size);
 		void CopyBuffer(const FCopyBufferParams& copyBufferInfo);
 		void CopyBufferToTexture(THandle<FBuffer> src, THandle<FTexture> dst, uint32 mipIndex, FDeviceSize bufferOffset = 0);
+		/** The texture has to be in eTransferSrcOptimal. Texels are tightly packed. */
+		void CopyTextureToBuffer(THandle<FTexture> src, THandle<FBuffer> dst, uint32 mipIndex, FDeviceSize bufferOffset = 0);
 		void FillBuffer(THandle<FBuffer> dst, FDeviceSize offset, FDeviceSize size, uint32 value);
 
 		void BindDescriptorSet(THandle<FDescriptorSet> descriptorSetHandle, uint32 setIndex = 0);
@@ -143,7 +192,8 @@ namespace Turbo
 
 		void Dispatch(const glm::uint3& groupCount);
 
-		void BeginRendering(const FRenderingAttachments& renderingAttachments);
+		/** When bSecondaryCommandBuffersContent is set, the rendering scope can only contain ExecuteCommands */
+		void BeginRendering(const FRenderingAttachments& renderingAttachments, bool bSecondaryCommandBuffersContent = false);
 		void EndRendering();
 
 		void SetViewport(const FViewport& viewport);
@@ -159,6 +209,8 @@ namespace Turbo
 
 		void BuildTLAS(const FBuildTLASParams& buildTLASParams);
 
+		void ExecuteCommands(std::span<FCommandBuffer* const> secondaryCommandBuffers);
+
 #if WITH_DEBUG_RENDERING_FEATURES
 		void BeginDebugUtilsLabel(const std::string_view& label, glm::float4 color = ELinearColor::kWhite);
 		void EndDebugUtilsLabel();
@@ -166,9 +218,18 @@ namespace Turbo
 	public:
 		vk::CommandBuffer GetVkCommandBuffer() const { return mVkCommandBuffer; }
 		FGPUDevice* GetGPUDevice() const { return mGpu; }
+		/** State commands issued and skipped since the command buffer began recording */
+		const FCommandBufferStats& GetStats() const { return mStats; }
+
+		/**
+		 * Forgets the bound state, the next state commands are issued even when they match it.
+		 * Has to be called after recording raw Vulkan commands into GetVkCommandBuffer().
+		 */
+		void InvalidateBoundState();
 
 	private:
 		void Begin();
+		void BeginSecondary(const vk::CommandBufferInheritanceInfo& inheritanceInfo);
 		void End();
 
 		void Reset();
@@ -181,9 +242,36 @@ namespace Turbo
 		FGPUDevice* mGpu;
 		vk::CommandBuffer mVkCommandBuffer = nullptr;
 
-		std::array<THandle<FDescriptorSet>, kMaxDescriptorSets> mBoundDescriptorSets;
 		THandle<FPipeline> mCurrentPipeline = {};
 
+		/**
+		 * State last recorded into the command buffer. Pipelines are compared by their Vulkan objects, which change when the
+		 * pipeline is recompiled. Descriptor sets and push constants are compared together with the layout key of the
+		 * pipeline they were recorded with, they stay valid for pipelines with compatible layouts.
+		 */
+		struct FBoundState
+		{
+			vk::Pipeline mVkPipeline = nullptr;
+
+			std::array<vk::DescriptorSet, kMaxDescriptorSets> mDescriptorSets = {};
+			std::array<vk::PipelineBindPoint, kMaxDescriptorSets> mDescriptorSetBindPoints = {};
+			std::array<size_t, kMaxDescriptorSets> mDescriptorSetLayoutKeys = {};
+
+			size_t mPushConstantsLayoutKey = 0;
+			uint32 mPushConstantsSize = 0;
+			std::array<byte, kMaxPushConstantSize> mPushConstants = {};
+
+			bool mbViewportValid = false;
+			vk::Viewport mViewport = {};
+			bool mbScissorValid = false;
+			vk::Rect2D mScissor = {};
+		};
+
+		FBoundState mBoundState = {};
+		FCommandBufferStats mStats = {};
+		/** Redundant state commands are skipped, see gpu.cmd.stateCache */
+		bool mbStateCache = true;
+
 		bool mbRecording = false;
 
 	public:
@@ -19,8 +19,9 @@ namespace Turbo
 	private:
 		FCommandBuffer* mCommandBuffer = nullptr;
 #if WITH_PROFILER
-		tracy::VkCtxScope* mGPUZone = nullptr;
-		tracy::ScopedZone* mCPUZone = nullptr;
+		/** Stored in place, every render graph pass opens a region */
+		std::optional<tracy::VkCtxScope> mGPUZone;
+		std::optional<tracy::ScopedZone> mCPUZone;
 #endif // WITH_PROFILER
 	};
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <typeindex>
 
 #include "Graphics/GraphicsCore.h"
@@ -86,4 +87,50 @@ namespace Turbo
 
 		FOnDestroy mOnDestroy;
 	};
+
+	/**
+	 * Destroy requests tagged with the device timeline value after which the GPU no longer uses their resources.
+	 * Requests are gathered in an open queue until the submission which can still use them is known, then Seal tags them
+	 * with its timeline value. Flush destroys every sealed request the GPU is done with, in the order they were sealed.
+	 */
+	class FTimelineDestroyQueue
+	{
+	public:
+		FTimelineDestroyQueue() : mOpenQueue(MakeUnique<FDestroyQueue>()) { }
+		DELETE_COPY(FTimelineDestroyQueue);
+
+		template <typename DestroyerType>
+			requires (std::is_base_of_v<IDestroyer, DestroyerType>)
+		void RequestDestroy(const DestroyerType& destroyer)
+		{
+			mOpenQueue->RequestDestroy(destroyer);
+			mbOpenQueueEmpty = false;
+		}
+
+		void AddOnDestroy(FOnDestroy::Delegate&& delegate)
+		{
+			mOpenQueue->OnDestroy().Add(std::move(delegate));
+			mbOpenQueueEmpty = false;
+		}
+
+		/** Requests made so far are destroyed once the timeline reaches the value */
+		void Seal(uint64 timelineValue);
+		void Flush(FGPUDevice& GPUDevice, uint64 completedTimelineValue);
+		/** Destroys every request, sealed or not. The device has to be idle. */
+		void FlushAll(FGPUDevice& GPUDevice);
+
+	private:
+		struct FSealedQueue
+		{
+			uint64 mTimelineValue = 0;
+			TUniquePtr<FDestroyQueue> mQueue;
+		};
+
+		TUniquePtr<FDestroyQueue> mOpenQueue;
+		bool mbOpenQueueEmpty = true;
+
+		std::deque<FSealedQueue> mSealedQueues;
+		/** Flushed queues keep their per type storage, so they are reused */
+		std::vector<TUniquePtr<FDestroyQueue>> mFreeQueues;
+	};
 } // Turbo
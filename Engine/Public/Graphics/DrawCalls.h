@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Assets/MaterialManager.h"
+#include "Core/DataStructures/Handle.h"
+#include "World/Camera.h"
+
+namespace Turbo
+{
+	struct FMesh;
+
+	struct FDrawCall
+	{
+		/** Index of the instance data in the GPU scene */
+		uint32 mInstanceId = 0;
+
+		THandle<FMesh> mMesh = {};
+		THandle<FMaterial> mMaterial = {};
+		THandle<FMaterial::Instance> mMaterialInstance = {};
+
+		uint64 mDrawCallHash = std::numeric_limits<uint64>::max();
+	};
+
+	using FDrawCallStorage = entt::storage<FDrawCall>;
+	using FDrawCallIt = FDrawCallStorage::iterator;
+
+	/** Range of sorted draw calls sharing the material */
+	struct FMaterialBucket
+	{
+		THandle<FMaterial> mTargetMaterial = {};
+		FDrawCallIt mStartIt = {};
+		FDrawCallIt mEndIt = {};
+	};
+
+	/** CPU side of the scene draw preparation. Doesn't touch the GPU, so it can run headless. */
+	namespace DrawCalls
+	{
+		/** Creates a draw call for each mesh entity registered in the GPU scene and sorts them by material, material instance and mesh */
+		void GatherDrawCalls(entt::registry& registry, FDrawCallStorage& outDrawCalls);
+
+		/** Splits sorted draw calls into material buckets */
+		void CreateMaterialBuckets(FDrawCallStorage& drawCalls, std::vector<FMaterialBucket>& outBuckets);
+	}
+} // Turbo
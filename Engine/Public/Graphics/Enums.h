@@ -2,7 +2,7 @@
 
 namespace Turbo
 {
-	enum class EBufferFlags : uint8
+	enum class EBufferFlags : uint16
 	{
 		None = 0,
 
@@ -18,8 +18,11 @@ namespace Turbo
 
 		AccelerationStructureStorage = 1 << 6,
 		AccelerationStructureInput = 1 << 7,
+
+		/** With CreateMapped, the host reads the buffer. See FGPUDevice::InvalidateMappedBuffer */
+		Readback = 1 << 8,
 	};
-	DEFINE_ENUM_OPERATORS(EBufferFlags, uint8)
+	DEFINE_ENUM_OPERATORS(EBufferFlags, uint16)
 
 	enum class ETextureType : uint8
 	{
@@ -59,6 +62,21 @@ namespace Turbo
 		Num
 	};
 
+	/** Owner of a GPU memory allocation, used for the memory budget accounting */
+	enum class EGPUMemoryCategory : uint8
+	{
+		Other,
+		TransientRenderTarget,
+		Mesh,
+		Texture,
+		AccelerationStructure,
+		Staging,
+		Material,
+		Scene,
+
+		Num
+	};
+
 	enum class EFilter : uint8
 	{
 		Nearest,
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "Core/DataStructures/ArenaArray.h"
 #include "Core/DataStructures/Handle.h"
 #include "Core/Delegate.h"
 #include "Core/Allocators/StackAllocator.h"
 #include "Graphics/GraphicsCore.h"
 #include "Graphics/FrameGraph/RenderGraphHelpers.h"
+#include "Graphics/FrameGraph/RenderGraphResourcePool.h"
+#include "Graphics/FrameGraph/RenderGraphUploadRing.h"
+#include <atomic>
 
 DECLARE_LOG_CATEGORY(LogRenderGraph, Info, Display)
 
@@ -18,34 +22,66 @@ namespace Turbo
 	struct FTexture;
 
 	DECLARE_DELEGATE(FRGExecutePassDelegate, FGPUDevice& /*gpu*/, FCommandBuffer& /*cmd*/, FRenderResources& /*resources*/);
+	DECLARE_DELEGATE(FRGExecutePassRangeDelegate, FGPUDevice& /*gpu*/, FCommandBuffer& /*cmd*/, FRenderResources& /*resources*/, uint32 /*begin*/, uint32 /*end*/);
 
 	struct FRGPassInfo
 	{
-		FRGResourceHandle ReadTexture(FRGResourceHandle texture);
-		FRGResourceHandle WriteTexture(FRGResourceHandle texture);
+		FRGResourceHandle ReadTexture(FRGResourceHandle texture, ERGResourceUsage usage = ERGResourceUsage::Default);
+		FRGResourceHandle WriteTexture(FRGResourceHandle texture, ERGResourceUsage usage = ERGResourceUsage::Default);
 
-		FRGResourceHandle ReadBuffer(FRGResourceHandle buffer);
-		FRGResourceHandle WriteBuffer(FRGResourceHandle buffer);
+		FRGResourceHandle ReadBuffer(FRGResourceHandle buffer, ERGResourceUsage usage = ERGResourceUsage::Default);
+		FRGResourceHandle WriteBuffer(FRGResourceHandle buffer, ERGResourceUsage usage = ERGResourceUsage::Default);
 
 		void AddAttachment(FRGResourceHandle attachment, uint32 attachmentIndex);
 		void AddAttachment(FRGAttachment attachment, uint32 attachmentIndex);
 		void SetDepthStencilAttachment(FRGResourceHandle attachment);
 		void SetDepthStencilAttachment(FRGAttachment attachment);
 
+		/** Pass has side effects not visible to the graph (e.g. acceleration structure build) and is never culled. */
+		void SetNeverCull(bool bNeverCull = true) { mbNeverCull = bNeverCull; }
+
+		/**
+		 * Binds the lambda to mExecutePass (or mExecutePassRange). Lambda is stored in the per frame arena of the graph, so
+		 * its captures are not limited by the inline storage of the delegate. Captures are never destroyed.
+		 */
+		template <typename LambdaType>
+		void BindExecute(LambdaType&& lambda);
+		template <typename LambdaType>
+		void BindExecuteRange(LambdaType&& lambda);
+
 	public:
-		std::vector<FRGResourceHandle> mTextureReads;
-		std::vector<FRGResourceHandle> mTextureWrites;
+		/** Arena backed. Allocated by the graph builder which owns the pass. */
+		TArenaArray<FRGResourceHandle> mTextureReads;
+		TArenaArray<FRGResourceHandle> mTextureWrites;
+
+		TArenaArray<FRGResourceHandle> mBufferReads;
+		TArenaArray<FRGResourceHandle> mBufferWrites;
 
-		std::vector<FRGResourceHandle> mBufferReads;
-		std::vector<FRGResourceHandle> mBufferWrites;
+		/** Parallel to the reads and writes above */
+		TArenaArray<ERGResourceUsage> mTextureReadUsages;
+		TArenaArray<ERGResourceUsage> mTextureWriteUsages;
+		TArenaArray<ERGResourceUsage> mBufferReadUsages;
+		TArenaArray<ERGResourceUsage> mBufferWriteUsages;
 
 		std::array<FRGAttachment, kMaxColorAttachments> mColorAttachments;
 		FRGAttachment mDepthStencilAttachment = {};
 
 		EPassType mPassType = EPassType::Undefined;
+		bool mbNeverCull = false;
+		/** Set during compilation, when no graph output depends on this pass */
+		bool mbCulled = false;
+		/** Set during compilation. AsyncCompute passes fall back to the graphics queue when there is no async compute queue. */
+		ERGQueue mQueue = ERGQueue::Graphics;
 
 		FRGExecutePassDelegate mExecutePass;
 
+		/**
+		 * Alternative to mExecutePass for passes with many independent work items (e.g. draw buckets).
+		 * Ranges of [0, mNumWorkItems) can be recorded on different threads into separate command buffers.
+		 */
+		FRGExecutePassRangeDelegate mExecutePassRange;
+		uint32 mNumWorkItems = 0;
+
 		FRenderGraphBuilder* mGraphBuilder = nullptr;
 		FRGPassHandle mHandle = {};
 		FName mName = {};
@@ -72,10 +108,39 @@ namespace Turbo
 		friend struct FRenderGraphBuilder;
 	};
 
+	/** Resources of one type indexed directly by the graph handles */
+	template <typename ResourceHandleType>
+	struct TRGResourceTable
+	{
+		/** Keeps the capacity, so the table doesn't allocate once it has seen the largest graph */
+		void Reset(uint32 numTransient, uint32 numExternal)
+		{
+			mTransient.assign(numTransient, {});
+			mExternal.assign(numExternal, {});
+		}
+
+		[[nodiscard]] ResourceHandleType at(FRGResourceHandle resource) const
+		{
+			const std::vector<ResourceHandleType>& resources = resource.IsExternal() ? mExternal : mTransient;
+			TURBO_CHECK_SLOW(resource.GetIndex() < resources.size())
+			return resources[resource.GetIndex()];
+		}
+
+		ResourceHandleType& operator[](FRGResourceHandle resource)
+		{
+			std::vector<ResourceHandleType>& resources = resource.IsExternal() ? mExternal : mTransient;
+			TURBO_CHECK_SLOW(resource.GetIndex() < resources.size())
+			return resources[resource.GetIndex()];
+		}
+
+		std::vector<ResourceHandleType> mTransient;
+		std::vector<ResourceHandleType> mExternal;
+	};
+
 	struct FRenderResources
 	{
-		entt::dense_map<FRGResourceHandle, THandle<FTexture>> mTextures = {};
-		entt::dense_map<FRGResourceHandle, THandle<FBuffer>> mBuffers = {};
+		TRGResourceTable<THandle<FTexture>> mTextures = {};
+		TRGResourceTable<THandle<FBuffer>> mBuffers = {};
 	};
 
 	struct FRenderGraphBuilder
@@ -94,34 +159,87 @@ namespace Turbo
 		// Buffer related methods
 		[[nodiscard]] FRGResourceHandle CreateBuffer(const FRGBufferInfo& bufferInfo);
 		FRGResourceHandle RegisterExternalBuffer(THandle<FBuffer> buffer);
-		void QueueBufferUpload(const FRGBufferUpload& bufferUpload);
-		[[nodiscard]] std::tuple<FRGResourceHandle, void* /*intermediatePtr */> CreateAndQueueBufferUpload(const FCreateAndUploadBuffer& createAndUploadBuffer);
 		[[nodiscard]] FRGBufferInfo GetBufferInfo(FRGResourceHandle resourceHandle) const;
 
-		template<typename T>
-		[[nodiscard]] std::tuple<FRGResourceHandle, T* /*intermediatePtr */> CreateAndQueueBufferUpload(const FCreateAndUploadBuffer& createAndUploadBuffer)
+		/** Marks resource as a graph output. Passes producing it are not culled. External resources are always exported. */
+		void ExportResource(FRGResourceHandle resourceHandle);
+
+		/**
+		 * Sub-allocates host written, device read data from the frame upload ring. Write it through the mapped pointer
+		 * before the graph is executed and read it on the device through the device address. The data is not a graph
+		 * resource, host writes are visible to every pass of the frame.
+		 */
+		[[nodiscard]] FRGUploadAllocation AllocateUpload(FDeviceSize size, FDeviceSize alignment = FRGUploadRing::kDefaultAlignment)
+		{
+			return mUploadRing.Allocate(size, alignment);
+		}
+
+		template <typename PODType>
+		[[nodiscard]] FRGUploadAllocation AllocateUpload(size_t num = 1)
 		{
-			std::tuple<FRGResourceHandle, void*> result = CreateAndQueueBufferUpload(createAndUploadBuffer);
-			return std::make_tuple(std::get<0>(result), static_cast<T*>(std::get<1>(result)));
+			return mUploadRing.Allocate(num * sizeof(PODType), glm::max<FDeviceSize>(alignof(PODType), FRGUploadRing::kDefaultAlignment));
 		}
 
 		// Pass related methods
 		[[nodiscard]] FRGPassInitializer AddPass(FName passName, EPassType passType = EPassType::Undefined);
 
 		// Compilation
+		/** Compiles the graph, or reuses results of the previous compilation when the graph structure didn't change */
 		void Compile();
+		/** Hash of everything the compilation depends on: passes, their resource uses and the resource descriptions */
+		[[nodiscard]] size_t HashGraphStructure() const;
+		void CullPasses();
+		void CompileQueues();
+		void CompileResourceLifetimes();
+		void CompileResourceAliasing();
 		void CompileTextureSynchronization();
 		void CompileBufferSynchronization();
+		/** Splits passes into submissions at cross queue dependencies */
+		void CompileSubmissions();
 
 		void Execute(FGPUDevice& gpu, FCommandBuffer& cmd);
-
-		void Reset();
+		void RecordPass(FGPUDevice& gpu, FCommandBuffer& cmd, uint32 passId, FRenderResources& renderResources);
+		/** Records chunks of passes on task threads into secondary command buffers, and executes them in the graph order */
+		void RecordPassesParallel(FGPUDevice& gpu, FCommandBuffer& cmd, std::span<const uint32> passIds, FRenderResources& renderResources);
+		void RecordPassBarriers(FGPUDevice& gpu, FCommandBuffer& cmd, uint32 passId, const FRenderResources& renderResources);
+		/** Releases ownership of textures used next on the other queue */
+		void RecordReleaseBarriers(FGPUDevice& gpu, FCommandBuffer& cmd, std::span<const FRGTextureMemoryBarrier> releaseBarriers, const FRenderResources& renderResources);
+		/** Records a single pipeline barrier, skipped when there is nothing to synchronize */
+		void RecordBarriers(FCommandBuffer& cmd, std::span<const vk::ImageMemoryBarrier2> imageBarriers, const vk::MemoryBarrier2& memoryBarrier);
+
+		/** Starts a new graph. Call after FGPUDevice::BeginFrame, the upload ring of the buffered frame is reused. */
+		void Reset(FGPUDevice& gpu);
+
+		/** Destroys resources kept alive between frames. Call before the gpu device shutdown. */
+		void ReleaseResources(FGPUDevice& gpu);
+
+		[[nodiscard]] const FRGResourcePool& GetResourcePool() const { return mResourcePool; }
+		[[nodiscard]] const FRGUploadRing& GetUploadRing() const { return mUploadRing; }
+		/** Memory required by the transient resources of the last compiled graph, with and without aliasing */
+		[[nodiscard]] FDeviceSize GetTransientMemorySize() const { return mTransientMemorySize; }
+		[[nodiscard]] FDeviceSize GetTransientMemorySizeWithoutAliasing() const { return mTransientMemorySizeWithoutAliasing; }
+		/** Barriers recorded by the last executed graph and the number of vkCmdPipelineBarrier2 calls they were batched into */
+		[[nodiscard]] uint32 GetNumBarriers() const { return mNumBarriers; }
+		[[nodiscard]] uint32 GetNumBarrierBatches() const { return mNumBarrierBatches; }
+		/** Queue submissions of the last compiled graph */
+		[[nodiscard]] const std::vector<FRGSubmission>& GetSubmissions() const { return mSubmissions; }
+		/** Number of Compile() calls which reused the previous compilation and which compiled the graph from scratch */
+		[[nodiscard]] uint32 GetNumCompileCacheHits() const { return mNumCompileCacheHits; }
+		[[nodiscard]] uint32 GetNumCompileCacheMisses() const { return mNumCompileCacheMisses; }
+		/** State commands issued and skipped by each pass of the last executed graph, indexed by pass id */
+		[[nodiscard]] std::span<const FRGPassCommandStats> GetPassCommandStats() const { return mPassCommandStats; }
 
 		[[nodiscard]] byte* Allocate(size_t numBytes)
 		{
 			return mAllocator.Allocate(numBytes);
 		}
 
+		template <typename Type>
+		[[nodiscard]] TArenaArray<Type> AllocateArray()
+		{
+			return TArenaArray<Type>(mAllocator);
+		}
+
 		template <typename PODType>
 		[[nodiscard]] PODType* AllocatePOD()
 		{
@@ -135,6 +253,12 @@ namespace Turbo
 		}
 
 		[[nodiscard]] vk::Format GetTextureFormat(FRGResourceHandle resourceHandle) const;
+		[[nodiscard]] FRenderingAttachments MakeRenderingAttachments(FGPUDevice& gpu, const FRGPassInfo& pass, const FRenderResources& renderResources) const;
+		[[nodiscard]] const FRGTextureInfo& GetRenderTargetInfo(const FRGPassInfo& pass) const;
+		void SetViewportAndScissor(FCommandBuffer& cmd, const FRGPassInfo& pass) const;
+
+		/** Records the graph on the calling thread this frame, e.g. when a frame debugger captures it */
+		void ForceSerialRecording() { mbForceSerialRecording = true; }
 
 	public:
 		std::vector<FRGPassInfo> mRenderPasses;
@@ -143,6 +267,10 @@ namespace Turbo
 		std::vector<FRGPassTextureBarriers> mPerPassTextureBarriers;
 		FRGPassTextureBarriers mExternalTexturesBarriers;
 
+		/** Ownership releases recorded after the pass, or before the graph for the external textures */
+		std::vector<FRGPassTextureBarriers> mPerPassTextureReleaseBarriers;
+		FRGPassTextureBarriers mExternalTexturesReleaseBarriers;
+
 		using FRGPassBufferBarriers = std::vector<FRGBufferMemoryBarrier>;
 		std::vector<FRGPassBufferBarriers> mPerPassBufferBarriers;
 
@@ -150,9 +278,79 @@ namespace Turbo
 		std::vector<FRGExternalTextureInfo> mExternalTextures;
 
 		std::vector<FRGBufferInfo> mBuffers;
-		std::vector<FRGBufferUpload> mQueuedBufferUploads;
 		std::vector<FRGExternalBufferInfo> mExternalBuffers;
 
+		/** Indexed by transient resource index */
+		std::vector<FRGResourceLifetime> mTextureLifetimes;
+		std::vector<FRGResourceLifetime> mBufferLifetimes;
+		std::vector<FRGResourcePlacement> mTexturePlacements;
+		std::vector<FRGResourcePlacement> mBufferPlacements;
+		std::array<FRGTransientHeapInfo, static_cast<size_t>(ERGTransientHeap::Num)> mTransientHeaps;
+
+		FDeviceSize mTransientMemorySize = 0;
+		FDeviceSize mTransientMemorySizeWithoutAliasing = 0;
+
+		std::vector<FRGResourceHandle> mExportedResources;
+		uint32 mNumCulledPasses = 0;
+
+		std::vector<FRGQueueDependency> mQueueDependencies;
+		std::vector<FRGSubmission> mSubmissions;
+		bool mbUsesAsyncCompute = false;
+
+		/** Reused by Execute() between frames */
+		FRenderResources mRenderResources;
+		std::vector<vk::Semaphore> mSubmissionSemaphores;
+		std::vector<vk::Semaphore> mWaitSemaphores;
+
+		/** Compilation results above survive Reset() and are reused while the graph hash stays the same */
+		std::vector<FRGCompiledPass> mCompiledPasses;
+		size_t mCompiledGraphHash = 0;
+		bool mbCompiledGraphValid = false;
+		uint32 mNumCompileCacheHits = 0;
+		uint32 mNumCompileCacheMisses = 0;
+
+		/** Incremented by the recording threads */
+		std::atomic<uint32> mNumBarriers = 0;
+		std::atomic<uint32> mNumBarrierBatches = 0;
+
+		/** Every element is written by the thread recording its pass, split passes are summed after recording */
+		std::vector<FRGPassCommandStats> mPassCommandStats;
+
+		bool mbForceSerialRecording = false;
+
 		FArenaAllocator mAllocator = FArenaAllocator(kPerFrameStackSize);
+
+		FRGResourcePool mResourcePool;
+		FRGUploadRing mUploadRing;
 	};
+
+	template <typename LambdaType>
+	void FRGPassInfo::BindExecute(LambdaType&& lambda)
+	{
+		using FLambda = std::decay_t<LambdaType>;
+		static_assert(std::is_trivially_destructible_v<FLambda>, "Captures are never destroyed. Capture arena allocated data instead of containers.");
+
+		FLambda* storedLambda = new (mGraphBuilder->AllocatePOD<FLambda>()) FLambda(std::forward<LambdaType>(lambda));
+		mExecutePass.BindLambda(
+			[storedLambda](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources)
+			{
+				(*storedLambda)(gpu, cmd, resources);
+			}
+		);
+	}
+
+	template <typename LambdaType>
+	void FRGPassInfo::BindExecuteRange(LambdaType&& lambda)
+	{
+		using FLambda = std::decay_t<LambdaType>;
+		static_assert(std::is_trivially_destructible_v<FLambda>, "Captures are never destroyed. Capture arena allocated data instead of containers.");
+
+		FLambda* storedLambda = new (mGraphBuilder->AllocatePOD<FLambda>()) FLambda(std::forward<LambdaType>(lambda));
+		mExecutePassRange.BindLambda(
+			[storedLambda](FGPUDevice& gpu, FCommandBuffer& cmd, FRenderResources& resources, uint32 begin, uint32 end)
+			{
+				(*storedLambda)(gpu, cmd, resources, begin, end);
+			}
+		);
+	}
 } // Turbo
@@ -94,9 +94,22 @@ namespace Turbo
 		Undefined,
 		Graphics,
 		Compute,
-		Transfer
+		Transfer,
+		/** Compute pass submitted to the async compute queue. Runs on the graphics queue when the device has no separate compute queue family. */
+		AsyncCompute
 	};
 
+	/** Queue the pass is submitted to */
+	enum class ERGQueue : uint8
+	{
+		Graphics,
+		AsyncCompute,
+
+		Num
+	};
+
+	[[nodiscard]] uint32 FindQueueFamily(const FGPUDevice& gpu, ERGQueue queue);
+
 	enum class ETextureLayout
 	{
 		Undefined,
@@ -166,12 +179,34 @@ namespace Turbo
 		return ETextureLayout::Undefined;
 	}
 
-	enum class EResourceAccess
+	/** How a pass uses a resource. Selects pipeline stages, access masks and texture layout of the barriers. */
+	enum class ERGResourceUsage : uint8
 	{
-		Read,
-		ReadWrite,
+		/** Derived from the pass type */
+		Default,
+
+		IndirectArgument,
+		Uniform,
+		Storage,
+		Sampled,
+
+		ColorAttachment,
+		DepthStencilAttachment,
+
+		TransferSrc,
+		TransferDst,
+
+		AccelerationStructureBuild,
+		/** Ray queries in fragment or compute shaders */
+		AccelerationStructureRead,
+	};
 
-		HostWrite,
+	/** Synchronization scope of one resource use */
+	struct FRGResourceAccess
+	{
+		vk::PipelineStageFlags2 mStageMask = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 mAccessMask = vk::AccessFlagBits2::eNone;
+		ETextureLayout mLayout = ETextureLayout::Undefined;
 	};
 
 	struct FRGTextureInfo
@@ -237,6 +272,10 @@ namespace Turbo
 		vk::AccessFlags2 mSrcAccessMask = vk::AccessFlagBits2::eMemoryWrite;
 		vk::AccessFlags2 mDstAccessMask = vk::AccessFlagBits2::eMemoryWrite | vk::AccessFlagBits2::eMemoryRead;
 
+		/** Queue family ownership transfer when different. Release and acquire barriers are recorded on the source and destination queue. */
+		ERGQueue mSrcQueue = ERGQueue::Graphics;
+		ERGQueue mDstQueue = ERGQueue::Graphics;
+
 		FRGResourceHandle mTexture = {};
 
 		[[nodiscard]] vk::ImageMemoryBarrier2 ToVkImageBarrier(FGPUDevice& gpu, THandle<FTexture> textureHandle) const;
@@ -247,22 +286,80 @@ namespace Turbo
 	{
 		uint16 mFirstPass = UINT16_MAX;
 		uint16 mLastPass = 0;
+		/** Used on the async compute queue. It can be in use outside of the lifetime, so it is never aliased. */
+		bool mbAsyncCompute = false;
+
+		[[nodiscard]] bool IsValid() const { return mFirstPass <= mLastPass; }
+		[[nodiscard]] bool Overlaps(const FRGResourceLifetime& other) const
+		{
+			return mFirstPass <= other.mLastPass && other.mFirstPass <= mLastPass;
+		}
+
+		void AddPass(uint16 passIndex)
+		{
+			mFirstPass = glm::min(mFirstPass, passIndex);
+			mLastPass = glm::max(mLastPass, passIndex);
+		}
 	};
 
-	struct FRGBufferUpload
+	/** Transient resources of different kinds are never placed in the same memory. */
+	enum class ERGTransientHeap : uint8
 	{
-		FRGResourceHandle mTargetBuffer = {};
-		void* mData = nullptr;
-		size_t mDataSize = 0;
-		size_t mOffset = 0;
+		Textures,
+		Buffers,
+
+		Num
 	};
 
-	struct FCreateAndUploadBuffer
+	struct FRGTransientHeapInfo
 	{
-		void* mData = nullptr;
 		FDeviceSize mSize = 0;
-		EBufferFlags mBufferFlags;
-		FName mName = {};
+		FDeviceSize mAlignment = 1;
+		uint32 mMemoryTypeBits = std::numeric_limits<uint32>::max();
+	};
+
+	/** Where a transient resource is placed in its transient heap */
+	struct FRGResourcePlacement
+	{
+		FDeviceSize mOffset = 0;
+		FDeviceSize mSize = 0;
+		bool mbAliased = false;
+	};
+
+	/** Pass of one queue waiting for a pass of another queue */
+	struct FRGQueueDependency
+	{
+		/** Work recorded on the graphics queue before and after the graph */
+		static constexpr uint32 kGraphBegin = std::numeric_limits<uint32>::max() - 1;
+		static constexpr uint32 kGraphEnd = std::numeric_limits<uint32>::max();
+
+		uint32 mSrcPass = kGraphBegin;
+		uint32 mDstPass = kGraphEnd;
+	};
+
+	/** Part of the pass info written by the compilation. Kept to restore passes of a graph with unchanged structure. */
+	struct FRGCompiledPass
+	{
+		bool mbCulled = false;
+		ERGQueue mQueue = ERGQueue::Graphics;
+	};
+
+	/** Passes recorded into a single command buffer and submitted to one queue */
+	struct FRGSubmission
+	{
+		ERGQueue mQueue = ERGQueue::Graphics;
+		std::vector<uint32> mPasses;
+
+		/** Earlier submissions of the other queue to wait for. Each of them signals a semaphore waited only by this submission. */
+		std::vector<uint32> mWaitSubmissions;
+		bool mbSignal = false;
+	};
+
+	/** State commands recorded by a pass, see FCommandBuffer::GetStats */
+	struct FRGPassCommandStats
+	{
+		FName mPassName = {};
+		FCommandBufferStats mStats = {};
 	};
 
 	struct FRGAttachment
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/GraphicsCore.h"
+#include "Graphics/FrameGraph/RenderGraphHelpers.h"
+
+namespace Turbo
+{
+	class FGPUDevice;
+	struct FTexture;
+	struct FBuffer;
+
+	/**
+	 * Keeps render graph transient resources alive between frames.
+	 * Resources are matched by their description (size, format, flags, samples), so a graph which doesn't change
+	 * its topology does not allocate anything after the first frame.
+	 * Unused entries are destroyed after `rg.pool.maxUnusedFrames` frames or when the pool exceeds `rg.pool.budgetMiB`.
+	 * Aliased resources are placed in transient heaps which are shared by all resources with disjoint lifetimes.
+	 */
+	struct FRGResourcePool
+	{
+		DELETE_COPY(FRGResourcePool)
+		FRGResourcePool() = default;
+
+		[[nodiscard]] THandle<FTexture> AcquireTexture(FGPUDevice& gpu, const FRGTextureInfo& textureInfo);
+		[[nodiscard]] THandle<FBuffer> AcquireBuffer(FGPUDevice& gpu, const FRGBufferInfo& bufferInfo);
+
+		/** Makes sure the heaps can hold the compiled placements. Resources placed in reallocated heap are destroyed. */
+		void PrepareHeaps(FGPUDevice& gpu, const std::array<FRGTransientHeapInfo, static_cast<size_t>(ERGTransientHeap::Num)>& heapInfos);
+		[[nodiscard]] THandle<FTexture> AcquireAliasedTexture(FGPUDevice& gpu, const FRGTextureInfo& textureInfo, FDeviceSize heapOffset);
+		[[nodiscard]] THandle<FBuffer> AcquireAliasedBuffer(FGPUDevice& gpu, const FRGBufferInfo& bufferInfo, FDeviceSize heapOffset);
+
+		void ReleaseTexture(THandle<FTexture> texture);
+		void ReleaseBuffer(THandle<FBuffer> buffer);
+
+		/** Destroys entries that were not used for a while and trims the pool to the memory budget. Call once per frame, after all resources are released. */
+		void Tick(FGPUDevice& gpu);
+
+		/** Destroys every pooled resource. All resources have to be released. */
+		void Flush(FGPUDevice& gpu);
+
+		[[nodiscard]] FDeviceSize GetPooledMemorySize() const { return mPooledMemorySize; }
+		[[nodiscard]] uint32 GetNumPooledTextures() const { return mTextures.size(); }
+		[[nodiscard]] uint32 GetNumPooledBuffers() const { return mBuffers.size(); }
+
+	private:
+		static constexpr FDeviceSize kNotAliased = std::numeric_limits<FDeviceSize>::max();
+
+		struct FPooledTexture
+		{
+			FRGTextureInfo mInfo = {};
+			THandle<FTexture> mHandle = {};
+			FDeviceSize mSize = 0;
+			/** Offset in the textures heap or kNotAliased */
+			FDeviceSize mHeapOffset = kNotAliased;
+			uint32 mLastUsedFrame = 0;
+			bool mbInUse = false;
+		};
+
+		struct FPooledBuffer
+		{
+			FRGBufferInfo mInfo = {};
+			THandle<FBuffer> mHandle = {};
+			/** Offset in the buffers heap or kNotAliased */
+			FDeviceSize mHeapOffset = kNotAliased;
+			uint32 mLastUsedFrame = 0;
+			bool mbInUse = false;
+		};
+
+		struct FTransientHeap
+		{
+			vma::Allocation mMemory = nullptr;
+			FRGTransientHeapInfo mInfo = {};
+			uint32 mLastUsedFrame = 0;
+		};
+
+		void DestroyHeap(FGPUDevice& gpu, ERGTransientHeap heapType);
+
+		std::vector<FPooledTexture> mTextures;
+		std::vector<FPooledBuffer> mBuffers;
+		std::array<FTransientHeap, static_cast<size_t>(ERGTransientHeap::Num)> mHeaps;
+
+		FDeviceSize mPooledMemorySize = 0;
+		uint32 mNumAllocationsThisFrame = 0;
+	};
+} // Turbo
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/GraphicsCore.h"
+
+namespace Turbo
+{
+	class FGPUDevice;
+	struct FBuffer;
+
+	/** Host-mapped range of the upload ring, valid until the end of the frame which allocated it */
+	struct FRGUploadAllocation
+	{
+		template <typename T>
+		[[nodiscard]] T* GetMapped() const { return static_cast<T*>(mMappedAddress); }
+
+		[[nodiscard]] bool IsValid() const { return mMappedAddress != nullptr; }
+
+		void* mMappedAddress = nullptr;
+		FDeviceAddress mDeviceAddress = kNullDeviceAddress;
+		THandle<FBuffer> mBuffer = {};
+		FDeviceSize mOffset = 0;
+		FDeviceSize mSize = 0;
+	};
+
+	/**
+	 * Linear allocator of per-frame upload data (uniforms, draw data, TLAS instances) written by the host and read by the device.
+	 * Each buffered frame owns a persistently mapped buffer, so nothing is created or copied per payload. The buffers are
+	 * created with sequential host writes, which lets VMA pick device local host visible memory (ReBAR) when the device has it.
+	 * Memory is write-combined, the host should only write to it.
+	 * When a frame runs out of space it spills to an overflow buffer and the next time that buffered frame begins
+	 * its buffer is reallocated to fit everything the frame needed.
+	 */
+	struct FRGUploadRing
+	{
+		static constexpr FDeviceSize kDefaultAlignment = 16;
+
+		DELETE_COPY(FRGUploadRing)
+		FRGUploadRing() = default;
+
+		/** Recycles the ring of the buffered frame. Its timeline value has to be waited already. */
+		void BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId);
+
+		[[nodiscard]] FRGUploadAllocation Allocate(FDeviceSize size, FDeviceSize alignment = kDefaultAlignment);
+
+		/** Destroys buffers of all buffered frames */
+		void Destroy(FGPUDevice& gpu);
+
+		/** Capacity and usage of the current frame ring, overflow buffers included */
+		[[nodiscard]] FDeviceSize GetCapacity() const;
+		[[nodiscard]] FDeviceSize GetUsedSize() const;
+
+	private:
+		struct FBlock
+		{
+			THandle<FBuffer> mBuffer = {};
+			byte* mMappedAddress = nullptr;
+			FDeviceAddress mDeviceAddress = kNullDeviceAddress;
+			FDeviceSize mSize = 0;
+			FDeviceSize mUsedSize = 0;
+		};
+
+		struct FFrameRing
+		{
+			FBlock mBlock = {};
+			std::vector<FBlock> mOverflowBlocks;
+		};
+
+		[[nodiscard]] static FBlock CreateBlock(FGPUDevice& gpu, FDeviceSize size);
+		static void DestroyBlock(FGPUDevice& gpu, FBlock& block);
+		[[nodiscard]] static FRGUploadAllocation AllocateFromBlock(FBlock& block, FDeviceSize size, FDeviceSize alignment);
+
+	private:
+		std::array<FFrameRing, kMaxBufferedFrames> mFrameRings;
+		FFrameRing* mCurrentRing = nullptr;
+		/** Used to create overflow blocks, set in BeginFrame */
+		FGPUDevice* mGpu = nullptr;
+	};
+} // Turbo
@@ -4,14 +4,18 @@
 #include "CommonConstants.h"
 #include "Core/Allocators/StackAllocator.h"
 #include "Core/DataStructures/Handle.h"
+#include "Graphics/GPUMemoryBudget.h"
+#include "Graphics/GPUProfiler.h"
+#include "Graphics/GPUUploadManager.h"
 #include "Graphics/GraphicsCore.h"
 #include "Resources.h"
+#include "TaskScheduler.h"
 #include "VkBootstrap.h"
 
 #include "DestoryQueue.h"
 #include "ResourceBuilders.h"
 #include "VulkanHelpers.h"
-#include "Core/DataStructures/GenPool.h"
+#include "Core/DataStructures/PagedGenPool.h"
 #include "Graphics/Resources.h"
 #include <vector>
 
@@ -24,25 +28,102 @@ namespace Turbo
 
 	DECLARE_DELEGATE(FOnImmediateSubmit, FCommandBuffer&);
 
-	constexpr size_t kTexturePoolSize = 1024;
-	constexpr size_t kSamplerPoolSize = 128;
-	constexpr size_t kTLASPoolSize = 16;
+	/** Upper bounds of the bindless descriptor arrays, device limits may lower them. See FGPUDevice::GetBindlessCapacity */
+	constexpr uint32 kMaxBindlessTextures = 1 << 16;
+	constexpr uint32 kMaxBindlessSamplers = 1 << 11;
+	constexpr uint32 kMaxBindlessTLAS = 256;
 	constexpr uint32 kInvalidBinding = std::numeric_limits<uint32>::max();
 
+	/** Sizes of the bindless descriptor arrays. Texture, sampler and TLAS handle indices are their descriptor indices. */
+	struct FBindlessCapacity
+	{
+		uint32 mNumTextures = kMaxBindlessTextures;
+		uint32 mNumSamplers = kMaxBindlessSamplers;
+		uint32 mNumTLAS = kMaxBindlessTLAS;
+	};
+
+	struct FBindlessUpdateStats
+	{
+		/** Update requests, including the ones made for the same array element */
+		uint32 mNumRequests = 0;
+		/** Array elements written */
+		uint32 mNumDescriptorWrites = 0;
+		/** vk::WriteDescriptorSet entries, contiguous array elements share one */
+		uint32 mNumWriteEntries = 0;
+		/** Requests overridden by a later one, or matching the descriptor already written */
+		uint32 mNumSkippedRequests = 0;
+	};
+
+	/** Present image of a headless frame copied to host memory, see gpu.headless.readback */
+	struct FHeadlessFrameReadback
+	{
+		/** Value of GetNumRenderedFrames when the frame was rendered */
+		uint32 mFrame = 0;
+		glm::uint2 mSize = glm::uint2(0);
+		vk::Format mFormat = vk::Format::eUndefined;
+		/** Tightly packed rows, valid only during the broadcast */
+		std::span<const byte> mData;
+	};
+
+	DECLARE_MULTICAST_DELEGATE(FOnHeadlessFrameReadback, const FHeadlessFrameReadback&);
+
 	struct FBufferedFrameData final
 	{
-		vk::Fence mCommandBufferExecutedFence = nullptr;
+		/** Device timeline value signaled by the last submission of the frame */
+		uint64 mTimelineValue = 0;
 		vk::Semaphore mImageAcquiredSemaphore = nullptr;
 
 		std::array<vk::CommandPool, kMaxRenderingThreads> mVkCommandPools;
 
-		TUniquePtr<FCommandBuffer> mMainCommandBuffer;
+		/** Main command buffer is split when the frame is submitted to the graphics queue more than once. See SubmitMainCommandBuffer */
+		std::vector<TUniquePtr<FCommandBuffer>> mMainCommandBuffers;
+		uint32 mMainCommandBufferId = 0;
+
+		vk::CommandPool mVkAsyncComputeCommandPool = nullptr;
+		std::vector<TUniquePtr<FCommandBuffer>> mAsyncComputeCommandBuffers;
+		uint32 mNumUsedAsyncComputeCommandBuffers = 0;
+
+		/** Binary semaphores synchronizing submissions of different queues. Each one is signaled and waited once per frame. */
+		std::vector<vk::Semaphore> mQueueSemaphores;
+		uint32 mNumUsedQueueSemaphores = 0;
 
-		FDestroyQueue mDestroyQueue;
+		/** Waited by the next main command buffer submission */
+		std::vector<vk::Semaphore> mPendingMainCommandBufferWaits;
+		bool mbSwapchainImageWaitPending = false;
+
+		/** Secondary command buffers allocated from the command pool with the same index. Reused every frame. */
+		std::array<std::vector<TUniquePtr<FCommandBuffer>>, kMaxRenderingThreads> mSecondaryCommandBuffers;
+		std::array<uint32, kMaxRenderingThreads> mNumUsedSecondaryCommandBuffers = {};
+	};
+
+	/** Vulkan objects of a compiled pipeline. Moved into the pipeline pool on the game thread, see FGPUDevice::FinishPipeline */
+	struct FCompiledPipeline
+	{
+		FShaderState mShaderState = {};
+		vk::Pipeline mVkPipeline = nullptr;
+		vk::PipelineLayout mVkLayout = nullptr;
+		size_t mLayoutKey = 0;
+		vk::PipelineBindPoint mVkBindPoint = {};
+
+		bool mbSucceeded = false;
+	};
+
+	struct FPipelineCompileTask final : enki::ITaskSet
+	{
+		virtual void ExecuteRange(enki::TaskSetPartition range, uint32_t threadNum) override;
+
+		FGPUDevice* mGpu = nullptr;
+		FPipelineBuilder mBuilder = {};
+		THandle<FPipeline> mHandle = {};
+		vk::DescriptorSetLayout mBindlessLayout = nullptr;
+
+		FCompiledPipeline mResult = {};
 	};
 
 	class FGPUDevice final
 	{
+		friend struct FPipelineCompileTask;
+
 		/** Initialization interface */
 	public:
 		void Init(const FGPUDeviceBuilder& gpuDeviceBuilder);
@@ -58,14 +139,52 @@ namespace Turbo
 		[[nodiscard]] vk::CommandPool GetCommandPool() const;
 		[[nodiscard]] FCommandBuffer& GetMainCommandBuffer() const;
 
+		/**
+		 * Begins a secondary command buffer allocated from the calling thread command pool. Valid until the end of the frame.
+		 * With inheritedRendering the buffer continues a rendering scope begun in the primary command buffer.
+		 */
+		[[nodiscard]] FCommandBuffer& BeginSecondaryCommandBuffer(const FRenderingAttachments* inheritedRendering = nullptr, EMSAASamples numSamples = EMSAASamples::One);
+		void EndSecondaryCommandBuffer(FCommandBuffer& cmd);
+
 		[[nodiscard]] THandle<FDescriptorSet> GetBindlessResourcesSet() const { return mBindlessResourcesSet; }
-		[[nodiscard]] THandle<FTexture> GetPresentImage() const { return mSwapChainTextures[mCurrentSwapchainImageIndex]; }
+		[[nodiscard]] const FBindlessCapacity& GetBindlessCapacity() const { return mBindlessCapacity; }
+		/** Bindless descriptor updates of the last presented frame */
+		[[nodiscard]] const FBindlessUpdateStats& GetBindlessUpdateStats() const { return mLastFrameBindlessUpdateStats; }
+		/** Invalid on a null device, it has no swapchain */
+		[[nodiscard]] THandle<FTexture> GetPresentImage() const { return mSwapChainTextures.empty() ? THandle<FTexture>() : mSwapChainTextures[mCurrentSwapchainImageIndex]; }
 
 		void WaitIdle() const;
 
+		/**
+		 * Device timeline, every graphics queue submission signals the next value. Buffered frames and destroy requests are
+		 * retired by the values, so a value known to be completed frees everything tagged with it or lower.
+		 */
+		[[nodiscard]] uint64 GetLastSubmittedTimelineValue() const { return mLastSubmittedTimelineValue; }
+		[[nodiscard]] uint64 GetCompletedTimelineValue() const;
+		void WaitForTimelineValue(uint64 value) const;
+
+		/** Blocks until the recorded commands finish. Uploads queued before the call are complete before the commands run. */
 		void ImmediateSubmit(const FOnImmediateSubmit& immediateSubmitDelegate);
 		void SubmitMainCommandBufferAndWaitIdle();
 
+		/**
+		 * Submits the main command buffer in the middle of the frame and begins a new one, returned by GetMainCommandBuffer.
+		 * Set bWaitForSwapchainImage when the submitted commands use the present image.
+		 */
+		void SubmitMainCommandBuffer(vk::Semaphore signalSemaphore, bool bWaitForSwapchainImage);
+		/** Semaphore waited by the next main command buffer submission, mid frame or in PresentFrame */
+		void AddMainCommandBufferWait(vk::Semaphore semaphore);
+
+		/** Async compute queue. Without a separate compute queue family all compute work goes to the graphics queue. */
+		[[nodiscard]] bool HasAsyncComputeQueue() const { return mVkComputeQueueFamilyIndex != mVkGraphicsQueueFamilyIndex; }
+		/** Pipeline statistics queries and their inheritance by secondary command buffers are optional device features */
+		[[nodiscard]] bool HasPipelineStatisticsQueries() const { return mbPipelineStatisticsQueries; }
+		[[nodiscard]] FCommandBuffer& BeginAsyncComputeCommandBuffer();
+		void SubmitAsyncComputeCommandBuffer(FCommandBuffer& cmd, std::span<const vk::Semaphore> waitSemaphores, vk::Semaphore signalSemaphore);
+
+		/** Binary semaphore valid until the end of the frame. It has to be signaled and waited exactly once. */
+		[[nodiscard]] vk::Semaphore AcquireQueueSemaphore();
+
 		[[nodiscard]] glm::uint2 GetMainViewportSize() const { return mViewportSize; }
 		void SetMainViewportSize(glm::uint2 newSize)
 		{
@@ -81,38 +200,50 @@ namespace Turbo
 
 		void RequestSwapChainResize() { mbRequestedSwapchainResize = true; }
 
+		/**
+		 * Headless devices have no window surface and swapchain. Frames are rendered into offscreen present images, which
+		 * are left in eTransferSrcOptimal instead of ePresentSrcKHR and can be read back, see OnHeadlessFrameReadback.
+		 */
+		[[nodiscard]] bool IsHeadless() const { return mbHeadless; }
+
+		/** Pipelines are recompiled on worker threads and swapped in once ready, without waiting for the device */
 		void RecreatePipelines();
 		void RecompileShaders();
 
 		/** Rendering interface end */
 
+		/** Events */
+	public:
+		/** Broadcast from BeginFrame once the frame is complete on the GPU, up to kMaxBufferedFrames frames late */
+		FOnHeadlessFrameReadback OnHeadlessFrameReadback;
+
 		/** Resource accessors */
 	public:
-		[[nodiscard]] FBuffer* AccessBuffer(THandle<FBuffer> handle) { return mBufferPool->Access(handle); }
-		[[nodiscard]] FBufferCold* AccessBufferCold(THandle<FBuffer> handle) { return mBufferPool->AccessCold(handle); }
-		[[nodiscard]] FTexture* AccessTexture(THandle<FTexture> handle) { return mTexturePool->Access(handle); }
-		[[nodiscard]] FTextureCold* AccessTextureCold(THandle<FTexture> handle) { return mTexturePool->AccessCold(handle); }
-		[[nodiscard]] FSampler* AccessSampler(THandle<FSampler> handle) { return mSamplerPool->Access(handle); }
-		[[nodiscard]] FSamplerCold* AccessSamplerCold(THandle<FSampler> handle) { return mSamplerPool->AccessCold(handle); }
-		[[nodiscard]] FPipeline* AccessPipeline(THandle<FPipeline> handle) { return mPipelinePool->Access(handle); }
-		[[nodiscard]] FPipelineCold* AccessPipelineCold(THandle<FPipeline> handle) { return mPipelinePool->AccessCold(handle); }
-		[[nodiscard]] FDescriptorPool* AccessDescriptorPool(THandle<FDescriptorPool> handle) { return mDescriptorPoolPool->Access(handle); }
-		[[nodiscard]] FDescriptorSetLayout* AccessDescriptorSetLayout(THandle<FDescriptorSetLayout> handle) { return mDescriptorSetLayoutPool->Access(handle); }
-		[[nodiscard]] FDescriptorSet* AccessDescriptorSet(THandle<FDescriptorSet> handle) { return mDescriptorSetPool->Access(handle); }
-		[[nodiscard]] FShaderState* AccessShaderState(THandle<FShaderState> handle) { return mShaderStatePool->Access(handle); }
-		[[nodiscard]] FBLAS* AccessBLAS(THandle<FBLAS> handle) { return mBLASPool->Access(handle); }
-		[[nodiscard]] FTLAS* AccessTLAS(THandle<FTLAS> handle) { return mTLASPool->Access(handle); }
-
-		[[nodiscard]] const FBuffer* AccessBuffer(THandle<FBuffer> handle) const { return mBufferPool->Access(handle); }
-		[[nodiscard]] const FTexture* AccessTexture(THandle<FTexture> handle) const { return mTexturePool->Access(handle); }
-		[[nodiscard]] const FSampler* AccessSampler(THandle<FSampler> handle) const { return mSamplerPool->Access(handle); }
-		[[nodiscard]] const FPipeline* AccessPipeline(THandle<FPipeline> handle) const { return mPipelinePool->Access(handle); }
-		[[nodiscard]] const FDescriptorPool* AccessDescriptorPool(THandle<FDescriptorPool> handle) const { return mDescriptorPoolPool->Access(handle); }
-		[[nodiscard]] const FDescriptorSetLayout* AccessDescriptorSetLayout(THandle<FDescriptorSetLayout> handle) const { return mDescriptorSetLayoutPool->Access(handle); }
-		[[nodiscard]] const FDescriptorSet* AccessDescriptorSet(THandle<FDescriptorSet> handle) const { return mDescriptorSetPool->Access(handle); }
-		[[nodiscard]] const FShaderState* AccessShaderState(THandle<FShaderState> handle) const { return mShaderStatePool->Access(handle); }
-		[[nodiscard]] const FBLAS* AccessBLAS(THandle<FBLAS> handle) const { return mBLASPool->Access(handle); }
-		[[nodiscard]] const FTLAS* AccessTLAS(THandle<FTLAS> handle) const { return mTLASPool->Access(handle); }
+		[[nodiscard]] FBuffer* AccessBuffer(THandle<FBuffer> handle) { return mBufferPool.Access(handle); }
+		[[nodiscard]] FBufferCold* AccessBufferCold(THandle<FBuffer> handle) { return mBufferPool.AccessCold(handle); }
+		[[nodiscard]] FTexture* AccessTexture(THandle<FTexture> handle) { return mTexturePool.Access(handle); }
+		[[nodiscard]] FTextureCold* AccessTextureCold(THandle<FTexture> handle) { return mTexturePool.AccessCold(handle); }
+		[[nodiscard]] FSampler* AccessSampler(THandle<FSampler> handle) { return mSamplerPool.Access(handle); }
+		[[nodiscard]] FSamplerCold* AccessSamplerCold(THandle<FSampler> handle) { return mSamplerPool.AccessCold(handle); }
+		[[nodiscard]] FPipeline* AccessPipeline(THandle<FPipeline> handle) { return mPipelinePool.Access(handle); }
+		[[nodiscard]] FPipelineCold* AccessPipelineCold(THandle<FPipeline> handle) { return mPipelinePool.AccessCold(handle); }
+		[[nodiscard]] FDescriptorPool* AccessDescriptorPool(THandle<FDescriptorPool> handle) { return mDescriptorPoolPool.Access(handle); }
+		[[nodiscard]] FDescriptorSetLayout* AccessDescriptorSetLayout(THandle<FDescriptorSetLayout> handle) { return mDescriptorSetLayoutPool.Access(handle); }
+		[[nodiscard]] FDescriptorSet* AccessDescriptorSet(THandle<FDescriptorSet> handle) { return mDescriptorSetPool.Access(handle); }
+		[[nodiscard]] FShaderState* AccessShaderState(THandle<FShaderState> handle) { return mShaderStatePool.Access(handle); }
+		[[nodiscard]] FBLAS* AccessBLAS(THandle<FBLAS> handle) { return mBLASPool.Access(handle); }
+		[[nodiscard]] FTLAS* AccessTLAS(THandle<FTLAS> handle) { return mTLASPool.Access(handle); }
+
+		[[nodiscard]] const FBuffer* AccessBuffer(THandle<FBuffer> handle) const { return mBufferPool.Access(handle); }
+		[[nodiscard]] const FTexture* AccessTexture(THandle<FTexture> handle) const { return mTexturePool.Access(handle); }
+		[[nodiscard]] const FSampler* AccessSampler(THandle<FSampler> handle) const { return mSamplerPool.Access(handle); }
+		[[nodiscard]] const FPipeline* AccessPipeline(THandle<FPipeline> handle) const { return mPipelinePool.Access(handle); }
+		[[nodiscard]] const FDescriptorPool* AccessDescriptorPool(THandle<FDescriptorPool> handle) const { return mDescriptorPoolPool.Access(handle); }
+		[[nodiscard]] const FDescriptorSetLayout* AccessDescriptorSetLayout(THandle<FDescriptorSetLayout> handle) const { return mDescriptorSetLayoutPool.Access(handle); }
+		[[nodiscard]] const FDescriptorSet* AccessDescriptorSet(THandle<FDescriptorSet> handle) const { return mDescriptorSetPool.Access(handle); }
+		[[nodiscard]] const FShaderState* AccessShaderState(THandle<FShaderState> handle) const { return mShaderStatePool.Access(handle); }
+		[[nodiscard]] const FBLAS* AccessBLAS(THandle<FBLAS> handle) const { return mBLASPool.Access(handle); }
+		[[nodiscard]] const FTLAS* AccessTLAS(THandle<FTLAS> handle) const { return mTLASPool.Access(handle); }
 
 		/** Resource accessors end */
 
@@ -122,11 +253,15 @@ namespace Turbo
 		THandle<FTexture> CreateTexture(const FTextureBuilder& builder);
 		THandle<FSampler> CreateSampler(const FSamplerBuilder& builder);
 		THandle<FPipeline> CreatePipeline(const FPipelineBuilder& builder);
+		/** Returns before the pipeline is compiled. It can be bound once IsPipelineReady returns true. */
+		THandle<FPipeline> CreatePipelineAsync(const FPipelineBuilder& builder);
 		THandle<FDescriptorPool> CreateDescriptorPool(const FDescriptorPoolBuilder& builder);
 		THandle<FDescriptorSetLayout> CreateDescriptorSetLayout(const FDescriptorSetLayoutBuilder& builder);
 		THandle<FDescriptorSet> CreateDescriptorSet(const FDescriptorSetBuilder& builder);
 		THandle<FShaderState> CreateShaderState(const FShaderStateBuilder& builder);
 		THandle<FBLAS> CreateBLAS(const FBLASBuilder& builder);
+		/** Builds all BLAS in one submission sharing one scratch buffer, outHandles has to match builders in size */
+		void CreateBLAS(std::span<const FBLASBuilder> builders, std::span<THandle<FBLAS>> outHandles);
 		THandle<FTLAS> CreateTLAS(const FTLASBuilder& builder);
 
 		vk::CommandPool CreateCommandPool(uint32 queueFamilyIndex, vk::CommandPoolCreateFlags createFlags = {});
@@ -138,9 +273,25 @@ namespace Turbo
 	public:
    	[[nodiscard]] FAccelerationStructureSizeInfo CalculateTLASSize(const FTLASBuilder& builder) const;
 		void ResetDescriptorPool(THandle<FDescriptorPool> descriptorPoolHandle);
+
+		[[nodiscard]] bool IsPipelineReady(THandle<FPipeline> handle) const;
+		/** Finishes all pipelines compiled on worker threads */
+		void WaitForPendingPipelines();
+
+		/** Null devices return estimates, see CreateNullDevice */
+		[[nodiscard]] vk::MemoryRequirements GetTextureMemoryRequirements(const FTextureBuilder& builder) const;
+		[[nodiscard]] vk::MemoryRequirements GetBufferMemoryRequirements(const FBufferBuilder& builder) const;
+
+		/** Allocates device local memory which resources can be placed in. See FTextureBuilder::SetAliasedMemory */
+		[[nodiscard]] vma::Allocation AllocateMemory(const vk::MemoryRequirements& requirements, FName name, EGPUMemoryCategory category = EGPUMemoryCategory::Other);
+		void FreeMemory(vma::Allocation allocation);
 		/** Other resource related methods end */
 
-		/** Resource destroy */
+		/**
+		 * Resource destroy. The destruction is deferred until the GPU completes the frame it is requested in, so a resource
+		 * can be destroyed right after it is replaced even though frames in flight, or commands recorded later in the
+		 * frame, still read it.
+		 */
 	public:
 		void DestroyBuffer(THandle<FBuffer> handle);
 		void DestroyTexture(THandle<FTexture> handle);
@@ -167,13 +318,23 @@ namespace Turbo
 		void DestroyDescriptorSetLayoutImmediate(const FDescriptorSetLayoutDestroyer& destroyer);
 		void DestroyShaderStateImmediate(const FShaderStateDestroyer& destroyer);
 		void DestroyAccelerationStructureImmediate(const FAccelerationStructureDestroyer& destroyer);
+		void FreeMemoryImmediate(const FMemoryDestroyer& destroyer);
 
 		/** Destroy immediate end */
 
 		/** Resource helpers */
 	public:
+		/** Queued in the upload manager, the texture can be used by commands submitted after the call */
 		void UploadTextureUsingStagingBuffer(THandle<FTexture> handle, std::span<const byte> data);
 
+		/** Makes GPU writes visible to the mapped address of a readback buffer, call before reading it */
+		void InvalidateMappedBuffer(THandle<FBuffer> handle);
+		/** Makes host writes to the mapped address visible to the GPU, needed only for writes to readback buffers */
+		void FlushMappedBuffer(THandle<FBuffer> handle);
+
+		[[nodiscard]] FGPUUploadManager& GetUploadManager() { return mUploadManager; }
+		[[nodiscard]] const FGPUUploadManager& GetUploadManager() const { return mUploadManager; }
+
 		/** Resource helpers end */
 
 		/** Vulkan Getters */
@@ -182,6 +343,8 @@ namespace Turbo
 		[[nodiscard]] vk::PhysicalDevice GetVkPhysicalDevice() const { return mVkPhysicalDevice; }
 		[[nodiscard]] vk::Device GetVkDevice() const { return mVkDevice; }
 		[[nodiscard]] vk::Queue GetVkQueue() const { return mVkGraphicsQueue; }
+		[[nodiscard]] vk::Queue GetVkTransferQueue() const { return mVkTransferQueue; }
+		[[nodiscard]] vma::Allocator GetVmaAllocator() const { return mVmaAllocator; }
 
 		[[nodiscard]] uint32 GetGraphicsQueueFamily() const { return mVkGraphicsQueueFamilyIndex; }
 		[[nodiscard]] uint32 GetComputeQueueFamily() const { return mVkComputeQueueFamilyIndex; }
@@ -189,10 +352,16 @@ namespace Turbo
 
 		/** Vulkan Getters end */
 
-#if WITH_PROFILER
 		/** Profiling */
+	public:
+		[[nodiscard]] FGPUProfiler& GetGPUProfiler() { return mGPUProfiler; }
+		[[nodiscard]] const FGPUProfiler& GetGPUProfiler() const { return mGPUProfiler; }
+		[[nodiscard]] FGPUMemoryBudget& GetMemoryBudget() { return mMemoryBudget; }
+		[[nodiscard]] const FGPUMemoryBudget& GetMemoryBudget() const { return mMemoryBudget; }
+#if WITH_PROFILER
 		[[nodiscard]] FTraceGPUCtx GetTraceGpuCtx() const { return mTraceGpuCtx; }
 #endif
+		/** Profiling end */
 
 		/** Initialization methods */
 	private:
@@ -200,8 +369,11 @@ namespace Turbo
 		vkb::PhysicalDevice SelectPhysicalDevice(const vkb::Instance& builtInstance);
 		vkb::Device CreateDevice(const vkb::PhysicalDevice& physicalDevice);
 		vkb::Swapchain CreateSwapchain();
+		void CreateHeadlessPresentImages();
 		void CreateVulkanMemoryAllocator();
+		void CreatePipelineCache();
 		void CreateFrameDatas();
+		void CreateTimelineSemaphore();
 
 		void InitializeImmediateCommands();
 
@@ -216,9 +388,12 @@ namespace Turbo
 		/** Destroy methods */
 	private:
 		void DestroySwapChain();
+		void DestroyHeadlessPresentImages();
 		void DestroyFrameDatas();
+		void DestroyTimelineSemaphore();
 		void DestroyImmediateCommands();
 		void DestroyBindlessResources();
+		void DestroyPipelineCache();
 		void FlushDestroyQueues();
 
 		/** Destroy methods end */
@@ -229,14 +404,35 @@ namespace Turbo
 
 		/** Rendering interface */
 	private:
+		/** Writes the pending bindless requests, the last request of an array element wins */
 		void UpdateBindlessResources();
+		/** The array element is written again by the next request, e.g. when its resource is destroyed */
+		void ForgetBindlessDescriptor(uint32 binding, uint32 arrayElement);
+		/** Consumes semaphores added by AddMainCommandBufferWait */
+		[[nodiscard]] std::vector<vk::SemaphoreSubmitInfo> MakeMainCommandBufferWaits(bool bWaitForSwapchainImage);
+		/** Every graphics queue submission goes through here, so it waits for the pending uploads */
+		void SubmitToGraphicsQueue(FCommandBuffer& cmd, std::vector<vk::SemaphoreSubmitInfo>& waitSemaphores, const vk::SemaphoreSubmitInfo* signalSemaphore);
+		/** Records the copy of the present image when gpu.headless.readback is enabled */
+		void RecordHeadlessReadback(FCommandBuffer& cmd);
+		/** The buffered frame timeline value has to be waited already */
+		void BroadcastHeadlessReadback(uint32 bufferedFrameId);
 
 		/** Rendering interface end */
 
 		/** Creation helpers */
 	private:
 		void InitVulkanTexture(const FTextureBuilder& builder, THandle<FTexture> handle);
-		void InitPipeline(const FPipelineBuilder& builder, THandle<FPipeline> handle);
+
+		/** Doesn't touch the resource pools, so it can run on any thread */
+		void CompilePipeline(const FPipelineBuilder& builder, vk::DescriptorSetLayout bindlessLayout, FCompiledPipeline& outPipeline) const;
+		[[nodiscard]] bool CompileShaderState(const FShaderStateBuilder& builder, FShaderState& outShaderState) const;
+		void RequestPipelineCompilation(THandle<FPipeline> handle);
+		/** Replaces the previous Vulkan objects of the pipeline, they are destroyed once no frame in flight uses them */
+		void FinishPipeline(THandle<FPipeline> handle, FCompiledPipeline& compiledPipeline);
+		void UpdatePendingPipelines();
+		/** Destroys a result which was never bound */
+		void DestroyCompiledPipeline(const FCompiledPipeline& compiledPipeline);
+		void CancelPipelineCompilation(THandle<FPipeline> handle);
 
 		/** Creation helpers end */
 
@@ -258,27 +454,53 @@ namespace Turbo
 
 		/** Resource pools */
 	private:
-		TPoolHeap<FBuffer, 16384, FBufferCold, true> mBufferPool;
-		TPoolHeap<FTexture, kTexturePoolSize, FTextureCold, true> mTexturePool;
-		TPoolHeap<FSampler, kSamplerPoolSize, FSamplerCold> mSamplerPool;
-		TPoolHeap<FPipeline, 256, FPipelineCold> mPipelinePool;
-		TPoolHeap<FDescriptorSetLayout, 128> mDescriptorSetLayoutPool;
-		TPoolHeap<FDescriptorPool, 16> mDescriptorPoolPool;
-		TPoolHeap<FDescriptorSet, 256> mDescriptorSetPool;
-		TPoolHeap<FShaderState, 256> mShaderStatePool;
-		TPoolHeap<FBLAS, 1024, FDummyColdType, false> mBLASPool;
-		TPoolHeap<FTLAS, 32, FDummyColdType, true> mTLASPool;
+		TPagedGenPool<FBuffer, FBufferCold, true, 1024> mBufferPool;
+		/** Capacity of the texture, sampler and TLAS pools is limited by the bindless arrays, see SelectPhysicalDevice */
+		TPagedGenPool<FTexture, FTextureCold, true> mTexturePool;
+		TPagedGenPool<FSampler, FSamplerCold, false, 64> mSamplerPool;
+		TPagedGenPool<FPipeline, FPipelineCold, false, 64> mPipelinePool;
+		TPagedGenPool<FDescriptorSetLayout, FDummyColdType, false, 64> mDescriptorSetLayoutPool;
+		TPagedGenPool<FDescriptorPool, FDummyColdType, false, 16> mDescriptorPoolPool;
+		TPagedGenPool<FDescriptorSet, FDummyColdType, false, 64> mDescriptorSetPool;
+		TPagedGenPool<FShaderState, FDummyColdType, false, 64> mShaderStatePool;
+		TPagedGenPool<FBLAS, FDummyColdType, false> mBLASPool;
+		TPagedGenPool<FTLAS, FDummyColdType, true, 16> mTLASPool;
 
 		/** Resource pools end */
 
 		/** Bindless resources */
 	private:
+		FBindlessCapacity mBindlessCapacity = {};
 		THandle<FDescriptorPool> mBindlessResourcesPool;
 		THandle<FDescriptorSetLayout> mBindlessResourcesLayout;
 		THandle<FDescriptorSet> mBindlessResourcesSet;
 
 		std::vector<FBindlessResourceUpdateRequest> mBindlessResourcesToUpdate;
 
+		/** Descriptors written to the bindless arrays, per binding. Requests which match them are skipped. */
+		struct FBindlessDescriptor
+		{
+			vk::ImageView mVkImageView = nullptr;
+			vk::Sampler mVkSampler = nullptr;
+			vk::AccelerationStructureKHR mVkAccelerationStructure = nullptr;
+
+			bool operator==(const FBindlessDescriptor&) const = default;
+		};
+		std::array<std::vector<FBindlessDescriptor>, BindlessResourcesBindings::kNumBindings> mBindlessDescriptors;
+
+		FBindlessUpdateStats mBindlessUpdateStats = {};
+		FBindlessUpdateStats mLastFrameBindlessUpdateStats = {};
+
+		/** Reused by UpdateBindlessResources, so updates stop allocating once the arrays grew to the largest frame */
+		struct FBindlessUpdateScratch
+		{
+			std::vector<vk::WriteDescriptorSet> mDescriptorWrites;
+			std::vector<vk::DescriptorImageInfo> mImageInfos;
+			std::vector<vk::AccelerationStructureKHR> mAccelerationStructures;
+			std::vector<vk::WriteDescriptorSetAccelerationStructureKHR> mAccelerationStructureWrites;
+		};
+		FBindlessUpdateScratch mBindlessUpdateScratch;
+
 		/** Bindless resources end */
 
 		/** Vulkan handles */
@@ -289,6 +511,7 @@ namespace Turbo
 		vk::PhysicalDeviceProperties mVkPhysicalDeviceProperties = {};
 		vk::PhysicalDeviceAccelerationStructurePropertiesKHR mVkAccelerationStructureProperties = {};
 		vk::PhysicalDeviceRayTracingPipelinePropertiesKHR mVkRayTracingPipelineProperties = {};
+		bool mbPipelineStatisticsQueries = false;
 
 		vk::Device mVkDevice = nullptr;
 
@@ -301,10 +524,19 @@ namespace Turbo
 		vk::Queue mVkComputeQueue = nullptr;
 		uint32 mVkComputeQueueFamilyIndex = std::numeric_limits<uint32>::max();
 
+		/** Queue families sharing buffers, the transfer family included. See MakeBufferCreateInfo */
+		std::vector<uint32> mBufferQueueFamilies;
+
 		vk::DescriptorPool mVkDescriptorPool = nullptr;
 
 		vma::Allocator mVmaAllocator = nullptr;
 
+		/** Used by all pipeline creations. Loaded from and saved to FileSystem::kCachePath. */
+		vk::PipelineCache mVkPipelineCache = nullptr;
+
+		/** Pipelines compiled on worker threads, finished at the begin of the frame */
+		std::vector<TUniquePtr<FPipelineCompileTask>> mPipelineCompileTasks;
+
 		/** Vulkan Handles end */
 
 		/** Swapchain */
@@ -324,6 +556,17 @@ namespace Turbo
 
 		bool mbRequestedSwapchainResize = false;
 
+		/** Headless devices use one present image per buffered frame, see IsHeadless */
+		bool mbHeadless = false;
+
+		struct FHeadlessReadback
+		{
+			THandle<FBuffer> mBuffer = {};
+			uint32 mFrame = 0;
+			bool mbPending = false;
+		};
+		std::array<FHeadlessReadback, kMaxBufferedFrames> mHeadlessReadbacks;
+
 		/** Swapchain end */
 
 		/** Frame handing */
@@ -335,6 +578,9 @@ namespace Turbo
 		/** Note that this is an index of rendered frame (from Init) */
 		uint32 mRenderedFrames = 0;
 
+		vk::Semaphore mVkTimelineSemaphore = nullptr;
+		uint64 mLastSubmittedTimelineValue = 0;
+
 		/** TODO: move me to better category */
 		bool mbVSync = false;
 
@@ -342,22 +588,26 @@ namespace Turbo
 
 		/** Immediate commands */
 	private:
-		vk::Fence mImmediateCommandsFence;
 		vk::CommandPool mImmediateCommandsPool;
 		TUniquePtr<FCommandBuffer> mImmediateCommandsBuffer;
 
+		FGPUUploadManager mUploadManager;
+
 		/** Immediate commands end */
 
 		/** Profiling */
 	private:
 		FTraceGPUCtx mTraceGpuCtx = {};
+		FGPUProfiler mGPUProfiler;
+		FGPUMemoryBudget mMemoryBudget;
 		/** Profiling end */
 
 		/** Other */
 	private:
       FArenaAllocator mPerFrameArena{16 * Constants::kKibi};
 
-		FDestroyQueue mDestroyQueue;
+		/** Requests are sealed with the timeline value of the submission which last uses the resources, see BeginFrame */
+		FTimelineDestroyQueue mDestroyQueue;
 		vk::DebugUtilsMessengerEXT mVkDebugUtilsMessenger;
 
 		glm::uint2 mViewportSize = glm::uint2(0);
@@ -365,6 +615,16 @@ namespace Turbo
 
 		/** Other end */
 
+	public:
+		/**
+		 * Device which is never initialized, for CPU-only tools like the benchmarks. Queries which don't need Vulkan,
+		 * e.g. memory requirements, return estimates. Buffers and textures keep only their description, they have no
+		 * memory. Commands recorded into CreateNullCommandBuffer go nowhere. Nothing can be submitted.
+		 */
+		[[nodiscard]] static FGPUDevice* CreateNullDevice();
+		[[nodiscard]] bool IsNullDevice() const { return mVkDevice == nullptr; }
+		[[nodiscard]] TUniquePtr<FCommandBuffer> CreateNullCommandBuffer();
+
 	private:
 		FGPUDevice() = default;
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Core/Delegate.h"
+#include "Graphics/Enums.h"
+#include "Graphics/GraphicsCore.h"
+
+#include <atomic>
+
+DECLARE_LOG_CATEGORY(LogGPUMemory, Display, Display)
+
+namespace Turbo
+{
+	class FGPUDevice;
+
+	constexpr uint32 kNumGPUMemoryCategories = static_cast<uint32>(EGPUMemoryCategory::Num);
+
+	struct FGPUHeapBudget
+	{
+		uint32 mHeapIndex = 0;
+		bool mbDeviceLocal = false;
+
+		/** Memory used by the process, including allocations made outside of VMA */
+		FDeviceSize mUsage = 0;
+		/** Memory the process can use without a risk of evictions or allocation failures */
+		FDeviceSize mBudget = 0;
+		/** Memory blocks allocated by VMA */
+		FDeviceSize mBlockBytes = 0;
+		/** Part of the blocks occupied by allocations */
+		FDeviceSize mAllocationBytes = 0;
+
+		/** Usage is above gpu.memory.budgetThreshold of the budget */
+		bool mbOverThreshold = false;
+	};
+
+	DECLARE_MULTICAST_DELEGATE(FOnGPUMemoryOverBudget, const FGPUHeapBudget&);
+
+	/**
+	 * Accounts GPU memory allocations by their category and reads the heap budgets every frame. The budgets come from
+	 * VK_EXT_memory_budget when the device supports it, otherwise VMA estimates them from the heap sizes.
+	 * Categories are stored in the user data of the VMA allocations, so the accounting needs only the allocation to release it.
+	 */
+	class FGPUMemoryBudget final
+	{
+	public:
+		void Init(FGPUDevice& gpu, bool bMemoryBudgetExtension);
+
+		/** Publishes the heap budgets to the profiler and broadcasts OnOverBudget when a heap crosses the threshold */
+		void Update(FGPUDevice& gpu);
+
+		/** Thread safe */
+		void OnAllocated(vma::Allocation allocation, const vma::AllocationInfo& allocationInfo, EGPUMemoryCategory category);
+		void OnFreed(FGPUDevice& gpu, vma::Allocation allocation);
+
+		/** Category to pass as the user data of a new allocation */
+		[[nodiscard]] static void* ToUserData(EGPUMemoryCategory category) { return reinterpret_cast<void*>(static_cast<uintptr_t>(category)); }
+
+		[[nodiscard]] FDeviceSize GetCategorySize(EGPUMemoryCategory category) const { return mCategorySizes[static_cast<uint32>(category)].load(std::memory_order_relaxed); }
+		[[nodiscard]] uint32 GetNumCategoryAllocations(EGPUMemoryCategory category) const { return mNumCategoryAllocations[static_cast<uint32>(category)].load(std::memory_order_relaxed); }
+		[[nodiscard]] std::span<const FGPUHeapBudget> GetHeapBudgets() const { return mHeapBudgets; }
+		[[nodiscard]] bool HasMemoryBudgetExtension() const { return mbMemoryBudgetExtension; }
+
+	public:
+		/** Called on the main thread from FGPUDevice::BeginFrame, e.g. to let streaming systems drop resources */
+		FOnGPUMemoryOverBudget OnOverBudget;
+
+	private:
+		bool mbMemoryBudgetExtension = false;
+
+		std::vector<FGPUHeapBudget> mHeapBudgets;
+		/** Tracy keeps plot names by pointer */
+		std::vector<std::string> mHeapPlotNames;
+
+		std::array<std::atomic<FDeviceSize>, kNumGPUMemoryCategories> mCategorySizes = {};
+		std::array<std::atomic<uint32>, kNumGPUMemoryCategories> mNumCategoryAllocations = {};
+	};
+} // Turbo
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Core/Name.h"
+#include "Graphics/Enums.h"
+#include "Graphics/GraphicsCore.h"
+
+#include <atomic>
+
+DECLARE_LOG_CATEGORY(LogGPUProfiler, Info, Display)
+
+namespace Turbo
+{
+	class FCommandBuffer;
+	class FGPUDevice;
+
+	constexpr uint32 kMaxGPUProfilerScopes = 256;
+	constexpr uint32 kGPUProfilerHistorySize = 128;
+
+	/** Order matches the order of the query results, which follows vk::QueryPipelineStatisticFlagBits */
+	enum class EGPUPipelineStatistic : uint8
+	{
+		InputAssemblyPrimitives,
+		VertexShaderInvocations,
+		FragmentShaderInvocations,
+		ComputeShaderInvocations,
+
+		Num
+	};
+
+	constexpr uint32 kNumGPUPipelineStatistics = static_cast<uint32>(EGPUPipelineStatistic::Num);
+
+	struct FGPUProfilerSample
+	{
+		float mTimeMs = 0.f;
+		std::array<uint64, kNumGPUPipelineStatistics> mPipelineStatistics = {};
+	};
+
+	/** Rolling statistics of all scopes with the same name, e.g. a render graph pass */
+	struct FGPUProfilerScopeStats
+	{
+		FName mName = {};
+
+		std::array<FGPUProfilerSample, kGPUProfilerHistorySize> mHistory = {};
+		uint32 mNumSamples = 0;
+		/** Slot of the newest sample in mHistory */
+		uint32 mLatestSample = 0;
+		/** Frame of the newest sample. Scopes sharing a name within a frame are summed into one sample. */
+		uint32 mLatestFrame = std::numeric_limits<uint32>::max();
+
+		/** Summary of the history, updated when new samples are read back */
+		float mAverageTimeMs = 0.f;
+		float mP95TimeMs = 0.f;
+		float mP99TimeMs = 0.f;
+		std::array<uint64, kNumGPUPipelineStatistics> mAveragePipelineStatistics = {};
+	};
+
+	/**
+	 * Measures GPU time of command ranges with timestamp queries and, optionally, pipeline statistics queries.
+	 * Each buffered frame has its own query pools which are read back after the frame timeline value is waited in
+	 * FGPUDevice::BeginFrame, so results are late by the number of buffered frames but never stall the CPU.
+	 * Independent of the Tracy GPU zones, works in every build configuration.
+	 */
+	class FGPUProfiler final
+	{
+	public:
+		static constexpr uint32 kInvalidScope = std::numeric_limits<uint32>::max();
+
+	public:
+		void Init(FGPUDevice& gpu);
+		void Destroy(FGPUDevice& gpu);
+
+		/** Reads back the queries of the buffered frame and resets them. Its timeline value has to be waited already. */
+		void BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId);
+
+		/**
+		 * Thread safe. Returns kInvalidScope when the profiler is disabled or out of queries. Pipeline statistics
+		 * are collected only by scopes recorded for the graphics queue and they can't be nested.
+		 */
+		[[nodiscard]] uint32 BeginScope(FCommandBuffer& cmd, EQueueType queue, FName name);
+		void EndScope(FCommandBuffer& cmd, uint32 scopeId);
+
+		void ResetStats();
+
+		[[nodiscard]] std::span<const FGPUProfilerScopeStats> GetScopeStats() const { return mScopeStats; }
+		[[nodiscard]] bool IsPipelineStatisticsEnabled() const { return mbPipelineStatisticsEnabled; }
+		/** Statistics which secondary command buffers executed inside a pipeline statistics scope have to inherit */
+		[[nodiscard]] static vk::QueryPipelineStatisticFlags GetPipelineStatisticsFlags();
+
+	private:
+		struct FScope
+		{
+			FName mName = {};
+			EQueueType mQueue = EQueueType::Graphics;
+			bool mbPipelineStatistics = false;
+		};
+
+		struct FFrameQueries
+		{
+			vk::QueryPool mTimestampPool = nullptr;
+			vk::QueryPool mPipelineStatisticsPool = nullptr;
+
+			std::array<FScope, kMaxGPUProfilerScopes> mScopes = {};
+			std::atomic<uint32> mNumScopes = 0;
+			/** Frame which recorded the queries */
+			uint32 mFrame = 0;
+		};
+
+	private:
+		void ReadBackQueries(FGPUDevice& gpu, FFrameQueries& frameQueries);
+		void AddSample(FName name, uint32 frame, const FGPUProfilerSample& sample);
+		static void UpdateSummary(FGPUProfilerScopeStats& stats);
+
+	private:
+		std::array<FFrameQueries, kMaxBufferedFrames> mFrameQueries;
+		FFrameQueries* mCurrentFrameQueries = nullptr;
+
+		/** Timestamp bits valid for each queue type, zero when the queue doesn't support timestamps */
+		std::array<uint64, static_cast<uint32>(EQueueType::Num)> mTimestampMasks = {};
+		double mTimestampPeriodNs = 1.0;
+
+		bool mbEnabled = false;
+		/** Without device support there is no pipeline statistics pool */
+		bool mbPipelineStatisticsSupported = false;
+		bool mbPipelineStatisticsEnabled = false;
+
+		std::vector<FGPUProfilerScopeStats> mScopeStats;
+		entt::dense_map<FName, uint32> mScopeStatsLookUp;
+
+		/** Query results with availability. Sized once in Init. */
+		std::vector<uint64> mTimestampResults;
+		std::vector<uint64> mPipelineStatisticsResults;
+	};
+} // Turbo
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Assets/MaterialManager.h"
+#include "Assets/StaticMesh.h"
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/FrameGraph/RenderGraphHelpers.h"
+#include "Graphics/GraphicsCore.h"
+
+DECLARE_LOG_CATEGORY(LogGPUScene, Display, Display)
+
+namespace Turbo
+{
+	class FGPUDevice;
+	struct FRenderGraphBuilder;
+
+	/** Per-instance data of the GPU scene, mirrored by FGPUSceneInstance in BasePassCommon.slang. View independent. */
+	struct FGPUSceneInstance final
+	{
+		/** Rows of the affine model to world matrix. Shaders transform normals by its cofactor matrix. */
+		std::array<glm::float4, 3> mModelToWorldRows = {
+			glm::float4(1.f, 0.f, 0.f, 0.f),
+			glm::float4(0.f, 1.f, 0.f, 0.f),
+			glm::float4(0.f, 0.f, 1.f, 0.f)
+		};
+		/** World space bounding sphere, center and radius */
+		glm::float4 mBoundingSphere = {};
+
+		/** Index to the mesh table, see FAssetManager::GetMeshTableAddress */
+		uint32 mMeshIndex = 0;
+		/** Index to the material table, see FMaterialManager::GetMaterialTableAddress */
+		uint32 mMaterialIndex = 0;
+		/** Slot of the material instance data in the material buffer */
+		uint32 mMaterialInstanceIndex = 0;
+		/** Owned by the GPU, written only by the late phase of the scene culling. Host updates keep the GPU value. */
+		uint32 mVisibilityFlags = 0;
+
+		static constexpr uint32 kVisibleLastFrame = 1u << 0;
+	};
+	static_assert(sizeof(FGPUSceneInstance) == 80, "Has to match the scalar layout of the shader struct");
+
+	/** Stable index of the entity data in the GPU scene instance buffer */
+	struct FGPUSceneInstanceId final
+	{
+		uint32 mId = 0;
+	};
+
+	/** Mesh or material of the entity changed. Added by patching or replacing FMeshComponent. */
+	struct FGPUSceneDirty {};
+
+	/** Draws of the scene sharing the material, a range of FGPUScene::GetDrawInstanceIds */
+	struct FGPUSceneBucket final
+	{
+		THandle<FMaterial> mMaterial = {};
+		uint32 mFirstDraw = 0;
+		uint32 mNumDraws = 0;
+		/** Mesh clusters of all the draws */
+		uint32 mNumClusters = 0;
+	};
+
+	/**
+	 * Keeps per-instance data of the mesh entities in a persistent GPU buffer indexed by FGPUSceneInstanceId. Only instances
+	 * of entities with FWorldTransformDirty or FGPUSceneDirty are written each frame, a compute pass scatters them into
+	 * the instance buffer. Draw lists, instance ids sorted into material buckets, are rebuilt only when mesh entities are
+	 * added, removed or their mesh or material changes.
+	 * View dependent transforms are derived in the shaders from the view data.
+	 */
+	class FGPUScene final
+	{
+		DELETE_COPY(FGPUScene);
+
+	public:
+		FGPUScene() = default;
+
+	public:
+		void Init(FGPUDevice& gpu, entt::registry& registry);
+		void Destroy(FGPUDevice& gpu, entt::registry& registry);
+
+		/** Call after the world transforms are updated and before their dirty flags are cleared */
+		void Update(FGPUDevice& gpu, FRenderGraphBuilder& graphBuilder, entt::registry& registry);
+
+		/** Instance buffer registered in the graph by the last Update */
+		[[nodiscard]] FRGResourceHandle GetInstanceBuffer() const { return mInstanceBufferHandle; }
+		[[nodiscard]] FDeviceAddress GetInstancesAddress(const FGPUDevice& gpu) const;
+
+		[[nodiscard]] std::span<const FGPUSceneBucket> GetBuckets() const { return mBuckets; }
+		/** Instance ids of every draw of the scene, ordered by the buckets */
+		[[nodiscard]] std::span<const uint32> GetDrawInstanceIds() const { return mDrawInstanceIds; }
+		/** Parallel to the draw instance ids, index of the first mesh cluster of the draw counted from the start of its bucket */
+		[[nodiscard]] std::span<const uint32> GetDrawClusterOffsets() const { return mDrawClusterOffsets; }
+
+		[[nodiscard]] uint32 GetNumInstances() const { return mNumUsedIds - static_cast<uint32>(mFreeIds.size()); }
+		[[nodiscard]] uint32 GetNumUpdatedInstances() const { return mNumUpdatedInstances; }
+
+		/** Fills the affine transform and the world bounds of the instance */
+		static void FillInstanceTransforms(const glm::float4x4& modelToWorld, const FBounds& meshBounds, FGPUSceneInstance& outInstance);
+
+	private:
+		void OnMeshComponentUpdated(entt::registry& registry, entt::entity entity);
+		void OnMeshComponentDestroyed(entt::registry& registry, entt::entity entity);
+		void OnInstanceIdDestroyed(entt::registry& registry, entt::entity entity);
+
+		[[nodiscard]] uint32 AcquireInstanceId();
+
+		/** Grows the instance buffer to fit every acquired id, content of the old buffer is copied by a graph pass */
+		void ReserveInstances(FGPUDevice& gpu, FRenderGraphBuilder& graphBuilder);
+		void CreateInstanceBuffer(FGPUDevice& gpu, uint32 capacity);
+		void RebuildDrawLists(entt::registry& registry);
+		void AddUpdatePass(FRenderGraphBuilder& graphBuilder, std::span<const entt::entity> entities, entt::registry& registry);
+
+	private:
+		THandle<FPipeline> mUpdatePipeline = {};
+
+		THandle<FBuffer> mInstanceBuffer = {};
+		uint32 mInstanceCapacity = 0;
+		FRGResourceHandle mInstanceBufferHandle = {};
+
+		uint32 mNumUsedIds = 0;
+		std::vector<uint32> mFreeIds;
+
+		std::vector<FGPUSceneBucket> mBuckets;
+		std::vector<uint32> mDrawInstanceIds;
+		std::vector<uint32> mDrawClusterOffsets;
+		bool mbDrawListsDirty = true;
+
+		std::vector<entt::entity> mUpdatedEntities;
+		uint32 mNumUpdatedInstances = 0;
+	};
+} // Turbo
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/CommandBuffer.h"
+#include "Graphics/GraphicsCore.h"
+
+#include <deque>
+
+namespace Turbo
+{
+	class FGPUDevice;
+
+	struct FGPUUploadStats
+	{
+		uint64 mNumBatches = 0;
+		uint64 mNumCopies = 0;
+		uint64 mNumBytes = 0;
+		/** Times the host waited for a batch to free staging memory */
+		uint64 mNumStalls = 0;
+	};
+
+	/**
+	 * Uploads buffer and texture data through a persistently mapped staging ring. Data is copied to the ring right away and
+	 * the copies are recorded into a batch which is submitted to the transfer queue when the next graphics submission happens,
+	 * or sooner when the ring runs out of space. Batches signal a timeline semaphore which graphics submissions wait for, so the
+	 * host never waits for an upload unless the ring is full.
+	 * Textures are released by the transfer queue family and acquired by the graphics queue family in eShaderReadOnlyOptimal,
+	 * buffers are shared by both families. Not thread safe.
+	 */
+	class FGPUUploadManager final
+	{
+	public:
+		void Init(FGPUDevice& gpu);
+		void Destroy(FGPUDevice& gpu);
+
+		/** Recycles acquire command buffers of the buffered frame. Its timeline value has to be waited already. */
+		void BeginFrame(FGPUDevice& gpu, uint32 bufferedFrameId);
+
+		/** The data is copied to the staging ring, it can be freed once the call returns */
+		void UploadBuffer(FGPUDevice& gpu, THandle<FBuffer> dst, FDeviceSize dstOffset, std::span<const byte> data);
+
+		/** Every mip has to be uploaded in one call, mips start with the mip 0. Previous content of the texture is discarded. */
+		void UploadTexture(FGPUDevice& gpu, THandle<FTexture> dst, std::span<const std::span<const byte>> mips);
+		void UploadTexture(FGPUDevice& gpu, THandle<FTexture> dst, std::span<const byte> data);
+
+		/** Submits the recorded copies to the transfer queue without waiting */
+		void Flush(FGPUDevice& gpu);
+
+		/** Copies recorded since the last graphics submission, the next one waits for them */
+		[[nodiscard]] bool HasPendingUploads() const { return mRecordingBatch != nullptr || mLastGraphicsWaitValue != mLastSubmittedValue; }
+
+		/**
+		 * Flushes the uploads and adds the wait of the graphics queue submission on them. Returns the command buffer with
+		 * texture acquire barriers, which has to be executed before the other command buffers of the submission, or nullptr.
+		 */
+		[[nodiscard]] FCommandBuffer* PrepareGraphicsSubmit(FGPUDevice& gpu, std::vector<vk::SemaphoreSubmitInfo>& outWaitSemaphores);
+
+		/** Flushes the uploads and adds the wait of the async compute queue submission on them. Buffers need no acquire. */
+		void PrepareAsyncComputeSubmit(FGPUDevice& gpu, std::vector<vk::SemaphoreSubmitInfo>& outWaitSemaphores);
+
+		[[nodiscard]] const FGPUUploadStats& GetStats() const { return mStats; }
+		[[nodiscard]] FDeviceSize GetStagingSize() const { return mStagingSize; }
+		[[nodiscard]] FDeviceSize GetUsedStagingSize() const { return mStagingHead - mStagingTail; }
+
+	private:
+		struct FBatch
+		{
+			vk::CommandPool mVkCommandPool = nullptr;
+			TUniquePtr<FCommandBuffer> mCommandBuffer;
+
+			/** Timeline value signaled by the batch */
+			uint64 mTimelineValue = 0;
+			/** End of the staging ring range the batch reads */
+			uint64 mStagingEnd = 0;
+			/** Uploads too large for the ring */
+			std::vector<THandle<FBuffer>> mDedicatedStagingBuffers;
+		};
+
+		struct FFrameAcquire
+		{
+			vk::CommandPool mVkCommandPool = nullptr;
+			std::vector<TUniquePtr<FCommandBuffer>> mCommandBuffers;
+			uint32 mNumUsedCommandBuffers = 0;
+		};
+
+		struct FStagingAllocation
+		{
+			THandle<FBuffer> mBuffer = {};
+			byte* mMappedAddress = nullptr;
+			FDeviceSize mOffset = 0;
+		};
+
+	private:
+		[[nodiscard]] FStagingAllocation AllocateStaging(FGPUDevice& gpu, FDeviceSize size);
+		[[nodiscard]] FCommandBuffer& GetRecordingCommandBuffer(FGPUDevice& gpu);
+
+		/** Frees staging memory of completed batches, with bWait the oldest batch is waited for */
+		void RetireBatches(FGPUDevice& gpu, bool bWait);
+
+	private:
+		vk::Semaphore mTimelineSemaphore = nullptr;
+		uint64 mLastSubmittedValue = 0;
+		uint64 mLastGraphicsWaitValue = 0;
+		uint64 mLastAsyncComputeWaitValue = 0;
+
+		/** Ownership transfer is needed only when the transfer queue has its own family */
+		bool mbQueueFamilyTransfer = false;
+
+		THandle<FBuffer> mStagingBuffer = {};
+		byte* mStagingMappedAddress = nullptr;
+		FDeviceSize mStagingSize = 0;
+		/** Ring positions grow monotonically, offsets in the buffer wrap around mStagingSize */
+		uint64 mStagingHead = 0;
+		uint64 mStagingTail = 0;
+
+		TUniquePtr<FBatch> mRecordingBatch;
+		std::deque<TUniquePtr<FBatch>> mSubmittedBatches;
+		std::vector<TUniquePtr<FBatch>> mFreeBatches;
+
+		/** Graphics side of the ownership transfers of submitted batches */
+		std::vector<vk::ImageMemoryBarrier2> mPendingAcquireBarriers;
+		std::array<FFrameAcquire, kMaxBufferedFrames> mFrameAcquires;
+
+		FGPUUploadStats mStats = {};
+	};
+} // Turbo
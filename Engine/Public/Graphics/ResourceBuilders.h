@@ -12,6 +12,8 @@ namespace Turbo
 
 	struct FGPUDeviceBuilder
 	{
+		/** No window surface and swapchain, frames are rendered into offscreen textures. See FGPUDevice::IsHeadless */
+		bool mbHeadless = false;
 	};
 
 	struct FBufferBuilder
@@ -30,6 +32,10 @@ namespace Turbo
 		}
 		FBufferBuilder& SetData(const void* data) { mInitialData = data; return *this; }
 		FBufferBuilder& SetName(FName name) { mName = name; return *this; }
+		/** Places the buffer in already allocated memory (see FGPUDevice::AllocateMemory). The memory is not owned by the buffer. */
+		FBufferBuilder& SetAliasedMemory(vma::Allocation memory, FDeviceSize offset) { mAliasedMemory = memory; mAliasedMemoryOffset = offset; return *this; }
+		/** Acceleration structure buffers are categorized automatically */
+		FBufferBuilder& SetMemoryCategory(EGPUMemoryCategory category) { mMemoryCategory = category; return *this; }
 
 	public:
 		EBufferFlags mBufferFlags = EBufferFlags::None;
@@ -38,6 +44,11 @@ namespace Turbo
 		const void* mInitialData = nullptr;
 
 		FName mName;
+
+		vma::Allocation mAliasedMemory = nullptr;
+		FDeviceSize mAliasedMemoryOffset = 0;
+
+		EGPUMemoryCategory mMemoryCategory = EGPUMemoryCategory::Other;
 	};
 
 	enum class EDummyTextureType
@@ -58,6 +69,9 @@ namespace Turbo
 		FTextureBuilder& SetBindTexture(bool bBindTexture) { mbBindTexture = bBindTexture; return *this; }
 
 		FTextureBuilder& SetName(FName name) { mName = name; return *this; }
+		/** Places the texture in already allocated memory (see FGPUDevice::AllocateMemory). The memory is not owned by the texture. */
+		FTextureBuilder& SetAliasedMemory(vma::Allocation memory, FDeviceSize offset) { mAliasedMemory = memory; mAliasedMemoryOffset = offset; return *this; }
+		FTextureBuilder& SetMemoryCategory(EGPUMemoryCategory category) { mMemoryCategory = category; return *this; }
 
 	public:
 		uint16 mWidth = 1;
@@ -74,6 +88,11 @@ namespace Turbo
 		bool mbBindTexture = true;
 
 		FName mName;
+
+		vma::Allocation mAliasedMemory = nullptr;
+		FDeviceSize mAliasedMemoryOffset = 0;
+
+		EGPUMemoryCategory mMemoryCategory = EGPUMemoryCategory::Texture;
 	};
 
 	struct FSamplerBuilder
@@ -443,7 +462,11 @@ namespace Turbo
 		THandle<FBuffer> mVertexBuffer = {};
 		THandle<FBuffer> mIndexBuffer = {};
 
+		/** Indices of the triangles, a range of the index buffer starting at mFirstIndex */
 		uint32 mNumVertices = 0;
+		uint32 mFirstIndex = 0;
+		/** Highest vertex index the triangles use, mNumVertices - 1 when zero */
+		uint32 mMaxVertex = 0;
 
 		vk::GeometryTypeKHR mGeometryType = vk::GeometryTypeKHR::eTriangles;
 		vk::GeometryFlagsKHR mGeometryFlags = vk::GeometryFlagBitsKHR::eOpaque;
@@ -30,6 +30,8 @@ namespace Turbo
 		constexpr uint32 kStorageImage = 1;
 		constexpr uint32 kSampler = 2;
 		constexpr uint32 kTLAS = 3;
+
+		constexpr uint32 kNumBindings = 4;
 	}
 
 	struct FBindlessResourceUpdateRequest
@@ -232,13 +234,25 @@ namespace Turbo
 		THandle<FDescriptorPool> mhandle;
 	};
 
+	enum class EPipelineState : uint8
+	{
+		/** Compiled on a worker thread, can't be bound yet */
+		Pending,
+		Ready,
+		/** Compilation failed and there is no previous pipeline to keep */
+		Failed
+	};
+
 	struct FPipeline
 	{
 		vk::Pipeline mVkPipeline = nullptr;
 		vk::PipelineLayout mVkLayout = nullptr;
+		/** Pipelines with equal keys have compatible layouts, bound descriptor sets and push constants stay valid between them */
+		size_t mLayoutKey = 0;
 
 		vk::PipelineBindPoint mVkBindPoint = {};
 
+		EPipelineState mState = EPipelineState::Pending;
 		bool mbGraphicsPipeline = true;
 	};
 
@@ -299,6 +313,17 @@ namespace Turbo
 		EAccelerationStructureType mType;
 	};
 
+	/** Destroys memory allocated with FGPUDevice::AllocateMemory */
+	class FMemoryDestroyer : public IDestroyer
+	{
+		DESTROYER_BODY()
+	public:
+		virtual void Destroy(FGPUDevice& GPUDevice) override;
+
+	private:
+		vma::Allocation mAllocation = nullptr;
+	};
+
 	/** Vulkan object abstractions end */
 
 } // Turbo
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/Resources.h"
+
+namespace Turbo::GPUSceneUpdateCS
+{
+	struct FPushConstants
+	{
+		FDeviceAddress mInstances;
+		FDeviceAddress mUpdateIds;
+		FDeviceAddress mUpdates;
+
+		uint32 mNumUpdates;
+	};
+
+	inline THandle<FPipeline> CreatePipeline(FGPUDevice& gpu)
+	{
+		FPipelineBuilder pipelineBuilder = {};
+		pipelineBuilder
+			.SetPushConstantType<FPushConstants>()
+			.SetName(FName("GPUSceneUpdate"));
+
+		pipelineBuilder.mShaderStateBuilder
+			.AddStage("SceneRendering/GPUSceneUpdate", vk::ShaderStageFlagBits::eCompute);
+
+		return gpu.CreatePipeline(pipelineBuilder);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Core/DataStructures/Handle.h"
+#include "Graphics/GPUDevice.h"
+#include "Graphics/ResourceBuilders.h"
+#include "Graphics/Resources.h"
+
+namespace Turbo::HiZBuildCS
+{
+	/** Levels of 16 bit wide textures, down to 1x1 */
+	constexpr uint32 kMaxLevels = 16;
+	constexpr vk::Format kFormat = vk::Format::eR32Sfloat;
+
+	struct FPushConstants
+	{
+		uint32 mSource = kInvalidBinding;
+		uint32 mDestination = kInvalidBinding;
+		glm::uint2 mSourceSize = {};
+		glm::uint2 mDestinationSize = {};
+	};
+
+	inline THandle<FPipeline> CreatePipeline(FGPUDevice& gpu)
+	{
+		FPipelineBuilder pipelineBuilder = {};
+		pipelineBuilder
+			.SetPushConstantType<FPushConstants>()
+			.SetName(FName("HiZBuild"));
+
+		pipelineBuilder.mShaderStateBuilder
+			.AddStage("SceneRendering/HiZBuild", vk::ShaderStageFlagBits::eCompute);
+
+		return gpu.CreatePipeline(pipelineBuilder);
+	}
+}
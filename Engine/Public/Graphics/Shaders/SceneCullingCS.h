@@ -7,15 +7,56 @@
 
 namespace Turbo::SceneCullingCS
 {
+	enum class EPhase : uint32
+	{
+		/** Draws instances visible in the last frame */
+		Early,
+		/** Tests instances against the Hi-Z of the early draws, draws the newly visible ones and stores the visibility */
+		Late,
+		/** Draws every instance inside the frustum, used when occlusion culling is disabled */
+		FrustumOnly,
+	};
+
+	/** Counters accumulated by all phases of a frame */
+	struct FCullingStats
+	{
+		uint32 mNumEarlyDraws = 0;
+		uint32 mNumLateDraws = 0;
+		uint32 mNumFrustumCulled = 0;
+		uint32 mNumOcclusionCulled = 0;
+
+		uint32 mNumClustersFrustumCulled = 0;
+		uint32 mNumClustersConeCulled = 0;
+		uint32 mNumClustersOcclusionCulled = 0;
+		uint32 _PADDING = 0;
+	};
+
 	struct FPushConstants
 	{
 		FDeviceAddress mViewData;
-		FDeviceAddress mDrawData;
-		FDeviceAddress mBounds;
+		FDeviceAddress mInstances;
+		FDeviceAddress mDrawInstanceIds;
+		FDeviceAddress mMeshes;
 
 		FDeviceAddress mDrawIndirectCommand;
 
+		FDeviceAddress mHiZLevels;
+		FDeviceAddress mStats;
+
+		FDeviceAddress mDrawClusterOffsets;
+		FDeviceAddress mVisibleDraws;
+
+		glm::uint2 mDepthSize;
+		uint32 mNumHiZLevels;
+
 		uint32 mNumDraws;
+		/** Zero when the draws are not split into clusters */
+		uint32 mNumClusters;
+		EPhase mPhase;
+
+		/** Converts mesh space errors at unit distance to fractions of the screen space error allowed by r.lodBias */
+		float mLodErrorScale;
+		uint32 _PADDING;
 	};
 
 	inline THandle<FPipeline> CreatePipeline(FGPUDevice& gpu)
@@ -30,4 +71,18 @@ namespace Turbo::SceneCullingCS
 
 		return gpu.CreatePipeline(pipelineBuilder);
 	}
+
+	/** Tests the clusters of the draws accepted by the pipeline from CreatePipeline, shares its push constants */
+	inline THandle<FPipeline> CreateClusterPipeline(FGPUDevice& gpu)
+	{
+		FPipelineBuilder pipelineBuilder = {};
+		pipelineBuilder
+			.SetPushConstantType<FPushConstants>()
+			.SetName(FName("SceneClusterCulling"));
+
+		pipelineBuilder.mShaderStateBuilder
+			.AddStage("SceneRendering/SceneCulling", vk::ShaderStageFlagBits::eCompute, "clusterMain");
+
+		return gpu.CreatePipeline(pipelineBuilder);
+	}
 }
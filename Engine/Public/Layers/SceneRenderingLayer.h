@@ -1,8 +1,12 @@
 #pragma once
 
+#include "Core/DataStructures/ArenaArray.h"
 #include "Core/DataStructures/Handle.h"
 #include "Graphics/FrameGraph/RenderGraphHelpers.h"
+#include "Graphics/GPUScene.h"
 #include "Graphics/Resources.h"
+#include "Graphics/Shaders/HiZBuildCS.h"
+#include "Graphics/Shaders/SceneCullingCS.h"
 #include "Layer.h"
 #include "World/Camera.h"
 #include "World/World.h"
@@ -15,9 +19,6 @@ namespace Turbo
 	struct FMaterial;
 	class FCommandBuffer;
 
-	// Replace with growable buffer
-	constexpr size_t kNumAllocatedMaterialInstances = 512;
-
 	struct FSceneData final
 	{
 		uint32 mNumLights = 0;
@@ -30,14 +31,26 @@ namespace Turbo
 
 	struct FSceneView
 	{
-		// Those pointers are valid only during this frame
+		// Host copy of the uploaded view data, valid only during this frame
 		FViewData* mViewData = nullptr;
-		FSceneData* mSceneData = nullptr;
-		FLight* mLights = nullptr; // There is mNumLights in mSceneData;
 
-		FRGResourceHandle mViewDataBufferHandle = {};
-		FRGResourceHandle mSceneDataBufferHandle = {};
-		FRGResourceHandle mLightsBufferHandle = {};
+		// Upload ring addresses, valid only during this frame. There is mNumLights in the scene data.
+		FDeviceAddress mViewDataAddress = kNullDeviceAddress;
+		FDeviceAddress mSceneDataAddress = kNullDeviceAddress;
+		FDeviceAddress mLightsAddress = kNullDeviceAddress;
+
+		// Persistent GPU scene instances, valid until the next GPU scene update
+		FDeviceAddress mInstancesAddress = kNullDeviceAddress;
+		FRGResourceHandle mInstanceBuffer = {};
+		// Flag per draw written by the instance culling and read by the cluster culling. Invalid when cluster culling is disabled.
+		FRGResourceHandle mVisibleDrawsBuffer = {};
+
+		// Tables the instances index into
+		FDeviceAddress mMeshTableAddress = kNullDeviceAddress;
+		FDeviceAddress mMaterialTableAddress = kNullDeviceAddress;
+
+		// Converts mesh space LOD errors at unit distance to fractions of the screen space error allowed by r.lodBias
+		float mLodErrorScale = 0.f;
 
 		// Ray-tracing
 		THandle<FTLAS> mTLAS = {};
@@ -48,8 +61,24 @@ namespace Turbo
 	{
 		THandle<FMaterial> mMaterialHandle = {};
 		uint32 mCount = 0;
+		uint32 mFirstDraw = 0;
+		// Commands the indirect buffers fit, one per draw or one per mesh cluster with cluster culling
+		uint32 mMaxDrawCommands = 0;
+		// Clusters of all draws of the bucket, zero when cluster culling is disabled
+		uint32 mNumClusters = 0;
 		FRGResourceHandle mIndirectCommandBuffer = {};
-		FRGResourceHandle mDrawBuffer = {};
+		// Draws which became visible in the late culling phase. Invalid when occlusion culling is disabled.
+		FRGResourceHandle mLateIndirectCommandBuffer = {};
+		FDeviceAddress mDrawInstanceIdsAddress = kNullDeviceAddress;
+		FDeviceAddress mDrawClusterOffsetsAddress = kNullDeviceAddress;
+	};
+
+	// Farthest depth of the depth pre-pass. Levels are separate textures, level N has 1/2^(N+1) of the depth resolution.
+	struct FHiZPyramid
+	{
+		std::array<FRGResourceHandle, HiZBuildCS::kMaxLevels> mLevels = {};
+		uint32 mNumLevels = 0;
+		glm::uint2 mDepthSize = {};
 	};
 
 	class FSceneRenderingLayer : public ILayer
@@ -66,21 +95,55 @@ namespace Turbo
 		void RenderScene(FRenderGraphBuilder& graphBuilder, FSceneView* SceneView);
 		void RenderPostProcess(FRenderGraphBuilder& graphBuilder, FSceneView* SceneView);
 
+		/** Culling counters of the last frame completed by the GPU */
+		[[nodiscard]] const SceneCullingCS::FCullingStats& GetCullingStats() const { return mCullingStats; }
+
 	private:
 		static void UpdateViewData(FWorld* world, FViewData& viewData);
 
-		static void CreateIndirectRenderBuffers(
+		void CreateIndirectRenderBuffers(
+			FRenderGraphBuilder& graphBuilder,
+			FSceneView* sceneView,
+			bool bOcclusionCulling,
+			bool bClusterCulling,
+			TArenaArray<FDrawIndirectBucket>& outBuckets
+		) const;
+
+		/** Reads the stats of the buffered frame which is about to be reused and clears them for this frame */
+		void ReadCullingStats();
+
+		void AddCullingPass(
 			FRenderGraphBuilder& graphBuilder,
-			FWorld* world,
 			FSceneView* sceneView,
-			std::vector<FDrawIndirectBucket>& outBuckets
+			const TArenaArray<FDrawIndirectBucket>& buckets,
+			SceneCullingCS::EPhase phase,
+			const FHiZPyramid* hiZ,
+			FRGResourceHandle statsBuffer
+		) const;
+
+		[[nodiscard]] const FHiZPyramid* AddHiZBuildPasses(FRenderGraphBuilder& graphBuilder, FRGResourceHandle depthTexture) const;
+
+		/** Early phase clears the depth, late phase adds the newly visible draws */
+		static void AddDepthPrepass(
+			FRenderGraphBuilder& graphBuilder,
+			FSceneView* sceneView,
+			const TArenaArray<FDrawIndirectBucket>& buckets,
+			SceneCullingCS::EPhase phase
 		);
 
 		static void CreateSceneTLAS(FRenderGraphBuilder& graphBuilder, FWorld* world, FSceneView* sceneView);
 
 	private:
 		THandle<FPipeline> mFrustumCullingPipeline = {};
+		THandle<FPipeline> mClusterCullingPipeline = {};
+		THandle<FPipeline> mHiZBuildPipeline = {};
 		THandle<FPipeline> mToneMapperPipeline = {};
+
+		// Host visible, one per buffered frame so the host reads only stats of completed frames
+		std::array<THandle<FBuffer>, kMaxBufferedFrames> mCullingStatsBuffers = {};
+		SceneCullingCS::FCullingStats mCullingStats = {};
+
+		FGPUScene mGPUScene;
 	};
 
 	template <>